@@ -0,0 +1,199 @@
+/*
+ * Checked Arithmetic - checked_arith.c
+ *
+ * Array forms of the checked operations. Calling the scalar functions in
+ * a loop with a branch per element stops the compiler from vectorizing
+ * it. Here each lane computes the wrapped result and an overflow flag
+ * with plain arithmetic only, and the flags of a block of 64 lanes are
+ * ORed together. Only a block that did overflow is revisited to build
+ * its mask bits, so a clean vector costs little more than unchecked
+ * arithmetic.
+ *
+ * The per-lane checks:
+ *   signed add        r = a + b (mod 2^N); overflow iff a and b have
+ *                     the same sign and r does not: ((a ^ r) & (b ^ r)) < 0
+ *   signed subtract   overflow iff a and b differ in sign and r differs
+ *                     from a: ((a ^ b) & (a ^ r)) < 0
+ *   unsigned add      the carry out of the top bit
+ *   unsigned subtract the borrow out of the top bit
+ *   multiply, 8-16    the exact product in 32 bits; overflow iff it
+ *                     changes when narrowed to the type
+ *   multiply, u32     the product in 64 bits; overflow iff the high half
+ *                     is not zero
+ *   multiply, i32     with AVX2, the same from an unsigned product;
+ *                     otherwise the scalar ck_mul_i32()
+ *   multiply, 64      the scalar ck_mul_*() (no wider type to use)
+ */
+
+#include <string.h>
+#include "checked_arith.h"
+
+#define BLOCK 64
+
+// ============================================================================
+// Lanes
+// ============================================================================
+
+// Flags come from sign bits and shifts rather than compares: x86-64's
+// baseline SSE2 has no 64-bit vector compare, but it can shift.
+#define CK_TOP_BIT(U, v) ((U)((U)(v) >> (sizeof(U) * 8 - 1)))
+
+#define CK_SIGNED_LANES(sfx, T, U, MIN, MAX)                    \
+    static inline U add_lane_##sfx(T x, T y, T *z)            \
+    {                                                           \
+        T r = (T)(U)((U)x + (U)y);                              \
+        *z = r;                                                 \
+        return CK_TOP_BIT(U, (x ^ r) & (y ^ r));                \
+    }                                                           \
+    static inline U sub_lane_##sfx(T x, T y, T *z)            \
+    {                                                           \
+        T r = (T)(U)((U)x - (U)y);                              \
+        *z = r;                                                 \
+        return CK_TOP_BIT(U, (x ^ y) & (x ^ r));                \
+    }
+
+// Carry and borrow out of the top bit, as a full adder computes them
+#define CK_UNSIGNED_LANES(sfx, T, U, MIN, MAX)                  \
+    static inline U add_lane_##sfx(T x, T y, T *z)            \
+    {                                                           \
+        T r = (T)(x + y);                                       \
+        *z = r;                                                 \
+        return CK_TOP_BIT(U, (x & y) | ((x | y) & ~r));         \
+    }                                                           \
+    static inline U sub_lane_##sfx(T x, T y, T *z)            \
+    {                                                           \
+        T r = (T)(x - y);                                       \
+        *z = r;                                                 \
+        return CK_TOP_BIT(U, (~x & y) | (~(x ^ y) & r));        \
+    }
+
+// 8- and 16-bit products are exact in 32 bits
+#define CK_NARROW_MUL_LANE(sfx, T, U, W)                        \
+    static inline U mul_lane_##sfx(T x, T y, T *z)              \
+    {                                                           \
+        W p = (W)x * (W)y;                                      \
+        *z = (T)p;                                              \
+        return (U)(p != (W)(T)p);                               \
+    }
+
+CK_SIGNED_TYPES(CK_SIGNED_LANES)
+CK_UNSIGNED_TYPES(CK_UNSIGNED_LANES)
+
+CK_NARROW_MUL_LANE(i8, int8_t, uint8_t, int32_t)
+CK_NARROW_MUL_LANE(i16, int16_t, uint16_t, int32_t)
+CK_NARROW_MUL_LANE(u8, uint8_t, uint8_t, uint32_t)
+CK_NARROW_MUL_LANE(u16, uint16_t, uint16_t, uint32_t)
+
+// 32-bit products in 64 bits. Unsigned: the high half must be zero.
+// "v != 0" is the top bit of v | -v.
+static inline uint32_t mul_lane_u32(uint32_t x, uint32_t y, uint32_t *z)
+{
+    uint64_t p = (uint64_t)x * y;
+    uint32_t high = (uint32_t)(p >> 32);
+    *z = (uint32_t)p;
+    return (high | (0 - high)) >> 31;
+}
+
+#ifdef __AVX2__
+// Signed, vectorized: the product is taken unsigned because that is the
+// widening multiply x86 vectors have; the signed high half is the
+// unsigned one less y where x < 0 and less x where y < 0, and it must
+// equal the sign extension of the low half.
+static inline uint32_t mul_lane_i32(int32_t x, int32_t y, int32_t *z)
+{
+    uint32_t ux = (uint32_t)x, uy = (uint32_t)y;
+    uint64_t p = (uint64_t)ux * uy;
+    uint32_t low = (uint32_t)p;
+    uint32_t high = (uint32_t)(p >> 32) - (uy & (0 - (ux >> 31))) - (ux & (0 - (uy >> 31)));
+    uint32_t diff = high ^ (0 - (low >> 31));
+    *z = (int32_t)low;
+    return (diff | (0 - diff)) >> 31;
+}
+#else
+// With SSE2 alone the sequence above costs more than it saves: one
+// scalar multiply and overflow test per lane is faster
+static inline uint32_t mul_lane_i32(int32_t x, int32_t y, int32_t *z)
+{
+    return ck_mul_i32(x, y, z);
+}
+#endif
+
+static inline uint64_t mul_lane_i64(int64_t x, int64_t y, int64_t *z)
+{
+    return ck_mul_i64(x, y, z);
+}
+
+static inline uint64_t mul_lane_u64(uint64_t x, uint64_t y, uint64_t *z)
+{
+    return ck_mul_u64(x, y, z);
+}
+
+// ============================================================================
+// Arrays
+// ============================================================================
+
+// Only called for blocks that overflowed, so a portable loop will do
+static size_t count_bits(uint64_t bits)
+{
+    size_t count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        count++;
+    }
+    return count;
+}
+
+// Results go to a local array first: it cannot alias a or b, so with a
+// full block's fixed trip count the loop vectorizes without runtime
+// overlap checks, and r may safely be a or b. The lanes' overflow words
+// are only ORed together; a block that overflowed is re-run for its mask
+// bits before r is written, while a and b are still intact.
+#define CK_LANE_LOOP(op, sfx, count)                                                \
+    for (size_t i = 0; i < (count); i++)                                            \
+    {                                                                               \
+        any |= op##_lane_##sfx(a[base + i], b[base + i], &out[i]);                  \
+    }
+
+#define CK_DEFINE_ARRAY(op, sfx, T, U)                                              \
+    size_t ck_##op##_array_##sfx(const T *a, const T *b, T *r, size_t n, uint64_t *mask) \
+    {                                                                               \
+        size_t overflows = 0;                                                       \
+        for (size_t base = 0; base < n; base += BLOCK)                              \
+        {                                                                           \
+            size_t len = n - base < BLOCK ? n - base : BLOCK;                       \
+            T out[BLOCK];                                                           \
+            U any = 0;                                                              \
+            if (len == BLOCK)                                                       \
+            {                                                                       \
+                CK_LANE_LOOP(op, sfx, BLOCK)                                        \
+            }                                                                       \
+            else                                                                    \
+            {                                                                       \
+                CK_LANE_LOOP(op, sfx, len)                                          \
+            }                                                                       \
+            uint64_t bits = 0;                                                      \
+            if (any != 0)                                                           \
+            {                                                                       \
+                for (size_t i = 0; i < len; i++)                                    \
+                {                                                                   \
+                    T z;                                                            \
+                    bits |= (uint64_t)(op##_lane_##sfx(a[base + i], b[base + i], &z) != 0) << i; \
+                }                                                                   \
+                overflows += count_bits(bits);                                      \
+            }                                                                       \
+            memcpy(r + base, out, len * sizeof(T));                                 \
+            if (mask != NULL)                                                       \
+            {                                                                       \
+                mask[base / BLOCK] = bits;                                          \
+            }                                                                       \
+        }                                                                           \
+        return overflows;                                                           \
+    }
+
+#define CK_DEFINE_ARRAYS(sfx, T, U, MIN, MAX) \
+    CK_DEFINE_ARRAY(add, sfx, T, U)           \
+    CK_DEFINE_ARRAY(sub, sfx, T, U)           \
+    CK_DEFINE_ARRAY(mul, sfx, T, U)
+
+CK_SIGNED_TYPES(CK_DEFINE_ARRAYS)
+CK_UNSIGNED_TYPES(CK_DEFINE_ARRAYS)
@@ -0,0 +1,186 @@
+/*
+ * Checked Arithmetic - checked_arith.h
+ *
+ * Overflow-reporting add, subtract and multiply for the fixed-width
+ * types of ../../listings/fixed_width.c. ../../listings/int_overflow.c
+ * shows that unsigned arithmetic wraps and that signed overflow is
+ * undefined; these functions always produce the wrapped result and say
+ * whether it is the true one.
+ *
+ * Scalar form (inline, one per operation and type):
+ *
+ *     int32_t r;
+ *     if (ck_mul_i32(a, b, &r))        // or ck_mul(a, b, &r)
+ *         ...overflow...
+ *
+ * Each returns true when the exact result does not fit in *result. GCC
+ * and Clang do this with __builtin_*_overflow (an add plus a test of the
+ * overflow flag); other compilers, or -DCK_NO_BUILTINS, use the portable
+ * checks of the *_portable functions, which are always available.
+ *
+ * Array form (checked_arith.c): r[i] = a[i] op b[i] for a whole vector,
+ * with the per-lane checks written so the compiler vectorizes them. The
+ * result is the number of lanes that overflowed, and an optional bit
+ * mask says which. r may be a or b.
+ *
+ * ck_add(), ck_add_array() and friends pick the type from the result
+ * pointer with _Generic. Only the <stdint.h> types are covered: where
+ * int64_t is long, a long long * result does not match.
+ */
+
+#ifndef CHECKED_ARITH_H
+#define CHECKED_ARITH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(CK_NO_BUILTINS) && defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && \
+    __has_builtin(__builtin_mul_overflow)
+#define CK_USE_BUILTINS 1
+#endif
+#elif !defined(CK_NO_BUILTINS) && defined(__GNUC__) && __GNUC__ >= 5
+#define CK_USE_BUILTINS 1
+#endif
+
+// X(suffix, type, unsigned type, minimum, maximum) for every type
+#define CK_SIGNED_TYPES(X)                              \
+    X(i8, int8_t, uint8_t, INT8_MIN, INT8_MAX)          \
+    X(i16, int16_t, uint16_t, INT16_MIN, INT16_MAX)     \
+    X(i32, int32_t, uint32_t, INT32_MIN, INT32_MAX)     \
+    X(i64, int64_t, uint64_t, INT64_MIN, INT64_MAX)
+
+#define CK_UNSIGNED_TYPES(X)                    \
+    X(u8, uint8_t, uint8_t, 0, UINT8_MAX)       \
+    X(u16, uint16_t, uint16_t, 0, UINT16_MAX)   \
+    X(u32, uint32_t, uint32_t, 0, UINT32_MAX)   \
+    X(u64, uint64_t, uint64_t, 0, UINT64_MAX)
+
+// ============================================================================
+// Portable checks
+// ============================================================================
+
+// Wrapped results are computed in the unsigned type, where wrapping is
+// defined; converting back to a signed type is modular on every compiler
+// this code targets (and implementation-defined, not undefined, in C).
+
+#define CK_DEFINE_SIGNED_PORTABLE(sfx, T, U, MIN, MAX)                        \
+    static inline bool ck_add_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)(U)((U)a + (U)b);                                        \
+        return b > 0 ? a > MAX - b : a < MIN - b;                             \
+    }                                                                         \
+    static inline bool ck_sub_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)(U)((U)a - (U)b);                                        \
+        return b < 0 ? a > MAX + b : a < MIN + b;                             \
+    }                                                                         \
+    static inline bool ck_mul_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)(U)((uintmax_t)a * (uintmax_t)b);                        \
+        if (a > 0)                                                            \
+        {                                                                     \
+            return b > 0 ? a > MAX / b : b < MIN / a;                         \
+        }                                                                     \
+        return b > 0 ? a < MIN / b : a != 0 && b < MAX / a;                   \
+    }
+
+#define CK_DEFINE_UNSIGNED_PORTABLE(sfx, T, U, MIN, MAX)                      \
+    static inline bool ck_add_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)(a + b);                                                 \
+        return *result < a;                                                   \
+    }                                                                         \
+    static inline bool ck_sub_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)(a - b);                                                 \
+        return a < b;                                                         \
+    }                                                                         \
+    static inline bool ck_mul_##sfx##_portable(T a, T b, T *result)           \
+    {                                                                         \
+        *result = (T)((uintmax_t)a * (uintmax_t)b);                           \
+        return a != 0 && b > MAX / a;                                         \
+    }
+
+CK_SIGNED_TYPES(CK_DEFINE_SIGNED_PORTABLE)
+CK_UNSIGNED_TYPES(CK_DEFINE_UNSIGNED_PORTABLE)
+
+// ============================================================================
+// Scalar operations
+// ============================================================================
+
+#ifdef CK_USE_BUILTINS
+#define CK_DEFINE_SCALAR(sfx, T, U, MIN, MAX)                 \
+    static inline bool ck_add_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return __builtin_add_overflow(a, b, result);          \
+    }                                                         \
+    static inline bool ck_sub_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return __builtin_sub_overflow(a, b, result);          \
+    }                                                         \
+    static inline bool ck_mul_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return __builtin_mul_overflow(a, b, result);          \
+    }
+#else
+#define CK_DEFINE_SCALAR(sfx, T, U, MIN, MAX)                 \
+    static inline bool ck_add_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return ck_add_##sfx##_portable(a, b, result);         \
+    }                                                         \
+    static inline bool ck_sub_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return ck_sub_##sfx##_portable(a, b, result);         \
+    }                                                         \
+    static inline bool ck_mul_##sfx(T a, T b, T *result)      \
+    {                                                         \
+        return ck_mul_##sfx##_portable(a, b, result);         \
+    }
+#endif
+
+CK_SIGNED_TYPES(CK_DEFINE_SCALAR)
+CK_UNSIGNED_TYPES(CK_DEFINE_SCALAR)
+
+// ============================================================================
+// Array operations
+// ============================================================================
+
+// r[i] = a[i] op b[i] (wrapped) for i < n. Returns the number of lanes
+// that overflowed. If mask is not NULL it receives (n + 63) / 64 words,
+// with bit i % 64 of mask[i / 64] set where lane i overflowed.
+#define CK_DECLARE_ARRAY(sfx, T, U, MIN, MAX)                                                  \
+    size_t ck_add_array_##sfx(const T *a, const T *b, T *r, size_t n, uint64_t *mask);        \
+    size_t ck_sub_array_##sfx(const T *a, const T *b, T *r, size_t n, uint64_t *mask);        \
+    size_t ck_mul_array_##sfx(const T *a, const T *b, T *r, size_t n, uint64_t *mask);
+
+CK_SIGNED_TYPES(CK_DECLARE_ARRAY)
+CK_UNSIGNED_TYPES(CK_DECLARE_ARRAY)
+
+#define CK_MASK_WORDS(n) (((n) + 63) / 64)
+
+// ============================================================================
+// Type-generic names
+// ============================================================================
+
+#define CK_SELECT(prefix, r)    \
+    _Generic(*(r),              \
+        int8_t: prefix##i8,     \
+        int16_t: prefix##i16,   \
+        int32_t: prefix##i32,   \
+        int64_t: prefix##i64,   \
+        uint8_t: prefix##u8,    \
+        uint16_t: prefix##u16,  \
+        uint32_t: prefix##u32,  \
+        uint64_t: prefix##u64)
+
+#define ck_add(a, b, r) CK_SELECT(ck_add_, r)(a, b, r)
+#define ck_sub(a, b, r) CK_SELECT(ck_sub_, r)(a, b, r)
+#define ck_mul(a, b, r) CK_SELECT(ck_mul_, r)(a, b, r)
+
+#define ck_add_array(a, b, r, n, mask) CK_SELECT(ck_add_array_, r)(a, b, r, n, mask)
+#define ck_sub_array(a, b, r, n, mask) CK_SELECT(ck_sub_array_, r)(a, b, r, n, mask)
+#define ck_mul_array(a, b, r, n, mask) CK_SELECT(ck_mul_array_, r)(a, b, r, n, mask)
+
+#endif /* CHECKED_ARITH_H */
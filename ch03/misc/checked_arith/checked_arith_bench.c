@@ -0,0 +1,260 @@
+/*
+ * Checked Arithmetic - checked_arith_bench.c
+ *
+ * Benchmark: elements per second for vector add and multiply, unchecked
+ * (wrapping) versus a loop of scalar checks versus the array forms. The
+ * vectors are sized to stay in cache so the arithmetic, not memory, is
+ * measured.
+ *
+ * Usage: ./checked_arith_bench [lanes] [passes]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "checked_arith.h"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t rng_state = 0x5851f42d4c957f2dULL;
+
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static size_t lanes;
+static int passes;
+static int32_t *a32, *b32, *r32;
+static int64_t *a64, *b64, *r64;
+static uint64_t *mask;
+static volatile size_t sink; // keeps results observable
+
+// Unchecked: what int_overflow.c warns about, done without UB (wrapping)
+static void add32_unchecked(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        for (size_t i = 0; i < lanes; i++)
+        {
+            r32[i] = (int32_t)((uint32_t)a32[i] + (uint32_t)b32[i]);
+        }
+        sink = (size_t)r32[p % lanes];
+    }
+}
+
+static void add32_scalar(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        size_t overflows = 0;
+        for (size_t i = 0; i < lanes; i++)
+        {
+            if (ck_add(a32[i], b32[i], &r32[i]))
+            {
+                overflows++;
+            }
+        }
+        sink = overflows;
+    }
+}
+
+static void add32_array(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        sink = ck_add_array(a32, b32, r32, lanes, NULL);
+    }
+}
+
+static void add32_array_mask(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        sink = ck_add_array(a32, b32, r32, lanes, mask);
+    }
+}
+
+static void mul32_unchecked(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        for (size_t i = 0; i < lanes; i++)
+        {
+            r32[i] = (int32_t)((uint32_t)a32[i] * (uint32_t)b32[i]);
+        }
+        sink = (size_t)r32[p % lanes];
+    }
+}
+
+static void mul32_scalar(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        size_t overflows = 0;
+        for (size_t i = 0; i < lanes; i++)
+        {
+            if (ck_mul(a32[i], b32[i], &r32[i]))
+            {
+                overflows++;
+            }
+        }
+        sink = overflows;
+    }
+}
+
+static void mul32_array(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        sink = ck_mul_array(a32, b32, r32, lanes, NULL);
+    }
+}
+
+static void add64_unchecked(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        for (size_t i = 0; i < lanes; i++)
+        {
+            r64[i] = (int64_t)((uint64_t)a64[i] + (uint64_t)b64[i]);
+        }
+        sink = (size_t)r64[p % lanes];
+    }
+}
+
+static void add64_scalar(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        size_t overflows = 0;
+        for (size_t i = 0; i < lanes; i++)
+        {
+            if (ck_add(a64[i], b64[i], &r64[i]))
+            {
+                overflows++;
+            }
+        }
+        sink = overflows;
+    }
+}
+
+static void add64_array(void)
+{
+    for (int p = 0; p < passes; p++)
+    {
+        sink = ck_add_array(a64, b64, r64, lanes, NULL);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    lanes = (argc > 1) ? strtoul(argv[1], NULL, 10) : 4096;
+    passes = (argc > 2) ? atoi(argv[2]) : 20000;
+    if (lanes == 0 || passes <= 0)
+    {
+        fprintf(stderr, "Usage: %s [lanes] [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    a32 = malloc(lanes * sizeof(*a32));
+    b32 = malloc(lanes * sizeof(*b32));
+    r32 = malloc(lanes * sizeof(*r32));
+    a64 = malloc(lanes * sizeof(*a64));
+    b64 = malloc(lanes * sizeof(*b64));
+    r64 = malloc(lanes * sizeof(*r64));
+    mask = malloc(CK_MASK_WORDS(lanes) * sizeof(*mask));
+    if (!a32 || !b32 || !r32 || !a64 || !b64 || !r64 || !mask)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    // Mostly in range, with an occasional overflow as in real data
+    for (size_t i = 0; i < lanes; i++)
+    {
+        a32[i] = (int32_t)(next_random() % 60000) - 30000;
+        b32[i] = (int32_t)(next_random() % 60000) - 30000;
+        a64[i] = (int64_t)(next_random() >> 2) - (INT64_MAX >> 2);
+        b64[i] = (int64_t)(next_random() >> 2) - (INT64_MAX >> 2);
+        if (i % 1000 == 999)
+        {
+            a32[i] = INT32_MAX;
+            b32[i] = 1000;
+            a64[i] = INT64_MAX;
+            b64[i] = 1000;
+        }
+    }
+
+    struct
+    {
+        const char *label;
+        void (*fn)(void);
+    } rows[] = {
+        {"int32 add, unchecked", add32_unchecked},
+        {"int32 add, ck_add() per lane", add32_scalar},
+        {"int32 add, ck_add_array()", add32_array},
+        {"int32 add, ck_add_array() + mask", add32_array_mask},
+        {"int32 mul, unchecked", mul32_unchecked},
+        {"int32 mul, ck_mul() per lane", mul32_scalar},
+        {"int32 mul, ck_mul_array()", mul32_array},
+        {"int64 add, unchecked", add64_unchecked},
+        {"int64 add, ck_add() per lane", add64_scalar},
+        {"int64 add, ck_add_array()", add64_array},
+    };
+    size_t nrows = sizeof(rows) / sizeof(rows[0]);
+
+    printf("=== Checked Arithmetic Benchmark ===\n\n");
+    printf("%zu lanes x %d passes per method\n\n", lanes, passes);
+    printf("  %-34s %14s %10s\n", "Method", "Elements/s", "vs plain");
+
+    // Warm up the caches and the CPU clock
+    for (size_t i = 0; i < nrows; i++)
+    {
+        int saved = passes;
+        passes = saved / 10 + 1;
+        rows[i].fn();
+        passes = saved;
+    }
+
+    double baseline = 0;
+    for (size_t i = 0; i < nrows; i++)
+    {
+        double t0 = now_seconds();
+        rows[i].fn();
+        double t = now_seconds() - t0;
+        if (rows[i].fn == add32_unchecked || rows[i].fn == mul32_unchecked || rows[i].fn == add64_unchecked)
+        {
+            baseline = t;
+            printf("\n");
+        }
+        printf("  %-34s %14.0f %9.2fx\n", rows[i].label, (double)lanes * passes / t, t / baseline);
+    }
+
+    // The array forms must report what the scalar checks report
+    size_t scalar = 0;
+    int32_t z;
+    for (size_t i = 0; i < lanes; i++)
+    {
+        scalar += ck_add(a32[i], b32[i], &z);
+    }
+    int ok = ck_add_array(a32, b32, r32, lanes, mask) == scalar;
+
+    free(a32);
+    free(b32);
+    free(r32);
+    free(a64);
+    free(b64);
+    free(r64);
+    free(mask);
+    printf("\n%s Array and scalar overflow counts agree (%zu lanes)\n", ok ? "✓" : "✗", scalar);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
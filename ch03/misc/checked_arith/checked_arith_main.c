@@ -0,0 +1,314 @@
+/*
+ * Checked Arithmetic - checked_arith_main.c
+ *
+ * Demonstrates overflow-reporting arithmetic: edge cases for every type,
+ * the builtin and portable checks against exact results, _Generic
+ * dispatch, array forms with their overflow masks, and the factorial and
+ * power of ch10/misc/simple_program/math.c done with checks.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checked_arith.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static uint64_t rng_state = 0x853c49e6748fea9bULL;
+
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Random value biased towards the ends of the range, where overflow is
+static uint64_t random_bits(void)
+{
+    uint64_t v = next_random();
+    switch (next_random() % 4)
+    {
+    case 0:
+        return v >> (next_random() % 64); // small positive
+    case 1:
+        return ~(v >> (next_random() % 64)); // small negative / near max
+    default:
+        return v;
+    }
+}
+
+// Exact results in a wider type for the 8/16/32-bit checks
+static int fits(int64_t exact, int64_t min, int64_t max)
+{
+    return exact >= min && exact <= max;
+}
+
+// factorial() and power() from ch10/misc/simple_program/math.c, with
+// multiply() replaced by a checked one. Return -1 on overflow.
+static int checked_factorial(int32_t n, int32_t *result)
+{
+    int32_t r = 1;
+    for (int32_t i = 2; i <= n; i++)
+    {
+        if (ck_mul(r, i, &r))
+        {
+            return -1;
+        }
+    }
+    *result = r;
+    return 0;
+}
+
+static int checked_power(int32_t base, int32_t exponent, int32_t *result)
+{
+    int32_t r = 1;
+    for (int32_t i = 0; i < exponent; i++)
+    {
+        if (ck_mul(r, base, &r))
+        {
+            return -1;
+        }
+    }
+    *result = r;
+    return 0;
+}
+
+// Every array kernel against its scalar function on biased random lanes
+#define CHECK_ARRAY_OP(op, sfx, T)                                                   \
+    {                                                                                \
+        T a[LANES], b[LANES], r[LANES], z;                                           \
+        uint64_t mask[CK_MASK_WORDS(LANES)];                                         \
+        for (int i = 0; i < LANES; i++)                                              \
+        {                                                                            \
+            a[i] = (T)random_bits();                                                 \
+            b[i] = (T)random_bits();                                                 \
+        }                                                                            \
+        size_t count = ck_##op##_array_##sfx(a, b, r, LANES, mask), expect = 0;      \
+        for (int i = 0; i < LANES; i++)                                              \
+        {                                                                            \
+            int ov = ck_##op##_##sfx(a[i], b[i], &z);                                \
+            expect += (size_t)ov;                                                    \
+            bad += z != r[i] || ov != (int)((mask[i / 64] >> (i % 64)) & 1);         \
+        }                                                                            \
+        bad += count != expect;                                                      \
+    }
+
+#define CHECK_ARRAYS(sfx, T, U, MIN, MAX) \
+    CHECK_ARRAY_OP(add, sfx, T)           \
+    CHECK_ARRAY_OP(sub, sfx, T)           \
+    CHECK_ARRAY_OP(mul, sfx, T)
+
+int main(void)
+{
+    printf("=== Checked Arithmetic ===\n\n");
+#ifdef CK_USE_BUILTINS
+    printf("Scalar checks: __builtin_*_overflow\n\n");
+#else
+    printf("Scalar checks: portable fallback\n\n");
+#endif
+
+    // Test 1: Edge cases
+    printf("Test 1: Edge cases\n");
+    {
+        int8_t i8;
+        uint8_t u8;
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        int ok = ck_add_i8(INT8_MAX, 1, &i8) && i8 == INT8_MIN;
+        ok = ok && !ck_add_i8(INT8_MAX, 0, &i8) && i8 == INT8_MAX;
+        ok = ok && ck_add_u8(255, 1, &u8) && u8 == 0;
+        ok = ok && ck_mul_u8(200, 200, &u8) && u8 == (uint8_t)40000;
+        check(ok, "INT8_MAX + 1 and 200 * 200 overflow, with the wrapped result");
+
+        ok = ck_sub_u32(0, 1, &u32) && u32 == UINT32_MAX;
+        ok = ok && ck_sub_i32(INT32_MIN, 1, &i32) && i32 == INT32_MAX;
+        ok = ok && ck_mul_i32(INT32_MIN, -1, &i32) && i32 == INT32_MIN;
+        ok = ok && !ck_mul_i32(-46341, 46340, &i32) && i32 == -2147441940;
+        check(ok, "0u - 1, INT32_MIN - 1, INT32_MIN * -1");
+
+        ok = ck_mul_i64(INT64_MIN, -1, &i64) && i64 == INT64_MIN;
+        ok = ok && !ck_mul_i64(INT64_MIN, 1, &i64) && i64 == INT64_MIN;
+        ok = ok && ck_mul_u64(UINT64_MAX, 2, &u64) && u64 == UINT64_MAX - 1;
+        ok = ok && !ck_mul_u64(4294967296ULL, 4294967295ULL, &u64);
+        ok = ok && ck_mul_u64(4294967296ULL, 4294967296ULL, &u64) && u64 == 0;
+        ok = ok && !ck_sub_i64(-1, INT64_MAX, &i64) && i64 == INT64_MIN;
+        check(ok, "64-bit: INT64_MIN * -1, UINT64_MAX * 2, 2^32 * 2^32");
+    }
+    printf("\n");
+
+    // Test 2: Every 8-bit pair, random wider values
+    printf("Test 2: Builtin and portable checks against exact arithmetic\n");
+    {
+        int bad = 0;
+        for (int a = -128; a < 128; a++)
+        {
+            for (int b = -128; b < 128; b++)
+            {
+                int8_t r1, r2;
+                bad += ck_add_i8((int8_t)a, (int8_t)b, &r1) != !fits(a + b, INT8_MIN, INT8_MAX);
+                bad += ck_add_i8_portable((int8_t)a, (int8_t)b, &r2) != !fits(a + b, INT8_MIN, INT8_MAX) || r1 != r2;
+                bad += ck_sub_i8((int8_t)a, (int8_t)b, &r1) != !fits(a - b, INT8_MIN, INT8_MAX);
+                bad += ck_sub_i8_portable((int8_t)a, (int8_t)b, &r2) != !fits(a - b, INT8_MIN, INT8_MAX) || r1 != r2;
+                bad += ck_mul_i8((int8_t)a, (int8_t)b, &r1) != !fits(a * b, INT8_MIN, INT8_MAX);
+                bad += ck_mul_i8_portable((int8_t)a, (int8_t)b, &r2) != !fits(a * b, INT8_MIN, INT8_MAX) || r1 != r2;
+
+                uint8_t x = (uint8_t)a, y = (uint8_t)b, s1, s2;
+                bad += ck_add_u8(x, y, &s1) != !fits(x + y, 0, UINT8_MAX);
+                bad += ck_add_u8_portable(x, y, &s2) != !fits(x + y, 0, UINT8_MAX) || s1 != s2;
+                bad += ck_sub_u8(x, y, &s1) != !fits(x - y, 0, UINT8_MAX);
+                bad += ck_sub_u8_portable(x, y, &s2) != !fits(x - y, 0, UINT8_MAX) || s1 != s2;
+                bad += ck_mul_u8(x, y, &s1) != !fits(x * y, 0, UINT8_MAX);
+                bad += ck_mul_u8_portable(x, y, &s2) != !fits(x * y, 0, UINT8_MAX) || s1 != s2;
+            }
+        }
+        check(bad == 0, "all 65,536 int8_t and uint8_t pairs, three operations");
+
+        bad = 0;
+        for (int i = 0; i < 1000000; i++)
+        {
+            uint64_t ra = random_bits(), rb = random_bits();
+            int32_t a = (int32_t)ra, b = (int32_t)rb, r1, r2;
+            int64_t wa = a, wb = b;
+            bad += ck_add_i32(a, b, &r1) != !fits(wa + wb, INT32_MIN, INT32_MAX);
+            bad += (ck_add_i32_portable(a, b, &r2) != !fits(wa + wb, INT32_MIN, INT32_MAX)) || r1 != r2;
+            bad += ck_sub_i32(a, b, &r1) != !fits(wa - wb, INT32_MIN, INT32_MAX);
+            bad += (ck_sub_i32_portable(a, b, &r2) != !fits(wa - wb, INT32_MIN, INT32_MAX)) || r1 != r2;
+            bad += ck_mul_i32(a, b, &r1) != !fits(wa * wb, INT32_MIN, INT32_MAX);
+            bad += (ck_mul_i32_portable(a, b, &r2) != !fits(wa * wb, INT32_MIN, INT32_MAX)) || r1 != r2;
+
+            int16_t h = (int16_t)ra, k = (int16_t)rb, h1, h2;
+            bad += (ck_mul_i16(h, k, &h1) != ck_mul_i16_portable(h, k, &h2)) || h1 != h2;
+            uint16_t uh = (uint16_t)ra, uk = (uint16_t)rb, uh1, uh2;
+            bad += (ck_mul_u16(uh, uk, &uh1) != ck_mul_u16_portable(uh, uk, &uh2)) || uh1 != uh2;
+
+            // 64-bit: no wider type here, so builtin and portable must agree
+            int64_t p = (int64_t)ra, q = (int64_t)rb, p1, p2;
+            bad += (ck_add_i64(p, q, &p1) != ck_add_i64_portable(p, q, &p2)) || p1 != p2;
+            bad += (ck_sub_i64(p, q, &p1) != ck_sub_i64_portable(p, q, &p2)) || p1 != p2;
+            bad += (ck_mul_i64(p, q, &p1) != ck_mul_i64_portable(p, q, &p2)) || p1 != p2;
+            uint64_t u1, u2;
+            bad += (ck_add_u64(ra, rb, &u1) != ck_add_u64_portable(ra, rb, &u2)) || u1 != u2;
+            bad += (ck_sub_u64(ra, rb, &u1) != ck_sub_u64_portable(ra, rb, &u2)) || u1 != u2;
+            bad += (ck_mul_u64(ra, rb, &u1) != ck_mul_u64_portable(ra, rb, &u2)) || u1 != u2;
+        }
+        check(bad == 0, "1,000,000 random 16/32/64-bit pairs");
+    }
+    printf("\n");
+
+    // Test 3: _Generic
+    printf("Test 3: Type-generic names\n");
+    {
+        int16_t s16;
+        uint16_t u16;
+        int64_t s64;
+        int ok = ck_add((int16_t)32767, (int16_t)1, &s16) && s16 == INT16_MIN;
+        ok = ok && !ck_add((uint16_t)32767, (uint16_t)1, &u16) && u16 == 32768;
+        ok = ok && !ck_add((int64_t)32767, (int64_t)1, &s64) && s64 == 32768;
+        check(ok, "32767 + 1 overflows int16_t only; the result type picks the width");
+    }
+    printf("\n");
+
+    // Test 4: Arrays
+    printf("Test 4: Whole vectors with an overflow mask\n");
+    {
+        enum { LANES = 1000 };
+        int bad = 0;
+        for (int round = 0; round < 100; round++)
+        {
+            CK_SIGNED_TYPES(CHECK_ARRAYS)
+            CK_UNSIGNED_TYPES(CHECK_ARRAYS)
+        }
+        check(bad == 0, "all 24 kernels agree with the scalar checks, lane by lane");
+    }
+    {
+        enum { N = 1000 };
+        static int32_t a[N], b[N], r[N], expect[N];
+        static uint64_t mask[CK_MASK_WORDS(N)];
+        size_t planted = 0;
+        int expect_bit[N];
+        for (int i = 0; i < N; i++)
+        {
+            a[i] = (int32_t)(next_random() % 2000001) - 1000000;
+            b[i] = (int32_t)(next_random() % 2000001) - 1000000;
+            if (i % 97 == 5)
+            {
+                a[i] = INT32_MAX - (int32_t)(next_random() % 10);
+                b[i] = 100;
+            }
+            expect_bit[i] = ck_add_i32(a[i], b[i], &expect[i]);
+            planted += (size_t)expect_bit[i];
+        }
+        size_t count = ck_add_array(a, b, r, N, mask);
+        int bits_ok = memcmp(r, expect, sizeof(r)) == 0;
+        for (int i = 0; i < N; i++)
+        {
+            bits_ok = bits_ok && (int)((mask[i / 64] >> (i % 64)) & 1) == expect_bit[i];
+        }
+        printf("  %zu of %d lanes overflowed (%zu planted)\n", count, N, planted);
+        check(count == planted && bits_ok, "count, mask bits and wrapped results match the scalar checks");
+
+        // In place, with a length that is not a multiple of 64
+        static uint8_t x[200], y[200], z[200];
+        for (int i = 0; i < 200; i++)
+        {
+            x[i] = (uint8_t)i;
+            y[i] = 3;
+        }
+        size_t m = ck_mul_array(x, y, x, 200, NULL);
+        int ok = m == 200 - 86; // 3 * 85 = 255 still fits
+        for (int i = 0; i < 200; i++)
+        {
+            ok = ok && x[i] == (uint8_t)(i * 3);
+        }
+        check(ok, "in place (r == a), 200 uint8_t lanes, no mask");
+
+        for (int i = 0; i < 200; i++)
+        {
+            z[i] = (uint8_t)i;
+        }
+        check(ck_sub_array(z, z, z, 200, NULL) == 0 && z[199] == 0, "x - x never overflows");
+    }
+    printf("\n");
+
+    // Test 5: The calculator
+    printf("Test 5: factorial() and power() from simple_program, checked\n");
+    {
+        int32_t f = 0, p = 0;
+        int ok = checked_factorial(12, &f) == 0 && f == 479001600;
+        printf("  12! = %" PRId32 "\n", f);
+        ok = ok && checked_factorial(13, &f) == -1;
+        printf("  13! overflows int32_t (the unchecked version returns %" PRId32 ")\n",
+               (int32_t)(uint32_t)(479001600u * 13u));
+        ok = ok && checked_power(2, 30, &p) == 0 && checked_power(2, 31, &p) == -1;
+        ok = ok && checked_power(-2, 31, &p) == 0 && p == INT32_MIN;
+        check(ok, "13! and 2^31 are reported, (-2)^31 fits");
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Every operation returns the wrapped result and an overflow flag\n");
+    printf("2. Signed overflow is never performed: no undefined behavior\n");
+    printf("3. With GCC/Clang a check is one instruction plus a flag test\n");
+    printf("4. Array forms vectorize the checks and only revisit blocks that overflowed\n");
+    printf("5. _Generic picks the width from the result pointer's type\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,283 @@
+/*
+ * FAM Arena - fam_arena.c
+ *
+ * Implementation of the flexible-array-member record arena.
+ *
+ * Memory layout of a block:
+ *
+ *   | slot hdr | pad | record 0 | pad | slot hdr | pad | record 1 | ...
+ *
+ * Every slot starts on an 8-byte boundary with a small header giving the
+ * distance to the record and the record size, which is all the iterator
+ * needs to hop from one record to the next.
+ */
+
+#include "fam_arena.h"
+#include <stdalign.h>
+#include <stdlib.h>
+
+#define SLOT_ALIGN 8u
+
+// Per-record header stored in front of every record
+struct fam_slot
+{
+    uint32_t payload_offset; // from slot start to the record
+    uint32_t size;           // record size in bytes
+};
+
+// One contiguous block - itself a flexible array member structure
+struct fam_block
+{
+    struct fam_block *next;
+    size_t capacity;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+struct fam_arena
+{
+    struct fam_block *head;
+    struct fam_block *tail;
+    size_t block_size;
+    size_t count;
+    size_t bytes_used;
+    size_t block_count;
+};
+
+static size_t align_up(size_t value, size_t align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+static int is_power_of_two(size_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+// Create an empty arena; blocks are allocated on first use
+FamArena *fam_arena_create(size_t block_size)
+{
+    FamArena *arena = malloc(sizeof(FamArena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    arena->head = NULL;
+    arena->tail = NULL;
+    arena->block_size = block_size ? block_size : FAM_ARENA_DEFAULT_BLOCK;
+    arena->count = 0;
+    arena->bytes_used = 0;
+    arena->block_count = 0;
+
+    return arena;
+}
+
+// Release every record and the arena itself
+void fam_arena_destroy(FamArena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    struct fam_block *block = arena->head;
+    while (block != NULL)
+    {
+        struct fam_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+// Drop all records but keep the blocks for reuse
+void fam_arena_reset(FamArena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    for (struct fam_block *b = arena->head; b != NULL; b = b->next)
+    {
+        b->used = 0;
+    }
+    arena->tail = arena->head;
+    arena->count = 0;
+    arena->bytes_used = 0;
+}
+
+// Worst-case bytes one record can take inside a block
+size_t fam_arena_record_footprint(size_t size, size_t align)
+{
+    if (align < SLOT_ALIGN)
+    {
+        align = SLOT_ALIGN;
+    }
+    return align_up(sizeof(struct fam_slot) + (align - SLOT_ALIGN) + size, SLOT_ALIGN);
+}
+
+// Link a new block of at least `capacity` bytes after the tail
+static struct fam_block *add_block(FamArena *arena, size_t capacity)
+{
+    struct fam_block *block = malloc(sizeof(struct fam_block) + capacity);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    block->capacity = capacity;
+    block->used = 0;
+
+    if (arena->tail == NULL)
+    {
+        block->next = arena->head;
+        arena->head = block;
+    }
+    else
+    {
+        block->next = arena->tail->next;
+        arena->tail->next = block;
+    }
+    arena->tail = block;
+    arena->block_count++;
+
+    return block;
+}
+
+// Make sure the next `bytes` of records fit without another malloc()
+int fam_arena_reserve(FamArena *arena, size_t bytes)
+{
+    if (arena == NULL)
+    {
+        return -1;
+    }
+
+    struct fam_block *tail = arena->tail;
+    if (tail != NULL && tail->capacity - tail->used >= bytes)
+    {
+        return 0;
+    }
+    return add_block(arena, bytes) == NULL ? -1 : 0;
+}
+
+// Try to place a record in `block`; returns NULL if it does not fit
+static void *place(struct fam_block *block, size_t size, size_t align)
+{
+    uintptr_t base = (uintptr_t)block->data;
+    uintptr_t slot = base + block->used;
+    uintptr_t payload = (slot + sizeof(struct fam_slot) + align - 1) & ~(uintptr_t)(align - 1);
+    size_t end = align_up((size_t)(payload - base) + size, SLOT_ALIGN);
+
+    if (end > block->capacity)
+    {
+        return NULL;
+    }
+
+    struct fam_slot *hdr = (struct fam_slot *)slot;
+    hdr->payload_offset = (uint32_t)(payload - slot);
+    hdr->size = (uint32_t)size;
+    block->used = end;
+
+    return (void *)payload;
+}
+
+// Allocate one record of `size` bytes with the given alignment
+void *fam_arena_alloc(FamArena *arena, size_t size, size_t align)
+{
+    if (arena == NULL || size > UINT32_MAX)
+    {
+        return NULL;
+    }
+    if (align < SLOT_ALIGN)
+    {
+        align = SLOT_ALIGN;
+    }
+    if (!is_power_of_two(align))
+    {
+        return NULL;
+    }
+
+    void *record = NULL;
+
+    // Current block first, then any block kept around by fam_arena_reset()
+    while (arena->tail != NULL)
+    {
+        record = place(arena->tail, size, align);
+        if (record != NULL || arena->tail->next == NULL)
+        {
+            break;
+        }
+        arena->tail = arena->tail->next;
+    }
+
+    if (record == NULL)
+    {
+        size_t need = fam_arena_record_footprint(size, align);
+        size_t capacity = need > arena->block_size ? need : arena->block_size;
+        struct fam_block *block = add_block(arena, capacity);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        record = place(block, size, align);
+    }
+
+    arena->count++;
+    arena->bytes_used += size;
+
+    return record;
+}
+
+size_t fam_arena_count(const FamArena *arena)
+{
+    return (arena == NULL) ? 0 : arena->count;
+}
+
+size_t fam_arena_bytes_used(const FamArena *arena)
+{
+    return (arena == NULL) ? 0 : arena->bytes_used;
+}
+
+size_t fam_arena_block_count(const FamArena *arena)
+{
+    return (arena == NULL) ? 0 : arena->block_count;
+}
+
+// Start iterating at the first record
+void fam_arena_iter_init(const FamArena *arena, FamArenaIter *it)
+{
+    it->block = (arena == NULL) ? NULL : arena->head;
+    it->offset = 0;
+}
+
+// Return the next record (and its size) or NULL at the end
+void *fam_arena_iter_next(FamArenaIter *it, size_t *size)
+{
+    const struct fam_block *block = it->block;
+
+    while (block != NULL && it->offset >= block->used)
+    {
+        block = block->next;
+        it->offset = 0;
+    }
+    it->block = block;
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    const unsigned char *slot = block->data + it->offset;
+    const struct fam_slot *hdr = (const struct fam_slot *)slot;
+    unsigned char *payload = (unsigned char *)slot + hdr->payload_offset;
+
+    if (size != NULL)
+    {
+        *size = hdr->size;
+    }
+    it->offset = align_up(it->offset + hdr->payload_offset + hdr->size, SLOT_ALIGN);
+
+    return payload;
+}
@@ -0,0 +1,56 @@
+/*
+ * FAM Arena - fam_arena.h
+ *
+ * Public interface for a record arena that packs flexible-array-member
+ * structures back-to-back in large blocks instead of one malloc() each.
+ * Records are aligned, can be walked in creation order with an iterator,
+ * and are all released together by a single fam_arena_destroy().
+ */
+
+#ifndef FAM_ARENA_H
+#define FAM_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Default block size used when fam_arena_create() is given 0
+#define FAM_ARENA_DEFAULT_BLOCK (64u * 1024u)
+
+// Bytes needed for one FAM record: sizeof(header) + count elements
+#define FAM_SIZEOF(type, member, count) \
+    (sizeof(type) + (size_t)(count) * sizeof(((type *)0)->member[0]))
+
+// Opaque type - block list and bump pointer are hidden
+typedef struct fam_arena FamArena;
+
+// Iterator over the records of an arena, in creation order
+typedef struct
+{
+    const void *block;  // current block (internal)
+    size_t offset;      // offset of the next slot inside the block
+} FamArenaIter;
+
+// Arena lifetime
+FamArena *fam_arena_create(size_t block_size);
+void fam_arena_destroy(FamArena *arena);
+void fam_arena_reset(FamArena *arena);
+
+// Reserve room for a batch so the next records need no further malloc()
+int fam_arena_reserve(FamArena *arena, size_t bytes);
+
+// Allocate one record of `size` bytes aligned to `align` (power of two)
+void *fam_arena_alloc(FamArena *arena, size_t size, size_t align);
+
+// Capacity needed by fam_arena_reserve() for one record of this size
+size_t fam_arena_record_footprint(size_t size, size_t align);
+
+// Statistics
+size_t fam_arena_count(const FamArena *arena);
+size_t fam_arena_bytes_used(const FamArena *arena);
+size_t fam_arena_block_count(const FamArena *arena);
+
+// Iteration (returns NULL after the last record)
+void fam_arena_iter_init(const FamArena *arena, FamArenaIter *it);
+void *fam_arena_iter_next(FamArenaIter *it, size_t *size);
+
+#endif /* FAM_ARENA_H */
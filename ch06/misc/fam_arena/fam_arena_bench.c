@@ -0,0 +1,215 @@
+/*
+ * FAM Arena - fam_arena_bench.c
+ *
+ * Benchmark: creating, traversing and freeing a batch of Person records
+ * with one malloc() per record versus the FAM arena.
+ *
+ * Usage: ./fam_arena_bench [record_count]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <time.h>
+#include "fam_arena.h"
+
+typedef struct
+{
+    int id;
+    size_t name_length;
+    char name[];
+} Person;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Per-record path, as create_person() in flexible_array_member.c
+static Person *malloc_person(int id, const char *name, size_t name_len)
+{
+    Person *p = malloc(sizeof(Person) + name_len + 1);
+    if (p)
+    {
+        p->id = id;
+        p->name_length = name_len;
+        memcpy(p->name, name, name_len + 1);
+    }
+    return p;
+}
+
+static Person *arena_person(FamArena *arena, int id, const char *name, size_t name_len)
+{
+    Person *p = fam_arena_alloc(arena, FAM_SIZEOF(Person, name, name_len + 1), alignof(Person));
+    if (p)
+    {
+        p->id = id;
+        p->name_length = name_len;
+        memcpy(p->name, name, name_len + 1);
+    }
+    return p;
+}
+
+// Touch every record the way a report generator would
+static unsigned long long visit(const Person *p)
+{
+    return (unsigned long long)p->id + p->name_length + (unsigned char)p->name[p->name_length - 1];
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    if (n == 0)
+    {
+        n = 1;
+    }
+
+    // Pre-generate names so that both paths do identical work
+    char (*names)[24] = malloc(n * sizeof(*names));
+    size_t *lengths = malloc(n * sizeof(*lengths));
+    Person **people = malloc(n * sizeof(*people));
+    void **noise = malloc(n * sizeof(*noise));
+    if (!names || !lengths || !people || !noise)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        lengths[i] = (size_t)snprintf(names[i], sizeof(names[i]), "person-%zu", i * 2654435761u % 1000003u);
+    }
+
+    printf("=== FAM Arena Benchmark (%zu Person records) ===\n\n", n);
+    printf("%-28s %12s %12s %12s\n", "Path", "create ns", "traverse ns", "free ns");
+
+    // Path 1: one malloc() per record (fresh heap)
+    {
+        double t0 = now_seconds();
+        for (size_t i = 0; i < n; i++)
+        {
+            people[i] = malloc_person((int)i, names[i], lengths[i]);
+        }
+        double t1 = now_seconds();
+        unsigned long long sum = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += visit(people[i]);
+        }
+        double t2 = now_seconds();
+        for (size_t i = 0; i < n; i++)
+        {
+            free(people[i]);
+        }
+        double t3 = now_seconds();
+        printf("%-28s %12.1f %12.1f %12.1f  (checksum %llu)\n", "malloc per record",
+               (t1 - t0) * 1e9 / (double)n, (t2 - t1) * 1e9 / (double)n,
+               (t3 - t2) * 1e9 / (double)n, sum);
+    }
+
+    // Path 2: one malloc() per record interleaved with other allocations,
+    // which is what a long-running program's heap looks like
+    {
+        double t0 = now_seconds();
+        for (size_t i = 0; i < n; i++)
+        {
+            noise[i] = malloc(16 + (i * 7919) % 240);
+            people[i] = malloc_person((int)i, names[i], lengths[i]);
+        }
+        double t1 = now_seconds();
+        unsigned long long sum = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += visit(people[i]);
+        }
+        double t2 = now_seconds();
+        for (size_t i = 0; i < n; i++)
+        {
+            free(people[i]);
+        }
+        double t3 = now_seconds();
+        for (size_t i = 0; i < n; i++)
+        {
+            free(noise[i]);
+        }
+        printf("%-28s %12.1f %12.1f %12.1f  (checksum %llu)\n", "malloc per record (noisy)",
+               (t1 - t0) * 1e9 / (double)n, (t2 - t1) * 1e9 / (double)n,
+               (t3 - t2) * 1e9 / (double)n, sum);
+    }
+
+    // Path 3: arena with default blocks, iterator traversal
+    {
+        double t0 = now_seconds();
+        FamArena *arena = fam_arena_create(0);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (arena_person(arena, (int)i, names[i], lengths[i]) == NULL)
+            {
+                fprintf(stderr, "Arena allocation failed\n");
+                return EXIT_FAILURE;
+            }
+        }
+        double t1 = now_seconds();
+        unsigned long long sum = 0;
+        FamArenaIter it;
+        const Person *p;
+        fam_arena_iter_init(arena, &it);
+        while ((p = fam_arena_iter_next(&it, NULL)) != NULL)
+        {
+            sum += visit(p);
+        }
+        double t2 = now_seconds();
+        fam_arena_destroy(arena);
+        double t3 = now_seconds();
+        printf("%-28s %12.1f %12.1f %12.1f  (checksum %llu)\n", "arena (64 KiB blocks)",
+               (t1 - t0) * 1e9 / (double)n, (t2 - t1) * 1e9 / (double)n,
+               (t3 - t2) * 1e9 / (double)n, sum);
+    }
+
+    // Path 4: arena with the whole batch reserved up front
+    {
+        double t0 = now_seconds();
+        size_t total = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            total += fam_arena_record_footprint(FAM_SIZEOF(Person, name, lengths[i] + 1),
+                                                alignof(Person));
+        }
+        FamArena *arena = fam_arena_create(0);
+        if (arena == NULL || fam_arena_reserve(arena, total) != 0)
+        {
+            fprintf(stderr, "Arena reserve failed\n");
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            arena_person(arena, (int)i, names[i], lengths[i]);
+        }
+        double t1 = now_seconds();
+        unsigned long long sum = 0;
+        FamArenaIter it;
+        const Person *p;
+        fam_arena_iter_init(arena, &it);
+        while ((p = fam_arena_iter_next(&it, NULL)) != NULL)
+        {
+            sum += visit(p);
+        }
+        double t2 = now_seconds();
+        fam_arena_destroy(arena);
+        double t3 = now_seconds();
+        printf("%-28s %12.1f %12.1f %12.1f  (checksum %llu)\n", "arena (single reservation)",
+               (t1 - t0) * 1e9 / (double)n, (t2 - t1) * 1e9 / (double)n,
+               (t3 - t2) * 1e9 / (double)n, sum);
+    }
+
+    free(names);
+    free(lengths);
+    free(people);
+    free(noise);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+/*
+ * FAM Arena - fam_arena_main.c
+ *
+ * Demonstrates building batches of flexible-array-member records in an
+ * arena: one allocation for many records, iteration in creation order,
+ * and a single call to free everything.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include "fam_arena.h"
+
+// Same record types as ch06/misc/flexible_array_member.c
+typedef struct
+{
+    size_t length;
+    int data[];
+} IntArray;
+
+typedef struct
+{
+    int id;
+    size_t name_length;
+    char name[];
+} Person;
+
+typedef struct
+{
+    int type;
+    size_t count;
+    double values[];
+} DataPacket;
+
+// Arena counterparts of create_int_array(), create_person(), create_packet()
+static IntArray *arena_create_int_array(FamArena *arena, size_t n)
+{
+    IntArray *arr = fam_arena_alloc(arena, FAM_SIZEOF(IntArray, data, n), alignof(IntArray));
+    if (arr)
+    {
+        arr->length = n;
+        memset(arr->data, 0, n * sizeof(int));
+    }
+    return arr;
+}
+
+static Person *arena_create_person(FamArena *arena, int id, const char *name)
+{
+    size_t name_len = strlen(name);
+    Person *p = fam_arena_alloc(arena, FAM_SIZEOF(Person, name, name_len + 1), alignof(Person));
+    if (p)
+    {
+        p->id = id;
+        p->name_length = name_len;
+        memcpy(p->name, name, name_len + 1);
+    }
+    return p;
+}
+
+static DataPacket *arena_create_packet(FamArena *arena, int type, size_t count)
+{
+    DataPacket *pkt = fam_arena_alloc(arena, FAM_SIZEOF(DataPacket, values, count), alignof(DataPacket));
+    if (pkt)
+    {
+        pkt->type = type;
+        pkt->count = count;
+        for (size_t i = 0; i < count; i++)
+        {
+            pkt->values[i] = 0.0;
+        }
+    }
+    return pkt;
+}
+
+int main(void)
+{
+    static const char *names[] = {"Alice", "Bob", "Christopher", "Dana", "Eve"};
+    const size_t name_count = sizeof(names) / sizeof(names[0]);
+    int failures = 0;
+
+    printf("=== Flexible Array Member Arena ===\n\n");
+
+    // Test 1: Batch of Person records in one arena
+    printf("Test 1: Batch of Person records\n");
+    {
+        FamArena *arena = fam_arena_create(0);
+        if (arena == NULL)
+        {
+            fprintf(stderr, "Failed to create arena\n");
+            return EXIT_FAILURE;
+        }
+
+        for (size_t i = 0; i < name_count; i++)
+        {
+            if (arena_create_person(arena, (int)i + 1, names[i]) == NULL)
+            {
+                fprintf(stderr, "Failed to create person\n");
+                fam_arena_destroy(arena);
+                return EXIT_FAILURE;
+            }
+        }
+
+        printf("  Records: %zu, blocks: %zu, payload bytes: %zu\n",
+               fam_arena_count(arena), fam_arena_block_count(arena),
+               fam_arena_bytes_used(arena));
+
+        FamArenaIter it;
+        Person *p;
+        size_t i = 0;
+        fam_arena_iter_init(arena, &it);
+        while ((p = fam_arena_iter_next(&it, NULL)) != NULL)
+        {
+            printf("  Person: id=%d, name='%s' (length=%zu)\n", p->id, p->name, p->name_length);
+            if (i >= name_count || strcmp(p->name, names[i]) != 0)
+            {
+                failures++;
+            }
+            i++;
+        }
+        printf("  %s Iterated %zu records in creation order\n", i == name_count ? "✓" : "✗", i);
+        failures += (i != name_count);
+
+        fam_arena_destroy(arena); // frees every record at once
+    }
+    printf("\n");
+
+    // Test 2: Alignment is preserved for every record type
+    printf("Test 2: Mixed record types keep their alignment\n");
+    {
+        FamArena *arena = fam_arena_create(256);
+        if (arena == NULL)
+        {
+            fprintf(stderr, "Failed to create arena\n");
+            return EXIT_FAILURE;
+        }
+
+        int misaligned = 0;
+        for (size_t i = 0; i < 50; i++)
+        {
+            IntArray *arr = arena_create_int_array(arena, i % 7);
+            Person *p = arena_create_person(arena, (int)i, names[i % name_count]);
+            DataPacket *pkt = arena_create_packet(arena, (int)i, i % 5);
+            void *wide = fam_arena_alloc(arena, 3, 64);
+
+            if (!arr || !p || !pkt || !wide)
+            {
+                fprintf(stderr, "Allocation failed\n");
+                fam_arena_destroy(arena);
+                return EXIT_FAILURE;
+            }
+            misaligned += ((uintptr_t)arr % alignof(IntArray)) != 0;
+            misaligned += ((uintptr_t)p % alignof(Person)) != 0;
+            misaligned += ((uintptr_t)pkt % alignof(DataPacket)) != 0;
+            misaligned += ((uintptr_t)wide % 64) != 0;
+        }
+
+        printf("  %zu records in %zu blocks of 256 bytes\n",
+               fam_arena_count(arena), fam_arena_block_count(arena));
+        printf("  %s Misaligned records: %d\n", misaligned == 0 ? "✓" : "✗", misaligned);
+        failures += (misaligned != 0);
+
+        fam_arena_destroy(arena);
+    }
+    printf("\n");
+
+    // Test 3: Reserve a whole batch up front - exactly one block allocation
+    printf("Test 3: Single-allocation batch with fam_arena_reserve()\n");
+    {
+        const size_t n = 1000;
+        size_t total = 0;
+        char name[32];
+
+        for (size_t i = 0; i < n; i++)
+        {
+            int len = snprintf(name, sizeof(name), "person-%zu", i);
+            total += fam_arena_record_footprint(FAM_SIZEOF(Person, name, (size_t)len + 1),
+                                                alignof(Person));
+        }
+
+        FamArena *arena = fam_arena_create(0);
+        if (arena == NULL || fam_arena_reserve(arena, total) != 0)
+        {
+            fprintf(stderr, "Failed to reserve batch\n");
+            fam_arena_destroy(arena);
+            return EXIT_FAILURE;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            snprintf(name, sizeof(name), "person-%zu", i);
+            if (arena_create_person(arena, (int)i, name) == NULL)
+            {
+                fprintf(stderr, "Failed to create person\n");
+                fam_arena_destroy(arena);
+                return EXIT_FAILURE;
+            }
+        }
+
+        printf("  Reserved %zu bytes for %zu records\n", total, n);
+        printf("  %s Blocks allocated: %zu\n",
+               fam_arena_block_count(arena) == 1 ? "✓" : "✗", fam_arena_block_count(arena));
+        failures += (fam_arena_block_count(arena) != 1);
+
+        fam_arena_destroy(arena);
+    }
+    printf("\n");
+
+    // Test 4: Reset keeps the blocks for the next batch
+    printf("Test 4: Reusing blocks with fam_arena_reset()\n");
+    {
+        FamArena *arena = fam_arena_create(512);
+        if (arena == NULL)
+        {
+            fprintf(stderr, "Failed to create arena\n");
+            return EXIT_FAILURE;
+        }
+
+        for (int round = 0; round < 3; round++)
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                arena_create_person(arena, i, names[(size_t)i % name_count]);
+            }
+            printf("  Round %d: %zu records, %zu blocks\n", round + 1,
+                   fam_arena_count(arena), fam_arena_block_count(arena));
+            if (round < 2)
+            {
+                fam_arena_reset(arena);
+            }
+        }
+
+        size_t seen = 0;
+        FamArenaIter it;
+        fam_arena_iter_init(arena, &it);
+        while (fam_arena_iter_next(&it, NULL) != NULL)
+        {
+            seen++;
+        }
+        printf("  %s Iterator sees %zu records after reset\n", seen == 100 ? "✓" : "✗", seen);
+        failures += (seen != 100);
+
+        fam_arena_destroy(arena);
+    }
+    printf("\n");
+
+    // Test 5: Records larger than the block size get their own block
+    printf("Test 5: Oversized record\n");
+    {
+        FamArena *arena = fam_arena_create(128);
+        IntArray *big = arena ? arena_create_int_array(arena, 10000) : NULL;
+        if (big == NULL)
+        {
+            fprintf(stderr, "Failed to allocate oversized record\n");
+            fam_arena_destroy(arena);
+            return EXIT_FAILURE;
+        }
+
+        big->data[9999] = 42;
+        size_t size = 0;
+        FamArenaIter it;
+        fam_arena_iter_init(arena, &it);
+        IntArray *first = fam_arena_iter_next(&it, &size);
+        printf("  Record size: %zu bytes, last element: %d\n", size, first->data[9999]);
+        printf("  %s Size matches FAM_SIZEOF\n",
+               size == FAM_SIZEOF(IntArray, data, 10000) ? "✓" : "✗");
+        failures += (size != FAM_SIZEOF(IntArray, data, 10000));
+
+        fam_arena_destroy(arena);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. One malloc() per block instead of one per record\n");
+    printf("2. Records are contiguous, so traversal is cache friendly\n");
+    printf("3. Individual records cannot be freed - the whole arena is\n");
+    printf("4. Records cannot grow with realloc() once placed\n");
+    printf("5. Use FAM_SIZEOF() to compute the size of a record\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,335 @@
+/*
+ * String Kit - charclass.c
+ *
+ * Implementation of bulk character classification.
+ *
+ * The "C" locale table is generated by the preprocessor from the ASCII
+ * ranges below, so it costs nothing at run time. The SIMD kernels test the
+ * same ranges on 16 (SSE2) or 32 (AVX2) bytes at once: `lo <= c <= hi`
+ * becomes `min_epu8(c - lo, hi - lo) == c - lo`.
+ */
+
+#include "charclass.h"
+#include <ctype.h>
+#include <locale.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CC_X86 1
+#include <immintrin.h>
+#endif
+
+// ============================================================================
+// Compile-time "C" locale table
+// ============================================================================
+
+#define IN(c, lo, hi) ((c) >= (lo) && (c) <= (hi))
+
+#define CLS(c)                                                                   \
+    (uint8_t)((IN(c, 0x41, 0x5A) ? CC_UPPER : 0) |                              \
+              (IN(c, 0x61, 0x7A) ? CC_LOWER : 0) |                              \
+              (IN(c, 0x30, 0x39) ? CC_DIGIT : 0) |                              \
+              ((c) == 0x20 || IN(c, 0x09, 0x0D) ? CC_SPACE : 0) |               \
+              (IN(c, 0x21, 0x2F) || IN(c, 0x3A, 0x40) || IN(c, 0x5B, 0x60) ||   \
+                       IN(c, 0x7B, 0x7E)                                        \
+                   ? CC_PUNCT                                                   \
+                   : 0) |                                                       \
+              ((c) < 0x20 || (c) == 0x7F ? CC_CNTRL : 0) |                      \
+              (IN(c, 0x30, 0x39) || IN(c, 0x41, 0x46) || IN(c, 0x61, 0x66)      \
+                   ? CC_XDIGIT                                                  \
+                   : 0) |                                                       \
+              ((c) == 0x20 || (c) == 0x09 ? CC_BLANK : 0))
+
+#define R4(b) CLS(b), CLS((b) + 1), CLS((b) + 2), CLS((b) + 3)
+#define R16(b) R4(b), R4((b) + 4), R4((b) + 8), R4((b) + 12)
+#define R64(b) R16(b), R16((b) + 16), R16((b) + 32), R16((b) + 48)
+
+const uint8_t charclass_c_table[256] = {R64(0), R64(64), R64(128), R64(192)};
+
+// ============================================================================
+// Locale handling (slow path)
+// ============================================================================
+
+// One cached table per thread, rebuilt when LC_CTYPE changes
+static _Thread_local struct
+{
+    char name[128];
+    uint8_t table[256];
+    bool valid;
+} locale_cache;
+
+bool charclass_locale_is_c(void)
+{
+    const char *name = setlocale(LC_CTYPE, NULL);
+    return name == NULL || strcmp(name, "C") == 0 || strcmp(name, "POSIX") == 0;
+}
+
+static void build_locale_table(uint8_t *table)
+{
+    for (int c = 0; c < 256; c++)
+    {
+        table[c] = (uint8_t)((isupper(c) ? CC_UPPER : 0) |
+                             (islower(c) ? CC_LOWER : 0) |
+                             (isdigit(c) ? CC_DIGIT : 0) |
+                             (isspace(c) ? CC_SPACE : 0) |
+                             (ispunct(c) ? CC_PUNCT : 0) |
+                             (iscntrl(c) ? CC_CNTRL : 0) |
+                             (isxdigit(c) ? CC_XDIGIT : 0) |
+                             (isblank(c) ? CC_BLANK : 0));
+    }
+}
+
+const uint8_t *charclass_table(void)
+{
+    const char *name = setlocale(LC_CTYPE, NULL);
+    if (name == NULL || strcmp(name, "C") == 0 || strcmp(name, "POSIX") == 0)
+    {
+        return charclass_c_table;
+    }
+
+    if (!locale_cache.valid || strcmp(locale_cache.name, name) != 0)
+    {
+        build_locale_table(locale_cache.table);
+        strncpy(locale_cache.name, name, sizeof(locale_cache.name) - 1);
+        locale_cache.name[sizeof(locale_cache.name) - 1] = '\0';
+        // Names too long for the cache key are rebuilt every time
+        locale_cache.valid = strlen(name) < sizeof(locale_cache.name);
+    }
+    return locale_cache.table;
+}
+
+// ============================================================================
+// SIMD kernels for the "C" locale
+// ============================================================================
+
+#ifdef CC_X86
+
+#define INLINE static inline __attribute__((always_inline))
+#define AVX2 __attribute__((target("avx2")))
+
+// 0xFF in every byte lane where lo <= v <= hi (unsigned)
+INLINE __m128i in_range16(__m128i v, int lo, int hi)
+{
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8((char)lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8((char)(hi - lo))), t);
+}
+
+INLINE __m128i eq16(__m128i v, int c)
+{
+    return _mm_cmpeq_epi8(v, _mm_set1_epi8((char)c));
+}
+
+INLINE __m128i bit16(__m128i lanes, unsigned bit)
+{
+    return _mm_and_si128(lanes, _mm_set1_epi8((char)bit));
+}
+
+INLINE __m128i classify16(__m128i v)
+{
+    __m128i upper = in_range16(v, 0x41, 0x5A);
+    __m128i lower = in_range16(v, 0x61, 0x7A);
+    __m128i digit = in_range16(v, 0x30, 0x39);
+    __m128i blank = _mm_or_si128(eq16(v, 0x20), eq16(v, 0x09));
+    __m128i space = _mm_or_si128(eq16(v, 0x20), in_range16(v, 0x09, 0x0D));
+    __m128i cntrl = _mm_or_si128(in_range16(v, 0x00, 0x1F), eq16(v, 0x7F));
+    __m128i alnum = _mm_or_si128(_mm_or_si128(upper, lower), digit);
+    __m128i punct = _mm_andnot_si128(alnum, in_range16(v, 0x21, 0x7E));
+    __m128i xdigit = _mm_or_si128(digit, _mm_or_si128(in_range16(v, 0x41, 0x46),
+                                                      in_range16(v, 0x61, 0x66)));
+
+    __m128i r = _mm_or_si128(bit16(upper, CC_UPPER), bit16(lower, CC_LOWER));
+    r = _mm_or_si128(r, _mm_or_si128(bit16(digit, CC_DIGIT), bit16(space, CC_SPACE)));
+    r = _mm_or_si128(r, _mm_or_si128(bit16(punct, CC_PUNCT), bit16(cntrl, CC_CNTRL)));
+    return _mm_or_si128(r, _mm_or_si128(bit16(xdigit, CC_XDIGIT), bit16(blank, CC_BLANK)));
+}
+
+AVX2 INLINE __m256i in_range32(__m256i v, int lo, int hi)
+{
+    __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8((char)lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8((char)(hi - lo))), t);
+}
+
+AVX2 INLINE __m256i eq32(__m256i v, int c)
+{
+    return _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)c));
+}
+
+AVX2 INLINE __m256i bit32(__m256i lanes, unsigned bit)
+{
+    return _mm256_and_si256(lanes, _mm256_set1_epi8((char)bit));
+}
+
+AVX2 INLINE __m256i classify32(__m256i v)
+{
+    __m256i upper = in_range32(v, 0x41, 0x5A);
+    __m256i lower = in_range32(v, 0x61, 0x7A);
+    __m256i digit = in_range32(v, 0x30, 0x39);
+    __m256i blank = _mm256_or_si256(eq32(v, 0x20), eq32(v, 0x09));
+    __m256i space = _mm256_or_si256(eq32(v, 0x20), in_range32(v, 0x09, 0x0D));
+    __m256i cntrl = _mm256_or_si256(in_range32(v, 0x00, 0x1F), eq32(v, 0x7F));
+    __m256i alnum = _mm256_or_si256(_mm256_or_si256(upper, lower), digit);
+    __m256i punct = _mm256_andnot_si256(alnum, in_range32(v, 0x21, 0x7E));
+    __m256i xdigit = _mm256_or_si256(digit, _mm256_or_si256(in_range32(v, 0x41, 0x46),
+                                                            in_range32(v, 0x61, 0x66)));
+
+    __m256i r = _mm256_or_si256(bit32(upper, CC_UPPER), bit32(lower, CC_LOWER));
+    r = _mm256_or_si256(r, _mm256_or_si256(bit32(digit, CC_DIGIT), bit32(space, CC_SPACE)));
+    r = _mm256_or_si256(r, _mm256_or_si256(bit32(punct, CC_PUNCT), bit32(cntrl, CC_CNTRL)));
+    return _mm256_or_si256(r, _mm256_or_si256(bit32(xdigit, CC_XDIGIT), bit32(blank, CC_BLANK)));
+}
+
+static bool have_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+// Each kernel handles whole blocks and returns how many bytes it did
+
+AVX2 static size_t classify_avx2(const unsigned char *buf, size_t len, uint8_t *classes)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+        _mm256_storeu_si256((__m256i *)(classes + i), classify32(v));
+    }
+    return i;
+}
+
+static size_t classify_sse2(const unsigned char *buf, size_t len, uint8_t *classes)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        _mm_storeu_si128((__m128i *)(classes + i), classify16(v));
+    }
+    return i;
+}
+
+AVX2 static size_t count_avx2(const unsigned char *buf, size_t len, uint8_t mask, size_t *count)
+{
+    const __m256i m = _mm256_set1_epi8((char)mask);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i cls = classify32(_mm256_loadu_si256((const __m256i *)(buf + i)));
+        __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(cls, m), _mm256_setzero_si256());
+        *count += 32 - (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(miss));
+    }
+    return i;
+}
+
+static size_t count_sse2(const unsigned char *buf, size_t len, uint8_t mask, size_t *count)
+{
+    const __m128i m = _mm_set1_epi8((char)mask);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i cls = classify16(_mm_loadu_si128((const __m128i *)(buf + i)));
+        __m128i miss = _mm_cmpeq_epi8(_mm_and_si128(cls, m), _mm_setzero_si128());
+        *count += 16 - (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(miss));
+    }
+    return i;
+}
+
+// Subtract (or add) 0x20 in the lanes that fall in [lo, hi]
+AVX2 static size_t case_avx2(unsigned char *buf, size_t len, int lo, int hi, bool to_upper)
+{
+    const __m256i delta = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+        __m256i d = _mm256_and_si256(in_range32(v, lo, hi), delta);
+        v = to_upper ? _mm256_sub_epi8(v, d) : _mm256_add_epi8(v, d);
+        _mm256_storeu_si256((__m256i *)(buf + i), v);
+    }
+    return i;
+}
+
+static size_t case_sse2(unsigned char *buf, size_t len, int lo, int hi, bool to_upper)
+{
+    const __m128i delta = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        __m128i d = _mm_and_si128(in_range16(v, lo, hi), delta);
+        v = to_upper ? _mm_sub_epi8(v, d) : _mm_add_epi8(v, d);
+        _mm_storeu_si128((__m128i *)(buf + i), v);
+    }
+    return i;
+}
+
+#endif /* CC_X86 */
+
+// ============================================================================
+// Public entry points
+// ============================================================================
+
+void classify_buffer(const unsigned char *buf, size_t len, uint8_t *classes)
+{
+    const uint8_t *table = charclass_table();
+    size_t i = 0;
+
+#ifdef CC_X86
+    if (table == charclass_c_table)
+    {
+        i = have_avx2() ? classify_avx2(buf, len, classes) : classify_sse2(buf, len, classes);
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        classes[i] = table[buf[i]];
+    }
+}
+
+size_t count_class(const unsigned char *buf, size_t len, uint8_t mask)
+{
+    const uint8_t *table = charclass_table();
+    size_t count = 0;
+    size_t i = 0;
+
+#ifdef CC_X86
+    if (table == charclass_c_table)
+    {
+        i = have_avx2() ? count_avx2(buf, len, mask, &count) : count_sse2(buf, len, mask, &count);
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        count += (table[buf[i]] & mask) != 0;
+    }
+    return count;
+}
+
+static void ascii_case(unsigned char *buf, size_t len, int lo, int hi, bool to_upper)
+{
+    size_t i = 0;
+
+#ifdef CC_X86
+    i = have_avx2() ? case_avx2(buf, len, lo, hi, to_upper) : case_sse2(buf, len, lo, hi, to_upper);
+#endif
+
+    for (; i < len; i++)
+    {
+        if (buf[i] >= lo && buf[i] <= hi)
+        {
+            buf[i] = (unsigned char)(to_upper ? buf[i] - 0x20 : buf[i] + 0x20);
+        }
+    }
+}
+
+void ascii_upper_inplace(unsigned char *buf, size_t len)
+{
+    ascii_case(buf, len, 0x61, 0x7A, true);
+}
+
+void ascii_lower_inplace(unsigned char *buf, size_t len)
+{
+    ascii_case(buf, len, 0x41, 0x5A, false);
+}
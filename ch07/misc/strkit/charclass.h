@@ -0,0 +1,57 @@
+/*
+ * String Kit - charclass.h
+ *
+ * Public interface for bulk, table-driven character classification: the
+ * buffer-at-a-time counterpart of isalpha()/isdigit()/isspace()/toupper()
+ * from ch07/listings/characters.c.
+ *
+ * In the "C" locale every byte is classified from a 256-entry table built
+ * at compile time, and whole buffers are processed 16 or 32 bytes at a
+ * time with SIMD range checks. In any other locale the functions take an
+ * explicit slow path: a table built once from <ctype.h> for the current
+ * LC_CTYPE (cached per thread) and consulted one byte at a time.
+ */
+
+#ifndef STRKIT_CHARCLASS_H
+#define STRKIT_CHARCLASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Class bits stored per byte by classify_buffer()
+#define CC_UPPER  0x01u
+#define CC_LOWER  0x02u
+#define CC_DIGIT  0x04u
+#define CC_SPACE  0x08u // ' ', \t \n \v \f \r
+#define CC_PUNCT  0x10u
+#define CC_CNTRL  0x20u
+#define CC_XDIGIT 0x40u
+#define CC_BLANK  0x80u // ' ', \t
+
+// Combinations matching the <ctype.h> predicates
+#define CC_ALPHA (CC_UPPER | CC_LOWER)
+#define CC_ALNUM (CC_ALPHA | CC_DIGIT)
+#define CC_GRAPH (CC_ALNUM | CC_PUNCT)
+
+// The compile-time "C" locale table
+extern const uint8_t charclass_c_table[256];
+
+static inline uint8_t charclass_of(unsigned char c)
+{
+    return charclass_c_table[c];
+}
+
+// Locale handling
+bool charclass_locale_is_c(void);     // LC_CTYPE is "C" or "POSIX"
+const uint8_t *charclass_table(void); // table for the current LC_CTYPE
+
+// Bulk operations (follow the current LC_CTYPE)
+void classify_buffer(const unsigned char *buf, size_t len, uint8_t *classes);
+size_t count_class(const unsigned char *buf, size_t len, uint8_t mask);
+
+// ASCII case mapping (locale independent by definition)
+void ascii_upper_inplace(unsigned char *buf, size_t len);
+void ascii_lower_inplace(unsigned char *buf, size_t len);
+
+#endif /* STRKIT_CHARCLASS_H */
@@ -0,0 +1,257 @@
+/*
+ * String Kit - charclass_main.c
+ *
+ * Demonstrates bulk character classification and case mapping, checks
+ * them against <ctype.h> byte for byte, and compares throughput with the
+ * one-call-per-character loops of ch07/listings/characters.c.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <ctype.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "charclass.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Class bits computed the slow way, one <ctype.h> call per predicate
+static uint8_t ctype_class(int c)
+{
+    return (uint8_t)((isupper(c) ? CC_UPPER : 0) | (islower(c) ? CC_LOWER : 0) |
+                     (isdigit(c) ? CC_DIGIT : 0) | (isspace(c) ? CC_SPACE : 0) |
+                     (ispunct(c) ? CC_PUNCT : 0) | (iscntrl(c) ? CC_CNTRL : 0) |
+                     (isxdigit(c) ? CC_XDIGIT : 0) | (isblank(c) ? CC_BLANK : 0));
+}
+
+static void fill_text(unsigned char *buf, size_t len)
+{
+    unsigned seed = 12345;
+    for (size_t i = 0; i < len; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        // Mostly printable ASCII, some control and high bytes
+        unsigned r = (seed >> 16) & 0xFF;
+        buf[i] = (unsigned char)(r < 200 ? 0x20 + r % 95 : r);
+    }
+}
+
+// Every byte value, every offset and tail length, against <ctype.h>
+static bool bulk_matches_ctype(void)
+{
+    unsigned char buf[600];
+    uint8_t classes[600];
+    unsigned char upper[600];
+
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (unsigned char)(i * 7);
+    }
+
+    for (size_t off = 0; off < 40; off++)
+    {
+        size_t len = sizeof(buf) - off;
+        classify_buffer(buf + off, len, classes);
+        memcpy(upper, buf + off, len);
+        ascii_upper_inplace(upper, len);
+
+        size_t letters = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            int c = buf[off + i];
+            int ascii_upper = (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+            if (classes[i] != ctype_class(c) || upper[i] != ascii_upper)
+            {
+                return false;
+            }
+            letters += isalpha(c) != 0;
+        }
+        if (count_class(buf + off, len, CC_ALPHA) != letters)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    printf("=== Bulk Character Classification ===\n\n");
+
+    // Test 1: The compile-time table agrees with <ctype.h> in the C locale
+    printf("Test 1: Compile-time table vs <ctype.h> (\"C\" locale)\n");
+    {
+        int mismatches = 0;
+        for (int c = 0; c < 256; c++)
+        {
+            mismatches += charclass_of((unsigned char)c) != ctype_class(c);
+        }
+        printf("  Locale is C: %s\n", charclass_locale_is_c() ? "yes" : "no");
+        check(mismatches == 0, "all 256 byte values match");
+    }
+    printf("\n");
+
+    // Test 2: Classifying a whole buffer in one call
+    printf("Test 2: classify_buffer()\n");
+    {
+        const char *text = "Hello, World! 0x1F\t42\n";
+        size_t len = strlen(text);
+        uint8_t classes[64];
+        classify_buffer((const unsigned char *)text, len, classes);
+
+        printf("  Char | alpha digit space punct xdigit\n");
+        for (size_t i = 0; i < len; i++)
+        {
+            char c = text[i];
+            char display = (c == '\n') ? 'n' : (c == '\t') ? 't' : (c == ' ') ? '_' : c;
+            printf("   %c   |   %d     %d     %d     %d      %d\n", display,
+                   (classes[i] & CC_ALPHA) != 0, (classes[i] & CC_DIGIT) != 0,
+                   (classes[i] & CC_SPACE) != 0, (classes[i] & CC_PUNCT) != 0,
+                   (classes[i] & CC_XDIGIT) != 0);
+        }
+    }
+    printf("\n");
+
+    // Test 3: Counting and case mapping
+    printf("Test 3: count_class() and ascii_upper_inplace()\n");
+    {
+        unsigned char text[] = "The quick brown fox jumps over the lazy dog 1234567890 times!";
+        size_t len = strlen((char *)text);
+        printf("  Letters: %zu, digits: %zu, spaces: %zu, punctuation: %zu\n",
+               count_class(text, len, CC_ALPHA), count_class(text, len, CC_DIGIT),
+               count_class(text, len, CC_SPACE), count_class(text, len, CC_PUNCT));
+        ascii_upper_inplace(text, len);
+        printf("  Upper: %s\n", text);
+        ascii_lower_inplace(text, len);
+        printf("  Lower: %s\n", text);
+        check(bulk_matches_ctype(), "bulk results match <ctype.h> at every offset");
+    }
+    printf("\n");
+
+    // Test 4: Slow path for other locales
+    printf("Test 4: Non-C locale slow path\n");
+    {
+        static const char *candidates[] = {"en_US.ISO-8859-1", "de_DE.ISO-8859-1",
+                                           "en_US.UTF-8", "C.UTF-8", ""};
+        const char *chosen = NULL;
+        for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]) && chosen == NULL; i++)
+        {
+            chosen = setlocale(LC_CTYPE, candidates[i]);
+        }
+
+        if (chosen == NULL || charclass_locale_is_c())
+        {
+            printf("  No non-C locale installed - skipped\n");
+        }
+        else
+        {
+            const uint8_t *table = charclass_table();
+            int mismatches = 0;
+            for (int c = 0; c < 256; c++)
+            {
+                mismatches += table[c] != ctype_class(c);
+            }
+            printf("  LC_CTYPE = %s\n", chosen);
+            printf("  Using cached locale table: %s\n", table != charclass_c_table ? "yes" : "no");
+            check(mismatches == 0 && bulk_matches_ctype(), "cached table matches <ctype.h>");
+        }
+        setlocale(LC_CTYPE, "C");
+    }
+    printf("\n");
+
+    // Test 5: Throughput
+    printf("Test 5: Throughput on 64 MiB (MB/s)\n");
+    {
+        const size_t len = (size_t)64 << 20;
+        unsigned char *buf = malloc(len);
+        uint8_t *classes = malloc(len);
+        if (!buf || !classes)
+        {
+            fprintf(stderr, "Out of memory\n");
+            free(buf);
+            free(classes);
+            return EXIT_FAILURE;
+        }
+        fill_text(buf, len);
+        double mb = (double)len / 1e6;
+
+        double t0 = now_seconds();
+        size_t slow_count = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            slow_count += isalpha(buf[i]) != 0;
+        }
+        double t_isalpha = now_seconds() - t0;
+
+        t0 = now_seconds();
+        size_t fast_count = count_class(buf, len, CC_ALPHA);
+        double t_count = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (size_t i = 0; i < len; i++)
+        {
+            classes[i] = ctype_class(buf[i]);
+        }
+        double t_ctype_all = now_seconds() - t0;
+
+        t0 = now_seconds();
+        classify_buffer(buf, len, classes);
+        double t_classify = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (size_t i = 0; i < len; i++)
+        {
+            buf[i] = (unsigned char)toupper(buf[i]);
+        }
+        double t_toupper = now_seconds() - t0;
+
+        fill_text(buf, len);
+        t0 = now_seconds();
+        ascii_upper_inplace(buf, len);
+        double t_upper = now_seconds() - t0;
+
+        printf("  isalpha() loop:        %8.1f\n", mb / t_isalpha);
+        printf("  count_class():         %8.1f\n", mb / t_count);
+        printf("  8 ctype calls / byte:  %8.1f\n", mb / t_ctype_all);
+        printf("  classify_buffer():     %8.1f\n", mb / t_classify);
+        printf("  toupper() loop:        %8.1f\n", mb / t_toupper);
+        printf("  ascii_upper_inplace(): %8.1f\n", mb / t_upper);
+        check(slow_count == fast_count, "same letter count");
+
+        free(buf);
+        free(classes);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. <ctype.h> functions consult the locale on every call\n");
+    printf("2. In the C locale a 256-entry table is exact and built at compile time\n");
+    printf("3. SIMD range checks classify 16/32 bytes per step\n");
+    printf("4. Other locales use a per-thread table built once from <ctype.h>\n");
+    printf("5. ascii_upper_inplace() is ASCII only, whatever the locale\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
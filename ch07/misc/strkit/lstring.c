@@ -0,0 +1,263 @@
+/*
+ * String Kit - lstring.c
+ *
+ * Implementation of the length-carrying, small-string-optimized string.
+ * Heap capacities are powers of two, which makes repeated appends
+ * amortized O(1) and lets the capacity fit in a single byte.
+ */
+
+#include "lstring.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(((LString *)0)->u.heap) == sizeof(((LString *)0)->u.small),
+               "heap and inline layouts must overlap exactly");
+_Static_assert(sizeof(char *) == sizeof(size_t), "unsupported pointer size");
+
+#define TAG(s) ((s)->u.small[sizeof((s)->u.small) - 1])
+
+static void set_small_len(LString *s, size_t len)
+{
+    s->u.small[len] = '\0';
+    TAG(s) = (char)len;
+}
+
+static void set_len(LString *s, size_t len)
+{
+    if (lstr_is_inline(s))
+    {
+        set_small_len(s, len);
+    }
+    else
+    {
+        s->u.heap.size = len;
+        s->u.heap.data[len] = '\0';
+    }
+}
+
+// Smallest power-of-two exponent whose value holds `bytes`
+static unsigned char log2_ceil(size_t bytes)
+{
+    unsigned char shift = 0;
+    while (((size_t)1 << shift) < bytes)
+    {
+        shift++;
+    }
+    return shift;
+}
+
+void lstr_init(LString *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+void lstr_free(LString *s)
+{
+    if (!lstr_is_inline(s))
+    {
+        free(s->u.heap.data);
+    }
+    lstr_init(s);
+}
+
+// Make room for `len` characters plus the terminator
+bool lstr_reserve(LString *s, size_t len)
+{
+    if (len <= lstr_capacity(s))
+    {
+        return true;
+    }
+    if (len >= SIZE_MAX / 2)
+    {
+        return false;
+    }
+
+    unsigned char shift = log2_ceil(len + 1);
+    size_t bytes = (size_t)1 << shift;
+
+    if (lstr_is_inline(s))
+    {
+        size_t cur = lstr_len(s);
+        char *data = malloc(bytes);
+        if (data == NULL)
+        {
+            return false;
+        }
+        memcpy(data, s->u.small, cur + 1);
+        s->u.heap.data = data;
+        s->u.heap.size = cur;
+    }
+    else
+    {
+        char *data = realloc(s->u.heap.data, bytes);
+        if (data == NULL)
+        {
+            return false;
+        }
+        s->u.heap.data = data;
+    }
+
+    s->u.heap.cap_log2 = shift;
+    TAG(s) = (char)LSTR_HEAP_TAG;
+    return true;
+}
+
+// Constructor: `s` is treated as uninitialized, so any string it held is
+// not freed. Use lstr_copy() or lstr_clear() + lstr_append() to overwrite.
+bool lstr_from_buf(LString *s, const char *buf, size_t len)
+{
+    lstr_init(s);
+    return lstr_append(s, buf, len);
+}
+
+bool lstr_from_cstr(LString *s, const char *cstr)
+{
+    return lstr_from_buf(s, cstr, strlen(cstr));
+}
+
+// Assignment: `dst` must be initialized; its storage is reused
+bool lstr_copy(LString *dst, const LString *src)
+{
+    if (dst == src)
+    {
+        return true;
+    }
+    lstr_clear(dst);
+    return lstr_append(dst, lstr_cstr(src), lstr_len(src));
+}
+
+// Hand the contents over as a malloc'd C string and reset `s`
+char *lstr_detach(LString *s)
+{
+    char *out;
+    if (lstr_is_inline(s))
+    {
+        size_t len = lstr_len(s);
+        out = malloc(len + 1);
+        if (out != NULL)
+        {
+            memcpy(out, s->u.small, len + 1);
+        }
+    }
+    else
+    {
+        out = s->u.heap.data;
+    }
+    lstr_init(s);
+    return out;
+}
+
+bool lstr_append(LString *s, const char *buf, size_t len)
+{
+    size_t cur = lstr_len(s);
+    uintptr_t base = (uintptr_t)lstr_cstr(s);
+    uintptr_t src = (uintptr_t)buf;
+    bool self = src >= base && src <= base + cur; // appending part of itself
+
+    if (len > SIZE_MAX / 2 - cur || !lstr_reserve(s, cur + len))
+    {
+        return false;
+    }
+    if (self)
+    {
+        buf = lstr_cstr(s) + (src - base);
+    }
+    memmove(lstr_data(s) + cur, buf, len);
+    set_len(s, cur + len);
+    return true;
+}
+
+bool lstr_append_cstr(LString *s, const char *cstr)
+{
+    return lstr_append(s, cstr, strlen(cstr));
+}
+
+bool lstr_append_char(LString *s, char c)
+{
+    size_t cur = lstr_len(s);
+    if (cur == lstr_capacity(s) && !lstr_reserve(s, cur + 1))
+    {
+        return false;
+    }
+    lstr_data(s)[cur] = c;
+    set_len(s, cur + 1);
+    return true;
+}
+
+bool lstr_append_lstr(LString *s, const LString *other)
+{
+    return lstr_append(s, lstr_cstr(other), lstr_len(other));
+}
+
+// Shorten to `len` characters (no-op if already shorter)
+void lstr_truncate(LString *s, size_t len)
+{
+    if (len < lstr_len(s))
+    {
+        set_len(s, len);
+    }
+}
+
+void lstr_clear(LString *s)
+{
+    set_len(s, 0);
+}
+
+int lstr_compare(const LString *a, const LString *b)
+{
+    size_t la = lstr_len(a);
+    size_t lb = lstr_len(b);
+    int cmp = memcmp(lstr_cstr(a), lstr_cstr(b), la < lb ? la : lb);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (la > lb) - (la < lb);
+}
+
+bool lstr_equal(const LString *a, const LString *b)
+{
+    size_t len = lstr_len(a);
+    return len == lstr_len(b) && memcmp(lstr_cstr(a), lstr_cstr(b), len) == 0;
+}
+
+// In-place counterpart of string_reverse() without the strlen()
+void lstr_reverse(LString *s)
+{
+    char *data = lstr_data(s);
+    size_t len = lstr_len(s);
+    for (size_t i = 0, j = len; i + 1 < j; i++, j--)
+    {
+        char tmp = data[i];
+        data[i] = data[j - 1];
+        data[j - 1] = tmp;
+    }
+}
+
+bool lstr_is_palindrome(const LString *s)
+{
+    const char *data = lstr_cstr(s);
+    size_t len = lstr_len(s);
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        if (data[i] != data[len - 1 - i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copy into a fixed buffer with strlcpy() truncation semantics
+size_t lstr_copy_to(const LString *s, char *dst, size_t size)
+{
+    size_t len = lstr_len(s);
+    if (size != 0)
+    {
+        size_t n = (len < size - 1) ? len : size - 1;
+        memcpy(dst, lstr_cstr(s), n);
+        dst[n] = '\0';
+    }
+    return len;
+}
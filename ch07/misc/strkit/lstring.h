@@ -0,0 +1,96 @@
+/*
+ * String Kit - lstring.h
+ *
+ * Public interface for a length-carrying string with small-string
+ * optimization. The length is stored, so lstr_len() is O(1) and appends
+ * never rescan the existing contents. Strings of up to LSTR_SMALL_MAX
+ * bytes (22 on 64-bit targets) live inside the LString object itself and
+ * need no heap allocation. The contents are always NUL-terminated, so
+ * lstr_cstr() hands out a `const char *` without copying.
+ */
+
+#ifndef STRKIT_LSTRING_H
+#define STRKIT_LSTRING_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Layout: three machine words, the last byte of which is a tag
+typedef struct
+{
+    union
+    {
+        struct
+        {
+            char *data;
+            size_t size;
+            unsigned char cap_log2; // capacity is 1 << cap_log2 (incl. NUL)
+            unsigned char pad[sizeof(size_t) - 2];
+            unsigned char tag;      // LSTR_HEAP_TAG
+        } heap;
+        char small[2 * sizeof(size_t) + sizeof(char *)]; // chars, NUL, tag
+    } u;
+} LString;
+
+// Longest string stored inline (22 on 64-bit targets)
+#define LSTR_SMALL_MAX (sizeof(((LString *)0)->u.small) - 2)
+
+// Tag value marking a heap-allocated string
+#define LSTR_HEAP_TAG 0xFFu
+
+// Static initializer for an empty string
+#define LSTR_INIT {{.small = {0}}}
+
+// Lifetime and conversion from C strings. lstr_from_*() construct into
+// uninitialized memory; lstr_copy() assigns to an initialized string.
+void lstr_init(LString *s);
+bool lstr_from_cstr(LString *s, const char *cstr);
+bool lstr_from_buf(LString *s, const char *buf, size_t len);
+bool lstr_copy(LString *dst, const LString *src);
+void lstr_free(LString *s);
+char *lstr_detach(LString *s); // malloc'd copy the caller must free()
+
+// Modification
+bool lstr_reserve(LString *s, size_t len);
+bool lstr_append(LString *s, const char *buf, size_t len);
+bool lstr_append_cstr(LString *s, const char *cstr);
+bool lstr_append_char(LString *s, char c);
+bool lstr_append_lstr(LString *s, const LString *other);
+void lstr_truncate(LString *s, size_t len);
+void lstr_clear(LString *s);
+
+// Queries and algorithms that use the stored length
+int lstr_compare(const LString *a, const LString *b);
+bool lstr_equal(const LString *a, const LString *b);
+void lstr_reverse(LString *s);
+bool lstr_is_palindrome(const LString *s);
+size_t lstr_copy_to(const LString *s, char *dst, size_t size); // strlcpy semantics
+
+// O(1) accessors
+static inline bool lstr_is_inline(const LString *s)
+{
+    return (unsigned char)s->u.small[sizeof(s->u.small) - 1] != LSTR_HEAP_TAG;
+}
+
+static inline size_t lstr_len(const LString *s)
+{
+    return lstr_is_inline(s) ? (size_t)(unsigned char)s->u.small[sizeof(s->u.small) - 1]
+                             : s->u.heap.size;
+}
+
+static inline const char *lstr_cstr(const LString *s)
+{
+    return lstr_is_inline(s) ? s->u.small : s->u.heap.data;
+}
+
+static inline char *lstr_data(LString *s)
+{
+    return lstr_is_inline(s) ? s->u.small : s->u.heap.data;
+}
+
+static inline size_t lstr_capacity(const LString *s)
+{
+    return lstr_is_inline(s) ? LSTR_SMALL_MAX : ((size_t)1 << s->u.heap.cap_log2) - 1;
+}
+
+#endif /* STRKIT_LSTRING_H */
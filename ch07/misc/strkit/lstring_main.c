@@ -0,0 +1,215 @@
+/*
+ * String Kit - lstring_main.c
+ *
+ * Demonstrates the length-carrying LString: inline storage for short
+ * strings, O(1) length, amortized O(1) appends and cheap conversion to
+ * and from `const char *`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lstring.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+int main(void)
+{
+    printf("=== Length-Prefixed Strings (LString) ===\n\n");
+
+    // Test 1: Short strings are stored inline
+    printf("Test 1: Small-string optimization\n");
+    {
+        LString a = LSTR_INIT;
+        LString b;
+
+        printf("  sizeof(LString) = %zu bytes, inline capacity = %zu\n",
+               sizeof(LString), (size_t)LSTR_SMALL_MAX);
+
+        lstr_from_cstr(&b, "exactly-22-characters!");
+        check(lstr_is_inline(&a) && lstr_len(&a) == 0, "LSTR_INIT is an empty inline string");
+        check(lstr_len(&b) == 22 && lstr_is_inline(&b), "22 characters stay inline");
+
+        lstr_append_char(&b, '?');
+        check(!lstr_is_inline(&b) && lstr_len(&b) == 23, "23rd character moves to the heap");
+        check(strcmp(lstr_cstr(&b), "exactly-22-characters!?") == 0, "contents preserved on spill");
+
+        lstr_free(&a);
+        lstr_free(&b);
+    }
+    printf("\n");
+
+    // Test 2: Conversions to and from C strings
+    printf("Test 2: Converting to and from const char *\n");
+    {
+        LString s;
+        lstr_from_cstr(&s, "Hello");
+        lstr_append_cstr(&s, ", World!");
+
+        printf("  lstr_cstr() = \"%s\" (length %zu)\n", lstr_cstr(&s), lstr_len(&s));
+        check(lstr_cstr(&s)[lstr_len(&s)] == '\0', "always NUL-terminated");
+
+        char *owned = lstr_detach(&s);
+        check(owned != NULL && strcmp(owned, "Hello, World!") == 0, "lstr_detach() returns a malloc'd copy");
+        check(lstr_len(&s) == 0, "source is empty after detach");
+        free(owned);
+    }
+    printf("\n");
+
+    // Test 3: Appending in a loop - strcat() vs lstr_append()
+    printf("Test 3: Appends in a loop\n");
+    {
+        const size_t n = 20000;
+        const char *word = "word ";
+        const size_t word_len = strlen(word);
+
+        char *buf = malloc(n * word_len + 1);
+        if (buf == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+
+        // strcat() rescans the destination every time: O(n^2) total
+        clock_t start = clock();
+        buf[0] = '\0';
+        for (size_t i = 0; i < n; i++)
+        {
+            strcat(buf, word);
+        }
+        double strcat_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        // lstr_append() knows where the end is: O(n) total
+        LString s = LSTR_INIT;
+        start = clock();
+        for (size_t i = 0; i < n; i++)
+        {
+            lstr_append(&s, word, word_len);
+        }
+        double lstr_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("  %zu appends, final length %zu\n", n, lstr_len(&s));
+        printf("  strcat():      %.6f seconds\n", strcat_time);
+        printf("  lstr_append(): %.6f seconds\n", lstr_time);
+        check(lstr_len(&s) == strlen(buf) && memcmp(lstr_cstr(&s), buf, lstr_len(&s)) == 0,
+              "identical results");
+        printf("  Capacity: %zu (grows by doubling)\n", lstr_capacity(&s));
+
+        free(buf);
+        lstr_free(&s);
+    }
+    printf("\n");
+
+    // Test 4: Reverse and palindrome without strlen()
+    printf("Test 4: Reverse and palindrome (cf. ch11/listings/unit_testing.c)\n");
+    {
+        static const char *words[] = {"hello", "racecar", "a", "", "ab", "abba"};
+        for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++)
+        {
+            LString s;
+            lstr_from_cstr(&s, words[i]);
+            bool palindrome = lstr_is_palindrome(&s);
+            lstr_reverse(&s);
+            printf("  \"%s\" -> \"%s\" (palindrome: %s)\n", words[i], lstr_cstr(&s),
+                   palindrome ? "yes" : "no");
+            lstr_free(&s);
+        }
+
+        LString h;
+        lstr_from_cstr(&h, "hello");
+        lstr_reverse(&h);
+        check(strcmp(lstr_cstr(&h), "olleh") == 0, "lstr_reverse(\"hello\") == \"olleh\"");
+        lstr_free(&h);
+    }
+    printf("\n");
+
+    // Test 5: strlcpy() semantics without rescanning the source
+    printf("Test 5: lstr_copy_to() truncation\n");
+    {
+        LString s;
+        char small[8];
+        lstr_from_cstr(&s, "This is a long string");
+
+        size_t needed = lstr_copy_to(&s, small, sizeof(small));
+        printf("  Copied \"%s\", needed %zu bytes\n", small, needed + 1);
+        check(strcmp(small, "This is") == 0 && needed == lstr_len(&s), "truncates like strlcpy()");
+        check(lstr_copy_to(&s, NULL, 0) == lstr_len(&s), "size 0 only reports the length");
+
+        lstr_free(&s);
+    }
+    printf("\n");
+
+    // Test 6: Appending a string to itself across the inline/heap boundary
+    printf("Test 6: Self-append\n");
+    {
+        LString s;
+        lstr_from_cstr(&s, "0123456789abcdef");
+        lstr_append(&s, lstr_cstr(&s), lstr_len(&s));
+        check(strcmp(lstr_cstr(&s), "0123456789abcdef0123456789abcdef") == 0,
+              "source pointer survives reallocation");
+        lstr_free(&s);
+    }
+    printf("\n");
+
+    // Test 7: Comparison
+    printf("Test 7: Comparison\n");
+    {
+        LString a, b, c;
+        lstr_from_cstr(&a, "apple");
+        lstr_from_cstr(&b, "apples");
+        lstr_from_cstr(&c, "apple");
+
+        check(lstr_compare(&a, &b) < 0, "\"apple\" < \"apples\"");
+        check(lstr_equal(&a, &c), "\"apple\" == \"apple\"");
+
+        lstr_free(&a);
+        lstr_free(&b);
+        lstr_free(&c);
+    }
+    printf("\n");
+
+    // Test 8: Copying into a string that already holds data
+    printf("Test 8: lstr_copy() onto existing strings\n");
+    {
+        LString dst, small, big;
+        lstr_from_cstr(&dst, "a heap string longer than twenty-two characters");
+        lstr_from_cstr(&small, "hello");
+        lstr_from_cstr(&big, "another string that needs the heap as well");
+
+        lstr_copy(&dst, &small);
+        check(lstr_equal(&dst, &small) && !lstr_is_inline(&dst), "heap destination reuses its buffer");
+        lstr_copy(&dst, &big);
+        check(lstr_equal(&dst, &big), "copy of a long string");
+
+        lstr_copy(&small, &small);
+        check(strcmp(lstr_cstr(&small), "hello") == 0, "self-copy leaves the string intact");
+
+        lstr_free(&dst);
+        lstr_free(&small);
+        lstr_free(&big);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Length is stored, so lstr_len() never scans for the NUL\n");
+    printf("2. Up to %zu characters are stored inside the object\n", (size_t)LSTR_SMALL_MAX);
+    printf("3. Heap capacity doubles, so appends are amortized O(1)\n");
+    printf("4. lstr_cstr() pointers are invalidated by any modification\n");
+    printf("5. Always call lstr_free(), even for inline strings\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
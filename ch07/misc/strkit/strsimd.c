@@ -0,0 +1,731 @@
+/*
+ * String Kit - strsimd.c
+ *
+ * Implementation of the word-at-a-time and SIMD string kernels.
+ *
+ * NUL detection reads whole aligned blocks. An aligned block never
+ * crosses a page boundary, so reading a few bytes past the terminator is
+ * harmless on real hardware (glibc does the same), but AddressSanitizer
+ * would report it, so those kernels opt out of instrumentation.
+ *
+ * Reversal and palindrome kernels only touch bytes inside [0, len), using
+ * unaligned loads from both ends of the buffer.
+ */
+
+#include "strsimd.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STRSIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define STRSIMD_HAVE_SWAR 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+typedef uint64_t __attribute__((may_alias)) word_alias;
+#else
+#define NO_ASAN
+typedef uint64_t word_alias;
+#endif
+
+// Kernel table for one implementation level
+typedef struct
+{
+    size_t (*strnlen)(const char *s, size_t maxlen);
+    size_t (*strlcpy)(char *dst, const char *src, size_t size);
+    void (*reverse_copy)(char *dst, const char *src, size_t len);
+    void (*reverse_inplace)(char *s, size_t len);
+    bool (*is_palindrome)(const char *s, size_t len);
+} StrSimdOps;
+
+static size_t min_size(size_t a, size_t b)
+{
+    return a < b ? a : b;
+}
+
+// ============================================================================
+// Scalar kernels (also used for heads and tails by the wider levels)
+// ============================================================================
+
+static size_t strnlen_scalar(const char *s, size_t maxlen)
+{
+    size_t i = 0;
+    while (i < maxlen && s[i] != '\0')
+    {
+        i++;
+    }
+    return i;
+}
+
+static size_t strlcpy_scalar(char *dst, const char *src, size_t size)
+{
+    size_t i = 0;
+    if (size != 0)
+    {
+        while (i < size - 1 && src[i] != '\0')
+        {
+            dst[i] = src[i];
+            i++;
+        }
+        dst[i] = '\0';
+    }
+    return i + strnlen_scalar(src + i, SIZE_MAX);
+}
+
+static void reverse_copy_scalar(char *dst, const char *src, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = src[len - 1 - i];
+    }
+}
+
+static void reverse_inplace_scalar(char *s, size_t len)
+{
+    for (size_t i = 0, j = len; i + 1 < j; i++, j--)
+    {
+        char tmp = s[i];
+        s[i] = s[j - 1];
+        s[j - 1] = tmp;
+    }
+}
+
+static bool is_palindrome_scalar(const char *s, size_t len)
+{
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        if (s[i] != s[len - 1 - i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const StrSimdOps scalar_ops = {
+    strnlen_scalar, strlcpy_scalar, reverse_copy_scalar,
+    reverse_inplace_scalar, is_palindrome_scalar};
+
+// Shared tail for the block-wise strlcpy kernels: `i` bytes are copied,
+// src + i is aligned and the NUL has not been seen yet
+static size_t strlcpy_finish(char *dst, const char *src, size_t size, size_t i,
+                             size_t (*strnlen_fn)(const char *, size_t))
+{
+    size_t len = i + strnlen_fn(src + i, SIZE_MAX - i);
+    size_t n = min_size(len, size - 1);
+    if (n > i)
+    {
+        memcpy(dst + i, src + i, n - i);
+    }
+    dst[n] = '\0';
+    return len;
+}
+
+// ============================================================================
+// SWAR kernels: eight bytes in a uint64_t
+// ============================================================================
+
+#ifdef STRSIMD_HAVE_SWAR
+
+#define ONES 0x0101010101010101ull
+#define HIGHS 0x8080808080808080ull
+
+// Non-zero iff some byte of v is zero; the lowest set bit marks the first
+static uint64_t zero_bytes(uint64_t v)
+{
+    return (v - ONES) & ~v & HIGHS;
+}
+
+static unsigned ctz64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(v);
+#else
+    unsigned n = 0;
+    while ((v & 1) == 0)
+    {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static uint64_t bswap64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(v);
+#else
+    v = ((v & 0x00FF00FF00FF00FFull) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFull);
+    v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+    return (v << 32) | (v >> 32);
+#endif
+}
+
+static uint64_t load64(const char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Aligned read used by the NUL scans; may run past the terminator
+NO_ASAN static uint64_t load64_aligned(const char *p)
+{
+    return *(const word_alias *)(const void *)p;
+}
+
+static void store64(char *p, uint64_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+NO_ASAN static size_t strnlen_swar(const char *s, size_t maxlen)
+{
+    uintptr_t off = (uintptr_t)s & 7;
+    const char *p = s - off;
+    // Force the bytes before s to be non-zero
+    uint64_t z = zero_bytes(load64_aligned(p) | ((1ull << (8 * off)) - 1));
+    size_t scanned = 8 - off;
+
+    while (z == 0 && scanned < maxlen)
+    {
+        p += 8;
+        z = zero_bytes(load64_aligned(p));
+        scanned += 8;
+    }
+    if (z == 0)
+    {
+        return maxlen;
+    }
+    return min_size((size_t)(p - s) + ctz64(z) / 8, maxlen);
+}
+
+NO_ASAN static size_t strlcpy_swar(char *dst, const char *src, size_t size)
+{
+    if (size == 0)
+    {
+        return strnlen_swar(src, SIZE_MAX);
+    }
+
+    size_t room = size - 1;
+    size_t i = 0;
+
+    while (((uintptr_t)(src + i) & 7) != 0)
+    {
+        if (src[i] == '\0')
+        {
+            dst[min_size(i, room)] = '\0';
+            return i;
+        }
+        if (i < room)
+        {
+            dst[i] = src[i];
+        }
+        i++;
+    }
+
+    while (i + 8 <= room)
+    {
+        uint64_t v = load64_aligned(src + i);
+        uint64_t z = zero_bytes(v);
+        if (z != 0)
+        {
+            size_t k = ctz64(z) / 8;
+            memcpy(dst + i, src + i, k);
+            dst[i + k] = '\0';
+            return i + k;
+        }
+        store64(dst + i, v);
+        i += 8;
+    }
+
+    if (i > room)
+    {
+        dst[room] = '\0';
+        return i + strnlen_swar(src + i, SIZE_MAX);
+    }
+    return strlcpy_finish(dst, src, size, i, strnlen_swar);
+}
+
+static void reverse_copy_swar(char *dst, const char *src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        store64(dst + i, bswap64(load64(src + len - i - 8)));
+    }
+    for (; i < len; i++)
+    {
+        dst[i] = src[len - 1 - i];
+    }
+}
+
+static void reverse_inplace_swar(char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 16; i += 8, j -= 8)
+    {
+        uint64_t a = load64(s + i);
+        uint64_t b = load64(s + j - 8);
+        store64(s + i, bswap64(b));
+        store64(s + j - 8, bswap64(a));
+    }
+    reverse_inplace_scalar(s + i, j - i);
+}
+
+static bool is_palindrome_swar(const char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 16; i += 8, j -= 8)
+    {
+        if (load64(s + i) != bswap64(load64(s + j - 8)))
+        {
+            return false;
+        }
+    }
+    return is_palindrome_scalar(s + i, j - i);
+}
+
+static const StrSimdOps swar_ops = {
+    strnlen_swar, strlcpy_swar, reverse_copy_swar,
+    reverse_inplace_swar, is_palindrome_swar};
+
+#endif /* STRSIMD_HAVE_SWAR */
+
+// ============================================================================
+// SSE2 kernels: 16 bytes per step (always available on x86-64)
+// ============================================================================
+
+#ifdef STRSIMD_X86
+
+static unsigned ctz32(uint32_t v)
+{
+    return (unsigned)__builtin_ctz(v);
+}
+
+// Reverse the 16 bytes of v (SSE2 has no byte shuffle, so swap
+// dwords, then words, then the bytes inside each word)
+static __m128i reverse16(__m128i v)
+{
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static uint32_t nul_mask16(__m128i v)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+}
+
+NO_ASAN static size_t strnlen_sse2(const char *s, size_t maxlen)
+{
+    uintptr_t off = (uintptr_t)s & 15;
+    const char *p = s - off;
+    uint32_t mask = nul_mask16(_mm_load_si128((const __m128i *)p)) >> off;
+    if (mask != 0)
+    {
+        return min_size(ctz32(mask), maxlen);
+    }
+
+    size_t scanned = 16 - off;
+    while (scanned < maxlen)
+    {
+        p += 16;
+        mask = nul_mask16(_mm_load_si128((const __m128i *)p));
+        if (mask != 0)
+        {
+            return min_size((size_t)(p - s) + ctz32(mask), maxlen);
+        }
+        scanned += 16;
+    }
+    return maxlen;
+}
+
+NO_ASAN static size_t strlcpy_sse2(char *dst, const char *src, size_t size)
+{
+    if (size == 0)
+    {
+        return strnlen_sse2(src, SIZE_MAX);
+    }
+
+    size_t room = size - 1;
+    size_t i = 0;
+
+    while (((uintptr_t)(src + i) & 15) != 0)
+    {
+        if (src[i] == '\0')
+        {
+            dst[min_size(i, room)] = '\0';
+            return i;
+        }
+        if (i < room)
+        {
+            dst[i] = src[i];
+        }
+        i++;
+    }
+
+    while (i + 16 <= room)
+    {
+        __m128i v = _mm_load_si128((const __m128i *)(src + i));
+        uint32_t mask = nul_mask16(v);
+        if (mask != 0)
+        {
+            size_t k = ctz32(mask);
+            memcpy(dst + i, src + i, k);
+            dst[i + k] = '\0';
+            return i + k;
+        }
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+        i += 16;
+    }
+
+    if (i > room)
+    {
+        dst[room] = '\0';
+        return i + strnlen_sse2(src + i, SIZE_MAX);
+    }
+    return strlcpy_finish(dst, src, size, i, strnlen_sse2);
+}
+
+static void reverse_copy_sse2(char *dst, const char *src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + len - i - 16));
+        _mm_storeu_si128((__m128i *)(dst + i), reverse16(v));
+    }
+    for (; i < len; i++)
+    {
+        dst[i] = src[len - 1 - i];
+    }
+}
+
+static void reverse_inplace_sse2(char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 32; i += 16, j -= 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + j - 16));
+        _mm_storeu_si128((__m128i *)(s + i), reverse16(b));
+        _mm_storeu_si128((__m128i *)(s + j - 16), reverse16(a));
+    }
+    reverse_inplace_scalar(s + i, j - i);
+}
+
+static bool is_palindrome_sse2(const char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 32; i += 16, j -= 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i b = reverse16(_mm_loadu_si128((const __m128i *)(s + j - 16)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+    return is_palindrome_scalar(s + i, j - i);
+}
+
+static const StrSimdOps sse2_ops = {
+    strnlen_sse2, strlcpy_sse2, reverse_copy_sse2,
+    reverse_inplace_sse2, is_palindrome_sse2};
+
+// ============================================================================
+// AVX2 kernels: 32 bytes per step, compiled for AVX2 only in these functions
+// ============================================================================
+
+// GCC does not clear the upper ymm halves before calling the SSE2 kernels
+// in this file for the tail, and legacy SSE code after 256-bit code pays a
+// state-transition penalty; every hand-off calls _mm256_zeroupper() first.
+#define AVX2 __attribute__((target("avx2")))
+
+// Reverse the 32 bytes of v: byte shuffle inside each lane, then swap lanes
+AVX2 static __m256i reverse32(__m256i v)
+{
+    const __m256i idx = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                         15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    v = _mm256_shuffle_epi8(v, idx);
+    return _mm256_permute2x128_si256(v, v, 0x01);
+}
+
+AVX2 static uint32_t nul_mask32(__m256i v)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+}
+
+AVX2 NO_ASAN static size_t strnlen_avx2(const char *s, size_t maxlen)
+{
+    uintptr_t off = (uintptr_t)s & 31;
+    const char *p = s - off;
+    uint32_t mask = nul_mask32(_mm256_load_si256((const __m256i *)p)) >> off;
+    if (mask != 0)
+    {
+        return min_size(ctz32(mask), maxlen);
+    }
+
+    size_t scanned = 32 - off;
+    while (scanned < maxlen)
+    {
+        p += 32;
+        mask = nul_mask32(_mm256_load_si256((const __m256i *)p));
+        if (mask != 0)
+        {
+            return min_size((size_t)(p - s) + ctz32(mask), maxlen);
+        }
+        scanned += 32;
+    }
+    return maxlen;
+}
+
+AVX2 NO_ASAN static size_t strlcpy_avx2(char *dst, const char *src, size_t size)
+{
+    if (size == 0)
+    {
+        return strnlen_avx2(src, SIZE_MAX);
+    }
+
+    size_t room = size - 1;
+    size_t i = 0;
+
+    while (((uintptr_t)(src + i) & 31) != 0)
+    {
+        if (src[i] == '\0')
+        {
+            dst[min_size(i, room)] = '\0';
+            return i;
+        }
+        if (i < room)
+        {
+            dst[i] = src[i];
+        }
+        i++;
+    }
+
+    while (i + 32 <= room)
+    {
+        __m256i v = _mm256_load_si256((const __m256i *)(src + i));
+        uint32_t mask = nul_mask32(v);
+        if (mask != 0)
+        {
+            size_t k = ctz32(mask);
+            memcpy(dst + i, src + i, k);
+            dst[i + k] = '\0';
+            return i + k;
+        }
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+        i += 32;
+    }
+
+    if (i > room)
+    {
+        dst[room] = '\0';
+        return i + strnlen_avx2(src + i, SIZE_MAX);
+    }
+    return strlcpy_finish(dst, src, size, i, strnlen_avx2);
+}
+
+AVX2 static void reverse_copy_avx2(char *dst, const char *src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + len - i - 32));
+        _mm256_storeu_si256((__m256i *)(dst + i), reverse32(v));
+    }
+    _mm256_zeroupper();
+    reverse_copy_sse2(dst + i, src, len - i);
+}
+
+AVX2 static void reverse_inplace_avx2(char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 64; i += 32, j -= 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + j - 32));
+        _mm256_storeu_si256((__m256i *)(s + i), reverse32(b));
+        _mm256_storeu_si256((__m256i *)(s + j - 32), reverse32(a));
+    }
+    _mm256_zeroupper();
+    reverse_inplace_sse2(s + i, j - i);
+}
+
+AVX2 static bool is_palindrome_avx2(const char *s, size_t len)
+{
+    size_t i = 0;
+    size_t j = len;
+    for (; j - i >= 64; i += 32, j -= 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i b = reverse32(_mm256_loadu_si256((const __m256i *)(s + j - 32)));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) != 0xFFFFFFFFu)
+        {
+            return false;
+        }
+    }
+    _mm256_zeroupper();
+    return is_palindrome_sse2(s + i, j - i);
+}
+
+static const StrSimdOps avx2_ops = {
+    strnlen_avx2, strlcpy_avx2, reverse_copy_avx2,
+    reverse_inplace_avx2, is_palindrome_avx2};
+
+#endif /* STRSIMD_X86 */
+
+// ============================================================================
+// Runtime dispatch
+// ============================================================================
+
+// Chosen on first use, or by strsimd_set_level(). Atomic because the
+// first calls may come from several threads at once.
+static _Atomic(const StrSimdOps *) active_ops = NULL;
+static _Atomic StrSimdLevel active_level = STRSIMD_SCALAR;
+
+StrSimdLevel strsimd_detect(void)
+{
+#ifdef STRSIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return STRSIMD_AVX2;
+    }
+    return STRSIMD_SSE2;
+#elif defined(STRSIMD_HAVE_SWAR)
+    return STRSIMD_SWAR;
+#else
+    return STRSIMD_SCALAR;
+#endif
+}
+
+StrSimdLevel strsimd_set_level(StrSimdLevel level)
+{
+    StrSimdLevel best = strsimd_detect();
+    if (level > best)
+    {
+        level = best;
+    }
+
+    const StrSimdOps *chosen;
+    switch (level)
+    {
+#ifdef STRSIMD_X86
+    case STRSIMD_AVX2:
+        chosen = &avx2_ops;
+        break;
+    case STRSIMD_SSE2:
+        chosen = &sse2_ops;
+        break;
+#endif
+#ifdef STRSIMD_HAVE_SWAR
+    case STRSIMD_SWAR:
+        chosen = &swar_ops;
+        break;
+#endif
+    default:
+        level = STRSIMD_SCALAR;
+        chosen = &scalar_ops;
+        break;
+    }
+
+    atomic_store_explicit(&active_level, level, memory_order_relaxed);
+    atomic_store_explicit(&active_ops, chosen, memory_order_release);
+    return level;
+}
+
+static const StrSimdOps *ops(void)
+{
+    const StrSimdOps *o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    if (o == NULL)
+    {
+        strsimd_set_level(strsimd_detect());
+        o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    }
+    return o;
+}
+
+StrSimdLevel strsimd_level(void)
+{
+    ops();
+    return atomic_load_explicit(&active_level, memory_order_relaxed);
+}
+
+const char *strsimd_level_name(StrSimdLevel level)
+{
+    switch (level)
+    {
+    case STRSIMD_SCALAR:
+        return "scalar";
+    case STRSIMD_SWAR:
+        return "swar";
+    case STRSIMD_SSE2:
+        return "sse2";
+    case STRSIMD_AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// Public entry points
+// ============================================================================
+
+size_t strsimd_strlen(const char *s)
+{
+    return ops()->strnlen(s, SIZE_MAX);
+}
+
+size_t strsimd_strnlen(const char *s, size_t maxlen)
+{
+    return ops()->strnlen(s, maxlen);
+}
+
+size_t strsimd_strlcpy(char *dst, const char *src, size_t size)
+{
+    return ops()->strlcpy(dst, src, size);
+}
+
+size_t strsimd_strlcat(char *dst, const char *src, size_t size)
+{
+    const StrSimdOps *k = ops();
+    size_t dst_len = k->strnlen(dst, size);
+    if (dst_len == size)
+    {
+        return size + k->strnlen(src, SIZE_MAX);
+    }
+    return dst_len + k->strlcpy(dst + dst_len, src, size - dst_len);
+}
+
+void strsimd_reverse(char *dst, const char *src, size_t len)
+{
+    if (dst == src)
+    {
+        ops()->reverse_inplace(dst, len);
+    }
+    else
+    {
+        ops()->reverse_copy(dst, src, len);
+    }
+}
+
+bool strsimd_is_palindrome(const char *s, size_t len)
+{
+    return ops()->is_palindrome(s, len);
+}
@@ -0,0 +1,50 @@
+/*
+ * String Kit - strsimd.h
+ *
+ * Word-at-a-time and SIMD versions of the byte-by-byte string routines
+ * used in the book examples: strlcpy()/strlcat() from
+ * ch07/misc/safe_vs_unsafe.c and string_reverse()/string_is_palindrome()
+ * from ch11/listings/unit_testing.c.
+ *
+ * The best implementation for the running CPU is picked on first use
+ * (AVX2, then SSE2, then 64-bit SWAR, then plain bytes). Results are
+ * identical at every level; strsimd_set_level() exists so that tests and
+ * benchmarks can compare them.
+ */
+
+#ifndef STRKIT_STRSIMD_H
+#define STRKIT_STRSIMD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Implementation levels, from slowest to fastest
+typedef enum
+{
+    STRSIMD_SCALAR, // one byte at a time
+    STRSIMD_SWAR,   // 8 bytes in a 64-bit register
+    STRSIMD_SSE2,   // 16 bytes per step
+    STRSIMD_AVX2    // 32 bytes per step
+} StrSimdLevel;
+
+// Dispatch control
+StrSimdLevel strsimd_detect(void);                  // best level this CPU supports
+StrSimdLevel strsimd_level(void);                   // level currently in use
+StrSimdLevel strsimd_set_level(StrSimdLevel level); // clamps to what is supported
+const char *strsimd_level_name(StrSimdLevel level);
+
+// NUL detection
+size_t strsimd_strlen(const char *s);
+size_t strsimd_strnlen(const char *s, size_t maxlen);
+
+// BSD strlcpy()/strlcat() semantics: always NUL-terminate (if size > 0)
+// and return the length of the string they tried to create
+size_t strsimd_strlcpy(char *dst, const char *src, size_t size);
+size_t strsimd_strlcat(char *dst, const char *src, size_t size);
+
+// Reverse `len` bytes of src into dst; dst == src reverses in place
+// (other overlaps are not allowed)
+void strsimd_reverse(char *dst, const char *src, size_t len);
+bool strsimd_is_palindrome(const char *s, size_t len);
+
+#endif /* STRKIT_STRSIMD_H */
@@ -0,0 +1,330 @@
+/*
+ * String Kit - strsimd_main.c
+ *
+ * Demonstrates the SIMD string kernels, checks every implementation level
+ * against the scalar reference code from the book with a randomized
+ * (fuzz) equivalence test, and measures throughput per level.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "strsimd.h"
+
+// ============================================================================
+// Reference implementations (verbatim from the book examples)
+// ============================================================================
+
+// ch07/misc/safe_vs_unsafe.c
+static size_t ref_strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t src_len = strlen(src);
+    if (size == 0)
+    {
+        return src_len;
+    }
+    size_t copy_len = (src_len < size - 1) ? src_len : size - 1;
+    memcpy(dst, src, copy_len);
+    dst[copy_len] = '\0';
+    return src_len;
+}
+
+static size_t ref_strlcat(char *dst, const char *src, size_t size)
+{
+    size_t dst_len = strlen(dst);
+    size_t src_len = strlen(src);
+    if (dst_len >= size)
+    {
+        return size + src_len;
+    }
+    size_t copy_len = size - dst_len - 1;
+    if (src_len < copy_len)
+    {
+        copy_len = src_len;
+    }
+    memcpy(dst + dst_len, src, copy_len);
+    dst[dst_len + copy_len] = '\0';
+    return dst_len + src_len;
+}
+
+// ch11/listings/unit_testing.c (reversal into a caller buffer)
+static void ref_string_reverse(char *result, const char *str, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        result[i] = str[len - 1 - i];
+    }
+}
+
+static bool ref_string_is_palindrome(const char *str, size_t len)
+{
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        if (str[i] != str[len - 1 - i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Fuzzing helpers
+// ============================================================================
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static size_t rng_below(size_t n)
+{
+    return n == 0 ? 0 : (size_t)(rng() % n);
+}
+
+// Mostly short strings, sometimes long ones
+static size_t random_length(void)
+{
+    return (rng() % 8 == 0) ? rng_below(5000) : rng_below(300);
+}
+
+static void fill_random(char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (char)(1 + rng_below(255)); // never NUL
+    }
+}
+
+#define ARENA 8192
+#define CANARY 0x5A
+
+// Run `iterations` random cases at the current level; returns mismatches
+static int fuzz_level(int iterations)
+{
+    static char src_buf[ARENA], a[ARENA], b[ARENA];
+    int mismatches = 0;
+
+    for (int iter = 0; iter < iterations; iter++)
+    {
+        size_t src_off = rng_below(64);
+        size_t dst_off = rng_below(64);
+        size_t len = random_length();
+        char *src = src_buf + src_off;
+        fill_random(src, len);
+        src[len] = '\0';
+
+        // strlen / strnlen
+        size_t maxlen = rng_below(len + 40);
+        if (strsimd_strlen(src) != len ||
+            strsimd_strnlen(src, maxlen) != (maxlen < len ? maxlen : len))
+        {
+            mismatches++;
+        }
+
+        // strlcpy: compare return values and every byte of the destination
+        size_t size = rng_below(len + 40);
+        memset(a, CANARY, sizeof(a));
+        memset(b, CANARY, sizeof(b));
+        size_t r1 = ref_strlcpy(a + dst_off, src, size);
+        size_t r2 = strsimd_strlcpy(b + dst_off, src, size);
+        if (r1 != r2 || memcmp(a, b, sizeof(a)) != 0)
+        {
+            mismatches++;
+        }
+
+        // strlcat onto a random existing string
+        size_t dst_len = rng_below(200);
+        size = rng_below(dst_len + len + 40);
+        memset(a, CANARY, sizeof(a));
+        fill_random(a + dst_off, dst_len);
+        a[dst_off + dst_len] = '\0';
+        memcpy(b, a, sizeof(a));
+        r1 = ref_strlcat(a + dst_off, src, size);
+        r2 = strsimd_strlcat(b + dst_off, src, size);
+        if (r1 != r2 || memcmp(a, b, sizeof(a)) != 0)
+        {
+            mismatches++;
+        }
+
+        // reverse into a separate buffer and in place
+        memset(a, CANARY, sizeof(a));
+        memset(b, CANARY, sizeof(b));
+        ref_string_reverse(a + dst_off, src, len);
+        strsimd_reverse(b + dst_off, src, len);
+        if (memcmp(a, b, sizeof(a)) != 0)
+        {
+            mismatches++;
+        }
+        memcpy(b + dst_off, src, len);
+        strsimd_reverse(b + dst_off, b + dst_off, len);
+        if (memcmp(a, b, sizeof(a)) != 0)
+        {
+            mismatches++;
+        }
+
+        // palindromes: half are real ones, some with one byte changed
+        if (rng() & 1)
+        {
+            ref_string_reverse(src + len / 2 + (len & 1), src, len / 2);
+            if (len > 0 && rng() % 3 == 0)
+            {
+                src[rng_below(len)] ^= 0x20;
+            }
+        }
+        if (ref_string_is_palindrome(src, len) != strsimd_is_palindrome(src, len))
+        {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    int failures = 0;
+    StrSimdLevel best = strsimd_detect();
+
+    printf("=== SIMD String Kernels ===\n\n");
+
+    // Test 1: Runtime dispatch
+    printf("Test 1: Runtime dispatch\n");
+    printf("  Best level for this CPU: %s\n", strsimd_level_name(best));
+    printf("  Active level: %s\n", strsimd_level_name(strsimd_level()));
+    printf("\n");
+
+    // Test 2: strlcpy()/strlcat() truncation (cf. ch07/misc/safe_vs_unsafe.c)
+    printf("Test 2: strsimd_strlcpy() and strsimd_strlcat()\n");
+    {
+        char buffer[20];
+        size_t r = strsimd_strlcpy(buffer, "This is a very long string", sizeof(buffer));
+        printf("  strlcpy -> \"%s\" (returned %zu, truncated: %s)\n", buffer, r,
+               r >= sizeof(buffer) ? "yes" : "no");
+
+        strsimd_strlcpy(buffer, "Hello", sizeof(buffer));
+        r = strsimd_strlcat(buffer, ", World! How are you?", sizeof(buffer));
+        printf("  strlcat -> \"%s\" (returned %zu, truncated: %s)\n", buffer, r,
+               r >= sizeof(buffer) ? "yes" : "no");
+    }
+    printf("\n");
+
+    // Test 3: Reverse and palindrome (cf. ch11/listings/unit_testing.c)
+    printf("Test 3: strsimd_reverse() and strsimd_is_palindrome()\n");
+    {
+        char text[] = "A man, a plan, a canal: Panama! A man, a plan, a canal: Panama!";
+        size_t len = strlen(text);
+        strsimd_reverse(text, text, len);
+        printf("  Reversed: \"%s\"\n", text);
+
+        const char *pal = "step on no pets step on no pets step on no pets step on no pets";
+        printf("  \"%s\" is a palindrome: %s\n", pal,
+               strsimd_is_palindrome(pal, strlen(pal)) ? "yes" : "no");
+    }
+    printf("\n");
+
+    // Test 4: Fuzz equivalence with the scalar reference code at every level
+    printf("Test 4: Fuzz equivalence against the scalar versions\n");
+    for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+    {
+        StrSimdLevel used = strsimd_set_level((StrSimdLevel)level);
+        int mismatches = fuzz_level(20000);
+        printf("  %s %-6s 20000 random cases, %d mismatches\n",
+               mismatches == 0 ? "✓" : "✗", strsimd_level_name(used), mismatches);
+        failures += mismatches;
+    }
+    printf("\n");
+
+    // Test 5: Throughput on a large buffer
+    printf("Test 5: Throughput on a 16 MiB buffer (GB/s)\n");
+    {
+        const size_t len = (size_t)16 << 20;
+        char *src = malloc(len + 1);
+        char *dst = malloc(len + 1);
+        if (src == NULL || dst == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            free(src);
+            free(dst);
+            return EXIT_FAILURE;
+        }
+        fill_random(src, len / 2);
+        ref_string_reverse(src + len / 2, src, len / 2);
+        src[len] = '\0';
+
+        printf("  %-8s %10s %10s %10s %10s\n", "level", "strlen", "strlcpy", "reverse", "palindrome");
+        for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+        {
+            StrSimdLevel used = strsimd_set_level((StrSimdLevel)level);
+            const int reps = 5;
+            double t[4];
+            size_t sink = 0;
+
+            double t0 = now_seconds();
+            for (int r = 0; r < reps; r++)
+            {
+                sink += strsimd_strlen(src);
+            }
+            t[0] = now_seconds() - t0;
+
+            t0 = now_seconds();
+            for (int r = 0; r < reps; r++)
+            {
+                sink += strsimd_strlcpy(dst, src, len + 1);
+            }
+            t[1] = now_seconds() - t0;
+
+            t0 = now_seconds();
+            for (int r = 0; r < reps; r++)
+            {
+                strsimd_reverse(dst, src, len);
+            }
+            t[2] = now_seconds() - t0;
+
+            t0 = now_seconds();
+            for (int r = 0; r < reps; r++)
+            {
+                sink += strsimd_is_palindrome(src, len);
+            }
+            t[3] = now_seconds() - t0;
+
+            double bytes = (double)len * reps / 1e9;
+            printf("  %-8s %10.2f %10.2f %10.2f %10.2f\n", strsimd_level_name(used),
+                   bytes / t[0], bytes / t[1], bytes / t[2], bytes / t[3]);
+            (void)sink;
+        }
+
+        free(src);
+        free(dst);
+        strsimd_set_level(best);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. NUL detection compares 8/16/32 bytes at once instead of one\n");
+    printf("2. Aligned block reads never cross a page, so over-reading is safe\n");
+    printf("3. Reversal uses bswap (SWAR), word shuffles (SSE2), vpshufb (AVX2)\n");
+    printf("4. Return values and truncation match the scalar strlcpy()/strlcat()\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
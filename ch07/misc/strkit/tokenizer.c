@@ -0,0 +1,360 @@
+/*
+ * String Kit - tokenizer.c
+ *
+ * Implementation of the zero-copy tokenizer.
+ *
+ * Scalar path: one bitmap test per byte, no rescanning of the delimiter
+ * string (strtok() walks the whole delimiter set for every input byte).
+ *
+ * AVX2 path ("shufti" byte-class lookup): every byte is split into its
+ * low and high nibble, each nibble indexes a 16-entry table with vpshufb,
+ * and the byte is a delimiter if the two results share a bit. Any set in
+ * which the high nibbles use at most 8 distinct low-nibble patterns can be
+ * encoded exactly; that covers every practical delimiter set.
+ */
+
+#include "tokenizer.h"
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TOK_X86 1
+#include <immintrin.h>
+#endif
+
+#define BLOCK 32
+
+// ============================================================================
+// Delimiter sets
+// ============================================================================
+
+static bool cpu_has_avx2(void)
+{
+#ifdef TOK_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Build the nibble tables; returns false if the set needs > 8 classes
+static bool build_nibble_tables(TokDelims *d)
+{
+    uint16_t row[16];
+    uint16_t classes[8];
+    int nclasses = 0;
+
+    memset(d->lo_nibble, 0, sizeof(d->lo_nibble));
+    memset(d->hi_nibble, 0, sizeof(d->hi_nibble));
+
+    for (int hi = 0; hi < 16; hi++)
+    {
+        row[hi] = 0;
+        for (int lo = 0; lo < 16; lo++)
+        {
+            if (tok_is_delim(d, (unsigned char)(hi << 4 | lo)))
+            {
+                row[hi] |= (uint16_t)(1u << lo);
+            }
+        }
+    }
+
+    for (int hi = 0; hi < 16; hi++)
+    {
+        if (row[hi] == 0)
+        {
+            continue;
+        }
+
+        int cls = 0;
+        while (cls < nclasses && classes[cls] != row[hi])
+        {
+            cls++;
+        }
+        if (cls == nclasses)
+        {
+            if (nclasses == 8)
+            {
+                return false;
+            }
+            classes[nclasses++] = row[hi];
+            for (int lo = 0; lo < 16; lo++)
+            {
+                if (row[hi] & (1u << lo))
+                {
+                    d->lo_nibble[lo] |= (uint8_t)(1u << cls);
+                }
+            }
+        }
+        d->hi_nibble[hi] = (uint8_t)(1u << cls);
+    }
+    return true;
+}
+
+void tok_delims_init_bytes(TokDelims *d, const unsigned char *bytes, size_t count)
+{
+    memset(d->bits, 0, sizeof(d->bits));
+    for (size_t i = 0; i < count; i++)
+    {
+        d->bits[bytes[i] >> 6] |= (uint64_t)1 << (bytes[i] & 63);
+    }
+    d->simd_ok = build_nibble_tables(d) && cpu_has_avx2();
+}
+
+void tok_delims_init(TokDelims *d, const char *delims)
+{
+    tok_delims_init_bytes(d, (const unsigned char *)delims, strlen(delims));
+}
+
+// ============================================================================
+// Scalar spans
+// ============================================================================
+
+static const char *skip_delims_scalar(const char *p, const char *end, const TokDelims *d)
+{
+    while (p < end && tok_is_delim(d, (unsigned char)*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+static const char *find_delim_scalar(const char *p, const char *end, const TokDelims *d)
+{
+    while (p < end && !tok_is_delim(d, (unsigned char)*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+// ============================================================================
+// AVX2 spans
+// ============================================================================
+
+#ifdef TOK_X86
+
+#define AVX2 __attribute__((target("avx2")))
+
+typedef struct
+{
+    __m256i lo;
+    __m256i hi;
+} NibbleTables;
+
+AVX2 static NibbleTables load_tables(const TokDelims *d)
+{
+    NibbleTables t;
+    t.lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)d->lo_nibble));
+    t.hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)d->hi_nibble));
+    return t;
+}
+
+// Bit i set iff p[i] is a delimiter
+AVX2 static uint32_t delim_mask(const char *p, const NibbleTables *t)
+{
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    __m256i v = _mm256_loadu_si256((const __m256i *)p);
+    __m256i lo = _mm256_and_si256(v, low4);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low4);
+    __m256i cls = _mm256_and_si256(_mm256_shuffle_epi8(t->lo, lo),
+                                   _mm256_shuffle_epi8(t->hi, hi));
+    __m256i none = _mm256_cmpeq_epi8(cls, _mm256_setzero_si256());
+    return ~(uint32_t)_mm256_movemask_epi8(none);
+}
+
+AVX2 static const char *skip_delims_avx2(const char *p, const char *end, const TokDelims *d)
+{
+    NibbleTables t = load_tables(d);
+    while (end - p >= BLOCK)
+    {
+        uint32_t m = ~delim_mask(p, &t);
+        if (m != 0)
+        {
+            return p + __builtin_ctz(m);
+        }
+        p += BLOCK;
+    }
+    return skip_delims_scalar(p, end, d);
+}
+
+AVX2 static const char *find_delim_avx2(const char *p, const char *end, const TokDelims *d)
+{
+    NibbleTables t = load_tables(d);
+    while (end - p >= BLOCK)
+    {
+        uint32_t m = delim_mask(p, &t);
+        if (m != 0)
+        {
+            return p + __builtin_ctz(m);
+        }
+        p += BLOCK;
+    }
+    return find_delim_scalar(p, end, d);
+}
+
+// Classify each block once and read token boundaries off the bit masks
+AVX2 static size_t split_avx2(Tokenizer *tk, TokView *out, size_t max)
+{
+    NibbleTables t = load_tables(tk->delims);
+    const char *p = tk->cur;
+    const char *start = NULL; // start of the token we are inside, if any
+    size_t n = 0;
+
+    while (tk->end - p >= BLOCK)
+    {
+        uint32_t delim = delim_mask(p, &t);
+        uint32_t prev = (delim << 1) | (start == NULL ? 1u : 0u); // previous byte is a delimiter
+        uint32_t starts = ~delim & prev;
+        uint32_t ends = delim & ~prev;
+        uint32_t events = starts | ends;
+
+        while (events != 0)
+        {
+            unsigned i = (unsigned)__builtin_ctz(events);
+            events &= events - 1;
+            if (starts & (1u << i))
+            {
+                start = p + i;
+            }
+            else
+            {
+                out[n].ptr = start;
+                out[n].len = (size_t)(p + i - start);
+                start = NULL;
+                if (++n == max)
+                {
+                    tk->cur = p + i;
+                    return n;
+                }
+            }
+        }
+        p += BLOCK;
+    }
+
+    tk->cur = (start != NULL) ? start : p;
+    return n;
+}
+
+#endif /* TOK_X86 */
+
+static const char *skip_delims(const char *p, const char *end, const TokDelims *d)
+{
+#ifdef TOK_X86
+    if (d->simd_ok && end - p >= BLOCK)
+    {
+        return skip_delims_avx2(p, end, d);
+    }
+#endif
+    return skip_delims_scalar(p, end, d);
+}
+
+static const char *find_delim(const char *p, const char *end, const TokDelims *d)
+{
+#ifdef TOK_X86
+    if (d->simd_ok && end - p >= BLOCK)
+    {
+        return find_delim_avx2(p, end, d);
+    }
+#endif
+    return find_delim_scalar(p, end, d);
+}
+
+// ============================================================================
+// Iteration
+// ============================================================================
+
+void tok_init(Tokenizer *t, const char *buf, size_t len, const TokDelims *delims)
+{
+    t->cur = buf;
+    t->end = buf + len;
+    t->delims = delims;
+}
+
+bool tok_next(Tokenizer *t, TokView *token)
+{
+    if (t->cur == NULL)
+    {
+        return false;
+    }
+
+    const char *start = skip_delims(t->cur, t->end, t->delims);
+    if (start == t->end)
+    {
+        t->cur = start;
+        return false;
+    }
+
+    const char *stop = find_delim(start, t->end, t->delims);
+    token->ptr = start;
+    token->len = (size_t)(stop - start);
+    t->cur = (stop < t->end) ? stop + 1 : stop;
+    return true;
+}
+
+bool tok_next_field(Tokenizer *t, TokView *field)
+{
+    if (t->cur == NULL)
+    {
+        return false;
+    }
+
+    const char *stop = find_delim(t->cur, t->end, t->delims);
+    field->ptr = t->cur;
+    field->len = (size_t)(stop - t->cur);
+    t->cur = (stop < t->end) ? stop + 1 : NULL; // NULL: last field returned
+    return true;
+}
+
+size_t tok_split(Tokenizer *t, TokView *out, size_t max)
+{
+    size_t n = 0;
+
+#ifdef TOK_X86
+    if (t->delims->simd_ok && max > 0)
+    {
+        n = split_avx2(t, out, max);
+    }
+#endif
+
+    while (n < max && tok_next(t, &out[n]))
+    {
+        n++;
+    }
+    return n;
+}
+
+// ============================================================================
+// Partitioning for multi-threaded tokenizing
+// ============================================================================
+
+size_t tok_align(const char *buf, size_t len, size_t pos, const TokDelims *delims)
+{
+    if (pos == 0 || pos >= len)
+    {
+        return pos >= len ? len : 0;
+    }
+    if (tok_is_delim(delims, (unsigned char)buf[pos - 1]))
+    {
+        return pos;
+    }
+    return (size_t)(find_delim(buf + pos, buf + len, delims) - buf);
+}
+
+void tok_partition(const char *buf, size_t len, const TokDelims *delims,
+                   size_t nchunks, size_t *offsets)
+{
+    offsets[0] = 0;
+    for (size_t i = 1; i < nchunks; i++)
+    {
+        size_t pos = tok_align(buf, len, len / nchunks * i, delims);
+        offsets[i] = (pos < offsets[i - 1]) ? offsets[i - 1] : pos;
+    }
+    offsets[nchunks] = len;
+}
+
+bool tok_view_equals(TokView v, const char *s)
+{
+    size_t n = strlen(s);
+    return n == v.len && memcmp(v.ptr, s, n) == 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * String Kit - tokenizer.h
+ *
+ * Public interface for a reentrant, zero-copy tokenizer: the replacement
+ * for strtok() shown in ch07/listings/string_handling.c.
+ *
+ * - Tokens are (pointer, length) views into the caller's buffer; the
+ *   input is never modified and need not be NUL-terminated
+ * - All state lives in a Tokenizer the caller owns, so any number of
+ *   threads can tokenize (different parts of) the same buffer
+ * - The delimiter set is compiled once into a 256-bit bitmap, plus a
+ *   nibble lookup table used by the AVX2 path on long inputs
+ */
+
+#ifndef STRKIT_TOKENIZER_H
+#define STRKIT_TOKENIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Precompiled delimiter set
+typedef struct
+{
+    uint64_t bits[4];        // one bit per byte value
+    uint8_t lo_nibble[16];   // byte-class tables for the SIMD lookup
+    uint8_t hi_nibble[16];
+    bool simd_ok;            // set fits in the 8 classes the lookup supports
+} TokDelims;
+
+// A token: points into the original buffer, NOT NUL-terminated
+typedef struct
+{
+    const char *ptr;
+    size_t len;
+} TokView;
+
+// Tokenizer state (one per thread / per buffer)
+typedef struct
+{
+    const char *cur;
+    const char *end;
+    const TokDelims *delims;
+} Tokenizer;
+
+// Delimiter sets
+void tok_delims_init(TokDelims *d, const char *delims);
+void tok_delims_init_bytes(TokDelims *d, const unsigned char *bytes, size_t count);
+
+static inline bool tok_is_delim(const TokDelims *d, unsigned char c)
+{
+    return (d->bits[c >> 6] >> (c & 63)) & 1u;
+}
+
+// Iteration
+void tok_init(Tokenizer *t, const char *buf, size_t len, const TokDelims *delims);
+bool tok_next(Tokenizer *t, TokView *token);       // strtok(): skips empty tokens
+bool tok_next_field(Tokenizer *t, TokView *field); // strsep(): keeps empty fields
+// (use one style per Tokenizer; tok_next_field() marks the end by cur == NULL)
+size_t tok_split(Tokenizer *t, TokView *out, size_t max); // bulk tok_next()
+
+// Splitting work across threads: move `pos` forward to the start of the
+// next token so that each chunk [offsets[i], offsets[i+1]) tokenizes
+// independently; tok_partition() fills nchunks + 1 offsets
+size_t tok_align(const char *buf, size_t len, size_t pos, const TokDelims *delims);
+void tok_partition(const char *buf, size_t len, const TokDelims *delims,
+                   size_t nchunks, size_t *offsets);
+
+// Compare a view with a C string
+bool tok_view_equals(TokView v, const char *s);
+
+#endif /* STRKIT_TOKENIZER_H */
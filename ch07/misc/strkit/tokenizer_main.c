@@ -0,0 +1,350 @@
+/*
+ * String Kit - tokenizer_main.c
+ *
+ * Demonstrates the zero-copy tokenizer as a replacement for strtok():
+ * the input stays untouched, tokens are (pointer, length) views, and
+ * independent Tokenizer objects let several threads split one buffer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "tokenizer.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Fill buf with words separated by runs of " ,\t\n"
+static void make_log(char *buf, size_t len, unsigned seed)
+{
+    static const char seps[] = " ,\t\n";
+    size_t i = 0;
+    while (i < len)
+    {
+        seed = seed * 1103515245u + 12345u;
+        size_t word = 1 + (seed >> 16) % 12;
+        for (size_t k = 0; k < word && i < len; k++)
+        {
+            buf[i++] = (char)('a' + (seed >> (k % 16)) % 26);
+        }
+        seed = seed * 1103515245u + 12345u;
+        size_t run = 1 + (seed >> 16) % 3;
+        for (size_t k = 0; k < run && i < len; k++)
+        {
+            buf[i++] = seps[(seed >> (8 + k)) % 4];
+        }
+    }
+}
+
+// Token count and a cheap checksum of token lengths and first bytes
+typedef struct
+{
+    const char *buf;
+    size_t begin;
+    size_t end;
+    const TokDelims *delims;
+    size_t tokens;
+    unsigned long long checksum;
+} Job;
+
+static void *tokenize_job(void *arg)
+{
+    Job *job = arg;
+    Tokenizer t;
+    TokView batch[256];
+    size_t n;
+
+    tok_init(&t, job->buf + job->begin, job->end - job->begin, job->delims);
+    while ((n = tok_split(&t, batch, 256)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            job->checksum += batch[i].len * 31u + (unsigned char)batch[i].ptr[0];
+        }
+        job->tokens += n;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    printf("=== Zero-Copy Tokenizer ===\n\n");
+
+    // Test 1: The strtok() example from ch07/listings/string_handling.c
+    printf("Test 1: Tokenizing without modifying the input\n");
+    {
+        const char str[] = "apple,banana,cherry,date"; // can be const now
+        TokDelims delims;
+        Tokenizer t;
+        TokView token;
+
+        tok_delims_init(&delims, ",");
+        tok_init(&t, str, strlen(str), &delims);
+
+        printf("Original: \"%s\"\n", str);
+        printf("Tokens:\n");
+        while (tok_next(&t, &token))
+        {
+            printf("  \"%.*s\" (length %zu)\n", (int)token.len, token.ptr, token.len);
+        }
+        check(strcmp(str, "apple,banana,cherry,date") == 0, "input unchanged");
+    }
+    printf("\n");
+
+    // Test 2: Multiple delimiters and runs of delimiters
+    printf("Test 2: Several delimiters, runs are skipped like strtok()\n");
+    {
+        const char str[] = "  hello,, world\tfoo  ";
+        static const char *expected[] = {"hello", "world", "foo"};
+        TokDelims delims;
+        Tokenizer t;
+        TokView token;
+        size_t i = 0;
+        bool ok = true;
+
+        tok_delims_init(&delims, " ,\t");
+        tok_init(&t, str, strlen(str), &delims);
+        while (tok_next(&t, &token))
+        {
+            printf("  [%.*s]\n", (int)token.len, token.ptr);
+            ok = ok && i < 3 && tok_view_equals(token, expected[i]);
+            i++;
+        }
+        check(ok && i == 3, "three tokens");
+    }
+    printf("\n");
+
+    // Test 3: Empty fields (strsep() style) for CSV-like data
+    printf("Test 3: tok_next_field() keeps empty fields\n");
+    {
+        const char str[] = "id,,name,";
+        TokDelims delims;
+        Tokenizer t;
+        TokView field;
+        size_t count = 0;
+
+        tok_delims_init(&delims, ",");
+        tok_init(&t, str, strlen(str), &delims);
+        while (tok_next_field(&t, &field))
+        {
+            printf("  field %zu: \"%.*s\"\n", count, (int)field.len, field.ptr);
+            count++;
+        }
+        check(count == 4, "four fields, two of them empty");
+    }
+    printf("\n");
+
+    // Test 4: Same tokens as strtok() on random input, scalar and SIMD
+    printf("Test 4: Equivalence with strtok() on random input\n");
+    {
+        const size_t len = 1 << 20;
+        char *log = malloc(len + 1);
+        char *copy = malloc(len + 1);
+        TokView *views = malloc(len * sizeof(TokView));
+        if (!log || !copy || !views)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        make_log(log, len, 42);
+        log[len] = '\0';
+
+        TokDelims simd, scalar;
+        tok_delims_init(&simd, " ,\t\n");
+        scalar = simd;
+        scalar.simd_ok = false;
+        printf("  SIMD byte-class lookup available: %s\n", simd.simd_ok ? "yes" : "no");
+
+        const TokDelims *sets[] = {&scalar, &simd};
+        const char *names[] = {"scalar tok_next", "scalar tok_split", "simd tok_next", "simd tok_split"};
+        for (int s = 0; s < 2; s++)
+        {
+            for (int bulk = 0; bulk < 2; bulk++)
+            {
+                Tokenizer t;
+                size_t n = 0;
+                tok_init(&t, log, len, sets[s]);
+                if (bulk)
+                {
+                    size_t got;
+                    while ((got = tok_split(&t, views + n, 1000)) > 0)
+                    {
+                        n += got;
+                    }
+                }
+                else
+                {
+                    while (tok_next(&t, &views[n]))
+                    {
+                        n++;
+                    }
+                }
+
+                memcpy(copy, log, len + 1);
+                size_t i = 0;
+                bool same = true;
+                for (char *tok = strtok(copy, " ,\t\n"); tok != NULL; tok = strtok(NULL, " ,\t\n"))
+                {
+                    same = same && i < n && views[i].ptr == log + (tok - copy) &&
+                           views[i].len == strlen(tok);
+                    i++;
+                }
+                char what[80];
+                snprintf(what, sizeof(what), "%-17s %zu tokens match strtok()", names[s * 2 + bulk], n);
+                check(same && i == n, what);
+            }
+        }
+
+        free(log);
+        free(copy);
+        free(views);
+    }
+    printf("\n");
+
+    // Test 5: Splitting one buffer across threads
+    printf("Test 5: Four threads on one buffer with tok_partition()\n");
+    {
+        const size_t len = (size_t)32 << 20;
+        const size_t nthreads = 4;
+        char *log = malloc(len);
+        if (log == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        make_log(log, len, 7);
+
+        TokDelims delims;
+        tok_delims_init(&delims, " ,\t\n");
+
+        Job whole = {log, 0, len, &delims, 0, 0};
+        double t0 = now_seconds();
+        tokenize_job(&whole);
+        double single = now_seconds() - t0;
+
+        size_t offsets[5];
+        Job jobs[4];
+        pthread_t threads[4];
+        tok_partition(log, len, &delims, nthreads, offsets);
+
+        t0 = now_seconds();
+        for (size_t i = 0; i < nthreads; i++)
+        {
+            jobs[i] = (Job){log, offsets[i], offsets[i + 1], &delims, 0, 0};
+            pthread_create(&threads[i], NULL, tokenize_job, &jobs[i]);
+        }
+        size_t tokens = 0;
+        unsigned long long checksum = 0;
+        for (size_t i = 0; i < nthreads; i++)
+        {
+            pthread_join(threads[i], NULL);
+            tokens += jobs[i].tokens;
+            checksum += jobs[i].checksum;
+        }
+        double parallel = now_seconds() - t0;
+
+        printf("  1 thread:  %zu tokens in %.3f s\n", whole.tokens, single);
+        printf("  4 threads: %zu tokens in %.3f s\n", tokens, parallel);
+        check(tokens == whole.tokens && checksum == whole.checksum, "identical tokens");
+
+        free(log);
+    }
+    printf("\n");
+
+    // Test 6: Throughput
+    printf("Test 6: Throughput on 32 MiB (MB/s)\n");
+    {
+        const size_t len = (size_t)32 << 20;
+        char *log = malloc(len + 1);
+        TokView *batch = malloc(4096 * sizeof(TokView));
+        if (!log || !batch)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        make_log(log, len, 99);
+        log[len] = '\0';
+
+        TokDelims simd, scalar;
+        tok_delims_init(&simd, " ,\t\n");
+        scalar = simd;
+        scalar.simd_ok = false;
+
+        size_t count = 0;
+        double t0 = now_seconds();
+        for (char *tok = strtok(log, " ,\t\n"); tok != NULL; tok = strtok(NULL, " ,\t\n"))
+        {
+            count++;
+        }
+        double t_strtok = now_seconds() - t0;
+        make_log(log, len, 99); // strtok() wrote NULs into the buffer
+
+        const TokDelims *sets[] = {&scalar, &simd};
+        double t_next[2], t_split[2];
+        for (int s = 0; s < 2; s++)
+        {
+            Tokenizer t;
+            TokView token;
+            size_t n;
+
+            t0 = now_seconds();
+            tok_init(&t, log, len, sets[s]);
+            while (tok_next(&t, &token))
+            {
+                count++;
+            }
+            t_next[s] = now_seconds() - t0;
+
+            t0 = now_seconds();
+            tok_init(&t, log, len, sets[s]);
+            while ((n = tok_split(&t, batch, 4096)) > 0)
+            {
+                count += n;
+            }
+            t_split[s] = now_seconds() - t0;
+        }
+
+        double mb = (double)len / 1e6;
+        printf("  strtok():            %8.1f\n", mb / t_strtok);
+        printf("  tok_next() scalar:   %8.1f\n", mb / t_next[0]);
+        printf("  tok_split() scalar:  %8.1f\n", mb / t_split[0]);
+        printf("  tok_next() simd:     %8.1f\n", mb / t_next[1]);
+        printf("  tok_split() simd:    %8.1f\n", mb / t_split[1]);
+        (void)count;
+
+        free(log);
+        free(batch);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Tokens are views: print them with \"%%.*s\", not \"%%s\"\n");
+    printf("2. The buffer must outlive every view taken from it\n");
+    printf("3. No hidden static state - one Tokenizer per thread\n");
+    printf("4. The delimiter set is compiled once, not rescanned per byte\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,796 @@
+/*
+ * String Kit - utf8conv.c
+ *
+ * Implementation of the UTF-8 transcoder.
+ *
+ * The converters are scalar state machines that hand every run of ASCII
+ * to a kernel of the active level. A kernel converts whole blocks while
+ * they are pure ASCII; for the first block that is not, it still stores
+ * the whole block (the stores stay inside the caller's buffer) and
+ * returns only the length of the ASCII prefix, so the bytes after it are
+ * overwritten by the scalar code.
+ *
+ * Multibyte sequences are checked against the well-formed byte ranges of
+ * the Unicode standard (table 3-7), which rules out overlong forms,
+ * surrogates and values above U+10FFFF without decoding first.
+ */
+
+#include "utf8conv.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UTF_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UTF_HAVE_SWAR 1
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define le16(v) ((uint16_t)__builtin_bswap16(v))
+#else
+#define le16(v) ((uint16_t)(v))
+#endif
+
+// ASCII run kernels: convert the ASCII prefix of src[0..n) and return its
+// length
+typedef struct
+{
+    size_t (*widen16)(const unsigned char *src, size_t n, uint16_t *dst);
+    size_t (*widen32)(const unsigned char *src, size_t n, uint32_t *dst);
+    size_t (*narrow16)(const uint16_t *src, size_t n, char *dst);
+    size_t (*narrow32)(const uint32_t *src, size_t n, char *dst);
+} ConvOps;
+
+static size_t min_size(size_t a, size_t b)
+{
+    return a < b ? a : b;
+}
+
+// ============================================================================
+// Scalar kernels (also the tails of the wider levels)
+// ============================================================================
+
+static size_t widen16_scalar(const unsigned char *src, size_t n, uint16_t *dst)
+{
+    size_t i = 0;
+    for (; i < n && src[i] < 0x80; i++)
+    {
+        dst[i] = le16(src[i]);
+    }
+    return i;
+}
+
+static size_t widen32_scalar(const unsigned char *src, size_t n, uint32_t *dst)
+{
+    size_t i = 0;
+    for (; i < n && src[i] < 0x80; i++)
+    {
+        dst[i] = src[i];
+    }
+    return i;
+}
+
+static size_t narrow16_scalar(const uint16_t *src, size_t n, char *dst)
+{
+    size_t i = 0;
+    for (; i < n && le16(src[i]) < 0x80; i++)
+    {
+        dst[i] = (char)le16(src[i]);
+    }
+    return i;
+}
+
+static size_t narrow32_scalar(const uint32_t *src, size_t n, char *dst)
+{
+    size_t i = 0;
+    for (; i < n && src[i] < 0x80; i++)
+    {
+        dst[i] = (char)src[i];
+    }
+    return i;
+}
+
+static const ConvOps scalar_ops = {widen16_scalar, widen32_scalar, narrow16_scalar, narrow32_scalar};
+
+// ============================================================================
+// SWAR kernels: test 8 bytes for ASCII with one 64-bit AND
+// ============================================================================
+
+#ifdef UTF_HAVE_SWAR
+
+#define HIGH_BITS 0x8080808080808080ULL
+
+static size_t widen16_swar(const unsigned char *src, size_t n, uint16_t *dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        if ((w & HIGH_BITS) != 0)
+        {
+            break;
+        }
+        for (int k = 0; k < 8; k++)
+        {
+            dst[i + k] = (uint16_t)((w >> (8 * k)) & 0x7F);
+        }
+    }
+    return i + widen16_scalar(src + i, n - i, dst + i);
+}
+
+static size_t widen32_swar(const unsigned char *src, size_t n, uint32_t *dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        if ((w & HIGH_BITS) != 0)
+        {
+            break;
+        }
+        for (int k = 0; k < 8; k++)
+        {
+            dst[i + k] = (uint32_t)((w >> (8 * k)) & 0x7F);
+        }
+    }
+    return i + widen32_scalar(src + i, n - i, dst + i);
+}
+
+// Four UTF-16 units per 64-bit word: ASCII if no bit above 0x7F is set
+static size_t narrow16_swar(const uint16_t *src, size_t n, char *dst)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        if ((w & 0xFF80FF80FF80FF80ULL) != 0)
+        {
+            break;
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            dst[i + k] = (char)(w >> (16 * k));
+        }
+    }
+    return i + narrow16_scalar(src + i, n - i, dst + i);
+}
+
+static size_t narrow32_swar(const uint32_t *src, size_t n, char *dst)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        if ((w & 0xFFFFFF80FFFFFF80ULL) != 0)
+        {
+            break;
+        }
+        dst[i] = (char)w;
+        dst[i + 1] = (char)(w >> 32);
+    }
+    return i + narrow32_scalar(src + i, n - i, dst + i);
+}
+
+static const ConvOps swar_ops = {widen16_swar, widen32_swar, narrow16_swar, narrow32_swar};
+
+#endif /* UTF_HAVE_SWAR */
+
+// ============================================================================
+// SSE2 kernels: 16 bytes per step (always available on x86-64)
+// ============================================================================
+
+#ifdef UTF_X86
+
+static size_t widen16_sse2(const unsigned char *src, size_t n, uint16_t *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+        unsigned mask = (unsigned)_mm_movemask_epi8(v);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return i + widen16_scalar(src + i, n - i, dst + i);
+}
+
+static size_t widen32_sse2(const unsigned char *src, size_t n, uint32_t *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+        unsigned mask = (unsigned)_mm_movemask_epi8(v);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return i + widen32_scalar(src + i, n - i, dst + i);
+}
+
+// 16 units (32 bytes) per step; a block with any unit above 0x7F is left
+// to the scalar tail
+static size_t narrow16_sse2(const uint16_t *src, size_t n, char *dst)
+{
+    const __m128i high = _mm_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 8));
+        __m128i any = _mm_and_si128(_mm_or_si128(a, b), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(any, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+    }
+    return i + narrow16_scalar(src + i, n - i, dst + i);
+}
+
+static size_t narrow32_sse2(const uint32_t *src, size_t n, char *dst)
+{
+    const __m128i high = _mm_set1_epi32(~0x7F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 4));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i + 8));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + i + 12));
+        __m128i any = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(any, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+        // Every value is below 0x80, so the saturating packs are exact
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+    return i + narrow32_scalar(src + i, n - i, dst + i);
+}
+
+static const ConvOps sse2_ops = {widen16_sse2, widen32_sse2, narrow16_sse2, narrow32_sse2};
+
+// ============================================================================
+// AVX2 kernels: 32 bytes per step, compiled for AVX2 only in these functions
+// ============================================================================
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static size_t widen16_avx2(const unsigned char *src, size_t n, uint16_t *dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(v);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    _mm256_zeroupper(); // widen16_sse2() is legacy SSE code
+    return i + widen16_sse2(src + i, n - i, dst + i);
+}
+
+AVX2 static size_t widen32_avx2(const unsigned char *src, size_t n, uint32_t *dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi32(lo));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi32(hi));
+        _mm256_storeu_si256((__m256i *)(dst + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(v);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    _mm256_zeroupper(); // widen32_sse2() is legacy SSE code
+    return i + widen32_sse2(src + i, n - i, dst + i);
+}
+
+AVX2 static size_t narrow16_avx2(const uint16_t *src, size_t n, char *dst)
+{
+    const __m256i high = _mm256_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), high))
+        {
+            break;
+        }
+        // packus works per 128-bit lane: put the quadwords back in order
+        __m256i packed = _mm256_packus_epi16(a, b);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    _mm256_zeroupper(); // narrow16_sse2() is legacy SSE code
+    return i + narrow16_sse2(src + i, n - i, dst + i);
+}
+
+AVX2 static size_t narrow32_avx2(const uint32_t *src, size_t n, char *dst)
+{
+    const __m256i high = _mm256_set1_epi32(~0x7F);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + 8));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(src + i + 24));
+        if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), high))
+        {
+            break;
+        }
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    _mm256_zeroupper(); // narrow32_sse2() is legacy SSE code
+    return i + narrow32_sse2(src + i, n - i, dst + i);
+}
+
+static const ConvOps avx2_ops = {widen16_avx2, widen32_avx2, narrow16_avx2, narrow32_avx2};
+
+#endif /* UTF_X86 */
+
+// ============================================================================
+// Runtime dispatch
+// ============================================================================
+
+// Chosen on first use, or by utf8conv_set_level(). Atomic because the
+// first calls may come from several threads at once.
+static _Atomic(const ConvOps *) active_ops = NULL;
+static _Atomic StrSimdLevel active_level = STRSIMD_SCALAR;
+
+StrSimdLevel utf8conv_set_level(StrSimdLevel level)
+{
+    StrSimdLevel best = strsimd_detect();
+    if (level > best)
+    {
+        level = best;
+    }
+
+    const ConvOps *chosen;
+    switch (level)
+    {
+#ifdef UTF_X86
+    case STRSIMD_AVX2:
+        chosen = &avx2_ops;
+        break;
+    case STRSIMD_SSE2:
+        chosen = &sse2_ops;
+        break;
+#endif
+#ifdef UTF_HAVE_SWAR
+    case STRSIMD_SWAR:
+        chosen = &swar_ops;
+        break;
+#endif
+    default:
+        level = STRSIMD_SCALAR;
+        chosen = &scalar_ops;
+        break;
+    }
+
+    atomic_store_explicit(&active_level, level, memory_order_relaxed);
+    atomic_store_explicit(&active_ops, chosen, memory_order_release);
+    return level;
+}
+
+static const ConvOps *ops(void)
+{
+    const ConvOps *o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    if (o == NULL)
+    {
+        utf8conv_set_level(strsimd_detect());
+        o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    }
+    return o;
+}
+
+StrSimdLevel utf8conv_level(void)
+{
+    ops();
+    return atomic_load_explicit(&active_level, memory_order_relaxed);
+}
+
+// ============================================================================
+// UTF-8 decoding
+// ============================================================================
+
+// Decode the multibyte sequence at p (p[0] >= 0x80). Returns its length,
+// -EILSEQ if it is malformed, or -EINVAL if avail ends before it does.
+static int decode_seq(const unsigned char *p, size_t avail, uint32_t *cp)
+{
+    unsigned c = p[0];
+    int need;
+    unsigned lo = 0x80;
+    unsigned hi = 0xBF;
+    uint32_t v;
+
+    if (c < 0xC2)
+    {
+        return -EILSEQ; // continuation byte, or overlong C0/C1 lead
+    }
+    if (c < 0xE0)
+    {
+        need = 2;
+        v = c & 0x1F;
+    }
+    else if (c < 0xF0)
+    {
+        need = 3;
+        v = c & 0x0F;
+        lo = c == 0xE0 ? 0xA0 : 0x80; // E0 80..9F would be overlong
+        hi = c == 0xED ? 0x9F : 0xBF; // ED A0..BF would be a surrogate
+    }
+    else if (c < 0xF5)
+    {
+        need = 4;
+        v = c & 0x07;
+        lo = c == 0xF0 ? 0x90 : 0x80; // F0 80..8F would be overlong
+        hi = c == 0xF4 ? 0x8F : 0xBF; // F4 90.. would be above U+10FFFF
+    }
+    else
+    {
+        return -EILSEQ;
+    }
+
+    if (avail < 2)
+    {
+        return -EINVAL;
+    }
+    if (p[1] < lo || p[1] > hi)
+    {
+        return -EILSEQ;
+    }
+    v = (v << 6) | (p[1] & 0x3F);
+    for (int k = 2; k < need; k++)
+    {
+        if (avail <= (size_t)k)
+        {
+            return -EINVAL;
+        }
+        if ((p[k] & 0xC0) != 0x80)
+        {
+            return -EILSEQ;
+        }
+        v = (v << 6) | (p[k] & 0x3F);
+    }
+    *cp = v;
+    return need;
+}
+
+// Shared body of the two decoders; wide selects UTF-32 output. Being
+// static inline with a constant argument, it is compiled once per width.
+static inline UtfResult decode_utf8(const unsigned char *src, size_t len, void *out, size_t cap, bool wide)
+{
+    const ConvOps *k = ops();
+    uint16_t *out16 = out;
+    uint32_t *out32 = out;
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len)
+    {
+        if (o == cap)
+        {
+            return (UtfResult){i, o, E2BIG};
+        }
+        if (src[i] < 0x80)
+        {
+            // A lone ASCII byte between sequences (CJK punctuation and
+            // spaces) is not worth a kernel call
+            if (i + 1 < len && src[i + 1] >= 0x80)
+            {
+                if (wide)
+                {
+                    out32[o++] = src[i++];
+                }
+                else
+                {
+                    out16[o++] = le16(src[i++]);
+                }
+                continue;
+            }
+            size_t room = min_size(len - i, cap - o);
+            size_t n = wide ? k->widen32(src + i, room, out32 + o) : k->widen16(src + i, room, out16 + o);
+            i += n;
+            o += n;
+            continue;
+        }
+
+        uint32_t cp;
+        int n = decode_seq(src + i, len - i, &cp);
+        if (n < 0)
+        {
+            return (UtfResult){i, o, -n};
+        }
+        if (wide)
+        {
+            out32[o++] = cp;
+        }
+        else if (cp < 0x10000)
+        {
+            out16[o++] = le16(cp);
+        }
+        else
+        {
+            if (cap - o < 2)
+            {
+                return (UtfResult){i, o, E2BIG};
+            }
+            cp -= 0x10000;
+            out16[o++] = le16(0xD800 | (cp >> 10));
+            out16[o++] = le16(0xDC00 | (cp & 0x3FF));
+        }
+        i += (size_t)n;
+    }
+    return (UtfResult){i, o, 0};
+}
+
+UtfResult utf8_to_utf16le(const char *src, size_t len, uint16_t *dst, size_t cap)
+{
+    return decode_utf8((const unsigned char *)src, len, dst, cap, false);
+}
+
+UtfResult utf8_to_utf32(const char *src, size_t len, uint32_t *dst, size_t cap)
+{
+    return decode_utf8((const unsigned char *)src, len, dst, cap, true);
+}
+
+// ============================================================================
+// UTF-8 encoding
+// ============================================================================
+
+// Bytes needed for cp, or 0 if it is not a Unicode scalar value
+static int utf8_length(uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        return 1;
+    }
+    if (cp < 0x800)
+    {
+        return 2;
+    }
+    if (cp < 0x10000)
+    {
+        return (cp >= 0xD800 && cp <= 0xDFFF) ? 0 : 3;
+    }
+    return cp <= 0x10FFFF ? 4 : 0;
+}
+
+static void put_utf8(char *d, uint32_t cp, int n)
+{
+    switch (n)
+    {
+    case 1:
+        d[0] = (char)cp;
+        break;
+    case 2:
+        d[0] = (char)(0xC0 | (cp >> 6));
+        d[1] = (char)(0x80 | (cp & 0x3F));
+        break;
+    case 3:
+        d[0] = (char)(0xE0 | (cp >> 12));
+        d[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        d[2] = (char)(0x80 | (cp & 0x3F));
+        break;
+    default:
+        d[0] = (char)(0xF0 | (cp >> 18));
+        d[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        d[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        d[3] = (char)(0x80 | (cp & 0x3F));
+        break;
+    }
+}
+
+UtfResult utf16le_to_utf8(const uint16_t *src, size_t len, char *dst, size_t cap)
+{
+    const ConvOps *k = ops();
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len)
+    {
+        if (o == cap)
+        {
+            return (UtfResult){i, o, E2BIG};
+        }
+        uint32_t cp = le16(src[i]);
+        if (cp < 0x80)
+        {
+            size_t n = k->narrow16(src + i, min_size(len - i, cap - o), dst + o);
+            i += n;
+            o += n;
+            continue;
+        }
+
+        size_t units = 1;
+        if (cp >= 0xD800 && cp <= 0xDBFF)
+        {
+            if (i + 1 == len)
+            {
+                return (UtfResult){i, o, EINVAL}; // the low half is in the next chunk
+            }
+            uint32_t low = le16(src[i + 1]);
+            if (low < 0xDC00 || low > 0xDFFF)
+            {
+                return (UtfResult){i, o, EILSEQ};
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            units = 2;
+        }
+        int n = utf8_length(cp); // 0 for a lone low surrogate
+        if (n == 0)
+        {
+            return (UtfResult){i, o, EILSEQ};
+        }
+        if (cap - o < (size_t)n)
+        {
+            return (UtfResult){i, o, E2BIG};
+        }
+        put_utf8(dst + o, cp, n);
+        i += units;
+        o += (size_t)n;
+    }
+    return (UtfResult){i, o, 0};
+}
+
+UtfResult utf32_to_utf8(const uint32_t *src, size_t len, char *dst, size_t cap)
+{
+    const ConvOps *k = ops();
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len)
+    {
+        if (o == cap)
+        {
+            return (UtfResult){i, o, E2BIG};
+        }
+        uint32_t cp = src[i];
+        if (cp < 0x80)
+        {
+            size_t n = k->narrow32(src + i, min_size(len - i, cap - o), dst + o);
+            i += n;
+            o += n;
+            continue;
+        }
+        int n = utf8_length(cp);
+        if (n == 0)
+        {
+            return (UtfResult){i, o, EILSEQ};
+        }
+        if (cap - o < (size_t)n)
+        {
+            return (UtfResult){i, o, E2BIG};
+        }
+        put_utf8(dst + o, cp, n);
+        i++;
+        o += (size_t)n;
+    }
+    return (UtfResult){i, o, 0};
+}
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+void utf8_stream_init(Utf8Stream *s)
+{
+    s->npending = 0;
+}
+
+bool utf8_stream_complete(const Utf8Stream *s)
+{
+    return s->npending == 0;
+}
+
+static UtfResult stream_decode(Utf8Stream *s, const char *src, size_t len, void *out, size_t cap, bool wide)
+{
+    const unsigned char *in = (const unsigned char *)src;
+    size_t used = 0;    // bytes of src that completed the pending sequence
+    size_t written = 0; // units it produced
+
+    if (s->npending > 0)
+    {
+        unsigned char seq[4];
+        size_t have = s->npending + min_size(len, 4 - s->npending);
+        memcpy(seq, s->pending, s->npending);
+        memcpy(seq + s->npending, in, have - s->npending);
+
+        uint32_t cp;
+        int n = decode_seq(seq, have, &cp);
+        if (n == -EINVAL)
+        {
+            // Still incomplete: this whole chunk was part of it
+            memcpy(s->pending, seq, have);
+            s->npending = (unsigned)have;
+            return (UtfResult){len, 0, 0};
+        }
+        if (n < 0)
+        {
+            s->npending = 0;
+            return (UtfResult){0, 0, EILSEQ}; // the carried bytes are invalid
+        }
+        size_t units = (wide || cp < 0x10000) ? 1 : 2;
+        if (cap < units)
+        {
+            return (UtfResult){0, 0, E2BIG};
+        }
+        if (wide)
+        {
+            ((uint32_t *)out)[0] = cp;
+        }
+        else if (units == 1)
+        {
+            ((uint16_t *)out)[0] = le16(cp);
+        }
+        else
+        {
+            cp -= 0x10000;
+            ((uint16_t *)out)[0] = le16(0xD800 | (cp >> 10));
+            ((uint16_t *)out)[1] = le16(0xDC00 | (cp & 0x3FF));
+        }
+        used = (size_t)n - s->npending;
+        written = units;
+        s->npending = 0;
+    }
+
+    void *rest = wide ? (void *)((uint32_t *)out + written) : (void *)((uint16_t *)out + written);
+    UtfResult r = decode_utf8(in + used, len - used, rest, cap - written, wide);
+    r.read += used;
+    r.written += written;
+    if (r.error == EINVAL)
+    {
+        // At most 3 bytes: keep them for the next chunk
+        s->npending = (unsigned)(len - r.read);
+        memcpy(s->pending, in + r.read, s->npending);
+        r.read = len;
+        r.error = 0;
+    }
+    return r;
+}
+
+UtfResult utf8_stream_to_utf16le(Utf8Stream *s, const char *src, size_t len, uint16_t *dst, size_t cap)
+{
+    return stream_decode(s, src, len, dst, cap, false);
+}
+
+UtfResult utf8_stream_to_utf32(Utf8Stream *s, const char *src, size_t len, uint32_t *dst, size_t cap)
+{
+    return stream_decode(s, src, len, dst, cap, true);
+}
@@ -0,0 +1,84 @@
+/*
+ * String Kit - utf8conv.h
+ *
+ * Validating transcoder between UTF-8 and UTF-16LE / UTF-32.
+ *
+ * ch07/misc/utf16_conversion.c converts with mbstowcs() into a stack VLA,
+ * and ch07/misc/libiconv_example.c with iconv(). Both depend on the
+ * locale or on a conversion descriptor and work one character at a time.
+ * These functions need neither: they decode UTF-8 directly, and runs of
+ * ASCII are widened (or narrowed) 16 bytes per step with SSE2 or 32 with
+ * AVX2. The level is picked at run time like strsimd.h.
+ *
+ * Input is validated strictly: overlong forms, surrogates (U+D800 to
+ * U+DFFF) and code points above U+10FFFF are errors.
+ *
+ * Every conversion returns a UtfResult. error follows iconv():
+ *
+ *   0       all input converted
+ *   EILSEQ  invalid sequence at src + read
+ *   EINVAL  input ends inside a sequence that starts at src + read
+ *   E2BIG   dst is full; src + read is where to continue
+ *
+ * So a caller converting a file in chunks can carry the bytes from read
+ * onwards into the next chunk. Utf8Stream does that for the UTF-8
+ * decoders without any copying on the caller's side.
+ *
+ * UTF-16LE output is an array of uint16_t in little-endian byte order
+ * (the host order on x86), ready to write to a file.
+ *
+ * Capacities that always suffice: len units for UTF-8 to UTF-16 or
+ * UTF-32, 3 bytes per unit for UTF-16 to UTF-8, 4 per unit for UTF-32.
+ */
+
+#ifndef STRKIT_UTF8CONV_H
+#define STRKIT_UTF8CONV_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "strsimd.h"
+
+typedef struct
+{
+    size_t read;    // input units consumed
+    size_t written; // output units produced
+    int error;      // 0, EILSEQ, EINVAL or E2BIG
+} UtfResult;
+
+UtfResult utf8_to_utf16le(const char *src, size_t len, uint16_t *dst, size_t cap);
+UtfResult utf8_to_utf32(const char *src, size_t len, uint32_t *dst, size_t cap);
+UtfResult utf16le_to_utf8(const uint16_t *src, size_t len, char *dst, size_t cap);
+UtfResult utf32_to_utf8(const uint32_t *src, size_t len, char *dst, size_t cap);
+
+// ============================================================================
+// Streaming UTF-8 decoding
+// ============================================================================
+
+// A sequence cut off at the end of one chunk is kept here and completed
+// by the next one
+typedef struct
+{
+    unsigned char pending[4];
+    unsigned npending;
+} Utf8Stream;
+
+void utf8_stream_init(Utf8Stream *s);
+
+// Decode one chunk. An incomplete sequence at the end is consumed into
+// the stream instead of reported as EINVAL. On E2BIG, call again with
+// src + read.
+UtfResult utf8_stream_to_utf16le(Utf8Stream *s, const char *src, size_t len, uint16_t *dst, size_t cap);
+UtfResult utf8_stream_to_utf32(Utf8Stream *s, const char *src, size_t len, uint32_t *dst, size_t cap);
+
+// After the last chunk: false if the input ended inside a sequence
+bool utf8_stream_complete(const Utf8Stream *s);
+
+// ============================================================================
+// Dispatch control (same levels as strsimd.h)
+// ============================================================================
+
+StrSimdLevel utf8conv_level(void);
+StrSimdLevel utf8conv_set_level(StrSimdLevel level); // clamps to what is supported
+
+#endif /* STRKIT_UTF8CONV_H */
@@ -0,0 +1,213 @@
+/*
+ * String Kit - utf8conv_bench.c
+ *
+ * UTF-8 decoding throughput (GB/s of input) on four kinds of text:
+ *
+ *   ascii   English prose, all single bytes
+ *   latin   mostly ASCII with accented letters (2-byte sequences)
+ *   cjk     Chinese with ASCII punctuation (mostly 3-byte sequences)
+ *   emoji   4-byte sequences between short ASCII words
+ *
+ * against the per-character routes of ch07/misc: iconv() to UTF-16LE and
+ * mbstowcs() to wchar_t (UTF-32 on Linux) in a UTF-8 locale. Every
+ * utf8conv result is checked against iconv() or mbstowcs().
+ *
+ * Usage: ./utf8conv_bench [MiB_per_corpus]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <iconv.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include "utf8conv.h"
+
+#define ROUNDS 3
+
+static const char *ascii_words[] = {"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog. ", "\n"};
+static const char *latin_words[] = {"Grüße ", "aus ", "Köln ", "und ", "Zürich, ", "voilà ", "très ", "déjà ",
+                                    "niño ", "mañana. "};
+static const char *cjk_words[] = {"世界", "你好", "中文", "字符", "编码", "，", "。", "转换", "\n"};
+static const char *emoji_words[] = {"😀 ", "ok ", "🚀", "👍 ", "so ", "🎉🎉 ", "C ", "♥ "};
+
+typedef struct
+{
+    const char *name;
+    const char **words;
+    size_t nwords;
+} Corpus;
+
+static const Corpus corpora[] = {
+    {"ascii", ascii_words, sizeof(ascii_words) / sizeof(ascii_words[0])},
+    {"latin", latin_words, sizeof(latin_words) / sizeof(latin_words[0])},
+    {"cjk", cjk_words, sizeof(cjk_words) / sizeof(cjk_words[0])},
+    {"emoji", emoji_words, sizeof(emoji_words) / sizeof(emoji_words[0])},
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t fill(char *buf, size_t cap, const Corpus *c)
+{
+    unsigned seed = 2024;
+    size_t len = 0;
+    for (;;)
+    {
+        seed = seed * 1103515245u + 12345u;
+        const char *w = c->words[(seed >> 16) % c->nwords];
+        size_t n = strlen(w);
+        if (len + n > cap)
+        {
+            return len;
+        }
+        memcpy(buf + len, w, n);
+        len += n;
+    }
+}
+
+static size_t run_iconv(iconv_t cd, const char *src, size_t len, uint16_t *dst, size_t cap)
+{
+    char *in = (char *)src;
+    char *out = (char *)dst;
+    size_t out_left = cap * sizeof(uint16_t);
+    iconv(cd, NULL, NULL, NULL, NULL);
+    if (iconv(cd, &in, &len, &out, &out_left) == (size_t)-1)
+    {
+        return 0;
+    }
+    return (cap * sizeof(uint16_t) - out_left) / sizeof(uint16_t);
+}
+
+static void print_rate(const char *method, double bytes, double best)
+{
+    printf("  %-22s %8.2f\n", method, best > 0 ? bytes / best / 1e9 : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    if (mib == 0)
+    {
+        fprintf(stderr, "Usage: %s [MiB_per_corpus]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t cap = mib << 20;
+
+    char *text = malloc(cap + 1); // room for mbstowcs()'s terminator
+    uint16_t *u16 = malloc(cap * sizeof(uint16_t));
+    uint16_t *ref16 = malloc(cap * sizeof(uint16_t));
+    uint32_t *u32 = malloc(cap * sizeof(uint32_t));
+    wchar_t *wide = malloc((cap + 1) * sizeof(wchar_t));
+    if (!text || !u16 || !ref16 || !u32 || !wide)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    iconv_t cd = iconv_open("UTF-16LE", "UTF-8");
+    const char *locale = setlocale(LC_CTYPE, "C.UTF-8");
+    if (locale == NULL)
+    {
+        locale = setlocale(LC_CTYPE, "en_US.UTF-8");
+    }
+
+    printf("=== UTF-8 Decoding Benchmark ===\n\n");
+    printf("%zu MiB per corpus, best of %d, GB/s of UTF-8 input\n", mib, ROUNDS);
+    printf("mbstowcs() locale: %s\n\n", locale ? locale : "none (skipped)");
+
+    StrSimdLevel best_level = strsimd_detect();
+    bool all_ok = cd != (iconv_t)-1;
+
+    for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++)
+    {
+        size_t len = fill(text, cap, &corpora[c]);
+        text[len] = '\0';
+        double bytes = (double)len;
+        printf("Corpus %s\n", corpora[c].name);
+
+        size_t n_ref = 0;
+        double best = 0;
+        for (int r = 0; r < ROUNDS && cd != (iconv_t)-1; r++)
+        {
+            double t0 = now_seconds();
+            n_ref = run_iconv(cd, text, len, ref16, cap);
+            double t = now_seconds() - t0;
+            best = (r == 0 || t < best) ? t : best;
+        }
+        print_rate("iconv() UTF-16LE", bytes, best);
+
+        size_t n_wide = 0;
+        if (locale != NULL)
+        {
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                n_wide = mbstowcs(wide, text, cap + 1);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            print_rate("mbstowcs() wchar_t", bytes, best);
+        }
+
+        for (int level = STRSIMD_SCALAR; level <= (int)best_level; level++)
+        {
+            utf8conv_set_level((StrSimdLevel)level);
+            char label[40];
+
+            UtfResult res = {0, 0, 0};
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                res = utf8_to_utf16le(text, len, u16, cap);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            snprintf(label, sizeof(label), "utf8_to_utf16le %s", strsimd_level_name((StrSimdLevel)level));
+            print_rate(label, bytes, best);
+            all_ok = all_ok && res.error == 0 && res.written == n_ref &&
+                     memcmp(u16, ref16, n_ref * sizeof(uint16_t)) == 0;
+
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                res = utf8_to_utf32(text, len, u32, cap);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            snprintf(label, sizeof(label), "utf8_to_utf32 %s", strsimd_level_name((StrSimdLevel)level));
+            print_rate(label, bytes, best);
+            if (locale != NULL && sizeof(wchar_t) == sizeof(uint32_t))
+            {
+                bool same = res.error == 0 && res.written == n_wide;
+                for (size_t i = 0; same && i < n_wide; i++)
+                {
+                    same = u32[i] == (uint32_t)wide[i];
+                }
+                all_ok = all_ok && same;
+            }
+        }
+        printf("\n");
+    }
+    utf8conv_set_level(best_level);
+
+    printf("%s Every conversion matched iconv() and mbstowcs()\n", all_ok ? "✓" : "✗");
+
+    if (cd != (iconv_t)-1)
+    {
+        iconv_close(cd);
+    }
+    free(text);
+    free(u16);
+    free(ref16);
+    free(u32);
+    free(wide);
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,350 @@
+/*
+ * String Kit - utf8conv_main.c
+ *
+ * Demonstrates the UTF-8 transcoder on the strings of
+ * ch07/misc/utf16_conversion.c and ch07/misc/libiconv_example.c, checks
+ * it against iconv(), and shows error reporting and chunked decoding.
+ * utf8conv_bench measures throughput.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <iconv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utf8conv.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// Reference conversion with iconv(); returns output bytes or -1
+static long iconv_convert(const char *to, const char *from, const void *src, size_t len, void *dst, size_t cap)
+{
+    iconv_t cd = iconv_open(to, from);
+    if (cd == (iconv_t)-1)
+    {
+        return -1;
+    }
+    char *in = (char *)src;
+    char *out = dst;
+    size_t left = cap;
+    size_t rc = iconv(cd, &in, &len, &out, &left);
+    iconv_close(cd);
+    return rc == (size_t)-1 ? -1 : (long)(cap - left);
+}
+
+static const char *error_name(int error)
+{
+    switch (error)
+    {
+    case 0:
+        return "ok";
+    case EILSEQ:
+        return "EILSEQ";
+    case EINVAL:
+        return "EINVAL";
+    case E2BIG:
+        return "E2BIG";
+    default:
+        return "?";
+    }
+}
+
+// Text mixing all four sequence lengths, with ASCII runs long enough for
+// the vector kernels
+static size_t make_mixed(char *buf, size_t cap, unsigned seed)
+{
+    static const char *pieces[] = {"a", "plain ASCII words, long enough for a vector block ", "é", "ü", "€",
+                                   "♥", "中文", "😀", "🚀", "\n"};
+    size_t len = 0;
+    for (;;)
+    {
+        seed = seed * 1103515245u + 12345u;
+        const char *p = pieces[(seed >> 16) % (sizeof(pieces) / sizeof(pieces[0]))];
+        size_t n = strlen(p);
+        if (len + n > cap)
+        {
+            return len;
+        }
+        memcpy(buf + len, p, n);
+        len += n;
+    }
+}
+
+static bool same_result(UtfResult a, UtfResult b)
+{
+    return a.read == b.read && a.written == b.written && a.error == b.error;
+}
+
+// Decode noise to the end, skipping a byte after each error; returns a
+// checksum of where the errors were and what was produced
+static unsigned long scan_noise(const char *noise, size_t len, uint32_t *out, size_t cap)
+{
+    unsigned long sum = 0;
+    size_t pos = 0;
+    while (pos < len)
+    {
+        UtfResult r = utf8_to_utf32(noise + pos, len - pos, out, cap);
+        for (size_t i = 0; i < r.written; i++)
+        {
+            sum = sum * 31 + out[i];
+        }
+        pos += r.read;
+        sum = sum * 31 + pos * 7 + (unsigned long)r.error;
+        pos += r.error != 0;
+    }
+    return sum;
+}
+
+int main(void)
+{
+    printf("=== UTF-8 Transcoder ===\n\n");
+    printf("Dispatch level: %s\n\n", strsimd_level_name(utf8conv_level()));
+
+    // Test 1: The strings of the chapter's examples
+    printf("Test 1: UTF-8 to UTF-16LE and UTF-32 against iconv()\n");
+    {
+        const char *texts[] = {"I ♥ C!", "Hello, World! ♥", "Grüße, 世界 😀"};
+        for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++)
+        {
+            const char *s = texts[t];
+            size_t len = strlen(s);
+            uint16_t u16[64];
+            uint32_t u32[64];
+            uint16_t ref16[64];
+            uint32_t ref32[64];
+            UtfResult r16 = utf8_to_utf16le(s, len, u16, 64);
+            UtfResult r32 = utf8_to_utf32(s, len, u32, 64);
+            long n16 = iconv_convert("UTF-16LE", "UTF-8", s, len, ref16, sizeof(ref16));
+            long n32 = iconv_convert("UTF-32LE", "UTF-8", s, len, ref32, sizeof(ref32));
+
+            printf("  \"%s\": %zu bytes -> %zu UTF-16 units, %zu code points\n", s, len, r16.written, r32.written);
+            printf("   ");
+            for (size_t i = 0; i < r16.written; i++)
+            {
+                printf(" %04X", u16[i]);
+            }
+            printf("\n");
+            check(r16.error == 0 && r32.error == 0 && r16.read == len && n16 == (long)(r16.written * 2) &&
+                      n32 == (long)(r32.written * 4) && memcmp(u16, ref16, (size_t)n16) == 0 &&
+                      memcmp(u32, ref32, (size_t)n32) == 0,
+                  "same units as iconv()");
+        }
+    }
+    printf("\n");
+
+    // Test 2: Malformed input
+    printf("Test 2: Malformed input is reported, not converted\n");
+    {
+        static const struct
+        {
+            const char *what;
+            const char *bytes;
+            size_t read;
+            int error;
+        } cases[] = {
+            {"stray continuation", "ab\x80", 2, EILSEQ},
+            {"overlong '/' (C0 AF)", "\xC0\xAF", 0, EILSEQ},
+            {"overlong 3-byte (E0 80 AF)", "x\xE0\x80\xAF", 1, EILSEQ},
+            {"surrogate U+D800 (ED A0 80)", "\xED\xA0\x80", 0, EILSEQ},
+            {"above U+10FFFF (F4 90 80 80)", "\xF4\x90\x80\x80", 0, EILSEQ},
+            {"F5 lead byte", "\xF5\x80\x80\x80", 0, EILSEQ},
+            {"missing continuation", "\xE2\x99" "A", 0, EILSEQ},
+            {"truncated at end (E2 99)", "ok\xE2\x99", 2, EINVAL},
+            {"truncated 4-byte (F0 9F 98)", "\xF0\x9F\x98", 0, EINVAL},
+        };
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        {
+            uint16_t out[16];
+            UtfResult r = utf8_to_utf16le(cases[i].bytes, strlen(cases[i].bytes), out, 16);
+            char line[96];
+            snprintf(line, sizeof(line), "%-30s %s at %zu", cases[i].what, error_name(r.error), r.read);
+            check(r.error == cases[i].error && r.read == cases[i].read && r.written == r.read, line);
+        }
+
+        uint16_t bad16[] = {'a', 0xDC00, 'b'};
+        uint16_t cut16[] = {'a', 0xD83D};
+        uint32_t bad32[] = {'a', 0x110000};
+        uint32_t sur32[] = {0xD800};
+        char out[16];
+        UtfResult a = utf16le_to_utf8(bad16, 3, out, 16);
+        UtfResult b = utf16le_to_utf8(cut16, 2, out, 16);
+        UtfResult c = utf32_to_utf8(bad32, 2, out, 16);
+        UtfResult d = utf32_to_utf8(sur32, 1, out, 16);
+        check(a.error == EILSEQ && a.read == 1 && b.error == EINVAL && b.read == 1, "UTF-16: lone low surrogate EILSEQ, "
+                                                                                    "cut pair EINVAL");
+        check(c.error == EILSEQ && c.read == 1 && d.error == EILSEQ && d.read == 0,
+              "UTF-32: 0x110000 and U+D800 EILSEQ");
+    }
+    printf("\n");
+
+    // Test 3: Output buffer too small
+    printf("Test 3: E2BIG and continuing where it stopped\n");
+    {
+        const char *s = "ab😀cd";
+        size_t len = strlen(s);
+        uint16_t out[8];
+        UtfResult r = utf8_to_utf16le(s, len, out, 3);
+        printf("  Capacity 3: %s after %zu bytes, %zu units\n", error_name(r.error), r.read, r.written);
+        check(r.error == E2BIG && r.read == 2 && r.written == 2, "surrogate pair not split across calls");
+        UtfResult rest = utf8_to_utf16le(s + r.read, len - r.read, out + r.written, 8 - r.written);
+        check(rest.error == 0 && r.written + rest.written == 6 && out[2] == 0xD83D && out[3] == 0xDE00,
+              "second call finishes the string");
+    }
+    printf("\n");
+
+    // Test 4: Chunked input
+    printf("Test 4: Utf8Stream with the input cut at every offset\n");
+    {
+        char text[600];
+        size_t len = make_mixed(text, sizeof(text), 7);
+        uint32_t whole[600];
+        uint32_t pieces[600];
+        UtfResult ref = utf8_to_utf32(text, len, whole, 600);
+
+        bool ok = ref.error == 0;
+        for (size_t cut = 0; cut <= len && ok; cut++)
+        {
+            // Three chunks: [0, cut), [cut, cut + 1), the rest
+            size_t bounds[4] = {0, cut, cut + 1 < len ? cut + 1 : len, len};
+            Utf8Stream st;
+            utf8_stream_init(&st);
+            size_t n = 0;
+            for (int k = 0; k < 3 && ok; k++)
+            {
+                UtfResult r = utf8_stream_to_utf32(&st, text + bounds[k], bounds[k + 1] - bounds[k], pieces + n,
+                                                   600 - n);
+                ok = r.error == 0 && r.read == bounds[k + 1] - bounds[k];
+                n += r.written;
+            }
+            ok = ok && utf8_stream_complete(&st) && n == ref.written &&
+                 memcmp(pieces, whole, n * sizeof(uint32_t)) == 0;
+        }
+        printf("  %zu bytes, %zu code points, %zu cut positions\n", len, ref.written, len + 1);
+        check(ok, "same code points as one call");
+
+        // One byte at a time into UTF-16
+        Utf8Stream st;
+        utf8_stream_init(&st);
+        uint16_t u16[600];
+        uint16_t ref16[600];
+        UtfResult r16 = utf8_to_utf16le(text, len, ref16, 600);
+        size_t n = 0;
+        for (size_t i = 0; i < len && ok; i++)
+        {
+            UtfResult r = utf8_stream_to_utf16le(&st, text + i, 1, u16 + n, 600 - n);
+            ok = r.error == 0 && r.read == 1;
+            n += r.written;
+        }
+        check(ok && n == r16.written && memcmp(u16, ref16, n * 2) == 0, "byte-at-a-time UTF-16 matches");
+
+        const char cut[] = "end\xE2\x99";
+        utf8_stream_init(&st);
+        UtfResult r = utf8_stream_to_utf16le(&st, cut, sizeof(cut) - 1, u16, 600);
+        check(r.error == 0 && r.read == 5 && r.written == 3 && !utf8_stream_complete(&st),
+              "input ending inside a sequence is detected");
+    }
+    printf("\n");
+
+    // Test 5: Round trips and agreement between levels
+    printf("Test 5: Round trips at every dispatch level\n");
+    {
+        enum
+        {
+            SIZE = 4096
+        };
+        char *text = malloc(SIZE);
+        char *back = malloc(SIZE * 4);
+        uint16_t *u16 = malloc(SIZE * sizeof(uint16_t));
+        uint32_t *u32 = malloc(SIZE * sizeof(uint32_t));
+        char *noise = malloc(SIZE);
+        if (!text || !back || !u16 || !u32 || !noise)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        size_t len = make_mixed(text, SIZE, 99);
+
+        // Mostly ASCII with rare random high bytes, so errors land
+        // anywhere inside and around vector blocks
+        unsigned seed = 1;
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            unsigned r = (seed >> 16) & 0xFF;
+            noise[i] = (char)(r < 250 ? 'a' + r % 26 : r);
+        }
+
+        StrSimdLevel best = strsimd_detect();
+        UtfResult first[2];
+        unsigned long first_scan = 0;
+        for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+        {
+            utf8conv_set_level((StrSimdLevel)level);
+            bool ok = true;
+            for (size_t off = 0; off < 40 && ok; off++)
+            {
+                UtfResult a = utf8_to_utf16le(text + off, len - off, u16, SIZE);
+                // Skip to a sequence boundary first
+                if (a.error == EILSEQ)
+                {
+                    continue;
+                }
+                UtfResult b = utf16le_to_utf8(u16, a.written, back, SIZE * 4);
+                UtfResult c = utf8_to_utf32(text + off, len - off, u32, SIZE);
+                UtfResult d = utf32_to_utf8(u32, c.written, back + SIZE * 2, SIZE * 2);
+                ok = a.error == 0 && b.error == 0 && c.error == 0 && d.error == 0 && b.written == len - off &&
+                     d.written == len - off && memcmp(back, text + off, b.written) == 0 &&
+                     memcmp(back + SIZE * 2, text + off, d.written) == 0;
+            }
+
+            UtfResult res[2];
+            res[0] = utf8_to_utf16le(noise, SIZE, u16, SIZE);
+            res[1] = utf8_to_utf16le(text, len, u16, 1000); // stops with E2BIG
+            unsigned long scan = scan_noise(noise, SIZE, u32, SIZE);
+            if (level == STRSIMD_SCALAR)
+            {
+                memcpy(first, res, sizeof(first));
+                first_scan = scan;
+            }
+            bool agree = same_result(res[0], first[0]) && same_result(res[1], first[1]) && scan == first_scan &&
+                         res[1].error == E2BIG;
+
+            char line[96];
+            snprintf(line, sizeof(line), "%-6s round trips exact, errors at the same offsets",
+                     strsimd_level_name((StrSimdLevel)level));
+            check(ok && agree, line);
+        }
+        utf8conv_set_level(best);
+
+        free(text);
+        free(back);
+        free(u16);
+        free(u32);
+        free(noise);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. No locale and no iconv_t: UTF-8 is decoded directly\n");
+    printf("2. ASCII runs are converted 16 (SSE2) or 32 (AVX2) bytes per step\n");
+    printf("3. Overlong forms, surrogates and values above U+10FFFF are rejected\n");
+    printf("4. Errors follow iconv(): EILSEQ, EINVAL and E2BIG with a resume offset\n");
+    printf("5. Utf8Stream carries a sequence split between chunks\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,505 @@
+/*
+ * String Kit - utf8valid.c
+ *
+ * Implementation of UTF-8 validation and counting.
+ *
+ * Both vector algorithms look at each byte together with the one to three
+ * bytes before it, taking those from the previous block where needed, so
+ * no sequence is missed at a block boundary. The last partial block is
+ * copied into a zero-filled block: the zeros are ASCII, so a sequence cut
+ * off at the end of the input shows up as a missing continuation byte.
+ */
+
+#include "utf8valid.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UV_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UV_HAVE_SWAR 1
+#endif
+
+typedef struct
+{
+    bool (*validate)(const unsigned char *s, size_t len);
+    size_t (*count)(const unsigned char *s, size_t len);
+} ValidOps;
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+// Length of the well-formed sequence at s (s[0] >= 0x80), or 0
+static size_t sequence_length(const unsigned char *s, size_t avail)
+{
+    unsigned c = s[0];
+    size_t need;
+    unsigned lo = 0x80;
+    unsigned hi = 0xBF;
+
+    if (c < 0xC2)
+    {
+        return 0;
+    }
+    if (c < 0xE0)
+    {
+        need = 2;
+    }
+    else if (c < 0xF0)
+    {
+        need = 3;
+        lo = c == 0xE0 ? 0xA0 : 0x80;
+        hi = c == 0xED ? 0x9F : 0xBF;
+    }
+    else if (c < 0xF5)
+    {
+        need = 4;
+        lo = c == 0xF0 ? 0x90 : 0x80;
+        hi = c == 0xF4 ? 0x8F : 0xBF;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (avail < need || s[1] < lo || s[1] > hi)
+    {
+        return 0;
+    }
+    for (size_t k = 2; k < need; k++)
+    {
+        if ((s[k] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    return need;
+}
+
+static bool validate_scalar(const unsigned char *s, size_t len)
+{
+    size_t i = 0;
+    while (i < len)
+    {
+        if (s[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+        size_t n = sequence_length(s + i, len - i);
+        if (n == 0)
+        {
+            return false;
+        }
+        i += n;
+    }
+    return true;
+}
+
+static size_t count_scalar(const unsigned char *s, size_t len)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        n += (s[i] & 0xC0) != 0x80;
+    }
+    return n;
+}
+
+static const ValidOps scalar_ops = {validate_scalar, count_scalar};
+
+// ============================================================================
+// SWAR
+// ============================================================================
+
+#ifdef UV_HAVE_SWAR
+
+#define HIGH_BITS 0x8080808080808080ULL
+
+static bool validate_swar(const unsigned char *s, size_t len)
+{
+    size_t i = 0;
+    while (i < len)
+    {
+        uint64_t w;
+        if (i + 8 <= len && (memcpy(&w, s + i, 8), (w & HIGH_BITS) == 0))
+        {
+            i += 8;
+            continue;
+        }
+        if (s[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+        size_t n = sequence_length(s + i, len - i);
+        if (n == 0)
+        {
+            return false;
+        }
+        i += n;
+    }
+    return true;
+}
+
+// A continuation byte is 10xxxxxx: bit 7 set, bit 6 clear
+static size_t count_swar(const unsigned char *s, size_t len)
+{
+    size_t conts = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, s + i, 8);
+        conts += (size_t)__builtin_popcountll(w & ~(w << 1) & HIGH_BITS);
+    }
+    return i - conts + count_scalar(s + i, len - i);
+}
+
+static const ValidOps swar_ops = {validate_swar, count_swar};
+
+#endif /* UV_HAVE_SWAR */
+
+#ifdef UV_X86
+
+#define INLINE static inline __attribute__((always_inline))
+#define AVX2 __attribute__((target("avx2")))
+
+// ============================================================================
+// SSE2: range checks
+// ============================================================================
+
+// 0xFF where v >= c / v <= c (unsigned)
+INLINE __m128i ge16(__m128i v, int c)
+{
+    return _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8((char)c)), v);
+}
+
+INLINE __m128i le16(__m128i v, int c)
+{
+    return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8((char)c)), v);
+}
+
+INLINE __m128i eq16(__m128i v, int c)
+{
+    return _mm_cmpeq_epi8(v, _mm_set1_epi8((char)c));
+}
+
+// The block shifted n bytes later, with the end of prev shifted in
+#define PREV16(in, prev, n) _mm_or_si128(_mm_slli_si128((in), (n)), _mm_srli_si128((prev), 16 - (n)))
+
+// Error lanes for one block
+INLINE __m128i check16(__m128i in, __m128i prev)
+{
+    __m128i prev1 = PREV16(in, prev, 1);
+    __m128i prev2 = PREV16(in, prev, 2);
+    __m128i prev3 = PREV16(in, prev, 3);
+
+    // C0, C1 and F5..FF never appear
+    __m128i err = _mm_or_si128(_mm_or_si128(eq16(in, 0xC0), eq16(in, 0xC1)), ge16(in, 0xF5));
+
+    // Continuation bytes exactly where a lead byte 1 to 3 bytes back
+    // asks for them
+    __m128i must = _mm_or_si128(ge16(prev1, 0xC0), _mm_or_si128(ge16(prev2, 0xE0), ge16(prev3, 0xF0)));
+    __m128i cont = eq16(_mm_and_si128(in, _mm_set1_epi8((char)0xC0)), 0x80);
+    err = _mm_or_si128(err, _mm_xor_si128(must, cont));
+
+    // Lead bytes with a narrower second byte range: overlongs (E0, F0),
+    // surrogates (ED) and above U+10FFFF (F4)
+    err = _mm_or_si128(err, _mm_and_si128(eq16(prev1, 0xE0), le16(in, 0x9F)));
+    err = _mm_or_si128(err, _mm_and_si128(eq16(prev1, 0xED), ge16(in, 0xA0)));
+    err = _mm_or_si128(err, _mm_and_si128(eq16(prev1, 0xF0), le16(in, 0x8F)));
+    err = _mm_or_si128(err, _mm_and_si128(eq16(prev1, 0xF4), ge16(in, 0x90)));
+    return err;
+}
+
+static bool validate_sse2(const unsigned char *s, size_t len)
+{
+    __m128i prev = _mm_setzero_si128();
+    __m128i err = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+        // An ASCII block after an ASCII block cannot be wrong
+        if (_mm_movemask_epi8(_mm_or_si128(in, prev)) == 0)
+        {
+            prev = in;
+            continue;
+        }
+        err = _mm_or_si128(err, check16(in, prev));
+        if (_mm_movemask_epi8(err) != 0)
+        {
+            return false;
+        }
+        prev = in;
+    }
+
+    unsigned char tail[16] = {0};
+    memcpy(tail, s + i, len - i);
+    err = _mm_or_si128(err, check16(_mm_loadu_si128((const __m128i *)tail), prev));
+    return _mm_movemask_epi8(err) == 0;
+}
+
+// Sum the byte counters into 64-bit lanes before they can wrap
+static size_t count_sse2(const unsigned char *s, size_t len)
+{
+    const __m128i not_cont = _mm_set1_epi8(-65); // signed > -65: not 0x80..0xBF
+    __m128i total = _mm_setzero_si128();
+    size_t i = 0;
+    while (i + 16 <= len)
+    {
+        __m128i acc = _mm_setzero_si128();
+        for (int k = 0; k < 255 && i + 16 <= len; k++, i += 16)
+        {
+            __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(in, not_cont));
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(acc, _mm_setzero_si128()));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, total);
+    return (size_t)(lanes[0] + lanes[1]) + count_scalar(s + i, len - i);
+}
+
+static const ValidOps sse2_ops = {validate_sse2, count_sse2};
+
+// ============================================================================
+// AVX2: nibble lookup tables
+// ============================================================================
+
+// Each table maps a nibble to the set of errors it is compatible with; a
+// byte pair is invalid when all three lookups share an error bit. Bit 6
+// serves both for F0 80..8F (overlong) and F5+ 80..8F (too large).
+#define TOO_SHORT 0x01  // lead or ASCII, then lead or ASCII, where a
+                        // continuation was needed
+#define TOO_LONG 0x02   // ASCII, then continuation
+#define OVERLONG_3 0x04 // E0 80..9F
+#define TOO_LARGE 0x08  // F4 90..BF, F5..FF 90..BF
+#define SURROGATE 0x10  // ED A0..BF
+#define OVERLONG_2 0x20 // C0..C1, then continuation
+#define TOO_LARGE_1000 0x40
+#define OVERLONG_4 0x40
+#define TWO_CONTS 0x80 // continuation, then continuation
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// High nibble of the first byte of the pair
+static const uint8_t byte1_high[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// Low nibble of the first byte
+static const uint8_t byte1_low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// High nibble of the second byte
+static const uint8_t byte2_high[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+typedef struct
+{
+    __m256i b1_high;
+    __m256i b1_low;
+    __m256i b2_high;
+    __m256i max_end; // a lead byte at most this far from the end is cut off
+} Tables32;
+
+#define PREV32(in, prev, n) _mm256_alignr_epi8((in), _mm256_permute2x128_si256((prev), (in), 0x21), 16 - (n))
+
+AVX2 INLINE __m256i lookup32(__m256i table, __m256i nibbles)
+{
+    return _mm256_shuffle_epi8(table, nibbles);
+}
+
+AVX2 INLINE __m256i high_nibbles32(__m256i v)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+// Error bits for one block
+AVX2 INLINE __m256i check32(const Tables32 *t, __m256i in, __m256i prev)
+{
+    __m256i prev1 = PREV32(in, prev, 1);
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(lookup32(t->b1_high, high_nibbles32(prev1)),
+                         lookup32(t->b1_low, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+        lookup32(t->b2_high, high_nibbles32(in)));
+
+    // TWO_CONTS is expected in the third and fourth bytes of a sequence:
+    // cancel it there, and flag it where it is missing
+    __m256i third = _mm256_subs_epu8(PREV32(in, prev, 2), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(PREV32(in, prev, 3), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(special, must23);
+}
+
+AVX2 static bool validate_avx2(const unsigned char *s, size_t len)
+{
+    static const uint8_t max_end[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+    };
+    Tables32 t;
+    t.b1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte1_high));
+    t.b1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte1_low));
+    t.b2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte2_high));
+    t.max_end = _mm256_loadu_si256((const __m256i *)max_end);
+
+    __m256i prev = _mm256_setzero_si256();
+    __m256i err = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256(); // prev ends inside a sequence
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(s + i));
+        if (_mm256_movemask_epi8(in) == 0)
+        {
+            err = _mm256_or_si256(err, incomplete);
+            incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            err = _mm256_or_si256(err, check32(&t, in, prev));
+            incomplete = _mm256_subs_epu8(in, t.max_end);
+        }
+        if (!_mm256_testz_si256(err, err))
+        {
+            return false;
+        }
+        prev = in;
+    }
+
+    // The zero padding catches a sequence cut off by the end of the input
+    unsigned char tail[32] = {0};
+    memcpy(tail, s + i, len - i);
+    err = _mm256_or_si256(err, check32(&t, _mm256_loadu_si256((const __m256i *)tail), prev));
+    return _mm256_testz_si256(err, err);
+}
+
+AVX2 static size_t count_avx2(const unsigned char *s, size_t len)
+{
+    const __m256i not_cont = _mm256_set1_epi8(-65);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 32 <= len)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for (int k = 0; k < 255 && i + 32 <= len; k++, i += 32)
+        {
+            __m256i in = _mm256_loadu_si256((const __m256i *)(s + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(in, not_cont));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    _mm256_zeroupper(); // count_sse2() is legacy SSE code
+    return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + count_sse2(s + i, len - i);
+}
+
+static const ValidOps avx2_ops = {validate_avx2, count_avx2};
+
+#endif /* UV_X86 */
+
+// ============================================================================
+// Runtime dispatch
+// ============================================================================
+
+// Chosen on first use, or by utf8valid_set_level(). Atomic because the
+// first calls may come from several threads at once.
+static _Atomic(const ValidOps *) active_ops = NULL;
+static _Atomic StrSimdLevel active_level = STRSIMD_SCALAR;
+
+StrSimdLevel utf8valid_set_level(StrSimdLevel level)
+{
+    StrSimdLevel best = strsimd_detect();
+    if (level > best)
+    {
+        level = best;
+    }
+
+    const ValidOps *chosen;
+    switch (level)
+    {
+#ifdef UV_X86
+    case STRSIMD_AVX2:
+        chosen = &avx2_ops;
+        break;
+    case STRSIMD_SSE2:
+        chosen = &sse2_ops;
+        break;
+#endif
+#ifdef UV_HAVE_SWAR
+    case STRSIMD_SWAR:
+        chosen = &swar_ops;
+        break;
+#endif
+    default:
+        level = STRSIMD_SCALAR;
+        chosen = &scalar_ops;
+        break;
+    }
+
+    atomic_store_explicit(&active_level, level, memory_order_relaxed);
+    atomic_store_explicit(&active_ops, chosen, memory_order_release);
+    return level;
+}
+
+static const ValidOps *ops(void)
+{
+    const ValidOps *o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    if (o == NULL)
+    {
+        utf8valid_set_level(strsimd_detect());
+        o = atomic_load_explicit(&active_ops, memory_order_acquire);
+    }
+    return o;
+}
+
+StrSimdLevel utf8valid_level(void)
+{
+    ops();
+    return atomic_load_explicit(&active_level, memory_order_relaxed);
+}
+
+bool utf8_validate(const char *buf, size_t len)
+{
+    return ops()->validate((const unsigned char *)buf, len);
+}
+
+size_t utf8_count_codepoints(const char *buf, size_t len)
+{
+    return ops()->count((const unsigned char *)buf, len);
+}
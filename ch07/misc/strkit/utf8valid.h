@@ -0,0 +1,40 @@
+/*
+ * String Kit - utf8valid.h
+ *
+ * Standalone UTF-8 validation and code point counting.
+ *
+ * ch07/misc/utf16_conversion.c and ch07/misc/libiconv_example.c find out
+ * that their input is not UTF-8 only when mbstowcs() or iconv() fails
+ * partway through, after the output has been allocated. utf8_validate()
+ * answers the question up front, at several GB/s:
+ *
+ *   AVX2   lookup-table algorithm: three vpshufb nibble lookups classify
+ *          every pair of adjacent bytes, 32 bytes per step
+ *   SSE2   range algorithm: unsigned compares against the lead and second
+ *          byte ranges, 16 bytes per step (SSE2 has no byte shuffle)
+ *   SWAR   skips ASCII 8 bytes at a time, scalar otherwise
+ *
+ * Valid means well-formed as defined by the Unicode standard: no
+ * overlong forms, no surrogates (U+D800 to U+DFFF), nothing above
+ * U+10FFFF and no sequence cut off at the end. utf8conv.h accepts exactly
+ * the same inputs.
+ */
+
+#ifndef STRKIT_UTF8VALID_H
+#define STRKIT_UTF8VALID_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "strsimd.h"
+
+bool utf8_validate(const char *buf, size_t len);
+
+// Number of code points in valid UTF-8 (bytes that are not continuation
+// bytes). Invalid input gives a meaningless count; validate first.
+size_t utf8_count_codepoints(const char *buf, size_t len);
+
+// Dispatch control (same levels as strsimd.h)
+StrSimdLevel utf8valid_level(void);
+StrSimdLevel utf8valid_set_level(StrSimdLevel level); // clamps to what is supported
+
+#endif /* STRKIT_UTF8VALID_H */
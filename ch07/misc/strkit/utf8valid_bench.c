@@ -0,0 +1,202 @@
+/*
+ * String Kit - utf8valid_bench.c
+ *
+ * UTF-8 validation throughput (GB/s) on ASCII, Latin, CJK and emoji text,
+ * against the ways ch07/misc can find out today:
+ *
+ *   mbstowcs(NULL)  count the wide characters in a UTF-8 locale; fails
+ *                   with (size_t)-1 on invalid input, allocates nothing
+ *   iconv()         convert to UTF-32 and see whether it fails, which
+ *                   needs the output buffer first
+ *
+ * and reports utf8_validate() and utf8_count_codepoints() at each level.
+ *
+ * Usage: ./utf8valid_bench [MiB_per_corpus]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <iconv.h>
+#include <locale.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utf8valid.h"
+
+#define ROUNDS 3
+
+static const char *ascii_words[] = {"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog. ", "\n"};
+static const char *latin_words[] = {"Grüße ", "aus ", "Köln ", "und ", "Zürich, ", "voilà ", "très ", "déjà ",
+                                    "niño ", "mañana. "};
+static const char *cjk_words[] = {"世界", "你好", "中文", "字符", "编码", "，", "。", "转换", "\n"};
+static const char *emoji_words[] = {"😀 ", "ok ", "🚀", "👍 ", "so ", "🎉🎉 ", "C ", "♥ "};
+
+typedef struct
+{
+    const char *name;
+    const char **words;
+    size_t nwords;
+} Corpus;
+
+static const Corpus corpora[] = {
+    {"ascii", ascii_words, sizeof(ascii_words) / sizeof(ascii_words[0])},
+    {"latin", latin_words, sizeof(latin_words) / sizeof(latin_words[0])},
+    {"cjk", cjk_words, sizeof(cjk_words) / sizeof(cjk_words[0])},
+    {"emoji", emoji_words, sizeof(emoji_words) / sizeof(emoji_words[0])},
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t fill(char *buf, size_t cap, const Corpus *c)
+{
+    unsigned seed = 2024;
+    size_t len = 0;
+    for (;;)
+    {
+        seed = seed * 1103515245u + 12345u;
+        const char *w = c->words[(seed >> 16) % c->nwords];
+        size_t n = strlen(w);
+        if (len + n > cap)
+        {
+            return len;
+        }
+        memcpy(buf + len, w, n);
+        len += n;
+    }
+}
+
+static bool iconv_valid(iconv_t cd, const char *src, size_t len, uint32_t *dst, size_t cap)
+{
+    char *in = (char *)src;
+    char *out = (char *)dst;
+    size_t out_left = cap * sizeof(uint32_t);
+    iconv(cd, NULL, NULL, NULL, NULL);
+    return iconv(cd, &in, &len, &out, &out_left) != (size_t)-1;
+}
+
+static void print_rate(const char *method, double bytes, double best)
+{
+    printf("  %-28s %8.2f\n", method, best > 0 ? bytes / best / 1e9 : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    if (mib == 0)
+    {
+        fprintf(stderr, "Usage: %s [MiB_per_corpus]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t cap = mib << 20;
+
+    char *text = malloc(cap + 1);
+    uint32_t *u32 = malloc(cap * sizeof(uint32_t));
+    if (!text || !u32)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    iconv_t cd = iconv_open("UTF-32LE", "UTF-8");
+    const char *locale = setlocale(LC_CTYPE, "C.UTF-8");
+    if (locale == NULL)
+    {
+        locale = setlocale(LC_CTYPE, "en_US.UTF-8");
+    }
+
+    printf("=== UTF-8 Validation Benchmark ===\n\n");
+    printf("%zu MiB per corpus, best of %d, GB/s\n", mib, ROUNDS);
+    printf("mbstowcs() locale: %s\n\n", locale ? locale : "none (skipped)");
+
+    StrSimdLevel best_level = strsimd_detect();
+    bool all_ok = true;
+
+    for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++)
+    {
+        size_t len = fill(text, cap, &corpora[c]);
+        text[len] = '\0';
+        double bytes = (double)len;
+        printf("Corpus %s\n", corpora[c].name);
+
+        double best = 0;
+        size_t n_wide = 0;
+        if (locale != NULL)
+        {
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                n_wide = mbstowcs(NULL, text, 0);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            print_rate("mbstowcs(NULL)", bytes, best);
+        }
+
+        if (cd != (iconv_t)-1)
+        {
+            bool ok = false;
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                ok = iconv_valid(cd, text, len, u32, cap);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            print_rate("iconv() to UTF-32", bytes, best);
+            all_ok = all_ok && ok;
+        }
+
+        for (int level = STRSIMD_SCALAR; level <= (int)best_level; level++)
+        {
+            utf8valid_set_level((StrSimdLevel)level);
+            char label[48];
+
+            bool valid = false;
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                valid = utf8_validate(text, len);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            snprintf(label, sizeof(label), "utf8_validate %s", strsimd_level_name((StrSimdLevel)level));
+            print_rate(label, bytes, best);
+
+            size_t count = 0;
+            for (int r = 0; r < ROUNDS; r++)
+            {
+                double t0 = now_seconds();
+                count = utf8_count_codepoints(text, len);
+                double t = now_seconds() - t0;
+                best = (r == 0 || t < best) ? t : best;
+            }
+            snprintf(label, sizeof(label), "utf8_count_codepoints %s", strsimd_level_name((StrSimdLevel)level));
+            print_rate(label, bytes, best);
+            all_ok = all_ok && valid && (locale == NULL || count == n_wide);
+        }
+
+        // One bad byte near the end: the vector levels stop there
+        text[len - 2] = (char)0xFF;
+        utf8valid_set_level(best_level);
+        all_ok = all_ok && !utf8_validate(text, len);
+        printf("\n");
+    }
+    utf8valid_set_level(best_level);
+
+    printf("%s Every corpus accepted with the same count as mbstowcs(), damage rejected\n", all_ok ? "✓" : "✗");
+
+    if (cd != (iconv_t)-1)
+    {
+        iconv_close(cd);
+    }
+    free(text);
+    free(u32);
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,265 @@
+/*
+ * String Kit - utf8valid_main.c
+ *
+ * Demonstrates validating untrusted UTF-8 before converting it, and checks
+ * every dispatch level against the UTF-8 decoder of utf8conv.h on every
+ * two- and three-byte sequence and on randomly damaged text.
+ * utf8valid_bench measures throughput.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utf8conv.h"
+#include "utf8valid.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// The independent reference: does the transcoder accept it?
+static bool reference_valid(const char *s, size_t len, size_t *codepoints)
+{
+    static uint32_t out[1024];
+    UtfResult r = utf8_to_utf32(s, len, out, sizeof(out) / sizeof(out[0]));
+    *codepoints = r.written;
+    return r.error == 0;
+}
+
+static const char *levels_tested(StrSimdLevel best)
+{
+    static char names[64];
+    names[0] = '\0';
+    for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+    {
+        strcat(names, level > STRSIMD_SCALAR ? ", " : "");
+        strcat(names, strsimd_level_name((StrSimdLevel)level));
+    }
+    return names;
+}
+
+// Every sequence of `width` bytes, inside ASCII text and at an offset that
+// moves it across vector block boundaries, agrees with the reference
+static bool exhaustive(int width, StrSimdLevel best)
+{
+    char buf[80];
+    memset(buf, 'x', sizeof(buf));
+    unsigned long total = 1UL << (8 * width);
+    for (unsigned long v = 0; v < total; v++)
+    {
+        size_t off = 20 + v % 29;
+        for (int k = 0; k < width; k++)
+        {
+            buf[off + (size_t)k] = (char)(v >> (8 * (width - 1 - k)));
+        }
+        size_t ref_count;
+        bool ref = reference_valid(buf, sizeof(buf), &ref_count);
+        for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+        {
+            utf8valid_set_level((StrSimdLevel)level);
+            if (utf8_validate(buf, sizeof(buf)) != ref ||
+                (ref && utf8_count_codepoints(buf, sizeof(buf)) != ref_count))
+            {
+                printf("  Level %s disagrees on %0*lX\n", strsimd_level_name((StrSimdLevel)level), width * 2, v);
+                return false;
+            }
+        }
+        memset(buf + off, 'x', (size_t)width);
+    }
+    return true;
+}
+
+int main(void)
+{
+    printf("=== UTF-8 Validation ===\n\n");
+    StrSimdLevel best = strsimd_detect();
+    printf("Dispatch level: %s\n\n", strsimd_level_name(utf8valid_level()));
+
+    // Test 1: Validate, count, then allocate exactly
+    printf("Test 1: Validating before converting\n");
+    {
+        const char *texts[] = {"I ♥ C!", "Hello, World! ♥", "Grüße, 世界 😀", "bad \xC3\x28 byte"};
+        for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++)
+        {
+            const char *s = texts[t];
+            size_t len = strlen(s);
+            if (!utf8_validate(s, len))
+            {
+                printf("  %zu bytes: rejected before any allocation\n", len);
+                check(t == 3, "invalid input rejected");
+                continue;
+            }
+            size_t n = utf8_count_codepoints(s, len);
+            uint32_t *wide = malloc(n * sizeof(uint32_t));
+            UtfResult r = wide ? utf8_to_utf32(s, len, wide, n) : (UtfResult){0, 0, -1};
+            printf("  \"%s\": %zu bytes, %zu code points\n", s, len, n);
+            check(r.error == 0 && r.written == n, "buffer sized by utf8_count_codepoints() is exact");
+            free(wide);
+        }
+    }
+    printf("\n");
+
+    // Test 2: Each kind of malformation at every level
+    printf("Test 2: Malformed sequences at every level (%s)\n", levels_tested(best));
+    {
+        static const struct
+        {
+            const char *what;
+            const char *bytes;
+            bool at_end; // only invalid as the last bytes of the input
+        } cases[] = {
+            {"stray continuation", "\x80", false},
+            {"overlong 2-byte (C1 BF)", "\xC1\xBF", false},
+            {"overlong 3-byte (E0 9F BF)", "\xE0\x9F\xBF", false},
+            {"overlong 4-byte (F0 8F BF BF)", "\xF0\x8F\xBF\xBF", false},
+            {"surrogate (ED A0 80)", "\xED\xA0\x80", false},
+            {"above U+10FFFF (F4 90 80 80)", "\xF4\x90\x80\x80", false},
+            {"F8 lead byte", "\xF8\x88\x80\x80\x80", false},
+            {"too short (E2 99 then ASCII)", "\xE2\x99 ", false},
+            {"too long (C3 A9 80)", "\xC3\xA9\x80", false},
+            {"cut off at the end (F0 9F 98)", "\xF0\x9F\x98", true},
+        };
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        {
+            bool all_reject = true;
+            // Before, across and after a 16- and 32-byte boundary
+            for (size_t off = 0; off < 70 && all_reject; off += 3)
+            {
+                char buf[128];
+                size_t n = strlen(cases[i].bytes);
+                memset(buf, 'a', sizeof(buf));
+                memcpy(buf + off, cases[i].bytes, n);
+                size_t len = cases[i].at_end ? off + n : sizeof(buf);
+                for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+                {
+                    utf8valid_set_level((StrSimdLevel)level);
+                    all_reject = all_reject && !utf8_validate(buf, len);
+                }
+            }
+            check(all_reject, cases[i].what);
+        }
+        utf8valid_set_level(best);
+        check(utf8_validate("", 0) && utf8_count_codepoints("", 0) == 0, "empty input is valid");
+        check(utf8_validate("\xF4\x8F\xBF\xBF\xED\x9F\xBF\xEF\xBF\xBF", 10), "U+10FFFF, U+D7FF, U+FFFF accepted");
+    }
+    printf("\n");
+
+    // Test 3: Exhaustive agreement with the decoder
+    printf("Test 3: Every 2- and 3-byte sequence, 4-byte range edges, every level\n");
+    {
+        check(exhaustive(2, best), "65536 two-byte sequences agree with utf8conv");
+        check(exhaustive(3, best), "16777216 three-byte sequences agree with utf8conv");
+
+        // Four bytes: every lead from EF to F5 with each continuation byte
+        // at, and just outside, the edges of the ranges
+        static const unsigned char edges[] = {0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0};
+        bool agree = true;
+        size_t tried = 0;
+        for (unsigned lead = 0xEF; lead <= 0xF5; lead++)
+        {
+            for (size_t a = 0; a < 8; a++)
+            {
+                for (size_t b = 0; b < 8; b++)
+                {
+                    for (size_t c = 0; c < 8; c++)
+                    {
+                        char buf[64];
+                        memset(buf, 'x', sizeof(buf));
+                        size_t off = 12 + tried++ % 40;
+                        buf[off] = (char)lead;
+                        buf[off + 1] = (char)edges[a];
+                        buf[off + 2] = (char)edges[b];
+                        buf[off + 3] = (char)edges[c];
+                        size_t ref_count;
+                        bool ref = reference_valid(buf, sizeof(buf), &ref_count);
+                        for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+                        {
+                            utf8valid_set_level((StrSimdLevel)level);
+                            agree = agree && utf8_validate(buf, sizeof(buf)) == ref;
+                        }
+                    }
+                }
+            }
+        }
+        char line[80];
+        snprintf(line, sizeof(line), "%zu four-byte range edges agree with utf8conv", tried);
+        check(agree, line);
+        utf8valid_set_level(best);
+    }
+    printf("\n");
+
+    // Test 4: Damaged text
+    printf("Test 4: Random text with random damage\n");
+    {
+        static const char *pieces[] = {"a", "ASCII words long enough to fill a vector block ", "é", "€", "中",
+                                       "😀", "\U0010FFFF", "\n"};
+        unsigned seed = 42;
+        int agree = 1;
+        int valid = 0;
+        int rounds = 20000;
+        for (int round = 0; round < rounds && agree; round++)
+        {
+            char buf[300];
+            size_t len = 0;
+            size_t target = (size_t)round % 280;
+            while (len < target)
+            {
+                seed = seed * 1103515245u + 12345u;
+                const char *p = pieces[(seed >> 16) % (sizeof(pieces) / sizeof(pieces[0]))];
+                size_t n = strlen(p);
+                if (len + n > sizeof(buf))
+                {
+                    break;
+                }
+                memcpy(buf + len, p, n);
+                len += n;
+            }
+            // Half the rounds change one byte, a few truncate
+            seed = seed * 1103515245u + 12345u;
+            if (len > 0 && (seed >> 16) % 2 == 0)
+            {
+                buf[(seed >> 8) % len] = (char)(seed >> 20);
+            }
+            if (len > 0 && (seed >> 16) % 7 == 0)
+            {
+                len--;
+            }
+
+            size_t ref_count;
+            bool ref = reference_valid(buf, len, &ref_count);
+            valid += ref;
+            for (int level = STRSIMD_SCALAR; level <= (int)best; level++)
+            {
+                utf8valid_set_level((StrSimdLevel)level);
+                agree = agree && utf8_validate(buf, len) == ref &&
+                        (!ref || utf8_count_codepoints(buf, len) == ref_count);
+            }
+        }
+        utf8valid_set_level(best);
+        printf("  %d inputs, %d of them valid\n", rounds, valid);
+        check(agree, "every level agrees with utf8conv");
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Validate untrusted input before allocating for the conversion\n");
+    printf("2. AVX2 classifies byte pairs with three nibble table lookups\n");
+    printf("3. SSE2 has no byte shuffle, so it checks byte ranges instead\n");
+    printf("4. Counting code points is counting the non-continuation bytes\n");
+    printf("5. Exactly the inputs utf8conv.h converts are valid\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,654 @@
+/*
+ * Fast I/O - asyncio.c
+ *
+ * Implementation of the asynchronous I/O engine.
+ *
+ * Each request occupies one of queue_depth slots from prep to reap; the
+ * slot index is the io_uring user_data, or the entry in the thread pool's
+ * queues. Slots cap the requests in flight, so the submission ring never
+ * overflows and the completion ring (twice as large) never drops entries.
+ *
+ * The io_uring backend uses IORING_OP_READV/WRITEV with a one-entry iovec
+ * kept in the slot. They are supported by every io_uring kernel (5.1+),
+ * unlike IORING_OP_READ/WRITE (5.6+).
+ */
+
+#define _GNU_SOURCE // syscall(); the rest is POSIX.1-2008
+
+#include "asyncio.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ASIO_HAVE_URING 1
+#endif
+#endif
+#endif
+
+#define DEFAULT_DEPTH 64
+#define MAX_THREADS 32
+
+typedef struct
+{
+    int fd;
+    AsioOp op;
+    struct iovec iov;
+    off_t offset;
+    void *user;
+    ssize_t result;
+    unsigned next; // free list, or the thread pool's queues
+} Slot;
+
+#ifdef ASIO_HAVE_URING
+typedef struct
+{
+    int fd;
+    void *sq_map;
+    size_t sq_map_size;
+    void *cq_map;
+    size_t cq_map_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned local_tail; // SQEs written up to here; published on submit
+} Uring;
+#endif
+
+// Singly linked FIFO of slot indices
+typedef struct
+{
+    unsigned head;
+    unsigned tail;
+    unsigned count;
+} SlotQueue;
+
+struct AsioEngine
+{
+    AsioConfig cfg;
+    AsioBackend backend;
+    Slot *slots;
+    unsigned free_head;
+    unsigned queued;   // prepared, not submitted
+    unsigned inflight; // submitted, not reaped
+
+#ifdef ASIO_HAVE_URING
+    Uring ring;
+#endif
+
+    // ASIO_THREADS
+    SlotQueue staged; // prepared, owned by the caller
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    SlotQueue todo;     // submitted, waiting for a worker
+    SlotQueue finished; // completed, waiting for asio_reap()
+    pthread_t *workers;
+    unsigned nworkers;
+    bool stopping;
+};
+
+#define NO_SLOT UINT32_MAX
+
+static void queue_push(Slot *slots, SlotQueue *q, unsigned idx)
+{
+    slots[idx].next = NO_SLOT;
+    if (q->count == 0)
+    {
+        q->head = idx;
+    }
+    else
+    {
+        slots[q->tail].next = idx;
+    }
+    q->tail = idx;
+    q->count++;
+}
+
+static unsigned queue_pop(Slot *slots, SlotQueue *q)
+{
+    unsigned idx = q->head;
+    q->head = slots[idx].next;
+    q->count--;
+    return idx;
+}
+
+const char *asio_backend_name(AsioBackend backend)
+{
+    switch (backend)
+    {
+    case ASIO_URING:
+        return "io_uring";
+    case ASIO_THREADS:
+        return "thread pool";
+    default:
+        return "auto";
+    }
+}
+
+// ============================================================================
+// io_uring backend
+// ============================================================================
+
+#ifdef ASIO_HAVE_URING
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void uring_close(Uring *r)
+{
+    if (r->sqes != NULL && r->sqes != MAP_FAILED)
+    {
+        munmap(r->sqes, r->sqes_size);
+    }
+    if (r->cq_map != NULL && r->cq_map != MAP_FAILED && r->cq_map != r->sq_map)
+    {
+        munmap(r->cq_map, r->cq_map_size);
+    }
+    if (r->sq_map != NULL && r->sq_map != MAP_FAILED)
+    {
+        munmap(r->sq_map, r->sq_map_size);
+    }
+    if (r->fd >= 0)
+    {
+        close(r->fd);
+    }
+}
+
+static int uring_open(Uring *r, unsigned depth)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = (int)syscall(__NR_io_uring_setup, depth, &p);
+    if (r->fd < 0)
+    {
+        return -1;
+    }
+
+    r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+    {
+        r->sq_map_size = r->cq_map_size = r->sq_map_size > r->cq_map_size ? r->sq_map_size : r->cq_map_size;
+    }
+    r->sq_map = mmap(NULL, r->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, IORING_OFF_SQ_RING);
+    r->cq_map = single ? r->sq_map
+                       : mmap(NULL, r->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, IORING_OFF_CQ_RING);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, IORING_OFF_SQES);
+    if (r->sq_map == MAP_FAILED || r->cq_map == MAP_FAILED || r->sqes == MAP_FAILED)
+    {
+        int saved = errno;
+        uring_close(r);
+        errno = saved;
+        return -1;
+    }
+
+    char *sq = r->sq_map;
+    char *cq = r->cq_map;
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->local_tail = *r->sq_tail;
+    return 0;
+}
+
+static void uring_prep(AsioEngine *e, unsigned idx)
+{
+    Uring *r = &e->ring;
+    Slot *s = &e->slots[idx];
+    unsigned pos = r->local_tail & r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[pos];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = s->op == ASIO_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = s->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&s->iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t)s->offset;
+    sqe->user_data = idx;
+    r->sq_array[pos] = pos;
+    r->local_tail++;
+}
+
+static int uring_submit(AsioEngine *e)
+{
+    Uring *r = &e->ring;
+    __atomic_store_n(r->sq_tail, r->local_tail, __ATOMIC_RELEASE);
+    int started = 0;
+    while (e->queued > 0)
+    {
+        int n = uring_enter(r->fd, e->queued, 0, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return started > 0 ? started : -1;
+        }
+        if (n == 0)
+        {
+            break; // ring busy: the rest goes with the next submit
+        }
+        e->queued -= (unsigned)n;
+        e->inflight += (unsigned)n;
+        started += n;
+    }
+    return started;
+}
+
+// Takes the completions already in the ring
+static unsigned uring_collect(AsioEngine *e, unsigned *idx, ssize_t *res, unsigned max)
+{
+    Uring *r = &e->ring;
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned n = 0;
+    while (head != tail && n < max)
+    {
+        const struct io_uring_cqe *cqe = &r->cqes[head & r->cq_mask];
+        idx[n] = (unsigned)cqe->user_data;
+        res[n] = cqe->res;
+        head++;
+        n++;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+static int uring_wait(AsioEngine *e, unsigned min_complete)
+{
+    for (;;)
+    {
+        if (uring_enter(e->ring.fd, 0, min_complete, IORING_ENTER_GETEVENTS) >= 0)
+        {
+            return 0;
+        }
+        if (errno != EINTR)
+        {
+            return -1;
+        }
+    }
+}
+#endif
+
+// ============================================================================
+// Thread-pool backend
+// ============================================================================
+
+static void *worker_main(void *arg)
+{
+    AsioEngine *e = arg;
+    pthread_mutex_lock(&e->lock);
+    for (;;)
+    {
+        while (e->todo.count == 0 && !e->stopping)
+        {
+            pthread_cond_wait(&e->work, &e->lock);
+        }
+        if (e->todo.count == 0)
+        {
+            break;
+        }
+        unsigned idx = queue_pop(e->slots, &e->todo);
+        pthread_mutex_unlock(&e->lock);
+
+        Slot *s = &e->slots[idx];
+        ssize_t n;
+        do
+        {
+            n = s->op == ASIO_READ ? pread(s->fd, s->iov.iov_base, s->iov.iov_len, s->offset)
+                                   : pwrite(s->fd, s->iov.iov_base, s->iov.iov_len, s->offset);
+        } while (n < 0 && errno == EINTR);
+        s->result = n < 0 ? -errno : n;
+
+        pthread_mutex_lock(&e->lock);
+        queue_push(e->slots, &e->finished, idx);
+        pthread_cond_signal(&e->done);
+    }
+    pthread_mutex_unlock(&e->lock);
+    return NULL;
+}
+
+static int threads_start(AsioEngine *e)
+{
+    unsigned want = e->cfg.threads ? e->cfg.threads : e->cfg.queue_depth;
+    want = want > MAX_THREADS && e->cfg.threads == 0 ? MAX_THREADS : want;
+    e->workers = malloc(want * sizeof(pthread_t));
+    if (e->workers == NULL)
+    {
+        return -1;
+    }
+    for (e->nworkers = 0; e->nworkers < want; e->nworkers++)
+    {
+        int err = pthread_create(&e->workers[e->nworkers], NULL, worker_main, e);
+        if (err != 0)
+        {
+            if (e->nworkers > 0)
+            {
+                break; // a smaller pool still works
+            }
+            free(e->workers);
+            errno = err;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void threads_stop(AsioEngine *e)
+{
+    pthread_mutex_lock(&e->lock);
+    e->stopping = true;
+    pthread_cond_broadcast(&e->work);
+    pthread_mutex_unlock(&e->lock);
+    for (unsigned i = 0; i < e->nworkers; i++)
+    {
+        pthread_join(e->workers[i], NULL);
+    }
+    free(e->workers);
+}
+
+static int threads_submit(AsioEngine *e)
+{
+    int started = (int)e->staged.count;
+    if (started == 0)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&e->lock);
+    while (e->staged.count > 0)
+    {
+        queue_push(e->slots, &e->todo, queue_pop(e->slots, &e->staged));
+    }
+    // Wake as many workers as there is new work
+    if (started == 1)
+    {
+        pthread_cond_signal(&e->work);
+    }
+    else
+    {
+        pthread_cond_broadcast(&e->work);
+    }
+    pthread_mutex_unlock(&e->lock);
+    e->queued = 0;
+    e->inflight += (unsigned)started;
+    return started;
+}
+
+static unsigned threads_collect(AsioEngine *e, unsigned *idx, ssize_t *res, unsigned max, unsigned min_wait)
+{
+    unsigned n = 0;
+    pthread_mutex_lock(&e->lock);
+    while (e->finished.count < min_wait)
+    {
+        pthread_cond_wait(&e->done, &e->lock);
+    }
+    while (e->finished.count > 0 && n < max)
+    {
+        idx[n] = queue_pop(e->slots, &e->finished);
+        res[n] = e->slots[idx[n]].result;
+        n++;
+    }
+    pthread_mutex_unlock(&e->lock);
+    return n;
+}
+
+// ============================================================================
+// Engine
+// ============================================================================
+
+AsioEngine *asio_open(const AsioConfig *cfg)
+{
+    AsioEngine *e = calloc(1, sizeof(AsioEngine));
+    if (e == NULL)
+    {
+        return NULL;
+    }
+    if (cfg != NULL)
+    {
+        e->cfg = *cfg;
+    }
+    if (e->cfg.queue_depth == 0)
+    {
+        e->cfg.queue_depth = DEFAULT_DEPTH;
+    }
+    unsigned depth = e->cfg.queue_depth;
+
+    e->slots = calloc(depth, sizeof(Slot));
+    if (e->slots == NULL)
+    {
+        free(e);
+        return NULL;
+    }
+    for (unsigned i = 0; i < depth; i++)
+    {
+        e->slots[i].next = i + 1 < depth ? i + 1 : NO_SLOT;
+    }
+    e->free_head = 0;
+
+    AsioBackend want = e->cfg.backend;
+    int err = ENOSYS;
+#ifdef ASIO_HAVE_URING
+    if (want != ASIO_THREADS)
+    {
+        if (uring_open(&e->ring, depth) == 0)
+        {
+            e->backend = ASIO_URING;
+            return e;
+        }
+        err = errno;
+    }
+#endif
+    if (want == ASIO_URING)
+    {
+        free(e->slots);
+        free(e);
+        errno = err;
+        return NULL;
+    }
+
+    e->backend = ASIO_THREADS;
+    pthread_mutex_init(&e->lock, NULL);
+    pthread_cond_init(&e->work, NULL);
+    pthread_cond_init(&e->done, NULL);
+    if (threads_start(e) != 0)
+    {
+        int saved = errno;
+        pthread_mutex_destroy(&e->lock);
+        pthread_cond_destroy(&e->work);
+        pthread_cond_destroy(&e->done);
+        free(e->slots);
+        free(e);
+        errno = saved;
+        return NULL;
+    }
+    return e;
+}
+
+AsioBackend asio_backend(const AsioEngine *e)
+{
+    return e->backend;
+}
+
+unsigned asio_pending(const AsioEngine *e)
+{
+    return e->queued + e->inflight;
+}
+
+static int prep(AsioEngine *e, AsioOp op, int fd, void *buf, size_t len, off_t offset, void *user)
+{
+    if (e->free_head == NO_SLOT)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    unsigned idx = e->free_head;
+    Slot *s = &e->slots[idx];
+    e->free_head = s->next;
+
+    s->fd = fd;
+    s->op = op;
+    s->iov.iov_base = buf;
+    s->iov.iov_len = len;
+    s->offset = offset;
+    s->user = user;
+    e->queued++;
+#ifdef ASIO_HAVE_URING
+    if (e->backend == ASIO_URING)
+    {
+        uring_prep(e, idx);
+        return 0;
+    }
+#endif
+    queue_push(e->slots, &e->staged, idx);
+    return 0;
+}
+
+int asio_prep_read(AsioEngine *e, int fd, void *buf, size_t len, off_t offset, void *user)
+{
+    return prep(e, ASIO_READ, fd, buf, len, offset, user);
+}
+
+int asio_prep_write(AsioEngine *e, int fd, const void *buf, size_t len, off_t offset, void *user)
+{
+    return prep(e, ASIO_WRITE, fd, (void *)buf, len, offset, user);
+}
+
+int asio_submit(AsioEngine *e)
+{
+    if (e->queued == 0)
+    {
+        return 0;
+    }
+#ifdef ASIO_HAVE_URING
+    if (e->backend == ASIO_URING)
+    {
+        return uring_submit(e);
+    }
+#endif
+    return threads_submit(e);
+}
+
+int asio_reap(AsioEngine *e, AsioCompletion *out, unsigned max, unsigned min_wait)
+{
+    if (asio_submit(e) < 0)
+    {
+        return -1;
+    }
+    if (min_wait > e->inflight)
+    {
+        min_wait = e->inflight;
+    }
+    if (min_wait > max)
+    {
+        min_wait = max;
+    }
+
+    unsigned idx[64];
+    ssize_t res[64];
+    unsigned taken = 0;
+    while (taken < max)
+    {
+        unsigned want = max - taken < 64 ? max - taken : 64;
+        unsigned wait = min_wait > taken ? min_wait - taken : 0;
+        unsigned n;
+#ifdef ASIO_HAVE_URING
+        if (e->backend == ASIO_URING)
+        {
+            n = uring_collect(e, idx, res, want);
+            if (n == 0 && wait > 0)
+            {
+                if (uring_wait(e, wait < want ? wait : want) != 0)
+                {
+                    return taken > 0 ? (int)taken : -1;
+                }
+                continue;
+            }
+        }
+        else
+#endif
+        {
+            n = threads_collect(e, idx, res, want, wait < want ? wait : want);
+        }
+        if (n == 0)
+        {
+            break;
+        }
+
+        for (unsigned i = 0; i < n; i++)
+        {
+            Slot *s = &e->slots[idx[i]];
+            AsioCompletion c = {s->user, res[i], s->op};
+            s->next = e->free_head; // free before the callback, which may prep again
+            e->free_head = idx[i];
+            e->inflight--;
+            if (e->cfg.callback != NULL)
+            {
+                e->cfg.callback(&c, e->cfg.callback_ctx);
+            }
+            else
+            {
+                out[taken + i] = c;
+            }
+        }
+        taken += n;
+    }
+    return (int)taken;
+}
+
+void asio_close(AsioEngine *e)
+{
+    if (e == NULL)
+    {
+        return;
+    }
+    // Requests in flight still point at slots and caller buffers
+    e->cfg.callback = NULL;
+    AsioCompletion sink[64];
+    while (e->inflight > 0 || e->queued > 0)
+    {
+        if (asio_reap(e, sink, 64, 1) < 0)
+        {
+            break;
+        }
+    }
+#ifdef ASIO_HAVE_URING
+    if (e->backend == ASIO_URING)
+    {
+        uring_close(&e->ring);
+    }
+#endif
+    if (e->backend == ASIO_THREADS)
+    {
+        threads_stop(e);
+        pthread_mutex_destroy(&e->lock);
+        pthread_cond_destroy(&e->work);
+        pthread_cond_destroy(&e->done);
+    }
+    free(e->slots);
+    free(e);
+}
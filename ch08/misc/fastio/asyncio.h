@@ -0,0 +1,94 @@
+/*
+ * Fast I/O - asyncio.h
+ *
+ * Asynchronous positional file I/O with many requests in flight.
+ *
+ * Every read in ch08 (posix_io.c, binary_io.c, file_positioning.c) blocks
+ * the caller until the data arrives, so a thread has at most one request
+ * outstanding. An AsioEngine accepts up to queue_depth reads and writes,
+ * submits them in one go, and hands back completions as they finish.
+ *
+ * Two backends behind the same calls:
+ *   - ASIO_URING: Linux io_uring, driven with raw system calls (no
+ *     liburing). One io_uring_enter() submits a whole batch.
+ *   - ASIO_THREADS: a pool of threads doing pread()/pwrite(), used where
+ *     io_uring is missing or disabled.
+ *
+ * Completions are either polled (asio_reap() fills an array) or delivered
+ * to a callback set in AsioConfig, which asio_reap() calls in the
+ * caller's thread.
+ *
+ * Functions return 0 (or a count), or -1 with errno set. The result of a
+ * request is in its completion: bytes transferred, or -errno.
+ */
+
+#ifndef FASTIO_ASYNCIO_H
+#define FASTIO_ASYNCIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef enum
+{
+    ASIO_AUTO,   // io_uring if the kernel allows it, else threads
+    ASIO_URING,
+    ASIO_THREADS
+} AsioBackend;
+
+typedef enum
+{
+    ASIO_READ,
+    ASIO_WRITE
+} AsioOp;
+
+typedef struct
+{
+    void *user;     // as passed to asio_prep_*()
+    ssize_t result; // bytes transferred, or -errno
+    AsioOp op;
+} AsioCompletion;
+
+typedef void (*AsioCallback)(const AsioCompletion *c, void *ctx);
+
+typedef struct
+{
+    unsigned queue_depth; // most requests queued or in flight (0 = 64)
+    AsioBackend backend;
+    unsigned threads;      // ASIO_THREADS pool size (0 = queue_depth, at most 32)
+    AsioCallback callback; // NULL: poll mode
+    void *callback_ctx;
+} AsioConfig;
+
+typedef struct AsioEngine AsioEngine;
+
+// cfg may be NULL for the defaults. Asking for ASIO_URING where it is not
+// available fails with the kernel's errno (ENOSYS, EPERM, ...).
+AsioEngine *asio_open(const AsioConfig *cfg);
+
+AsioBackend asio_backend(const AsioEngine *e);
+
+// Queue a read or write of len bytes at offset. Nothing starts until
+// asio_submit(). Fails with EAGAIN when queue_depth requests are already
+// queued or in flight: reap some first. buf must stay valid until the
+// request completes.
+int asio_prep_read(AsioEngine *e, int fd, void *buf, size_t len, off_t offset, void *user);
+int asio_prep_write(AsioEngine *e, int fd, const void *buf, size_t len, off_t offset, void *user);
+
+// Start every queued request. Returns how many were started.
+int asio_submit(AsioEngine *e);
+
+// Wait for at least min_wait completions (0: do not wait) and take up to
+// max. In poll mode they are stored in out; with a callback each one is
+// passed to it and out may be NULL. Queued requests are submitted first.
+// Returns the number of completions taken.
+int asio_reap(AsioEngine *e, AsioCompletion *out, unsigned max, unsigned min_wait);
+
+// Requests queued or in flight
+unsigned asio_pending(const AsioEngine *e);
+
+// Wait for everything in flight, discarding the completions, and free
+void asio_close(AsioEngine *e);
+
+const char *asio_backend_name(AsioBackend backend);
+
+#endif /* FASTIO_ASYNCIO_H */
@@ -0,0 +1,434 @@
+/*
+ * Fast I/O - atomicfile.c
+ *
+ * Implementation of atomic file replacement.
+ *
+ * An O_TMPFILE inode has no name, so it cannot be renamed over the target
+ * directly. It is first linked to a hidden temporary name through
+ * /proc/self/fd (linkat() with AT_EMPTY_PATH needs CAP_DAC_READ_SEARCH),
+ * and that name is renamed over the target at once. The name exists only
+ * between those two calls, after the data is already on disk.
+ */
+
+#define _GNU_SOURCE // O_TMPFILE; the rest is POSIX.1-2008
+
+#include "atomicfile.h"
+#include "stream_buf.h"
+#include "vecio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NAME_TRIES 100
+
+struct AtomicFile
+{
+    int fd;
+    bool unnamed;  // O_TMPFILE: no name until published
+    char *path;    // the target
+    char *dir;     // its directory
+    char *tmpname; // the temporary name, once it has one
+    BufferedStream *stream;
+    int error;     // first failed af_write(), reported by af_commit()
+};
+
+struct AfBatch
+{
+    char **dirs; // directories to sync, each once
+    size_t count;
+    size_t cap;
+    AfStats stats;
+};
+
+// ============================================================================
+// Names
+// ============================================================================
+
+static char *copy_string(const char *s, size_t len)
+{
+    char *copy = malloc(len + 1);
+    if (copy != NULL)
+    {
+        memcpy(copy, s, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+// "a/b/c" -> "a/b", "c" -> ".", "/c" -> "/"
+static char *parent_dir(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+    {
+        return copy_string(".", 1);
+    }
+    return copy_string(path, slash == path ? 1 : (size_t)(slash - path));
+}
+
+// dir/.base.XXXXXX with a different suffix on each call
+static char *temp_name(const char *path)
+{
+    static atomic_ulong counter = 0; // af_open() may run in several threads
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    unsigned long n = atomic_fetch_add(&counter, 1);
+    unsigned long seed = (unsigned long)ts.tv_nsec ^ ((unsigned long)getpid() << 16) ^ n * 2654435761UL;
+
+    const char *slash = strrchr(path, '/');
+    const char *base = slash ? slash + 1 : path;
+    int dir_len = slash ? (int)(slash - path + 1) : 0;
+    size_t size = strlen(path) + 2 + 1 + 8 + 1;
+    char *name = malloc(size);
+    if (name != NULL)
+    {
+        snprintf(name, size, "%.*s.%s.%08lx", dir_len, path, base, seed & 0xffffffffUL);
+    }
+    return name;
+}
+
+// ============================================================================
+// Syncing
+// ============================================================================
+
+static int sync_dir(const char *dir)
+{
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int rc = fsync(fd);
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return rc;
+}
+
+#ifdef O_TMPFILE
+// O_TMPFILE is only worth trying if the inode can be named afterwards
+static bool tmpfile_usable(void)
+{
+    static atomic_int usable = -1;
+    if (usable < 0)
+    {
+        usable = access("/proc/self/fd", X_OK) == 0;
+    }
+    return usable;
+}
+#endif
+
+// ============================================================================
+// Replacing one file
+// ============================================================================
+
+AtomicFile *af_open(const char *path, mode_t mode)
+{
+    AtomicFile *af = calloc(1, sizeof(AtomicFile));
+    if (af == NULL)
+    {
+        return NULL;
+    }
+    af->fd = -1;
+    af->path = copy_string(path, strlen(path));
+    af->dir = parent_dir(path);
+    if (af->path == NULL || af->dir == NULL)
+    {
+        af_abort(af);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+#ifdef O_TMPFILE
+    if (tmpfile_usable())
+    {
+        af->fd = open(af->dir, O_TMPFILE | O_WRONLY, mode);
+        // Kernels or file systems without it fail in one of these ways
+        if (af->fd < 0 && errno != EOPNOTSUPP && errno != EISDIR && errno != EINVAL)
+        {
+            int saved = errno;
+            af_abort(af);
+            errno = saved;
+            return NULL;
+        }
+        af->unnamed = af->fd >= 0;
+    }
+#endif
+
+    for (int i = 0; af->fd < 0 && i < NAME_TRIES; i++)
+    {
+        free(af->tmpname);
+        af->tmpname = temp_name(path);
+        if (af->tmpname == NULL)
+        {
+            break;
+        }
+        af->fd = open(af->tmpname, O_WRONLY | O_CREAT | O_EXCL, mode);
+        if (af->fd < 0 && errno != EEXIST)
+        {
+            break;
+        }
+    }
+    if (af->fd < 0)
+    {
+        int saved = af->tmpname ? errno : ENOMEM;
+        free(af->tmpname);
+        af->tmpname = NULL; // nothing was created under it
+        af_abort(af);
+        errno = saved;
+        return NULL;
+    }
+    return af;
+}
+
+int af_write(AtomicFile *af, const void *buf, size_t len)
+{
+    if (af->error == 0 && vio_write_all(af->fd, buf, len) != 0)
+    {
+        af->error = errno;
+    }
+    if (af->error != 0)
+    {
+        errno = af->error;
+        return -1;
+    }
+    return 0;
+}
+
+FILE *af_file(AtomicFile *af)
+{
+    if (af->stream == NULL)
+    {
+        // The stream owns a duplicate, so af->fd stays open for the sync
+        int fd = dup(af->fd);
+        if (fd < 0)
+        {
+            return NULL;
+        }
+        af->stream = bs_fdopen(fd, "w", BS_SEQUENTIAL, 0);
+        if (af->stream == NULL)
+        {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return NULL;
+        }
+    }
+    return bs_file(af->stream);
+}
+
+// Give the synced inode its temporary name, if it has none yet
+static int link_unnamed(AtomicFile *af)
+{
+    char proc[64];
+    snprintf(proc, sizeof(proc), "/proc/self/fd/%d", af->fd);
+    for (int i = 0; i < NAME_TRIES; i++)
+    {
+        af->tmpname = temp_name(af->path);
+        if (af->tmpname == NULL)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (linkat(AT_FDCWD, proc, AT_FDCWD, af->tmpname, AT_SYMLINK_FOLLOW) == 0)
+        {
+            return 0;
+        }
+        int saved = errno;
+        free(af->tmpname);
+        af->tmpname = NULL;
+        if (saved != EEXIST)
+        {
+            errno = saved;
+            return -1;
+        }
+    }
+    errno = EEXIST;
+    return -1;
+}
+
+// Steps 1-3: everything but the directory sync
+static int publish(AtomicFile *af)
+{
+    if (af->stream != NULL)
+    {
+        BufferedStream *s = af->stream;
+        af->stream = NULL;
+        if (bs_close(s, NULL) != 0 && af->error == 0)
+        {
+            af->error = errno ? errno : EIO;
+        }
+    }
+    if (af->error != 0)
+    {
+        errno = af->error;
+        return -1;
+    }
+    if (fdatasync(af->fd) != 0)
+    {
+        return -1;
+    }
+    if (af->unnamed && link_unnamed(af) != 0)
+    {
+        return -1;
+    }
+    if (rename(af->tmpname, af->path) != 0)
+    {
+        return -1;
+    }
+    free(af->tmpname);
+    af->tmpname = NULL; // now the target: af_abort() must not unlink it
+    return 0;
+}
+
+// Remember af's directory for af_batch_sync(), once per directory
+static int defer_dir_sync(AtomicFile *af, AfBatch *b)
+{
+    for (size_t i = 0; i < b->count; i++)
+    {
+        if (strcmp(b->dirs[i], af->dir) == 0)
+        {
+            return 0;
+        }
+    }
+    if (b->count == b->cap)
+    {
+        size_t cap = b->cap ? b->cap * 2 : 8;
+        char **dirs = realloc(b->dirs, cap * sizeof(char *));
+        if (dirs == NULL)
+        {
+            // No room to defer it: sync now
+            b->stats.dir_syncs++;
+            return sync_dir(af->dir);
+        }
+        b->dirs = dirs;
+        b->cap = cap;
+    }
+    b->dirs[b->count++] = af->dir;
+    af->dir = NULL; // owned by the batch now
+    return 0;
+}
+
+static int commit(AtomicFile *af, AfBatch *b)
+{
+    int rc = publish(af);
+    if (rc == 0 && b != NULL)
+    {
+        struct stat st;
+        b->stats.files++;
+        b->stats.bytes += fstat(af->fd, &st) == 0 ? (unsigned long long)st.st_size : 0;
+        b->stats.tmpfiles += af->unnamed;
+    }
+    if (rc == 0)
+    {
+        rc = b != NULL ? defer_dir_sync(af, b) : sync_dir(af->dir);
+    }
+    int saved = errno;
+    af_abort(af);
+    errno = saved;
+    return rc;
+}
+
+int af_commit(AtomicFile *af)
+{
+    return commit(af, NULL);
+}
+
+int af_commit_to(AtomicFile *af, AfBatch *b)
+{
+    return commit(af, b);
+}
+
+void af_abort(AtomicFile *af)
+{
+    if (af == NULL)
+    {
+        return;
+    }
+    if (af->stream != NULL)
+    {
+        bs_close(af->stream, NULL);
+    }
+    if (af->fd >= 0)
+    {
+        close(af->fd);
+    }
+    if (af->tmpname != NULL)
+    {
+        unlink(af->tmpname);
+    }
+    free(af->tmpname);
+    free(af->path);
+    free(af->dir);
+    free(af);
+}
+
+int af_replace(const char *path, const void *data, size_t len, mode_t mode)
+{
+    AtomicFile *af = af_open(path, mode);
+    if (af == NULL)
+    {
+        return -1;
+    }
+    af_write(af, data, len); // a failure is sticky and reported by af_commit()
+    return af_commit(af);
+}
+
+// ============================================================================
+// Batches
+// ============================================================================
+
+AfBatch *af_batch_open(void)
+{
+    return calloc(1, sizeof(AfBatch));
+}
+
+int af_batch_sync(AfBatch *b)
+{
+    int rc = 0;
+    int saved = 0;
+    for (size_t i = 0; i < b->count; i++)
+    {
+        if (sync_dir(b->dirs[i]) != 0 && rc == 0)
+        {
+            rc = -1;
+            saved = errno;
+        }
+        b->stats.dir_syncs++;
+        free(b->dirs[i]);
+    }
+    b->count = 0;
+    if (rc != 0)
+    {
+        errno = saved;
+    }
+    return rc;
+}
+
+AfStats af_batch_stats(const AfBatch *b)
+{
+    return b->stats;
+}
+
+int af_batch_close(AfBatch *b, AfStats *final)
+{
+    if (b == NULL)
+    {
+        return 0;
+    }
+    int rc = af_batch_sync(b);
+    if (final != NULL)
+    {
+        *final = b->stats;
+    }
+    free(b->dirs);
+    free(b);
+    return rc;
+}
@@ -0,0 +1,92 @@
+/*
+ * Fast I/O - atomicfile.h
+ *
+ * Crash-safe atomic file replacement.
+ *
+ * Test 9 of ch08/listings/remove_rename.c writes a temporary file,
+ * renames the original to .bak and renames the temporary over it. Nothing
+ * is ever synced: after a crash the new name can point at a file whose
+ * data never reached the disk, or the rename itself can be lost. Between
+ * the two renames the original name does not exist at all.
+ *
+ * af_commit() does it in the order that survives a crash:
+ *
+ *   1. write the new content to a file nobody can see yet
+ *   2. fdatasync() it
+ *   3. rename() it directly over the target: readers see the old file or
+ *      the new one, never a missing or partial one
+ *   4. fsync() the parent directory so the rename itself is durable
+ *
+ * On Linux the new content goes to an unnamed O_TMPFILE inode, which is
+ * given a name with linkat() only after step 2, so a crash while writing
+ * leaves no stray temporary file. Elsewhere, or on file systems without
+ * O_TMPFILE, it is a hidden ".name.XXXXXX" file in the same directory.
+ *
+ * Replacing many small files costs a directory fsync() each. Commit them
+ * through an AfBatch instead: af_batch_sync() then syncs each directory
+ * once for the whole batch.
+ *
+ * Functions return 0, or -1 with errno set.
+ */
+
+#ifndef FASTIO_ATOMICFILE_H
+#define FASTIO_ATOMICFILE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+typedef struct
+{
+    unsigned long long files;     // replacements committed
+    unsigned long long bytes;
+    unsigned long long tmpfiles;  // of which went through O_TMPFILE
+    unsigned long long dir_syncs; // directory fsync() calls
+} AfStats;
+
+typedef struct AtomicFile AtomicFile;
+typedef struct AfBatch AfBatch;
+
+// Start replacing (or creating) path. The new file gets mode, less the
+// umask.
+AtomicFile *af_open(const char *path, mode_t mode);
+
+// Unbuffered write of the whole of buf, for content already in memory
+int af_write(AtomicFile *af, const void *buf, size_t len);
+
+// A fully buffered stdio stream (1 MiB or more, see stream_buf.h) for
+// fprintf() and friends. Do not fclose() it. Writes through it and
+// through af_write() must not be mixed.
+FILE *af_file(AtomicFile *af);
+
+// Make the new content visible under the path and durable, as described
+// above. af is freed whether or not this succeeds; on failure the
+// original file is untouched.
+int af_commit(AtomicFile *af);
+
+// Discard the new content. The original file is untouched.
+void af_abort(AtomicFile *af);
+
+// af_open() + af_write() + af_commit()
+int af_replace(const char *path, const void *data, size_t len, mode_t mode);
+
+// ============================================================================
+// Batches
+// ============================================================================
+
+AfBatch *af_batch_open(void);
+
+// Like af_commit(), but the directory fsync() is left to
+// af_batch_sync(). Until then, a crash may bring back the old file
+// (never a partial new one).
+int af_commit_to(AtomicFile *af, AfBatch *b);
+
+// fsync() every directory touched by the batch since the last call
+int af_batch_sync(AfBatch *b);
+
+AfStats af_batch_stats(const AfBatch *b);
+
+// af_batch_sync() and free. final (if not NULL) receives the counters.
+int af_batch_close(AfBatch *b, AfStats *final);
+
+#endif /* FASTIO_ATOMICFILE_H */
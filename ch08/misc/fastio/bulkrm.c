@@ -0,0 +1,524 @@
+/*
+ * Fast I/O - bulkrm.c
+ *
+ * Implementation of bulk removal.
+ *
+ * Both entry points turn their input into a list of jobs: "unlink these
+ * names in this directory" and "remove this subdirectory tree". Workers,
+ * the calling thread among them, take the next job from a shared atomic
+ * index until none are left, each keeping its own counters, which are
+ * added up at the end. A tree job walks depth-first with openat() and
+ * fdopendir(): one directory descriptor per level, no path ever built.
+ */
+
+#define _GNU_SOURCE // d_type in readdir(); the rest is POSIX.1-2008
+
+#include "bulkrm.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 16
+
+typedef struct
+{
+    char *dir;          // opened by the worker if dfd is -1
+    int dfd;
+    const char **names; // entries of that directory
+    size_t count;
+    int trees;          // names are subdirectories to remove whole
+} Job;
+
+typedef struct
+{
+    Job *jobs;
+    size_t count;
+    atomic_size_t next;
+} Queue;
+
+typedef struct
+{
+    Queue *queue;
+    BrmStats stats;
+} Worker;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void note_error(BrmStats *st, int err)
+{
+    if (err == ENOENT)
+    {
+        st->missing++;
+        return;
+    }
+    st->errors++;
+    if (st->first_error == 0)
+    {
+        st->first_error = err;
+    }
+}
+
+// ============================================================================
+// Removing
+// ============================================================================
+
+static void remove_tree(int dfd, const char *name, BrmStats *st);
+
+static void remove_file(int dfd, const char *name, BrmStats *st)
+{
+    if (unlinkat(dfd, name, 0) == 0)
+    {
+        st->files++;
+    }
+    else
+    {
+        note_error(st, errno);
+    }
+}
+
+static void remove_entry(int dfd, const char *name, unsigned char type, BrmStats *st)
+{
+    if (type == DT_UNKNOWN)
+    {
+        // Some file systems do not fill in d_type
+        struct stat sb;
+        if (fstatat(dfd, name, &sb, AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            note_error(st, errno);
+            return;
+        }
+        type = S_ISDIR(sb.st_mode) ? DT_DIR : DT_REG;
+    }
+    if (type == DT_DIR)
+    {
+        remove_tree(dfd, name, st);
+    }
+    else
+    {
+        remove_file(dfd, name, st);
+    }
+}
+
+// Remove everything in the directory fd, then close it
+static void clear_dir(int fd, BrmStats *st)
+{
+    DIR *d = fdopendir(fd);
+    if (d == NULL)
+    {
+        note_error(st, errno);
+        close(fd);
+        return;
+    }
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0)
+        {
+            remove_entry(fd, e->d_name, e->d_type, st);
+        }
+    }
+    closedir(d);
+}
+
+static void remove_tree(int dfd, const char *name, BrmStats *st)
+{
+    int fd = openat(dfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOTDIR || errno == ELOOP)
+        {
+            remove_file(dfd, name, st); // replaced by a file or a link since listed
+        }
+        else
+        {
+            note_error(st, errno);
+        }
+        return;
+    }
+    st->dir_opens++;
+    clear_dir(fd, st);
+    if (unlinkat(dfd, name, AT_REMOVEDIR) == 0)
+    {
+        st->dirs++;
+    }
+    else
+    {
+        note_error(st, errno);
+    }
+}
+
+static void run_job(Job *job, BrmStats *st)
+{
+    int dfd = job->dfd;
+    if (dfd < 0)
+    {
+        dfd = open(job->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dfd < 0)
+        {
+            int err = errno;
+            for (size_t i = 0; i < job->count; i++)
+            {
+                note_error(st, err);
+            }
+            return;
+        }
+        st->dir_opens++;
+    }
+    for (size_t i = 0; i < job->count; i++)
+    {
+        if (job->trees)
+        {
+            remove_tree(dfd, job->names[i], st);
+        }
+        else
+        {
+            remove_file(dfd, job->names[i], st);
+        }
+    }
+    if (job->dfd < 0)
+    {
+        close(dfd);
+    }
+}
+
+// ============================================================================
+// Worker pool
+// ============================================================================
+
+static void *worker_main(void *arg)
+{
+    Worker *w = arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&w->queue->next, 1)) < w->queue->count)
+    {
+        run_job(&w->queue->jobs[i], &w->stats);
+    }
+    return NULL;
+}
+
+static unsigned choose_threads(const BrmConfig *config, size_t jobs)
+{
+    long want = config && config->threads ? (long)config->threads : sysconf(_SC_NPROCESSORS_ONLN);
+    want = want < 1 ? 1 : want > MAX_THREADS ? MAX_THREADS : want;
+    want = (size_t)want > jobs ? (long)jobs : want;
+    return want < 1 ? 1 : (unsigned)want;
+}
+
+// Run every job; counters are added to *total
+static void run_jobs(Job *jobs, size_t count, unsigned threads, BrmStats *total)
+{
+    Queue queue = {jobs, count, 0};
+    Worker workers[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    int started[MAX_THREADS] = {0};
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers[t] = (Worker){&queue, {0}};
+    }
+
+    // Worker 0 is this thread; a failed pthread_create() leaves it more
+    // to do, nothing undone
+    for (unsigned t = 1; t < threads; t++)
+    {
+        started[t] = pthread_create(&tids[t], NULL, worker_main, &workers[t]) == 0;
+    }
+    worker_main(&workers[0]);
+
+    total->threads = 1;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        if (t > 0 && started[t])
+        {
+            pthread_join(tids[t], NULL);
+            total->threads++;
+        }
+        BrmStats *s = &workers[t].stats;
+        total->files += s->files;
+        total->dirs += s->dirs;
+        total->missing += s->missing;
+        total->errors += s->errors;
+        total->dir_opens += s->dir_opens;
+        if (total->first_error == 0)
+        {
+            total->first_error = s->first_error;
+        }
+    }
+}
+
+static int finish(BrmStats *st, double t0, BrmStats *out)
+{
+    st->seconds = now_seconds() - t0;
+    if (out != NULL)
+    {
+        *out = *st;
+    }
+    if (st->first_error != 0)
+    {
+        errno = st->first_error;
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Lists of paths
+// ============================================================================
+
+typedef struct
+{
+    const char *path;
+    size_t dir_len; // 0: no slash, the current directory
+} PathEntry;
+
+static int compare_dirs(const void *a, const void *b)
+{
+    const PathEntry *x = a;
+    const PathEntry *y = b;
+    size_t n = x->dir_len < y->dir_len ? x->dir_len : y->dir_len;
+    int c = memcmp(x->path, y->path, n);
+    return c != 0 ? c : (x->dir_len > y->dir_len) - (x->dir_len < y->dir_len);
+}
+
+int brm_unlink_paths(const char *const *paths, size_t count, const BrmConfig *config, BrmStats *stats)
+{
+    double t0 = now_seconds();
+    BrmStats st = {0};
+    PathEntry *entries = malloc((count ? count : 1) * sizeof(PathEntry));
+    const char **names = malloc((count ? count : 1) * sizeof(char *));
+    Job *jobs = malloc((count ? count : 1) * sizeof(Job));
+    if (entries == NULL || names == NULL || jobs == NULL)
+    {
+        free(entries);
+        free(names);
+        free(jobs);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *slash = strrchr(paths[i], '/');
+        entries[i].path = paths[i];
+        // "/x" lives in "/", whose dir_len is 1 like "a/x"'s
+        entries[i].dir_len = slash == NULL ? 0 : slash == paths[i] ? 1 : (size_t)(slash - paths[i]);
+    }
+    qsort(entries, count, sizeof(PathEntry), compare_dirs);
+
+    size_t njobs = 0;
+    int failed = 0;
+    for (size_t i = 0; i < count && !failed;)
+    {
+        size_t j = i;
+        while (j < count && compare_dirs(&entries[i], &entries[j]) == 0)
+        {
+            const char *slash = strrchr(entries[j].path, '/');
+            names[j] = slash ? slash + 1 : entries[j].path;
+            j++;
+        }
+        size_t len = entries[i].dir_len;
+        char *dir = malloc(len ? len + 1 : 2);
+        if (dir == NULL)
+        {
+            failed = 1;
+            break;
+        }
+        memcpy(dir, len ? entries[i].path : ".", len ? len : 1);
+        dir[len ? len : 1] = '\0';
+        jobs[njobs++] = (Job){dir, -1, names + i, j - i, 0};
+        i = j;
+    }
+
+    if (!failed)
+    {
+        run_jobs(jobs, njobs, choose_threads(config, njobs), &st);
+    }
+    for (size_t i = 0; i < njobs; i++)
+    {
+        free(jobs[i].dir);
+    }
+    free(entries);
+    free(names);
+    free(jobs);
+    if (failed)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    return finish(&st, t0, stats);
+}
+
+// ============================================================================
+// Trees
+// ============================================================================
+
+typedef struct
+{
+    char **items;
+    size_t count;
+    size_t cap;
+} Names;
+
+static int add_name(Names *n, const char *name)
+{
+    if (n->count == n->cap)
+    {
+        size_t cap = n->cap ? n->cap * 2 : 64;
+        char **items = realloc(n->items, cap * sizeof(char *));
+        if (items == NULL)
+        {
+            return -1;
+        }
+        n->items = items;
+        n->cap = cap;
+    }
+    if ((n->items[n->count] = strdup(name)) == NULL)
+    {
+        return -1;
+    }
+    n->count++;
+    return 0;
+}
+
+// Sort the entries of the directory fd into subdirectories and the rest
+static int list_top(int fd, Names *subdirs, Names *others)
+{
+    int copy = dup(fd); // closedir() closes it; fd stays open for the jobs
+    DIR *d = copy >= 0 ? fdopendir(copy) : NULL;
+    if (d == NULL)
+    {
+        if (copy >= 0)
+        {
+            close(copy);
+        }
+        return -1;
+    }
+    int rc = 0;
+    struct dirent *e;
+    while (rc == 0 && (e = readdir(d)) != NULL)
+    {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+        {
+            continue;
+        }
+        int is_dir = e->d_type == DT_DIR;
+        struct stat sb;
+        if (e->d_type == DT_UNKNOWN && fstatat(fd, e->d_name, &sb, AT_SYMLINK_NOFOLLOW) == 0)
+        {
+            is_dir = S_ISDIR(sb.st_mode);
+        }
+        rc = add_name(is_dir ? subdirs : others, e->d_name);
+    }
+    closedir(d);
+    return rc;
+}
+
+int brm_remove_trees(const char *const *dirs, size_t count, const BrmConfig *config, BrmStats *stats)
+{
+    double t0 = now_seconds();
+    BrmStats st = {0};
+    int *fds = malloc((count ? count : 1) * sizeof(int));
+    Names *subdirs = calloc(count ? count : 1, sizeof(Names));
+    Names *others = calloc(count ? count : 1, sizeof(Names));
+    if (fds == NULL || subdirs == NULL || others == NULL)
+    {
+        free(fds);
+        free(subdirs);
+        free(others);
+        errno = ENOMEM;
+        return -1;
+    }
+    Job *jobs = NULL;
+    size_t njobs = 0;
+
+    // List each top directory here, so that its subdirectories can be
+    // shared out; this thread also opens them, once each
+    for (size_t i = 0; i < count; i++)
+    {
+        fds[i] = open(dirs[i], O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fds[i] < 0)
+        {
+            note_error(&st, errno);
+            continue;
+        }
+        st.dir_opens++;
+        if (list_top(fds[i], &subdirs[i], &others[i]) != 0)
+        {
+            note_error(&st, errno);
+        }
+        njobs += subdirs[i].count + (others[i].count > 0);
+    }
+
+    int failed = (jobs = malloc((njobs ? njobs : 1) * sizeof(Job))) == NULL;
+    if (!failed)
+    {
+        size_t k = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (fds[i] < 0)
+            {
+                continue;
+            }
+            for (size_t s = 0; s < subdirs[i].count; s++)
+            {
+                jobs[k++] = (Job){NULL, fds[i], (const char **)&subdirs[i].items[s], 1, 1};
+            }
+            if (others[i].count > 0)
+            {
+                jobs[k++] = (Job){NULL, fds[i], (const char **)others[i].items, others[i].count, 0};
+            }
+        }
+        run_jobs(jobs, njobs, choose_threads(config, njobs), &st);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (fds[i] < 0)
+        {
+            continue;
+        }
+        close(fds[i]);
+        if (!failed && !(config && config->keep_top))
+        {
+            if (rmdir(dirs[i]) == 0)
+            {
+                st.dirs++;
+            }
+            else
+            {
+                note_error(&st, errno);
+            }
+        }
+        for (size_t s = 0; s < subdirs[i].count; s++)
+        {
+            free(subdirs[i].items[s]);
+        }
+        for (size_t s = 0; s < others[i].count; s++)
+        {
+            free(others[i].items[s]);
+        }
+        free(subdirs[i].items);
+        free(others[i].items);
+    }
+    free(fds);
+    free(subdirs);
+    free(others);
+    free(jobs);
+    if (failed)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    return finish(&st, t0, stats);
+}
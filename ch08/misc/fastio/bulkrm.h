@@ -0,0 +1,58 @@
+/*
+ * Fast I/O - bulkrm.h
+ *
+ * Bulk file removal.
+ *
+ * ch08/misc/unlink_example.c and ch08/listings/remove_rename.c delete one
+ * path at a time with unlink() or remove(). Every call makes the kernel
+ * walk the whole path again, component by component, and remove() also
+ * tries rmdir() semantics. Deleting a million spill files that way means
+ * a million path walks through the same few directories.
+ *
+ * bulkrm opens each directory once and removes its entries with
+ * unlinkat() relative to that descriptor, so each call looks up a single
+ * name. Directories are shared out to a pool of worker threads, so
+ * removals in different directories run in parallel (in one directory
+ * they would only contend for its lock).
+ *
+ * Symbolic links are removed, never followed, and subdirectories are
+ * opened with O_NOFOLLOW: a tree swapped for a link mid-removal cannot
+ * redirect the deletion elsewhere.
+ *
+ * Functions return 0, or -1 with errno set to the first failure; they
+ * carry on past failures and count them.
+ */
+
+#ifndef FASTIO_BULKRM_H
+#define FASTIO_BULKRM_H
+
+#include <stddef.h>
+
+typedef struct
+{
+    unsigned threads; // worker threads (0 = one per online CPU, at most 16)
+    int keep_top;     // brm_remove_trees(): empty the directories given, keep them
+} BrmConfig;
+
+typedef struct
+{
+    unsigned long long files;     // non-directories removed
+    unsigned long long dirs;      // directories removed
+    unsigned long long missing;   // already gone (ENOENT): not an error
+    unsigned long long errors;    // entries that could not be removed
+    unsigned long long dir_opens; // directories opened
+    int first_error;              // errno of the first error, or 0
+    unsigned threads;             // workers actually used
+    double seconds;
+} BrmStats;
+
+// Remove each file in paths. The paths are grouped by directory, and each
+// directory is opened once. config and stats may be NULL.
+int brm_unlink_paths(const char *const *paths, size_t count, const BrmConfig *config, BrmStats *stats);
+
+// Remove each directory in dirs with everything below it, like rm -r
+// (or only what is below it, with keep_top). Each directory's immediate
+// subdirectories are shared among the workers.
+int brm_remove_trees(const char *const *dirs, size_t count, const BrmConfig *config, BrmStats *stats);
+
+#endif /* FASTIO_BULKRM_H */
@@ -0,0 +1,625 @@
+/*
+ * Fast I/O - extsort.c
+ *
+ * Implementation of the external merge sort.
+ *
+ * Run formation: read memory_limit bytes, qsort() them in `threads`
+ * slices at once, then merge the slices through the same loser tree used
+ * for the on-disk runs. The merged output goes to the spill file, or
+ * straight to the output if the whole input fitted in memory.
+ *
+ * Merging: a loser tree over k sources needs about log2(k) comparisons
+ * per record, against 2*log2(k) for a binary heap. If there are more runs
+ * than read buffers fit in memory_limit, intermediate passes merge groups
+ * of runs into a new spill file until one final merge is possible.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "extsort.h"
+#include "vecio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_MEMORY ((size_t)64 << 20)
+#define DEFAULT_BUFFER ((size_t)1 << 20)
+
+static void *alloc_aligned(size_t size)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    void *p = NULL;
+    int rc = posix_memalign(&p, page > 0 ? (size_t)page : 4096, size > 0 ? size : 1);
+    if (rc != 0)
+    {
+        errno = rc;
+        return NULL;
+    }
+    return p;
+}
+
+// Anonymous spill file: the name is removed as soon as it exists
+static int open_workspace(const char *dir)
+{
+    if (dir != NULL)
+    {
+        char path[4096];
+        int len = snprintf(path, sizeof(path), "%s/extsort_XXXXXX", dir);
+        if (len < 0 || (size_t)len >= sizeof(path))
+        {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        int fd = mkstemp(path);
+        if (fd >= 0)
+        {
+            unlink(path);
+        }
+        return fd;
+    }
+
+    FILE *tmp = tmpfile();
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    int fd = dup(fileno(tmp)); // keeps the file alive after fclose()
+    int saved = errno;
+    fclose(tmp);
+    errno = saved;
+    return fd;
+}
+
+// ============================================================================
+// Buffered output
+// ============================================================================
+
+typedef struct
+{
+    int fd;
+    char *buf;
+    size_t cap;
+    size_t used;
+    off_t written; // bytes flushed to fd so far
+} Writer;
+
+static int writer_flush(Writer *w)
+{
+    if (w->used > 0)
+    {
+        if (vio_write_all(w->fd, w->buf, w->used) != 0)
+        {
+            return -1;
+        }
+        w->written += (off_t)w->used;
+        w->used = 0;
+    }
+    return 0;
+}
+
+static int writer_put(Writer *w, const void *rec, size_t size)
+{
+    if (w->cap - w->used < size && writer_flush(w) != 0)
+    {
+        return -1;
+    }
+    memcpy(w->buf + w->used, rec, size);
+    w->used += size;
+    return 0;
+}
+
+static void writer_reset(Writer *w, int fd)
+{
+    w->fd = fd;
+    w->used = 0;
+    w->written = 0;
+}
+
+// ============================================================================
+// Merge sources and the loser tree
+// ============================================================================
+
+typedef struct
+{
+    off_t offset;
+    off_t length;
+} Run;
+
+// A stream of sorted records: a memory slice (buf == NULL) or a file run
+typedef struct
+{
+    const char *cur;
+    const char *end; // cur == end after refill: exhausted
+    char *buf;
+    size_t buf_size;
+    int fd;
+    off_t next;
+    off_t stop;
+} Source;
+
+static void source_memory(Source *s, const char *base, size_t bytes)
+{
+    s->cur = base;
+    s->end = base + bytes;
+    s->buf = NULL;
+}
+
+static int source_refill(Source *s)
+{
+    if (s->buf == NULL || s->next >= s->stop)
+    {
+        s->cur = s->end;
+        return 0;
+    }
+
+    size_t want = s->buf_size;
+    if ((off_t)want > s->stop - s->next)
+    {
+        want = (size_t)(s->stop - s->next);
+    }
+    ssize_t got = vio_pread_full(s->fd, s->buf, want, s->next);
+    if (got < 0)
+    {
+        return -1;
+    }
+    if ((size_t)got != want)
+    {
+        errno = EIO; // spill file shorter than what we wrote
+        return -1;
+    }
+    s->cur = s->buf;
+    s->end = s->buf + got;
+    s->next += got;
+    return 0;
+}
+
+static int source_file(Source *s, char *buf, size_t buf_size, int fd, Run run)
+{
+    s->buf = buf;
+    s->buf_size = buf_size;
+    s->fd = fd;
+    s->next = run.offset;
+    s->stop = run.offset + run.length;
+    s->cur = s->end = buf;
+    return source_refill(s);
+}
+
+typedef struct
+{
+    Source *src;
+    size_t k;
+    size_t *tree; // tree[0] = winner, tree[1..k-1] = loser at each node
+    size_t record_size;
+    ExtSortCompare compare;
+    void *ctx;
+} LoserTree;
+
+// Does source a come before source b? Exhausted sources lose to anything.
+static bool beats(const LoserTree *t, size_t a, size_t b)
+{
+    const Source *sa = &t->src[a];
+    const Source *sb = &t->src[b];
+    if (sa->cur == sa->end)
+    {
+        return false;
+    }
+    if (sb->cur == sb->end)
+    {
+        return true;
+    }
+    int c = t->compare(sa->cur, sb->cur, t->ctx);
+    return c < 0 || (c == 0 && a < b);
+}
+
+// Nodes 1..k-1 are internal, node k+i is leaf i; returns the subtree winner
+static size_t build(LoserTree *t, size_t node)
+{
+    if (node >= t->k)
+    {
+        return node - t->k;
+    }
+    size_t a = build(t, 2 * node);
+    size_t b = build(t, 2 * node + 1);
+    if (beats(t, b, a))
+    {
+        t->tree[node] = a;
+        return b;
+    }
+    t->tree[node] = b;
+    return a;
+}
+
+static int merge_sources(Source *src, size_t k, const ExtSortConfig *cfg, Writer *out)
+{
+    if (k == 0)
+    {
+        return 0;
+    }
+
+    LoserTree t = {src, k, malloc(k * sizeof(size_t)), cfg->record_size, cfg->compare, cfg->ctx};
+    if (t.tree == NULL)
+    {
+        return -1;
+    }
+    t.tree[0] = (k == 1) ? 0 : build(&t, 1);
+
+    const size_t size = t.record_size;
+    for (;;)
+    {
+        size_t w = t.tree[0];
+        Source *s = &src[w];
+        if (s->cur == s->end)
+        {
+            break; // the winner is exhausted, so all are
+        }
+        if (writer_put(out, s->cur, size) != 0)
+        {
+            free(t.tree);
+            return -1;
+        }
+        s->cur += size;
+        if (s->cur == s->end && source_refill(s) != 0)
+        {
+            free(t.tree);
+            return -1;
+        }
+
+        // Replay the path from leaf w to the root
+        for (size_t node = (w + k) / 2; node >= 1; node /= 2)
+        {
+            if (beats(&t, t.tree[node], w))
+            {
+                size_t loser = w;
+                w = t.tree[node];
+                t.tree[node] = loser;
+            }
+        }
+        t.tree[0] = w;
+    }
+
+    free(t.tree);
+    return 0;
+}
+
+// ============================================================================
+// Parallel run formation
+// ============================================================================
+
+typedef struct
+{
+    char *base;
+    size_t count;
+    const ExtSortConfig *cfg;
+} SortJob;
+
+// qsort() has no context argument, so each sorting thread keeps its own
+static _Thread_local const SortJob *current_job;
+
+static int job_compare(const void *a, const void *b)
+{
+    return current_job->cfg->compare(a, b, current_job->cfg->ctx);
+}
+
+static void *sort_job(void *arg)
+{
+    const SortJob *job = arg;
+    current_job = job;
+    qsort(job->base, job->count, job->cfg->record_size, job_compare);
+    return NULL;
+}
+
+// Sort n records at buf in slices, then merge the slices into out
+static int sort_run(char *buf, size_t n, const ExtSortConfig *cfg, Writer *out)
+{
+    size_t slices = cfg->threads < n ? cfg->threads : n;
+    if (slices == 0)
+    {
+        slices = 1;
+    }
+
+    SortJob *jobs = malloc(slices * sizeof(SortJob));
+    pthread_t *threads = malloc(slices * sizeof(pthread_t));
+    bool *started = calloc(slices, sizeof(bool));
+    Source *src = malloc(slices * sizeof(Source));
+    int rc = -1;
+    if (!jobs || !threads || !started || !src)
+    {
+        goto done;
+    }
+
+    for (size_t i = 0; i < slices; i++)
+    {
+        size_t first = n / slices * i + (i < n % slices ? i : n % slices);
+        size_t count = n / slices + (i < n % slices ? 1 : 0);
+        jobs[i] = (SortJob){buf + first * cfg->record_size, count, cfg};
+    }
+
+    // Slice 0 is sorted on this thread; a failed pthread_create() also falls back to it
+    for (size_t i = 1; i < slices; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, sort_job, &jobs[i]) == 0;
+    }
+    sort_job(&jobs[0]);
+    for (size_t i = 1; i < slices; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            sort_job(&jobs[i]);
+        }
+    }
+
+    for (size_t i = 0; i < slices; i++)
+    {
+        source_memory(&src[i], jobs[i].base, jobs[i].count * cfg->record_size);
+    }
+    rc = merge_sources(src, slices, cfg, out);
+
+done:
+    free(jobs);
+    free(threads);
+    free(started);
+    free(src);
+    return rc;
+}
+
+// ============================================================================
+// Driver
+// ============================================================================
+
+static int add_run(Run **runs, size_t *count, size_t *cap, Run run)
+{
+    if (*count == *cap)
+    {
+        size_t new_cap = *cap ? *cap * 2 : 16;
+        Run *grown = realloc(*runs, new_cap * sizeof(Run));
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        *runs = grown;
+        *cap = new_cap;
+    }
+    (*runs)[(*count)++] = run;
+    return 0;
+}
+
+// Merge runs[0..k) from work into out; each source gets one read buffer
+static int merge_runs(const Run *runs, size_t k, int work, char **bufs, size_t buf_size,
+                      Source *src, const ExtSortConfig *cfg, Writer *out)
+{
+    for (size_t i = 0; i < k; i++)
+    {
+        if (source_file(&src[i], bufs[i], buf_size, work, runs[i]) != 0)
+        {
+            return -1;
+        }
+    }
+    if (merge_sources(src, k, cfg, out) != 0)
+    {
+        return -1;
+    }
+    return writer_flush(out);
+}
+
+int extsort_fd(int in_fd, int out_fd, const ExtSortConfig *config, ExtSortStats *stats)
+{
+    if (config == NULL || config->record_size == 0 || config->compare == NULL)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ExtSortConfig cfg = *config;
+    cfg.memory_limit = cfg.memory_limit ? cfg.memory_limit : DEFAULT_MEMORY;
+    cfg.buffer_size = cfg.buffer_size ? cfg.buffer_size : DEFAULT_BUFFER;
+    cfg.threads = cfg.threads ? cfg.threads : 1;
+
+    const size_t rsize = cfg.record_size;
+    size_t chunk_records = cfg.memory_limit / rsize;
+    chunk_records = chunk_records ? chunk_records : 1;
+    size_t buf_records = cfg.buffer_size / rsize;
+    const size_t buf_size = (buf_records ? buf_records : 1) * rsize;
+    const size_t chunk_size = chunk_records * rsize;
+
+    // Enough read buffers to fill the memory budget, at least two
+    size_t fan_in = cfg.memory_limit / buf_size;
+    fan_in = fan_in >= 2 ? fan_in : 2;
+
+    ExtSortStats st = {0, 0, 0, 0};
+    Writer w = {-1, alloc_aligned(buf_size), buf_size, 0, 0};
+    char *chunk = alloc_aligned(chunk_size);
+    Run *runs = NULL;
+    Run *next_runs = NULL;
+    size_t nruns = 0, runs_cap = 0;
+    char **bufs = NULL;
+    size_t nbufs = 0;
+    Source *src = NULL;
+    int work = -1;
+    int rc = -1;
+
+    if (w.buf == NULL || chunk == NULL)
+    {
+        goto done;
+    }
+
+    // Phase 1: sorted runs
+    for (;;)
+    {
+        ssize_t got = vio_read_full(in_fd, chunk, chunk_size);
+        if (got < 0)
+        {
+            goto done;
+        }
+        if ((size_t)got % rsize != 0)
+        {
+            errno = EINVAL;
+            goto done;
+        }
+        size_t n = (size_t)got / rsize;
+        bool last = (size_t)got < chunk_size;
+        if (n == 0)
+        {
+            break;
+        }
+        st.records += n;
+
+        if (last && nruns == 0)
+        {
+            // Everything fitted in memory: no spill file at all
+            writer_reset(&w, out_fd);
+            if (sort_run(chunk, n, &cfg, &w) != 0 || writer_flush(&w) != 0)
+            {
+                goto done;
+            }
+            rc = 0;
+            goto done;
+        }
+
+        if (work < 0)
+        {
+            work = open_workspace(cfg.temp_dir);
+            if (work < 0)
+            {
+                goto done;
+            }
+            writer_reset(&w, work);
+        }
+        off_t start = w.written;
+        if (sort_run(chunk, n, &cfg, &w) != 0 || writer_flush(&w) != 0 ||
+            add_run(&runs, &nruns, &runs_cap, (Run){start, w.written - start}) != 0)
+        {
+            goto done;
+        }
+        st.runs++;
+        st.bytes_spilled += (unsigned long long)(w.written - start);
+        if (last)
+        {
+            break;
+        }
+    }
+
+    // The run buffer is no longer needed; its memory goes to read buffers
+    free(chunk);
+    chunk = NULL;
+
+    nbufs = nruns < fan_in ? nruns : fan_in;
+    bufs = calloc(nbufs ? nbufs : 1, sizeof(char *));
+    src = malloc((nbufs ? nbufs : 1) * sizeof(Source));
+    if (bufs == NULL || src == NULL)
+    {
+        goto done;
+    }
+    for (size_t i = 0; i < nbufs; i++)
+    {
+        if ((bufs[i] = alloc_aligned(buf_size)) == NULL)
+        {
+            goto done;
+        }
+    }
+
+    // Phase 2: intermediate passes while one merge cannot take every run
+    while (nruns > fan_in)
+    {
+        int next_work = open_workspace(cfg.temp_dir);
+        size_t next_count = 0, next_cap = 0;
+        if (next_work < 0)
+        {
+            goto done;
+        }
+        writer_reset(&w, next_work);
+
+        for (size_t g = 0; g < nruns; g += fan_in)
+        {
+            size_t k = nruns - g < fan_in ? nruns - g : fan_in;
+            off_t start = w.written;
+            if (merge_runs(runs + g, k, work, bufs, buf_size, src, &cfg, &w) != 0 ||
+                add_run(&next_runs, &next_count, &next_cap, (Run){start, w.written - start}) != 0)
+            {
+                close(next_work);
+                goto done;
+            }
+        }
+
+        st.merge_passes++;
+        st.bytes_spilled += (unsigned long long)w.written;
+        close(work);
+        work = next_work;
+        free(runs);
+        runs = next_runs;
+        next_runs = NULL;
+        nruns = next_count;
+    }
+
+    // Phase 3: final merge into the output
+    writer_reset(&w, out_fd);
+    if (merge_runs(runs, nruns, work, bufs, buf_size, src, &cfg, &w) != 0)
+    {
+        goto done;
+    }
+    rc = 0;
+
+done:
+    {
+        int saved = errno;
+        if (bufs != NULL)
+        {
+            for (size_t i = 0; i < nbufs; i++)
+            {
+                free(bufs[i]);
+            }
+        }
+        free(bufs);
+        free(src);
+        free(runs);
+        free(next_runs);
+        free(chunk);
+        free(w.buf);
+        if (work >= 0)
+        {
+            close(work);
+        }
+        if (rc == 0 && stats != NULL)
+        {
+            *stats = st;
+        }
+        errno = saved;
+    }
+    return rc;
+}
+
+int extsort_path(const char *in_path, const char *out_path,
+                 const ExtSortConfig *cfg, ExtSortStats *stats)
+{
+    int in = open(in_path, O_RDONLY);
+    if (in < 0)
+    {
+        return -1;
+    }
+    int out = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0)
+    {
+        int saved = errno;
+        close(in);
+        errno = saved;
+        return -1;
+    }
+
+    int rc = extsort_fd(in, out, cfg, stats);
+    int saved = errno;
+    close(in);
+    if (close(out) != 0 && rc == 0)
+    {
+        return -1;
+    }
+    errno = saved;
+    return rc;
+}
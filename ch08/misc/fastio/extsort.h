@@ -0,0 +1,52 @@
+/*
+ * Fast I/O - extsort.h
+ *
+ * External merge sort for fixed-width binary records. This is the full
+ * version of the "tmpfile() as a sorting workspace" idea from Test 6 of
+ * ch08/listings/temp_files.c.
+ *
+ * Input larger than the memory budget is cut into runs. Each run is
+ * sorted in parallel slices, merged, and spilled to an anonymous
+ * temporary file (mkstemp() + unlink(), or tmpfile()). The runs are then
+ * k-way merged through a loser tree. Each run is read sequentially
+ * through its own large page-aligned buffer, so the only I/O is long
+ * sequential reads and writes, however large the input is.
+ */
+
+#ifndef FASTIO_EXTSORT_H
+#define FASTIO_EXTSORT_H
+
+#include <stddef.h>
+
+// Returns <0, 0 or >0 like the qsort() comparator, plus a user pointer
+typedef int (*ExtSortCompare)(const void *a, const void *b, void *ctx);
+
+typedef struct
+{
+    size_t record_size;     // bytes per record (required)
+    ExtSortCompare compare; // record ordering (required)
+    void *ctx;              // passed to compare
+    size_t memory_limit;    // bytes sorted in memory at once (0 = 64 MiB)
+    size_t buffer_size;     // read buffer per run while merging (0 = 1 MiB)
+    unsigned threads;       // threads sorting each run (0 = 1)
+    const char *temp_dir;   // directory for spill files (NULL = tmpfile())
+} ExtSortConfig;
+
+typedef struct
+{
+    size_t records;                   // records sorted
+    size_t runs;                      // runs spilled during run formation
+    size_t merge_passes;              // intermediate merge passes
+    unsigned long long bytes_spilled; // bytes written to temporary files
+} ExtSortStats;
+
+// Sort the records read from in_fd (until EOF) and write them to out_fd.
+// Returns 0 on success, -1 with errno set on failure (EINVAL if the input
+// is not a whole number of records). stats may be NULL.
+int extsort_fd(int in_fd, int out_fd, const ExtSortConfig *cfg, ExtSortStats *stats);
+
+// Same, opening in_path for reading and creating/truncating out_path
+int extsort_path(const char *in_path, const char *out_path,
+                 const ExtSortConfig *cfg, ExtSortStats *stats);
+
+#endif /* FASTIO_EXTSORT_H */
@@ -0,0 +1,263 @@
+/*
+ * Fast I/O - extsort_main.c
+ *
+ * Demonstrates the external merge sort: the eight integers from Test 6
+ * of ch08/listings/temp_files.c, then datasets many times larger than the
+ * memory budget, checked for order and for a lost or duplicated record.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "extsort.h"
+
+#define RECORD_SIZE 100 // 10-byte key + 90-byte payload, as in the sort benchmarks
+#define KEY_SIZE 10
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_int(const void *a, const void *b, void *ctx)
+{
+    (void)ctx;
+    int x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+static int compare_key(const void *a, const void *b, void *ctx)
+{
+    (void)ctx;
+    return memcmp(a, b, KEY_SIZE);
+}
+
+// Order-independent fingerprint of a record multiset
+static uint64_t record_hash(const unsigned char *rec)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < RECORD_SIZE; i++)
+    {
+        h = (h ^ rec[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Write `count` random records to a new temp file; returns its fd
+static int make_dataset(size_t count, unsigned seed, uint64_t *sum)
+{
+    FILE *tmp = tmpfile();
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+
+    unsigned char rec[RECORD_SIZE];
+    *sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t b = 0; b < RECORD_SIZE; b++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            rec[b] = (unsigned char)(b < KEY_SIZE ? ' ' + (seed >> 16) % 95 : 'a' + (seed >> 16) % 26);
+        }
+        *sum += record_hash(rec);
+        fwrite(rec, RECORD_SIZE, 1, tmp);
+    }
+    fflush(tmp);
+    int fd = dup(fileno(tmp));
+    fclose(tmp);
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+// Read fd from the start: sorted by key, same record count and fingerprint?
+static int verify_sorted(int fd, size_t count, uint64_t sum)
+{
+    FILE *in = fdopen(dup(fd), "rb");
+    if (in == NULL)
+    {
+        return 0;
+    }
+    fseek(in, 0, SEEK_SET);
+
+    unsigned char prev[RECORD_SIZE], rec[RECORD_SIZE];
+    size_t n = 0;
+    uint64_t got = 0;
+    int ordered = 1;
+    while (fread(rec, RECORD_SIZE, 1, in) == 1)
+    {
+        if (n > 0 && memcmp(prev, rec, KEY_SIZE) > 0)
+        {
+            ordered = 0;
+        }
+        got += record_hash(rec);
+        memcpy(prev, rec, RECORD_SIZE);
+        n++;
+    }
+    fclose(in);
+    return ordered && n == count && got == sum;
+}
+
+// Sort `count` records under the given budget and report the result
+static void sort_dataset(const char *label, size_t count, ExtSortConfig cfg)
+{
+    uint64_t sum;
+    int in = make_dataset(count, 2024, &sum);
+    FILE *out_tmp = tmpfile();
+    if (in < 0 || out_tmp == NULL)
+    {
+        perror("  ✗ temp file");
+        failures++;
+        return;
+    }
+    int out = fileno(out_tmp);
+
+    ExtSortStats st;
+    double t0 = now_seconds();
+    int rc = extsort_fd(in, out, &cfg, &st);
+    double elapsed = now_seconds() - t0;
+    if (rc != 0)
+    {
+        printf("  ✗ %s: extsort_fd failed: %s\n", label, strerror(errno));
+        failures++;
+    }
+    else
+    {
+        double mb = (double)count * RECORD_SIZE / 1e6;
+        printf("  %s: %.0f MB, budget %zu KiB, %u thread(s)\n", label, mb,
+               cfg.memory_limit >> 10, cfg.threads ? cfg.threads : 1);
+        printf("    runs %zu, merge passes %zu, spilled %.0f MB, %.1f MB/s\n", st.runs,
+               st.merge_passes, (double)st.bytes_spilled / 1e6, mb / elapsed);
+        check(verify_sorted(out, count, sum), "output sorted, no record lost or duplicated");
+    }
+    close(in);
+    fclose(out_tmp);
+}
+
+int main(void)
+{
+    printf("=== External Merge Sort ===\n\n");
+
+    // Test 1: The temp_files.c example, forced through several runs
+    printf("Test 1: Sorting the temp_files.c integers in 3-record runs\n");
+    {
+        int data[] = {42, 17, 93, 24, 56, 81, 33, 69};
+        size_t count = sizeof(data) / sizeof(data[0]);
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+        if (in == NULL || out == NULL)
+        {
+            perror("  ✗ tmpfile failed");
+            return EXIT_FAILURE;
+        }
+        fwrite(data, sizeof(int), count, in);
+        fflush(in);
+        rewind(in);
+
+        ExtSortConfig cfg = {sizeof(int), compare_int, NULL, 3 * sizeof(int), sizeof(int), 1, NULL};
+        ExtSortStats st;
+        int rc = extsort_fd(fileno(in), fileno(out), &cfg, &st);
+
+        int sorted[8] = {0};
+        rewind(out);
+        size_t got = fread(sorted, sizeof(int), count, out);
+        printf("  Runs: %zu, merge passes: %zu\n", st.runs, st.merge_passes);
+        printf("  Sorted: ");
+        int ok = rc == 0 && got == count;
+        for (size_t i = 0; i < got; i++)
+        {
+            printf("%d ", sorted[i]);
+            ok = ok && (i == 0 || sorted[i - 1] <= sorted[i]);
+        }
+        printf("\n");
+        check(ok, "eight integers in order");
+        fclose(in);
+        fclose(out);
+    }
+    printf("\n");
+
+    // Test 2: Input that fits in memory never touches a spill file
+    printf("Test 2: Input smaller than the budget\n");
+    {
+        ExtSortConfig cfg = {RECORD_SIZE, compare_key, NULL, (size_t)16 << 20, 0, 2, NULL};
+        sort_dataset("in memory", 50000, cfg);
+    }
+    printf("\n");
+
+    // Test 3: Many times the budget, one final merge
+    printf("Test 3: 40x the memory budget\n");
+    {
+        ExtSortConfig cfg = {RECORD_SIZE, compare_key, NULL, (size_t)1 << 20, (size_t)64 << 10, 4, "/tmp"};
+        sort_dataset("mkstemp runs", 400000, cfg);
+    }
+    printf("\n");
+
+    // Test 4: More runs than read buffers: intermediate merge passes
+    printf("Test 4: Tiny budget forcing multi-pass merging\n");
+    {
+        ExtSortConfig cfg = {RECORD_SIZE, compare_key, NULL, (size_t)64 << 10, (size_t)16 << 10, 2, NULL};
+        sort_dataset("4-way passes", 100000, cfg);
+    }
+    printf("\n");
+
+    // Test 5: Bad input is rejected
+    printf("Test 5: Error handling\n");
+    {
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+        if (in == NULL || out == NULL)
+        {
+            perror("  ✗ tmpfile failed");
+            return EXIT_FAILURE;
+        }
+        fputs("not a multiple of four", in); // 22 bytes
+        fflush(in);
+        rewind(in);
+
+        ExtSortConfig cfg = {sizeof(int), compare_int, NULL, 0, 0, 0, NULL};
+        int rc = extsort_fd(fileno(in), fileno(out), &cfg, NULL);
+        check(rc == -1 && errno == EINVAL, "partial record gives EINVAL");
+
+        ExtSortConfig no_compare = {sizeof(int), NULL, NULL, 0, 0, 0, NULL};
+        rc = extsort_fd(fileno(in), fileno(out), &no_compare, NULL);
+        check(rc == -1 && errno == EINVAL, "missing comparator gives EINVAL");
+        fclose(in);
+        fclose(out);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Memory use is bounded by memory_limit, not by the input size\n");
+    printf("2. Spill files are unlinked at once and vanish even after a crash\n");
+    printf("3. Every read and write is sequential, in buffer_size pieces\n");
+    printf("4. A loser tree costs ~log2(k) comparisons per record\n");
+    printf("5. Fewer, longer runs (more memory) mean fewer merge passes\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,319 @@
+/*
+ * Fast I/O - groupcommit.c
+ *
+ * Implementation of the group-commit writer.
+ *
+ * Two buffers: appenders copy into the active one under the lock while
+ * the writer thread, without the lock, writes and syncs the other. When a
+ * commit starts the buffers are swapped, so appenders only ever wait when
+ * the active buffer is completely full.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "groupcommit.h"
+#include "vecio.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_BUFFER ((size_t)1 << 20)
+
+struct GroupCommit
+{
+    int fd;
+    GcConfig cfg;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work;    // writer: records pending, flush requested, closing
+    pthread_cond_t space;   // appenders: the active buffer has room again
+    pthread_cond_t durable; // waiters: durable_lsn moved
+    pthread_t writer;
+
+    char *active;
+    size_t fill;
+    size_t batch_records;
+    struct timespec batch_start; // when the first pending record arrived
+    char *spare;
+
+    uint64_t appended_lsn;
+    uint64_t durable_lsn;
+    uint64_t requested_lsn; // gc_flush() wants everything up to here now
+    unsigned space_waiters;
+    bool closing;
+    int error; // sticky errno of the first failed write or sync
+    GcStats stats;
+};
+
+static int sync_fd(int fd, GcSync mode)
+{
+    int rc = 0;
+    if (mode == GC_FDATASYNC)
+    {
+        rc = fdatasync(fd);
+    }
+    else if (mode == GC_FSYNC)
+    {
+        rc = fsync(fd);
+    }
+    return rc == 0 ? 0 : errno;
+}
+
+static bool before(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void *writer_main(void *arg)
+{
+    GroupCommit *g = arg;
+
+    pthread_mutex_lock(&g->lock);
+    for (;;)
+    {
+        while (g->fill == 0 && !g->closing)
+        {
+            pthread_cond_wait(&g->work, &g->lock);
+        }
+        if (g->fill == 0)
+        {
+            break;
+        }
+        if (g->error != 0)
+        {
+            // Nothing more reaches the file after a failure
+            g->fill = 0;
+            g->batch_records = 0;
+            pthread_cond_broadcast(&g->space);
+            continue;
+        }
+
+        bool by_size = g->fill >= g->cfg.commit_bytes || g->space_waiters > 0;
+        bool urgent = g->closing || g->requested_lsn > g->durable_lsn;
+        bool by_deadline = false;
+        if (!by_size && !urgent && g->cfg.max_delay_us > 0)
+        {
+            struct timespec deadline = g->batch_start;
+            struct timespec now;
+            deadline.tv_nsec += (long)(g->cfg.max_delay_us % 1000000) * 1000;
+            deadline.tv_sec += g->cfg.max_delay_us / 1000000 + deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (before(&now, &deadline))
+            {
+                pthread_cond_timedwait(&g->work, &g->lock, &deadline);
+                continue; // re-check everything
+            }
+            by_deadline = true;
+        }
+
+        char *buf = g->active;
+        size_t len = g->fill;
+        size_t records = g->batch_records;
+        uint64_t end = g->appended_lsn;
+        g->active = g->spare;
+        g->spare = buf;
+        g->fill = 0;
+        g->batch_records = 0;
+        g->stats.size_commits += by_size;
+        g->stats.deadline_commits += by_deadline;
+        pthread_cond_broadcast(&g->space);
+        pthread_mutex_unlock(&g->lock);
+
+        int err = vio_write_all(g->fd, buf, len) == 0 ? 0 : errno;
+        if (err == 0)
+        {
+            err = sync_fd(g->fd, g->cfg.sync);
+        }
+
+        pthread_mutex_lock(&g->lock);
+        if (err != 0)
+        {
+            g->error = err;
+        }
+        else
+        {
+            g->durable_lsn = end;
+        }
+        g->stats.batches++;
+        if (records > g->stats.largest_batch)
+        {
+            g->stats.largest_batch = records;
+        }
+        pthread_cond_broadcast(&g->durable);
+    }
+    pthread_mutex_unlock(&g->lock);
+    return NULL;
+}
+
+GroupCommit *gc_open(int fd, const GcConfig *cfg)
+{
+    GroupCommit *g = calloc(1, sizeof(GroupCommit));
+    if (g == NULL)
+    {
+        return NULL;
+    }
+    if (cfg != NULL)
+    {
+        g->cfg = *cfg;
+    }
+    if (g->cfg.buffer_size == 0)
+    {
+        g->cfg.buffer_size = DEFAULT_BUFFER;
+    }
+    if (g->cfg.commit_bytes == 0 || g->cfg.commit_bytes > g->cfg.buffer_size)
+    {
+        g->cfg.commit_bytes = g->cfg.buffer_size / 2 ? g->cfg.buffer_size / 2 : 1;
+    }
+    g->fd = fd;
+    g->active = malloc(g->cfg.buffer_size);
+    g->spare = malloc(g->cfg.buffer_size);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC); // same clock as batch_start
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->work, &attr);
+    pthread_cond_init(&g->space, NULL);
+    pthread_cond_init(&g->durable, NULL);
+    pthread_condattr_destroy(&attr);
+
+    int err = (g->active == NULL || g->spare == NULL) ? ENOMEM : 0;
+    if (err == 0)
+    {
+        err = pthread_create(&g->writer, NULL, writer_main, g);
+    }
+    if (err != 0)
+    {
+        pthread_mutex_destroy(&g->lock);
+        pthread_cond_destroy(&g->work);
+        pthread_cond_destroy(&g->space);
+        pthread_cond_destroy(&g->durable);
+        free(g->active);
+        free(g->spare);
+        free(g);
+        errno = err;
+        return NULL;
+    }
+    return g;
+}
+
+int gc_submit(GroupCommit *g, const void *record, size_t len, uint64_t *lsn)
+{
+    if (len > g->cfg.buffer_size)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    pthread_mutex_lock(&g->lock);
+    while (g->error == 0 && g->fill + len > g->cfg.buffer_size)
+    {
+        g->space_waiters++;
+        pthread_cond_signal(&g->work);
+        pthread_cond_wait(&g->space, &g->lock);
+        g->space_waiters--;
+    }
+    if (g->error != 0)
+    {
+        int err = g->error;
+        pthread_mutex_unlock(&g->lock);
+        errno = err;
+        return -1;
+    }
+
+    if (g->fill == 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &g->batch_start);
+    }
+    memcpy(g->active + g->fill, record, len);
+    g->fill += len;
+    g->batch_records++;
+    g->appended_lsn += len;
+    g->stats.records++;
+    g->stats.bytes += len;
+    if (lsn != NULL)
+    {
+        *lsn = g->appended_lsn;
+    }
+    // The writer only needs waking for a new batch or a full one
+    if (g->batch_records == 1 || g->fill >= g->cfg.commit_bytes)
+    {
+        pthread_cond_signal(&g->work);
+    }
+    pthread_mutex_unlock(&g->lock);
+    return 0;
+}
+
+int gc_wait(GroupCommit *g, uint64_t lsn)
+{
+    pthread_mutex_lock(&g->lock);
+    while (g->durable_lsn < lsn && g->error == 0)
+    {
+        pthread_cond_wait(&g->durable, &g->lock);
+    }
+    int err = g->durable_lsn < lsn ? g->error : 0;
+    pthread_mutex_unlock(&g->lock);
+    if (err != 0)
+    {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+int gc_append(GroupCommit *g, const void *record, size_t len)
+{
+    uint64_t lsn;
+    if (gc_submit(g, record, len, &lsn) != 0)
+    {
+        return -1;
+    }
+    return gc_wait(g, lsn);
+}
+
+int gc_flush(GroupCommit *g)
+{
+    pthread_mutex_lock(&g->lock);
+    uint64_t target = g->appended_lsn;
+    g->requested_lsn = target;
+    pthread_cond_signal(&g->work);
+    pthread_mutex_unlock(&g->lock);
+    return gc_wait(g, target);
+}
+
+int gc_close(GroupCommit *g, GcStats *final)
+{
+    if (g == NULL)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&g->lock);
+    g->closing = true;
+    pthread_cond_signal(&g->work);
+    pthread_mutex_unlock(&g->lock);
+    pthread_join(g->writer, NULL);
+
+    int err = g->error;
+    if (final != NULL)
+    {
+        *final = g->stats;
+    }
+    pthread_mutex_destroy(&g->lock);
+    pthread_cond_destroy(&g->work);
+    pthread_cond_destroy(&g->space);
+    pthread_cond_destroy(&g->durable);
+    free(g->active);
+    free(g->spare);
+    free(g);
+    if (err != 0)
+    {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * Fast I/O - groupcommit.h
+ *
+ * Group-commit writer for append-only logs.
+ *
+ * ch08/misc/fflush_examples.c flushes after every logical write, and a log
+ * that must survive a crash also needs fsync() each time: one disk sync
+ * per record, a few thousand records per second at best. Here threads
+ * append records to one shared buffer. A background thread writes the
+ * buffer and calls fdatasync() once the batch reaches commit_bytes or its
+ * oldest record has waited max_delay_us. That one sync then wakes every
+ * thread whose record was in the batch.
+ *
+ * Positions in the log are byte offsets (LSNs): gc_submit() returns the
+ * LSN just past the record, and gc_wait() returns once everything up to
+ * that LSN is on disk.
+ *
+ * Functions return 0, or -1 with errno set. After a failed write or sync
+ * every later call fails with the same errno: records past the failure
+ * may or may not be on disk.
+ */
+
+#ifndef FASTIO_GROUPCOMMIT_H
+#define FASTIO_GROUPCOMMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+    GC_FDATASYNC, // data and the metadata needed to read it back (default)
+    GC_FSYNC,     // data and all metadata
+    GC_NO_SYNC    // write() only: batching without durability
+} GcSync;
+
+typedef struct
+{
+    size_t buffer_size;    // capacity of each of the two buffers (0 = 1 MiB)
+    size_t commit_bytes;   // commit once this much is pending (0 = buffer_size / 2)
+    unsigned max_delay_us; // longest a record waits for more to join its batch
+    GcSync sync;
+} GcConfig;
+
+typedef struct
+{
+    unsigned long long records;
+    unsigned long long bytes;
+    unsigned long long batches;           // write()+sync rounds
+    unsigned long long largest_batch;     // records in the biggest batch
+    unsigned long long size_commits;      // batches started by commit_bytes
+    unsigned long long deadline_commits;  // batches started by max_delay_us
+} GcStats;
+
+typedef struct GroupCommit GroupCommit;
+
+// Start a writer appending to fd (not closed by gc_close()). cfg may be
+// NULL for the defaults; max_delay_us 0 commits as soon as the previous
+// sync returns, so batches form only while a sync is in flight.
+GroupCommit *gc_open(int fd, const GcConfig *cfg);
+
+// Copy a record into the shared buffer and return without waiting. *lsn
+// (if not NULL) receives the LSN to pass to gc_wait(). Records larger
+// than buffer_size fail with EMSGSIZE.
+int gc_submit(GroupCommit *g, const void *record, size_t len, uint64_t *lsn);
+
+// Wait until the log is durable up to lsn
+int gc_wait(GroupCommit *g, uint64_t lsn);
+
+// gc_submit() then gc_wait(): returns once this record is on disk
+int gc_append(GroupCommit *g, const void *record, size_t len);
+
+// Commit everything submitted so far without waiting for the thresholds
+int gc_flush(GroupCommit *g);
+
+// Commit what is pending and stop the writer. final (if not NULL)
+// receives the counters. Returns -1 if any write or sync failed.
+int gc_close(GroupCommit *g, GcStats *final);
+
+#endif /* FASTIO_GROUPCOMMIT_H */
@@ -0,0 +1,525 @@
+/*
+ * Fast I/O - io_bench.c
+ *
+ * I/O benchmark suite: the stdio loops from ch08/listings against the
+ * fastio modules, on the same generated text file.
+ *
+ * Line reading: fgetc() (read_write_chars.c Test 9), fgets() into a
+ * fixed buffer (Test 10), POSIX getline(), lr_next() and lr_next_batch().
+ * Every reader must count the same number of lines.
+ *
+ * Character loops: the same file uppercased into /dev/null with
+ * fgetc()/fputc() (Test 3), getc()/putc() (Test 4), one locked region with
+ * getc_unlocked()/putc_unlocked(), fio_filter() and fio_translate().
+ * Every loop must write the same number of bytes.
+ *
+ * Record writes: every line of the file framed as header + line + '\n'
+ * and written to /dev/null with one write() per field (posix_io.c
+ * Test 2), fwrite() per field, one writev() per record, and VioBatch.
+ *
+ * Usage: ./io_bench [size_mb]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include "linereader.h"
+#include "unlocked_io.h"
+#include "vecio.h"
+
+typedef struct
+{
+    const char *name;
+    size_t (*run)(const char *path); // returns the number of lines or bytes
+} BenchCase;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Text with line lengths from 0 to ~160 bytes and a few 20 KB lines
+static int write_text(const char *path, size_t bytes)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    unsigned seed = 99;
+    size_t written = 0;
+    while (written < bytes)
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = seed >> 8;
+        size_t len = (r % 1000 == 0) ? 20000 : r % 160;
+        for (size_t i = 0; i < len; i++)
+        {
+            fputc('a' + (int)((r + i * 7) % 26), fp);
+        }
+        fputc('\n', fp);
+        written += len + 1;
+    }
+    return fclose(fp);
+}
+
+// ============================================================================
+// Line reading
+// ============================================================================
+
+static size_t lines_fgetc(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    size_t lines = 0;
+    int ch;
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    while ((ch = fgetc(fp)) != EOF)
+    {
+        lines += (ch == '\n');
+    }
+    fclose(fp);
+    return lines;
+}
+
+// A long line comes back in several pieces; only pieces ending in '\n' count
+static size_t lines_fgets(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char buffer[4096];
+    size_t lines = 0;
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        size_t len = strlen(buffer);
+        lines += (len > 0 && buffer[len - 1] == '\n');
+    }
+    fclose(fp);
+    return lines;
+}
+
+static size_t lines_getline(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char *line = NULL;
+    size_t cap = 0;
+    size_t lines = 0;
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    while (getline(&line, &cap, fp) != -1)
+    {
+        lines++;
+    }
+    free(line);
+    fclose(fp);
+    return lines;
+}
+
+static size_t lines_lr_next(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    LineReader *r = (fd >= 0) ? lr_open(fd, 0) : NULL;
+    LineView line;
+    size_t lines = 0;
+    while (r != NULL && lr_next(r, &line) == 1)
+    {
+        lines++;
+    }
+    lr_close(r);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return lines;
+}
+
+static size_t lines_lr_batch(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    LineReader *r = (fd >= 0) ? lr_open(fd, 0) : NULL;
+    LineView batch[512];
+    size_t lines = 0;
+    long n;
+    while (r != NULL && (n = lr_next_batch(r, batch, 512)) > 0)
+    {
+        lines += (size_t)n;
+    }
+    lr_close(r);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return lines;
+}
+
+static const BenchCase line_cases[] = {
+    {"fgetc() loop", lines_fgetc},
+    {"fgets() 4 KiB", lines_fgets},
+    {"getline()", lines_getline},
+    {"lr_next()", lines_lr_next},
+    {"lr_next_batch()", lines_lr_batch},
+};
+
+// ============================================================================
+// Character loops
+// ============================================================================
+
+#define UPPER(c) (((c) >= 'a' && (c) <= 'z') ? (c) - 'a' + 'A' : (c))
+
+static size_t chars_fgetc(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    size_t bytes = 0;
+    int c;
+    while (in != NULL && out != NULL && (c = fgetc(in)) != EOF)
+    {
+        fputc(UPPER(c), out);
+        bytes++;
+    }
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    return bytes;
+}
+
+static size_t chars_getc(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    size_t bytes = 0;
+    int c;
+    while (in != NULL && out != NULL && (c = getc(in)) != EOF)
+    {
+        putc(UPPER(c), out);
+        bytes++;
+    }
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    return bytes;
+}
+
+static size_t chars_unlocked(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    size_t bytes = 0;
+    int c;
+    if (in == NULL || out == NULL)
+    {
+        if (in != NULL)
+        {
+            fclose(in);
+        }
+        if (out != NULL)
+        {
+            fclose(out);
+        }
+        return 0;
+    }
+    fio_lock(in);
+    fio_lock(out);
+    while ((c = fio_getc(in)) != EOF)
+    {
+        fio_putc(UPPER(c), out);
+        bytes++;
+    }
+    fio_unlock(out);
+    fio_unlock(in);
+    fclose(in);
+    fclose(out);
+    return bytes;
+}
+
+static int upper_stage(int c, void *ctx)
+{
+    (void)ctx;
+    return UPPER(c);
+}
+
+static size_t chars_filter(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    const FioStage stage = {upper_stage, NULL};
+    long long bytes = (in != NULL && out != NULL) ? fio_filter(in, out, &stage, 1) : 0;
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    return bytes > 0 ? (size_t)bytes : 0;
+}
+
+static size_t chars_translate(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    const FioStage stage = {upper_stage, NULL};
+    int table[256];
+    fio_stages_to_table(&stage, 1, table);
+    long long bytes = (in != NULL && out != NULL) ? fio_translate(in, out, table) : 0;
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    return bytes > 0 ? (size_t)bytes : 0;
+}
+
+static const BenchCase char_cases[] = {
+    {"fgetc()/fputc()", chars_fgetc},
+    {"getc()/putc()", chars_getc},
+    {"*_unlocked() region", chars_unlocked},
+    {"fio_filter()", chars_filter},
+    {"fio_translate()", chars_translate},
+};
+
+// ============================================================================
+// Record writes
+// ============================================================================
+
+// The input file, loaded once for the record writers
+static char *text;
+static size_t text_len;
+
+typedef struct
+{
+    uint32_t length;
+    uint32_t sequence;
+} FrameHeader;
+
+typedef int (*FrameWriter)(void *out, const FrameHeader *h, const char *line);
+
+// Frames every line of text; returns the number of records written
+static size_t frame_lines(void *out, FrameWriter emit)
+{
+    size_t records = 0;
+    const char *p = text;
+    const char *end = text + text_len;
+    while (p < end)
+    {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        FrameHeader h = {(uint32_t)((nl ? nl : end) - p), (uint32_t)records};
+        if (emit(out, &h, p) != 0)
+        {
+            break;
+        }
+        records++;
+        p += h.length + 1;
+    }
+    return records;
+}
+
+static int emit_write(void *out, const FrameHeader *h, const char *line)
+{
+    int fd = *(int *)out;
+    return (write(fd, h, sizeof(*h)) < 0 || write(fd, line, h->length) < 0 || write(fd, "\n", 1) < 0) ? -1 : 0;
+}
+
+static int emit_fwrite(void *out, const FrameHeader *h, const char *line)
+{
+    FILE *fp = out;
+    fwrite(h, sizeof(*h), 1, fp);
+    fwrite(line, 1, h->length, fp);
+    return fputc('\n', fp) == EOF ? -1 : 0;
+}
+
+static int emit_writev(void *out, const FrameHeader *h, const char *line)
+{
+    struct iovec iov[3] = {{(void *)h, sizeof(*h)}, {(void *)line, h->length}, {"\n", 1}};
+    return vio_writev_all(*(int *)out, iov, 3);
+}
+
+static int emit_batch(void *out, const FrameHeader *h, const char *line)
+{
+    VioBatch *b = out;
+    // text outlives the batch, so the line is queued by reference
+    if (vio_batch_copy(b, h, sizeof(*h)) != 0 || vio_batch_add(b, line, h->length) != 0)
+    {
+        return -1;
+    }
+    return vio_batch_copy(b, "\n", 1);
+}
+
+static size_t records_write(const char *path)
+{
+    (void)path;
+    int fd = open("/dev/null", O_WRONLY);
+    size_t n = fd >= 0 ? frame_lines(&fd, emit_write) : 0;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return n;
+}
+
+static size_t records_fwrite(const char *path)
+{
+    (void)path;
+    FILE *fp = fopen("/dev/null", "w");
+    size_t n = fp != NULL ? frame_lines(fp, emit_fwrite) : 0;
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    return n;
+}
+
+static size_t records_writev(const char *path)
+{
+    (void)path;
+    int fd = open("/dev/null", O_WRONLY);
+    size_t n = fd >= 0 ? frame_lines(&fd, emit_writev) : 0;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return n;
+}
+
+static size_t records_batch(const char *path)
+{
+    (void)path;
+    int fd = open("/dev/null", O_WRONLY);
+    VioBatch *b = fd >= 0 ? vio_batch_open(fd, 0) : NULL;
+    size_t n = b != NULL ? frame_lines(b, emit_batch) : 0;
+    if (vio_batch_close(b, NULL) != 0)
+    {
+        n = 0;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return n;
+}
+
+static const BenchCase record_cases[] = {
+    {"write() per field", records_write},
+    {"fwrite() per field", records_fwrite},
+    {"writev() per record", records_writev},
+    {"VioBatch", records_batch},
+};
+
+// ============================================================================
+// Driver
+// ============================================================================
+
+// Runs each case three times and keeps the best; returns 0 if counts differ
+static int run_cases(const char *title, const char *unit, const BenchCase *cases, size_t ncases,
+                     const char *path, double mb)
+{
+    size_t expected = 0;
+    double baseline = 0;
+    int same = 1;
+
+    printf("%s\n", title);
+    printf("  %-22s %10s %14s %10s %9s\n", "Method", "Time (s)", unit, "MB/s", "Speedup");
+    for (size_t c = 0; c < ncases; c++)
+    {
+        double best = 1e30;
+        size_t lines = 0;
+        for (int run = 0; run < 3; run++)
+        {
+            double t0 = now_seconds();
+            lines = cases[c].run(path);
+            double elapsed = now_seconds() - t0;
+            best = elapsed < best ? elapsed : best;
+        }
+        if (c == 0)
+        {
+            expected = lines;
+            baseline = best;
+        }
+        same = same && lines == expected;
+        printf("  %-22s %10.3f %14.0f %10.1f %8.1fx%s\n", cases[c].name, best, lines / best, mb / best,
+               baseline / best, lines == expected ? "" : "  ✗ count differs");
+    }
+    printf("\n");
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size_mb = (argc > 1) ? strtoul(argv[1], NULL, 10) : 64;
+    char path[] = "/tmp/io_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || size_mb == 0)
+    {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    printf("=== I/O Benchmark Suite ===\n\n");
+    if (write_text(path, size_mb << 20) != 0)
+    {
+        perror("write_text");
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+    printf("Input: %zu MiB of text (warm page cache), best of 3 runs\n\n", size_mb);
+
+    double mb = (double)(size_mb << 20) / 1e6;
+    int ok = run_cases("Line reading", "Lines/s", line_cases, sizeof(line_cases) / sizeof(line_cases[0]),
+                       path, mb);
+    ok &= run_cases("Character loops (uppercase to /dev/null)", "Bytes/s", char_cases,
+                    sizeof(char_cases) / sizeof(char_cases[0]), path, mb);
+
+    fd = open(path, O_RDONLY);
+    text_len = size_mb << 20;
+    text = malloc(text_len);
+    if (fd < 0 || text == NULL || vio_read_full(fd, text, text_len) != (ssize_t)text_len)
+    {
+        perror("loading the input");
+        ok = 0;
+    }
+    else
+    {
+        ok &= run_cases("Record writes (header + line + '\\n' to /dev/null)", "Records/s", record_cases,
+                        sizeof(record_cases) / sizeof(record_cases[0]), path, mb);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    free(text);
+
+    unlink(path);
+    printf("%s All methods agree on the results\n", ok ? "✓" : "✗");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
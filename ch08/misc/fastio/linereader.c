@@ -0,0 +1,246 @@
+/*
+ * Fast I/O - linereader.c
+ *
+ * Implementation of the buffered line reader.
+ *
+ * lr_next() finds the next '\n' with memchr(), which the C library already
+ * implements with SIMD. lr_next_batch() goes further for files of short
+ * lines: it turns 64 bytes at a time into a bit mask of newline positions
+ * and emits one view per set bit, so there is no call per line at all.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "linereader.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LR_X86 1
+#include <emmintrin.h>
+#endif
+
+#define DEFAULT_BUFFER ((size_t)256 << 10)
+#define WINDOW 64 // bytes scanned per mask; the buffer has this much slack
+
+struct LineReader
+{
+    int fd;
+    char *buf;
+    size_t cap;
+    size_t start;   // first byte of the next line
+    size_t len;     // bytes in buf
+    size_t scanned; // buf[start .. scanned) holds no '\n'
+    bool eof;
+    size_t lines;
+};
+
+LineReader *lr_open(int fd, size_t buffer_size)
+{
+    LineReader *r = malloc(sizeof(LineReader));
+    if (r == NULL)
+    {
+        return NULL;
+    }
+    r->cap = buffer_size ? buffer_size : DEFAULT_BUFFER;
+    r->buf = calloc(r->cap + WINDOW, 1);
+    if (r->buf == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+    r->fd = fd;
+    r->start = 0;
+    r->len = 0;
+    r->scanned = 0;
+    r->eof = false;
+    r->lines = 0;
+    return r;
+}
+
+void lr_close(LineReader *r)
+{
+    if (r != NULL)
+    {
+        free(r->buf);
+        free(r);
+    }
+}
+
+size_t lr_line_count(const LineReader *r)
+{
+    return r->lines;
+}
+
+size_t lr_buffer_size(const LineReader *r)
+{
+    return r->cap;
+}
+
+// Move the partial line to the front, grow if it fills the buffer, read more
+static int refill(LineReader *r)
+{
+    size_t rest = r->len - r->start;
+    if (r->start > 0)
+    {
+        memmove(r->buf, r->buf + r->start, rest);
+        r->scanned = r->scanned > r->start ? r->scanned - r->start : 0;
+        r->start = 0;
+        r->len = rest;
+    }
+    if (r->len == r->cap)
+    {
+        char *grown = realloc(r->buf, r->cap * 2 + WINDOW);
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        memset(grown + r->cap + WINDOW, 0, r->cap);
+        r->buf = grown;
+        r->cap *= 2;
+    }
+
+    for (;;)
+    {
+        ssize_t n = read(r->fd, r->buf + r->len, r->cap - r->len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            r->eof = true;
+        }
+        r->len += (size_t)n;
+        return 0;
+    }
+}
+
+// The unterminated last line, if any
+static int last_line(LineReader *r, LineView *line)
+{
+    if (r->start == r->len)
+    {
+        return 0;
+    }
+    line->ptr = r->buf + r->start;
+    line->len = r->len - r->start;
+    r->start = r->scanned = r->len;
+    r->lines++;
+    return 1;
+}
+
+int lr_next(LineReader *r, LineView *line)
+{
+    for (;;)
+    {
+        if (r->scanned < r->start)
+        {
+            r->scanned = r->start;
+        }
+        char *nl = memchr(r->buf + r->scanned, '\n', r->len - r->scanned);
+        if (nl != NULL)
+        {
+            line->ptr = r->buf + r->start;
+            line->len = (size_t)(nl - line->ptr);
+            r->start = r->scanned = (size_t)(nl - r->buf) + 1;
+            r->lines++;
+            return 1;
+        }
+        r->scanned = r->len;
+
+        if (r->eof)
+        {
+            return last_line(r, line);
+        }
+        if (refill(r) != 0)
+        {
+            return -1;
+        }
+    }
+}
+
+// Bit i set iff p[i] == '\n', for i < 64
+static inline uint64_t newline_mask(const char *p)
+{
+#ifdef LR_X86
+    const __m128i nl = _mm_set1_epi8('\n');
+    uint64_t m0 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), nl));
+    uint64_t m1 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), nl));
+    uint64_t m2 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), nl));
+    uint64_t m3 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), nl));
+    return m0 | m1 << 16 | m2 << 32 | m3 << 48;
+#else
+    uint64_t m = 0;
+    for (int i = 0; i < WINDOW; i++)
+    {
+        m |= (uint64_t)(p[i] == '\n') << i;
+    }
+    return m;
+#endif
+}
+
+long lr_next_batch(LineReader *r, LineView *lines, size_t max)
+{
+    if (max == 0)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        size_t n = 0;
+        size_t line_start = r->start;
+        size_t i = r->scanned > r->start ? r->scanned : r->start;
+
+        // The slack after buf[cap] makes the last 64-byte load safe
+        while (i < r->len)
+        {
+            uint64_t m = newline_mask(r->buf + i);
+            if (r->len - i < WINDOW)
+            {
+                m &= ((uint64_t)1 << (r->len - i)) - 1;
+            }
+            while (m != 0 && n < max)
+            {
+                size_t nl = i + (size_t)__builtin_ctzll(m);
+                lines[n].ptr = r->buf + line_start;
+                lines[n].len = nl - line_start;
+                line_start = nl + 1;
+                n++;
+                m &= m - 1;
+            }
+            if (n == max)
+            {
+                break;
+            }
+            i += WINDOW;
+        }
+
+        r->start = line_start;
+        if (n > 0)
+        {
+            r->scanned = line_start;
+            r->lines += n;
+            return (long)n;
+        }
+        r->scanned = r->len;
+
+        if (r->eof)
+        {
+            return last_line(r, &lines[0]);
+        }
+        if (refill(r) != 0)
+        {
+            return -1;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Fast I/O - linereader.h
+ *
+ * Buffered line reader over a raw file descriptor, replacing the fgetc()
+ * and fgets() loops of Tests 9 and 10 in ch08/listings/read_write_chars.c.
+ *
+ * Lines are returned as (pointer, length) views into one large buffer
+ * that is refilled with read(): there is no FILE lock, no per-byte call
+ * and no copy. The buffer only grows when a single line is longer than
+ * it, so lines are never truncated the way fgets() truncates them.
+ */
+
+#ifndef FASTIO_LINEREADER_H
+#define FASTIO_LINEREADER_H
+
+#include <stddef.h>
+
+typedef struct
+{
+    const char *ptr; // not NUL-terminated
+    size_t len;      // without the '\n'
+} LineView;
+
+typedef struct LineReader LineReader;
+
+// buffer_size 0 = 256 KiB. Returns NULL if out of memory.
+LineReader *lr_open(int fd, size_t buffer_size);
+
+// Frees the reader; does not close the file descriptor
+void lr_close(LineReader *r);
+
+// Next line. Returns 1, 0 at end of input, -1 on read error (errno set).
+// The last line is returned even without a trailing '\n'. The view is
+// valid until the next call on this reader.
+int lr_next(LineReader *r, LineView *line);
+
+// Up to max lines that are already complete in the buffer (refilling if
+// there are none), found with a SIMD newline scan. Returns the count, 0
+// at end of input, -1 on error. Views are valid until the next call.
+long lr_next_batch(LineReader *r, LineView *lines, size_t max);
+
+// Number of lines returned so far
+size_t lr_line_count(const LineReader *r);
+
+// Current buffer size (grows for over-long lines)
+size_t lr_buffer_size(const LineReader *r);
+
+#endif /* FASTIO_LINEREADER_H */
@@ -0,0 +1,177 @@
+/*
+ * Fast I/O - linereader_main.c
+ *
+ * Demonstrates the line reader on the cases where the fgetc()/fgets()
+ * loops of ch08/listings/read_write_chars.c go wrong or go slowly: long
+ * lines, a missing final newline, and files of many short lines.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "linereader.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// Write len bytes to an anonymous temp file and return an fd at offset 0
+static int temp_fd_with(const char *data, size_t len)
+{
+    FILE *tmp = tmpfile();
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    fwrite(data, 1, len, tmp);
+    fflush(tmp);
+    int fd = dup(fileno(tmp));
+    fclose(tmp);
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+int main(void)
+{
+    printf("=== Buffered Line Reader ===\n\n");
+
+    // Test 1: Processing lines (read_write_chars.c Test 10) without a copy
+    printf("Test 1: Processing lines\n");
+    {
+        const char *text = "Hello, World!\nABCDEFGHIJKLMNOPQRSTUVWXYZ\n\nLast line without newline";
+        int fd = temp_fd_with(text, strlen(text));
+        LineReader *r = lr_open(fd, 0);
+        if (fd < 0 || r == NULL)
+        {
+            perror("  ✗ setup failed");
+            return EXIT_FAILURE;
+        }
+
+        LineView line;
+        while (lr_next(r, &line) == 1)
+        {
+            printf("  [%zu] '%.*s'\n", lr_line_count(r), (int)line.len, line.ptr);
+        }
+        check(lr_line_count(r) == 4, "4 lines, including the empty one and the unterminated one");
+        lr_close(r);
+        close(fd);
+    }
+    printf("\n");
+
+    // Test 2: A line longer than the buffer is not truncated
+    printf("Test 2: Lines longer than the buffer\n");
+    {
+        size_t long_len = 100000;
+        char *text = malloc(long_len + 16);
+        if (text == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        memset(text, 'x', long_len);
+        memcpy(text + long_len, "\nshort\n", 7);
+
+        int fd = temp_fd_with(text, long_len + 7);
+        LineReader *r = lr_open(fd, 4096); // 4 KiB, like a typical fgets() buffer
+        LineView line;
+        int first = r != NULL && lr_next(r, &line) == 1 && line.len == long_len && line.ptr[0] == 'x';
+        int second = r != NULL && lr_next(r, &line) == 1 && line.len == 5 && memcmp(line.ptr, "short", 5) == 0;
+        printf("  Buffer grew from 4096 to %zu bytes\n", r != NULL ? lr_buffer_size(r) : 0);
+        check(first && second, "100,000-byte line returned whole, next line intact");
+        lr_close(r);
+        close(fd);
+
+        // fgets() with a 100-byte buffer returns the same line in pieces
+        FILE *fp = tmpfile();
+        if (fp != NULL)
+        {
+            char buffer[100];
+            size_t pieces = 0;
+            fwrite(text, 1, long_len + 7, fp);
+            rewind(fp);
+            while (fgets(buffer, sizeof(buffer), fp) != NULL)
+            {
+                pieces++;
+            }
+            printf("  fgets(buffer, 100, fp) needed %zu calls for the same 2 lines\n", pieces);
+            fclose(fp);
+        }
+        free(text);
+    }
+    printf("\n");
+
+    // Test 3: lr_next_batch() returns exactly what lr_next() returns
+    printf("Test 3: Batch reading matches line-by-line reading\n");
+    {
+        size_t len = 1 << 20;
+        char *text = malloc(len);
+        if (text == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        unsigned seed = 3;
+        for (size_t i = 0; i < len; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            text[i] = ((seed >> 16) % 23 == 0) ? '\n' : (char)('a' + (seed >> 8) % 26);
+        }
+
+        int fd1 = temp_fd_with(text, len);
+        int fd2 = temp_fd_with(text, len);
+        LineReader *one = lr_open(fd1, 1000); // odd size: lines straddle refills
+        LineReader *many = lr_open(fd2, 1000);
+        if (fd1 < 0 || fd2 < 0 || one == NULL || many == NULL)
+        {
+            perror("  ✗ setup failed");
+            return EXIT_FAILURE;
+        }
+
+        LineView batch[37];
+        LineView line;
+        long n;
+        int same = 1;
+        size_t bytes = 0;
+        while ((n = lr_next_batch(many, batch, 37)) > 0)
+        {
+            for (long i = 0; i < n; i++)
+            {
+                same = same && lr_next(one, &line) == 1 && line.len == batch[i].len &&
+                       memcmp(line.ptr, batch[i].ptr, line.len) == 0;
+                bytes += batch[i].len;
+            }
+        }
+        same = same && lr_next(one, &line) == 0 && n == 0;
+        printf("  %zu lines, %zu bytes of text\n", lr_line_count(many), bytes);
+        check(same, "identical views from both APIs");
+
+        lr_close(one);
+        lr_close(many);
+        close(fd1);
+        close(fd2);
+        free(text);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Views point into the reader's buffer: copy what you keep\n");
+    printf("2. Views are not NUL-terminated; print them with \"%%.*s\"\n");
+    printf("3. No FILE lock and no per-byte call: one read() per buffer\n");
+    printf("4. Run ./io_bench for lines/s against fgetc/fgets/getline\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*
+ * Fast I/O - recfile.c
+ *
+ * Implementation of positional record access. A RecordFile is read-only
+ * after rf_open(), which is what makes sharing it between threads safe:
+ * every call computes its own offset and passes it to the kernel.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "recfile.h"
+#include "vecio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct RecordFile
+{
+    int fd;
+    int own;
+    size_t record_size;
+    size_t header_size;
+};
+
+RecordFile *rf_fdopen(int fd, size_t record_size, size_t header_size, int own)
+{
+    if (fd < 0 || record_size == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    RecordFile *rf = malloc(sizeof(RecordFile));
+    if (rf == NULL)
+    {
+        return NULL;
+    }
+    rf->fd = fd;
+    rf->own = own;
+    rf->record_size = record_size;
+    rf->header_size = header_size;
+    return rf;
+}
+
+RecordFile *rf_open(const char *path, int flags, size_t record_size, size_t header_size)
+{
+    if (record_size == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    int fd = open(path, flags, 0644);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    RecordFile *rf = rf_fdopen(fd, record_size, header_size, 1);
+    if (rf == NULL)
+    {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return rf;
+}
+
+int rf_fd(const RecordFile *rf)
+{
+    return rf->fd;
+}
+
+size_t rf_record_size(const RecordFile *rf)
+{
+    return rf->record_size;
+}
+
+// Offset of record index, or -1 (EOVERFLOW) if it does not fit in off_t
+static off_t record_offset(const RecordFile *rf, uint64_t index)
+{
+    uint64_t max = (uint64_t)INT64_MAX - rf->header_size;
+    if (index > max / rf->record_size)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return (off_t)(rf->header_size + index * rf->record_size);
+}
+
+int64_t rf_count(const RecordFile *rf)
+{
+    struct stat st;
+    if (fstat(rf->fd, &st) != 0)
+    {
+        return -1;
+    }
+    if ((uint64_t)st.st_size <= rf->header_size)
+    {
+        return 0;
+    }
+    return (int64_t)(((uint64_t)st.st_size - rf->header_size) / rf->record_size);
+}
+
+int rf_read(const RecordFile *rf, uint64_t index, void *rec)
+{
+    off_t off = record_offset(rf, index);
+    if (off < 0)
+    {
+        return -1;
+    }
+    ssize_t got = vio_pread_full(rf->fd, rec, rf->record_size, off);
+    if (got < 0)
+    {
+        return -1;
+    }
+    if ((size_t)got != rf->record_size)
+    {
+        errno = ERANGE;
+        return -1;
+    }
+    return 0;
+}
+
+int rf_write(const RecordFile *rf, uint64_t index, const void *rec)
+{
+    off_t off = record_offset(rf, index);
+    if (off < 0)
+    {
+        return -1;
+    }
+    return vio_pwrite_all(rf->fd, rec, rf->record_size, off);
+}
+
+int64_t rf_read_range(const RecordFile *rf, uint64_t first, void *recs, size_t count)
+{
+    off_t off = record_offset(rf, first);
+    if (off < 0)
+    {
+        return -1;
+    }
+    if (count > (SIZE_MAX >> 1) / rf->record_size)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    ssize_t got = vio_pread_full(rf->fd, recs, count * rf->record_size, off);
+    if (got < 0)
+    {
+        return -1;
+    }
+    return (int64_t)((size_t)got / rf->record_size);
+}
+
+int rf_write_range(const RecordFile *rf, uint64_t first, const void *recs, size_t count)
+{
+    off_t off = record_offset(rf, first);
+    if (off < 0)
+    {
+        return -1;
+    }
+    if (count > (SIZE_MAX >> 1) / rf->record_size)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return vio_pwrite_all(rf->fd, recs, count * rf->record_size, off);
+}
+
+int rf_append(const RecordFile *rf, const void *rec, uint64_t *index)
+{
+    int64_t n = rf_count(rf);
+    if (n < 0 || rf_write(rf, (uint64_t)n, rec) != 0)
+    {
+        return -1;
+    }
+    if (index != NULL)
+    {
+        *index = (uint64_t)n;
+    }
+    return 0;
+}
+
+int rf_read_header(const RecordFile *rf, void *header)
+{
+    ssize_t got = vio_pread_full(rf->fd, header, rf->header_size, 0);
+    if (got < 0)
+    {
+        return -1;
+    }
+    if ((size_t)got != rf->header_size)
+    {
+        errno = ERANGE;
+        return -1;
+    }
+    return 0;
+}
+
+int rf_write_header(const RecordFile *rf, const void *header)
+{
+    return vio_pwrite_all(rf->fd, header, rf->header_size, 0);
+}
+
+int rf_sync(const RecordFile *rf)
+{
+    return fdatasync(rf->fd);
+}
+
+int rf_close(RecordFile *rf)
+{
+    if (rf == NULL)
+    {
+        return 0;
+    }
+    int rc = rf->own ? close(rf->fd) : 0;
+    free(rf);
+    return rc;
+}
@@ -0,0 +1,65 @@
+/*
+ * Fast I/O - recfile.h
+ *
+ * Positional access to files of fixed-size records.
+ *
+ * ch08/listings/binary_io.c (Test 5) and file_positioning.c (Test 7) fetch
+ * record i with fseek() and then fread(). The seek moves the stream's
+ * shared position and throws away its buffer, and two threads doing it
+ * at once must hold the stream lock across both calls or read each
+ * other's record. RecordFile reads and writes with pread()/pwrite() at
+ * header_size + i * record_size: there is no file position to share, so
+ * any number of threads can use the same RecordFile without locking.
+ *
+ * Record i is bytes [header_size + i * record_size, + record_size). The
+ * header, if any, is left to the caller (rf_read_header()/rf_write_header()).
+ *
+ * Functions return 0 (or a count), or -1 with errno set. Reading a record
+ * that is not wholly in the file fails with ERANGE.
+ */
+
+#ifndef FASTIO_RECFILE_H
+#define FASTIO_RECFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct RecordFile RecordFile;
+
+// Open path with open(2) flags (O_RDONLY, O_RDWR, O_CREAT, ...); mode 0644
+// is used when creating
+RecordFile *rf_open(const char *path, int flags, size_t record_size, size_t header_size);
+
+// Use an open descriptor. own: close fd in rf_close().
+RecordFile *rf_fdopen(int fd, size_t record_size, size_t header_size, int own);
+
+int rf_fd(const RecordFile *rf);
+size_t rf_record_size(const RecordFile *rf);
+
+// Whole records in the file now
+int64_t rf_count(const RecordFile *rf);
+
+int rf_read(const RecordFile *rf, uint64_t index, void *rec);
+
+// Write record index, extending the file if needed
+int rf_write(const RecordFile *rf, uint64_t index, const void *rec);
+
+// count consecutive records from first in one system call. Returns the
+// records read: fewer than count only at end of file.
+int64_t rf_read_range(const RecordFile *rf, uint64_t first, void *recs, size_t count);
+int rf_write_range(const RecordFile *rf, uint64_t first, const void *recs, size_t count);
+
+// Append at rf_count(). index (if not NULL) receives the record number.
+// Not atomic: two threads appending at once need their own indexes and
+// rf_write().
+int rf_append(const RecordFile *rf, const void *rec, uint64_t *index);
+
+int rf_read_header(const RecordFile *rf, void *header);
+int rf_write_header(const RecordFile *rf, const void *header);
+
+// fdatasync()
+int rf_sync(const RecordFile *rf);
+
+int rf_close(RecordFile *rf);
+
+#endif /* FASTIO_RECFILE_H */
@@ -0,0 +1,227 @@
+/*
+ * Fast I/O - recfile_bench.c
+ *
+ * Random record lookups per second from 1 to 16 threads sharing one file:
+ *
+ *   fseek+fread  one FILE, each lookup holds flockfile() across the seek
+ *                and the read (without the lock, threads read each
+ *                other's records)
+ *   FILE/thread  a FILE per thread: no sharing, but a stdio buffer
+ *                refilled on every seek and one stream per thread
+ *   rf_read      one RecordFile, pread() with no lock
+ *
+ * The file stays in the page cache, so this measures the cost of the
+ * calls themselves. Threads only help where there are CPUs to run them.
+ *
+ * Usage: ./recfile_bench [records] [seconds_per_case] [directory]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "recfile.h"
+
+#define RECORD 128
+#define MAX_THREADS 16
+
+typedef enum
+{
+    SHARED_STDIO,
+    PRIVATE_STDIO,
+    PREAD
+} Method;
+
+static const char *method_names[] = {"fseek+fread", "FILE/thread", "rf_read"};
+
+typedef struct
+{
+    Method method;
+    const char *path;
+    FILE *shared;
+    const RecordFile *rf;
+    uint64_t records;
+    double seconds;
+    uint64_t seed;
+    unsigned long lookups;
+    int bad;
+} Worker;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Record i starts with i, so every lookup can be checked
+static int lookup(Worker *w, FILE *fp, uint64_t i, char *rec)
+{
+    switch (w->method)
+    {
+    case SHARED_STDIO:
+    case PRIVATE_STDIO:
+    {
+        int ok;
+        flockfile(fp);
+        ok = fseeko(fp, (off_t)(i * RECORD), SEEK_SET) == 0 && fread(rec, RECORD, 1, fp) == 1;
+        funlockfile(fp);
+        if (!ok)
+        {
+            return -1;
+        }
+        break;
+    }
+    case PREAD:
+        if (rf_read(w->rf, i, rec) != 0)
+        {
+            return -1;
+        }
+        break;
+    }
+    uint64_t id;
+    memcpy(&id, rec, sizeof(id));
+    return id == i ? 0 : -1;
+}
+
+static void *worker(void *arg)
+{
+    Worker *w = arg;
+    FILE *fp = w->shared;
+    if (w->method == PRIVATE_STDIO && (fp = fopen(w->path, "rb")) == NULL)
+    {
+        w->bad++;
+        return NULL;
+    }
+    char rec[RECORD];
+    double t0 = now_seconds();
+    while (now_seconds() - t0 < w->seconds)
+    {
+        for (int k = 0; k < 256; k++)
+        {
+            if (lookup(w, fp, next_random(&w->seed) % w->records, rec) != 0)
+            {
+                w->bad++;
+            }
+            w->lookups++;
+        }
+    }
+    if (w->method == PRIVATE_STDIO)
+    {
+        fclose(fp);
+    }
+    return NULL;
+}
+
+// Returns lookups per second, or a negative value on error
+static double run_case(Method m, int threads, const char *path, FILE *shared, const RecordFile *rf, uint64_t records,
+                       double seconds)
+{
+    pthread_t tid[MAX_THREADS];
+    Worker w[MAX_THREADS];
+    int started = 0;
+    double t0 = now_seconds();
+    for (int i = 0; i < threads; i++)
+    {
+        w[i] = (Worker){m, path, shared, rf, records, seconds, 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1), 0, 0};
+        if (pthread_create(&tid[i], NULL, worker, &w[i]) != 0)
+        {
+            break;
+        }
+        started++;
+    }
+    unsigned long total = 0;
+    int bad = started != threads;
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(tid[i], NULL);
+        total += w[i].lookups;
+        bad += w[i].bad;
+    }
+    double elapsed = now_seconds() - t0;
+    return bad ? -1 : total / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t records = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+    double seconds = (argc > 2) ? atof(argv[2]) : 0.5;
+    const char *dir = (argc > 3) ? argv[3] : ".";
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/recfile_bench.dat", dir);
+    if (records == 0 || seconds <= 0)
+    {
+        fprintf(stderr, "Usage: %s [records] [seconds_per_case] [directory]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    RecordFile *rf = rf_open(path, O_RDWR | O_CREAT | O_TRUNC, RECORD, 0);
+    if (rf == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    static char chunk[1024][RECORD];
+    int ok = 1;
+    for (uint64_t first = 0; first < records && ok; first += 1024)
+    {
+        size_t n = records - first < 1024 ? (size_t)(records - first) : 1024;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t id = first + i;
+            memset(chunk[i], (int)('a' + id % 26), RECORD);
+            memcpy(chunk[i], &id, sizeof(id));
+        }
+        ok = rf_write_range(rf, first, chunk, n) == 0;
+    }
+    FILE *shared = fopen(path, "rb");
+    if (!ok || shared == NULL)
+    {
+        perror(path);
+        rf_close(rf);
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+
+    printf("=== Random Record Lookup Benchmark ===\n\n");
+    printf("%llu records of %d bytes (%.1f MiB), %.1f s per case, %ld CPU(s)\n\n", (unsigned long long)records,
+           RECORD, (double)records * RECORD / (1 << 20), seconds, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  %-12s %8s %14s %9s\n", "Method", "Threads", "Lookups/s", "Speedup");
+
+    const int counts[] = {1, 2, 4, 8, 16};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        double base = 0;
+        for (int m = SHARED_STDIO; m <= PREAD; m++)
+        {
+            double rate = run_case((Method)m, counts[c], path, shared, rf, records, seconds);
+            ok = ok && rate > 0;
+            if (m == SHARED_STDIO)
+            {
+                base = rate;
+            }
+            printf("  %-12s %8d %14.0f %8.1fx\n", method_names[m], counts[c], rate, base > 0 ? rate / base : 0.0);
+        }
+        printf("\n");
+    }
+
+    fclose(shared);
+    rf_close(rf);
+    unlink(path);
+    printf("%s Every lookup returned the record asked for\n", ok ? "✓" : "✗");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
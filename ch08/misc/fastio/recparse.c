@@ -0,0 +1,813 @@
+/*
+ * Fast I/O - recparse.c
+ *
+ * Implementation of the record parser.
+ *
+ * fscanf() pays for interpreting the format string, locking the FILE and
+ * going through the locale-aware strtol()/strtod() on every call. Here the
+ * input sits in a 1 MiB buffer, and 64 bytes at a time are classified with
+ * SSE2 into a blank mask and a newline mask. A line that fits in such a
+ * window is cut into fields with bit operations, and the fields are
+ * converted by straight-line digit loops. Longer lines take the general
+ * field-by-field path.
+ *
+ * Exact doubles (Clinger's fast path): if the decimal mantissa m fits in
+ * 53 bits and the power of ten 10^e is itself an exact double (|e| <= 22),
+ * then m * 10^e or m / 10^e is one correctly rounded IEEE operation, so
+ * the result has the same bits as strtod(). Nearly all values in data
+ * exports ("175.3", "5.9", "-0.25") qualify. Everything else is handed to
+ * strtod() under a cached "C" locale, so "1,5" is a syntax error even
+ * where the caller's locale uses a decimal comma.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "recparse.h"
+#include <errno.h>
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define REC_X86 1
+#include <emmintrin.h>
+#endif
+
+#define DEFAULT_BUFFER ((size_t)1 << 20)
+#define WINDOW 64 // bytes classified at once; the buffer has this much slack
+
+struct RecReader
+{
+    int fd;
+    char *buf;
+    size_t cap;
+    size_t start; // first unconsumed byte
+    size_t len;   // bytes in buf
+    bool eof;
+    size_t line_no;
+    // Classification of buf[win_pos .. win_pos + 64), shared by the short
+    // lines that fall inside it
+    size_t win_pos;
+    uint64_t win_blank;
+    uint64_t win_newline;
+    bool win_valid;
+};
+
+// ============================================================================
+// Field parsers
+// ============================================================================
+
+// Blanks are the isspace() characters of the "C" locale
+static inline bool is_blank(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline const char *skip_blanks(const char *p, const char *end)
+{
+    while (p < end && is_blank(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+static inline const char *token_end(const char *p, const char *end)
+{
+    while (p < end && !is_blank(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+static inline bool at_token_end(const char *p, const char *end)
+{
+    return p == end || is_blank(*p);
+}
+
+// The parsers scan each field once: digits are converted as they are
+// found, and the field must end at a blank or at the end of the line.
+
+static inline FieldStatus word_field(const char **pos, const char *end, char *dst, size_t dst_size)
+{
+    const char *p = skip_blanks(*pos, end);
+    size_t n = 0;
+    for (; p < end && !is_blank(*p); p++, n++)
+    {
+        if (n + 1 < dst_size)
+        {
+            dst[n] = *p;
+        }
+    }
+    *pos = p;
+
+    if (n == 0)
+    {
+        return FIELD_MISSING;
+    }
+    if (n + 1 > dst_size)
+    {
+        return FIELD_TOO_LONG;
+    }
+    dst[n] = '\0';
+    return FIELD_OK;
+}
+
+static inline FieldStatus i64_field(const char **pos, const char *end, int64_t *out)
+{
+    const char *p = skip_blanks(*pos, end);
+    if (p == end)
+    {
+        *pos = p;
+        return FIELD_MISSING;
+    }
+
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+    const char *digits = p;
+    while (p < end && *p == '0')
+    {
+        p++;
+    }
+
+    // 19 significant digits always fit in a uint64_t; more are out of range
+    const char *significant = p;
+    uint64_t value = 0;
+    for (; p < end && (unsigned)(*p - '0') <= 9; p++)
+    {
+        value = value * 10 + (unsigned)(*p - '0');
+    }
+    if (p == digits || !at_token_end(p, end))
+    {
+        *pos = token_end(p, end);
+        return FIELD_SYNTAX;
+    }
+    *pos = p;
+
+    // INT64_MIN's magnitude is one more than INT64_MAX
+    const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (p - significant > 19 || value > limit)
+    {
+        return FIELD_RANGE;
+    }
+    *out = negative ? (int64_t)(0 - value) : (int64_t)value;
+    return FIELD_OK;
+}
+
+static inline FieldStatus int_field(const char **pos, const char *end, int *out)
+{
+    int64_t value;
+    FieldStatus status = i64_field(pos, end, &value);
+    if (status != FIELD_OK)
+    {
+        return status;
+    }
+    if (value < INT_MIN || value > INT_MAX)
+    {
+        return FIELD_RANGE;
+    }
+    *out = (int)value;
+    return FIELD_OK;
+}
+
+// Powers of ten that are exact doubles
+static const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const uint64_t int_pow10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull,
+    1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull};
+
+#define MAX_EXACT_MANTISSA ((uint64_t)1 << 53)
+
+// Longest token handed to strtod(): a double's exact decimal value has at
+// most 767 significant digits, and this leaves room for sign and exponent
+#define SLOW_TOKEN_MAX 1024
+
+// strtod() always sees the "C" locale, whatever the caller's setlocale()
+static pthread_once_t c_locale_once = PTHREAD_ONCE_INIT;
+static locale_t c_locale;
+
+static void make_c_locale(void)
+{
+    c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+}
+
+// strtod() on a NUL-terminated copy of the token, in the "C" locale
+static FieldStatus parse_double_slow(const char *p, const char *stop, double *out)
+{
+    size_t len = (size_t)(stop - p);
+    if (len >= SLOW_TOKEN_MAX)
+    {
+        return FIELD_TOO_LONG;
+    }
+    pthread_once(&c_locale_once, make_c_locale);
+    if (c_locale == (locale_t)0)
+    {
+        return FIELD_RANGE;
+    }
+
+    char copy[SLOW_TOKEN_MAX];
+    memcpy(copy, p, len);
+    copy[len] = '\0';
+
+    char *parsed_end;
+    locale_t saved = uselocale(c_locale);
+    errno = 0;
+    double value = strtod(copy, &parsed_end);
+    bool overflow = errno == ERANGE && isinf(value);
+    uselocale(saved);
+    bool complete = parsed_end == copy + len && len > 0;
+
+    if (!complete)
+    {
+        return FIELD_SYNTAX;
+    }
+    if (overflow)
+    {
+        return FIELD_RANGE;
+    }
+    *out = value;
+    return FIELD_OK;
+}
+
+static inline FieldStatus double_field(const char **pos, const char *end, double *out)
+{
+    const char *p = skip_blanks(*pos, end);
+    const char *token = p;
+    if (p == end)
+    {
+        *pos = p;
+        return FIELD_MISSING;
+    }
+
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // Up to 19 significant digits fit in a uint64_t
+    uint64_t mantissa = 0;
+    int digits = 0;       // significant digits kept in mantissa
+    int exponent = 0;     // decimal exponent applied to mantissa
+    bool any_digit = false;
+    bool truncated = false;
+
+    for (; p < end && (unsigned)(*p - '0') <= 9; p++)
+    {
+        any_digit = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (unsigned)(*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            exponent++;
+            truncated |= (*p != '0');
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && (unsigned)(*p - '0') <= 9; p++)
+        {
+            any_digit = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (unsigned)(*p - '0');
+                digits += (mantissa != 0);
+                exponent--;
+            }
+            else
+            {
+                truncated |= (*p != '0');
+            }
+        }
+    }
+    if (any_digit && p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool exp_negative = false;
+        if (q < end && (*q == '-' || *q == '+'))
+        {
+            exp_negative = (*q == '-');
+            q++;
+        }
+        int e = 0;
+        const char *first = q;
+        for (; q < end && (unsigned)(*q - '0') <= 9; q++)
+        {
+            if (e < 100000)
+            {
+                e = e * 10 + (*q - '0');
+            }
+        }
+        if (q > first)
+        {
+            exponent += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+
+    // Anything else (inf, nan, hex, junk) is strtod()'s business
+    if (!any_digit || !at_token_end(p, end))
+    {
+        *pos = token_end(p, end);
+        return parse_double_slow(token, *pos, out);
+    }
+    *pos = p;
+
+    if (!truncated && mantissa <= MAX_EXACT_MANTISSA)
+    {
+        double value = -1.0;
+        if (mantissa == 0)
+        {
+            value = 0.0;
+        }
+        else if (exponent >= 0 && exponent <= 22)
+        {
+            value = (double)mantissa * exact_pow10[exponent];
+        }
+        else if (exponent < 0 && exponent >= -22)
+        {
+            value = (double)mantissa / exact_pow10[-exponent];
+        }
+        else if (exponent > 22 && exponent <= 22 + 15 &&
+                 mantissa <= MAX_EXACT_MANTISSA / int_pow10[exponent - 22])
+        {
+            // 12e30 = 12000000000e22: shift digits into the mantissa first
+            value = (double)(mantissa * int_pow10[exponent - 22]) * exact_pow10[22];
+        }
+
+        if (value >= 0.0)
+        {
+            *out = negative ? -value : value;
+            return FIELD_OK;
+        }
+    }
+    return parse_double_slow(token, p, out);
+}
+
+// Whole token of the form [sign]digits, at most 9 digits: cannot overflow
+static inline bool short_int(const char *p, const char *end, int *out)
+{
+    bool negative = (*p == '-');
+    p += (*p == '-' || *p == '+');
+    if (p == end || end - p > 9)
+    {
+        return false;
+    }
+
+    int value = 0;
+    for (; p < end; p++)
+    {
+        unsigned digit = (unsigned)(*p - '0');
+        if (digit > 9)
+        {
+            return false;
+        }
+        value = value * 10 + (int)digit;
+    }
+    *out = negative ? -value : value;
+    return true;
+}
+
+// Whole token of the form [sign]digits[.digits], at most 16 digits: one
+// pass and one exact division. Returns false for anything else.
+static inline bool short_decimal(const char *p, const char *end, double *out)
+{
+    bool negative = (*p == '-');
+    p += (*p == '-' || *p == '+');
+    if (end - p > 17)
+    {
+        return false;
+    }
+
+    uint64_t mantissa = 0;
+    const char *q = p;
+    for (; q < end && (unsigned)(*q - '0') <= 9; q++)
+    {
+        mantissa = mantissa * 10 + (unsigned)(*q - '0');
+    }
+    const char *dot = q;
+    if (q < end && *q == '.')
+    {
+        for (q++; q < end && (unsigned)(*q - '0') <= 9; q++)
+        {
+            mantissa = mantissa * 10 + (unsigned)(*q - '0');
+        }
+    }
+
+    size_t digits = (size_t)(q - p) - (dot != q);
+    if (q != end || digits == 0 || digits > 16 || mantissa > MAX_EXACT_MANTISSA)
+    {
+        return false;
+    }
+    double value = (double)mantissa / exact_pow10[dot != q ? q - dot - 1 : 0];
+    *out = negative ? -value : value;
+    return true;
+}
+
+FieldStatus rec_parse_word(const char **pos, const char *end, char *dst, size_t dst_size)
+{
+    return word_field(pos, end, dst, dst_size);
+}
+
+FieldStatus rec_parse_i64(const char **pos, const char *end, int64_t *out)
+{
+    return i64_field(pos, end, out);
+}
+
+FieldStatus rec_parse_int(const char **pos, const char *end, int *out)
+{
+    return int_field(pos, end, out);
+}
+
+FieldStatus rec_parse_double(const char **pos, const char *end, double *out)
+{
+    return double_field(pos, end, out);
+}
+
+const char *rec_field_status_str(FieldStatus status)
+{
+    switch (status)
+    {
+    case FIELD_OK:
+        return "ok";
+    case FIELD_MISSING:
+        return "missing field";
+    case FIELD_SYNTAX:
+        return "not a number";
+    case FIELD_RANGE:
+        return "out of range";
+    case FIELD_TOO_LONG:
+        return "too long";
+    case FIELD_EXTRA:
+        return "unexpected extra field";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// Chunked line reader
+// ============================================================================
+
+RecReader *rec_reader_open(int fd, size_t buffer_size)
+{
+    RecReader *r = malloc(sizeof(RecReader));
+    if (r == NULL)
+    {
+        return NULL;
+    }
+    r->cap = buffer_size ? buffer_size : DEFAULT_BUFFER;
+    r->buf = calloc(r->cap + WINDOW, 1);
+    if (r->buf == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+    r->fd = fd;
+    r->start = 0;
+    r->len = 0;
+    r->eof = false;
+    r->line_no = 0;
+    r->win_valid = false;
+    return r;
+}
+
+void rec_reader_close(RecReader *r)
+{
+    if (r != NULL)
+    {
+        free(r->buf);
+        free(r);
+    }
+}
+
+// Move the partial line to the front and read more; false on error
+static bool refill(RecReader *r)
+{
+    size_t rest = r->len - r->start;
+    r->win_valid = false;
+    if (r->start > 0)
+    {
+        memmove(r->buf, r->buf + r->start, rest);
+        r->start = 0;
+        r->len = rest;
+    }
+    if (r->len == r->cap)
+    {
+        // One line fills the whole buffer: grow it
+        char *grown = realloc(r->buf, r->cap * 2 + WINDOW);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        memset(grown + r->cap + WINDOW, 0, r->cap);
+        r->buf = grown;
+        r->cap *= 2;
+    }
+
+    for (;;)
+    {
+        ssize_t n = read(r->fd, r->buf + r->len, r->cap - r->len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (n == 0)
+        {
+            r->eof = true;
+        }
+        r->len += (size_t)n;
+        return true;
+    }
+}
+
+RecStatus rec_reader_line(RecReader *r, const char **line, size_t *len)
+{
+    size_t scanned = r->start; // bytes already known to hold no newline
+    for (;;)
+    {
+        char *nl = memchr(r->buf + scanned, '\n', r->len - scanned);
+        if (nl != NULL)
+        {
+            *line = r->buf + r->start;
+            *len = (size_t)(nl - *line);
+            r->start = (size_t)(nl - r->buf) + 1;
+            r->line_no++;
+            return REC_OK;
+        }
+        if (r->eof)
+        {
+            if (r->start == r->len)
+            {
+                return REC_END;
+            }
+            // Last line without a newline
+            *line = r->buf + r->start;
+            *len = r->len - r->start;
+            r->start = r->len;
+            r->line_no++;
+            return REC_OK;
+        }
+
+        size_t seen = r->len - r->start;
+        if (!refill(r))
+        {
+            return REC_IO_ERROR;
+        }
+        scanned = seen;
+    }
+}
+
+size_t rec_reader_line_number(const RecReader *r)
+{
+    return r->line_no;
+}
+
+// ============================================================================
+// Person records
+// ============================================================================
+
+// Bit i of *blank / *newline is set iff p[i] is a blank / '\n', i < 64
+static inline void classify_window(const char *p, uint64_t *blank, uint64_t *newline)
+{
+#ifdef REC_X86
+    uint64_t b = 0, n = 0;
+    for (int i = 0; i < WINDOW; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+        __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8('\r' - '\t')), t);
+        __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+        __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        b |= (uint64_t)(unsigned)_mm_movemask_epi8(_mm_or_si128(ctl, sp)) << i;
+        n |= (uint64_t)(unsigned)_mm_movemask_epi8(nl) << i;
+    }
+    *blank = b;
+    *newline = n;
+#else
+    uint64_t b = 0, n = 0;
+    for (int i = 0; i < WINDOW; i++)
+    {
+        b |= (uint64_t)is_blank(p[i]) << i;
+        n |= (uint64_t)(p[i] == '\n') << i;
+    }
+    *blank = b;
+    *newline = n;
+#endif
+}
+
+static inline FieldStatus copy_word(const char *tok, size_t len, char *dst, size_t dst_size)
+{
+    if (len >= dst_size)
+    {
+        return FIELD_TOO_LONG;
+    }
+    if (len < 16 && dst_size >= 16)
+    {
+        memcpy(dst, tok, 16); // fixed size: no call, no branch on len
+    }
+    else
+    {
+        memcpy(dst, tok, len);
+    }
+    dst[len] = '\0';
+    return FIELD_OK;
+}
+
+// Fast path for a line of < 64 bytes whose blanks are already known: the
+// four fields are cut out with bit operations instead of byte loops.
+// Returns REC_END for a blank line.
+static RecStatus person_from_window(const char *line, size_t len, uint64_t blank,
+                                    PersonRecord *rec, size_t *column, unsigned *field,
+                                    FieldStatus *fs)
+{
+    uint64_t text = ~blank & (((uint64_t)1 << len) - 1);
+    if (text == 0)
+    {
+        return REC_END;
+    }
+
+    // One bit at the first byte of each token, and one just past its last
+    // byte (bit len at most, < 64). Each token then costs two independent
+    // "clear the lowest bit" steps instead of a chain of scans.
+    uint64_t starts = text & ~(text << 1);
+    uint64_t stops = ~text & (text << 1);
+    const char *tok[4];
+    size_t tok_len[4];
+    for (unsigned f = 0; f < 4; f++)
+    {
+        if (starts == 0)
+        {
+            *field = f;
+            *column = len + 1;
+            *fs = FIELD_MISSING;
+            return REC_BAD;
+        }
+        unsigned start = (unsigned)__builtin_ctzll(starts);
+        tok[f] = line + start;
+        tok_len[f] = (unsigned)__builtin_ctzll(stops) - start;
+        starts &= starts - 1;
+        stops &= stops - 1;
+    }
+    if (starts != 0)
+    {
+        *field = 4;
+        *column = (size_t)__builtin_ctzll(starts) + 1;
+        *fs = FIELD_EXTRA;
+        return REC_BAD;
+    }
+
+    const char *p;
+    if ((*fs = copy_word(tok[0], tok_len[0], rec->first, sizeof(rec->first))) != FIELD_OK)
+    {
+        *field = 0;
+    }
+    else if ((*fs = copy_word(tok[1], tok_len[1], rec->last, sizeof(rec->last))) != FIELD_OK)
+    {
+        *field = 1;
+    }
+    else if (!short_int(tok[2], tok[2] + tok_len[2], &rec->age) &&
+             (p = tok[2], (*fs = int_field(&p, tok[2] + tok_len[2], &rec->age)) != FIELD_OK))
+    {
+        *field = 2;
+    }
+    else if (!short_decimal(tok[3], tok[3] + tok_len[3], &rec->height) &&
+             (p = tok[3], (*fs = double_field(&p, tok[3] + tok_len[3], &rec->height)) != FIELD_OK))
+    {
+        *field = 3;
+    }
+    else
+    {
+        return REC_OK;
+    }
+    *column = (size_t)(tok[*field] - line) + 1;
+    return REC_BAD;
+}
+
+// General path: any line length, one field after another
+static RecStatus person_from_line(const char *line, size_t len, PersonRecord *rec,
+                                  size_t *column, unsigned *field, FieldStatus *fs)
+{
+    const char *end = line + len;
+    const char *p = skip_blanks(line, end);
+    if (p == end)
+    {
+        return REC_END;
+    }
+
+    const char *field_start = p;
+    *field = 0;
+    if ((*fs = word_field(&p, end, rec->first, sizeof(rec->first))) != FIELD_OK)
+    {
+        goto bad;
+    }
+    *field = 1;
+    field_start = skip_blanks(p, end);
+    if ((*fs = word_field(&p, end, rec->last, sizeof(rec->last))) != FIELD_OK)
+    {
+        goto bad;
+    }
+    *field = 2;
+    field_start = skip_blanks(p, end);
+    if ((*fs = int_field(&p, end, &rec->age)) != FIELD_OK)
+    {
+        goto bad;
+    }
+    *field = 3;
+    field_start = skip_blanks(p, end);
+    if ((*fs = double_field(&p, end, &rec->height)) != FIELD_OK)
+    {
+        goto bad;
+    }
+    *field = 4;
+    field_start = skip_blanks(p, end);
+    if (field_start != end)
+    {
+        *fs = FIELD_EXTRA;
+        goto bad;
+    }
+    return REC_OK;
+
+bad:
+    *column = (size_t)(field_start - line) + 1;
+    return REC_BAD;
+}
+
+RecStatus rec_read_person(RecReader *r, PersonRecord *rec, RecError *err)
+{
+    size_t column = 0;
+    unsigned field = 0;
+    FieldStatus fs = FIELD_OK;
+    RecStatus status;
+
+    do
+    {
+        // Fast path: the whole line, newline included, is in a classified window
+        size_t offset = r->start - r->win_pos;
+        uint64_t blank = r->win_blank >> (offset & (WINDOW - 1));
+        uint64_t newline = r->win_newline >> (offset & (WINDOW - 1));
+        if (!r->win_valid || offset >= WINDOW || newline == 0)
+        {
+            classify_window(r->buf + r->start, &r->win_blank, &r->win_newline);
+            size_t avail = r->len - r->start;
+            if (avail < WINDOW)
+            {
+                r->win_newline &= ((uint64_t)1 << avail) - 1;
+            }
+            r->win_pos = r->start;
+            r->win_valid = true;
+            blank = r->win_blank;
+            newline = r->win_newline;
+        }
+
+        if (newline != 0)
+        {
+            const char *line = r->buf + r->start;
+            size_t len = (size_t)__builtin_ctzll(newline);
+            r->start += len + 1;
+            r->line_no++;
+            status = person_from_window(line, len, blank, rec, &column, &field, &fs);
+        }
+        else
+        {
+            const char *line;
+            size_t len;
+            status = rec_reader_line(r, &line, &len);
+            if (status != REC_OK)
+            {
+                return status;
+            }
+            status = person_from_line(line, len, rec, &column, &field, &fs);
+        }
+    } while (status == REC_END); // blank line
+
+    if (status == REC_BAD && err != NULL)
+    {
+        err->line = r->line_no;
+        err->column = column;
+        err->field = field;
+        err->status = fs;
+    }
+    return status;
+}
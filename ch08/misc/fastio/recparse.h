@@ -0,0 +1,95 @@
+/*
+ * Fast I/O - recparse.h
+ *
+ * Fast parser for whitespace-separated text records, replacing the
+ * fscanf(fp, "%s %s %d %lf", ...) loop of Test 11 in
+ * ch08/listings/formatted_input.c.
+ *
+ * The input is read from a file descriptor in large chunks and parsed in
+ * place, one record per line. Integers and doubles are converted by
+ * specialized routines that do not look at the locale. Doubles are exact
+ * (same bits as strtod() in the "C" locale): the common case is an exact
+ * single multiply or divide by a power of ten, and the rare cases fall
+ * back to strtod().
+ *
+ * Unlike fscanf(), every failure is reported with its line, field and
+ * reason, and the reader resynchronizes at the next line.
+ */
+
+#ifndef FASTIO_RECPARSE_H
+#define FASTIO_RECPARSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Result of parsing one field
+typedef enum
+{
+    FIELD_OK,
+    FIELD_MISSING,  // line ended before the field
+    FIELD_SYNTAX,   // not a number, or junk after it
+    FIELD_RANGE,    // number does not fit the target type
+    FIELD_TOO_LONG, // word longer than the destination buffer, number over 1023 bytes
+    FIELD_EXTRA     // unexpected text after the last field
+} FieldStatus;
+
+// Result of reading one record
+typedef enum
+{
+    REC_OK,
+    REC_END,      // no more records
+    REC_BAD,      // malformed line (details in RecError), skipped
+    REC_IO_ERROR  // read() failed, errno is set
+} RecStatus;
+
+typedef struct
+{
+    size_t line;        // 1-based input line
+    size_t column;      // 1-based byte column of the bad field
+    unsigned field;     // 0-based field index
+    FieldStatus status;
+} RecError;
+
+// The record of formatted_input.c Test 11
+typedef struct
+{
+    char first[50];
+    char last[50];
+    int age;
+    double height;
+} PersonRecord;
+
+typedef struct RecReader RecReader;
+
+// ============================================================================
+// Field parsers: skip blanks, parse one field from [*pos, end), advance *pos
+// ============================================================================
+
+FieldStatus rec_parse_word(const char **pos, const char *end, char *dst, size_t dst_size);
+FieldStatus rec_parse_int(const char **pos, const char *end, int *out);
+FieldStatus rec_parse_i64(const char **pos, const char *end, int64_t *out);
+FieldStatus rec_parse_double(const char **pos, const char *end, double *out);
+
+// ============================================================================
+// Chunked line reader
+// ============================================================================
+
+// buffer_size 0 = 1 MiB; the buffer grows for longer lines
+RecReader *rec_reader_open(int fd, size_t buffer_size);
+void rec_reader_close(RecReader *r);
+
+// Next line without its newline; REC_OK, REC_END or REC_IO_ERROR.
+// The view stays valid until the next call.
+RecStatus rec_reader_line(RecReader *r, const char **line, size_t *len);
+
+// Current 1-based line number (of the line last returned)
+size_t rec_reader_line_number(const RecReader *r);
+
+// Parse the next non-blank line as "first last age height". Returns
+// REC_OK, REC_BAD (err filled in, line skipped), REC_END or REC_IO_ERROR.
+RecStatus rec_read_person(RecReader *r, PersonRecord *rec, RecError *err);
+
+// Human-readable text for a field status
+const char *rec_field_status_str(FieldStatus status);
+
+#endif /* FASTIO_RECPARSE_H */
@@ -0,0 +1,187 @@
+/*
+ * Fast I/O - recparse_bench.c
+ *
+ * Benchmark: reading "first last age height" records with
+ * fscanf(fp, "%s %s %d %lf", ...) versus rec_read_person(). Both must
+ * produce exactly the same values.
+ *
+ * Usage: ./recparse_bench [record_count]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "recparse.h"
+
+// Cheap per-record work, so that the timings are dominated by parsing
+typedef struct
+{
+    size_t records;
+    long long sum;        // ages plus first letters of the names
+    uint64_t height_bits; // XOR of the doubles' bit patterns
+} Totals;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void add_record(Totals *t, const char *first, const char *last, int age, double height)
+{
+    uint64_t bits;
+    memcpy(&bits, &height, sizeof(bits));
+    t->records++;
+    t->sum += age + first[0] + last[0];
+    t->height_bits ^= bits;
+}
+
+static int write_dataset(const char *path, size_t count)
+{
+    static const char *first[] = {"John", "Jane", "Ada", "Alan", "Grace", "Linus", "Ken", "Barbara"};
+    static const char *last[] = {"Doe", "Smith", "Lovelace", "Turing", "Hopper", "Torvalds",
+                                 "Thompson", "Liskov", "Ritchie", "Kernighan"};
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    unsigned seed = 7;
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = seed >> 8;
+        fprintf(fp, "%s %s %u %u.%u\n", first[r % 8], last[(r >> 3) % 10], 18 + (r >> 7) % 70,
+                4 + (r >> 13) % 3, (r >> 16) % 10);
+    }
+    return fclose(fp);
+}
+
+// fscanf(), as in formatted_input.c Test 11
+static double time_fscanf(const char *path, Totals *t, long *bytes)
+{
+    *t = (Totals){0, 0, 0};
+    double t0 = now_seconds();
+    FILE *fp = fopen(path, "r");
+    if (fp != NULL)
+    {
+        char first[50], last[50];
+        int age;
+        double height;
+        while (fscanf(fp, "%49s %49s %d %lf", first, last, &age, &height) == 4)
+        {
+            add_record(t, first, last, age, height);
+        }
+        *bytes = ftell(fp);
+        fclose(fp);
+    }
+    return now_seconds() - t0;
+}
+
+static double time_recparse(const char *path, Totals *t)
+{
+    *t = (Totals){0, 0, 0};
+    double t0 = now_seconds();
+    int fd = open(path, O_RDONLY);
+    RecReader *r = (fd >= 0) ? rec_reader_open(fd, 0) : NULL;
+    if (r != NULL)
+    {
+        PersonRecord rec;
+        while (rec_read_person(r, &rec, NULL) == REC_OK)
+        {
+            add_record(t, rec.first, rec.last, rec.age, rec.height);
+        }
+        rec_reader_close(r);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return now_seconds() - t0;
+}
+
+// Untimed: run both parsers side by side and compare every record
+static int compare_parsers(const char *path, size_t count)
+{
+    FILE *fp = fopen(path, "r");
+    int fd = open(path, O_RDONLY);
+    RecReader *r = (fd >= 0) ? rec_reader_open(fd, 0) : NULL;
+    size_t matched = 0;
+
+    if (fp != NULL && r != NULL)
+    {
+        PersonRecord a, b;
+        while (fscanf(fp, "%49s %49s %d %lf", a.first, a.last, &a.age, &a.height) == 4 &&
+               rec_read_person(r, &b, NULL) == REC_OK && strcmp(a.first, b.first) == 0 &&
+               strcmp(a.last, b.last) == 0 && a.age == b.age &&
+               memcmp(&a.height, &b.height, sizeof(double)) == 0)
+        {
+            matched++;
+        }
+    }
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    rec_reader_close(r);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return matched == count;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000000;
+    char path[] = "/tmp/recparse_bench_XXXXXX";
+    int tmp_fd = mkstemp(path);
+    if (tmp_fd < 0 || count == 0)
+    {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(tmp_fd);
+
+    printf("=== Record Parsing Benchmark ===\n\n");
+    if (write_dataset(path, count) != 0)
+    {
+        perror("write_dataset");
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+
+    // Best of three runs each
+    Totals slow = {0, 0, 0}, fast = {0, 0, 0};
+    double t_fscanf = 1e30, t_fast = 1e30;
+    long bytes = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        double elapsed = time_fscanf(path, &slow, &bytes);
+        t_fscanf = elapsed < t_fscanf ? elapsed : t_fscanf;
+        elapsed = time_recparse(path, &fast);
+        t_fast = elapsed < t_fast ? elapsed : t_fast;
+    }
+    int same = slow.records == count && fast.records == count && slow.sum == fast.sum &&
+               slow.height_bits == fast.height_bits && compare_parsers(path, count);
+    unlink(path);
+
+    double mb = (double)bytes / 1e6;
+    printf("Records: %zu (%.1f MB)\n\n", count, mb);
+    printf("%-18s %10s %12s %10s\n", "Parser", "Time (s)", "Records/s", "MB/s");
+    printf("%-18s %10.3f %12.0f %10.1f\n", "fscanf()", t_fscanf, slow.records / t_fscanf, mb / t_fscanf);
+    printf("%-18s %10.3f %12.0f %10.1f\n", "rec_read_person()", t_fast, fast.records / t_fast, mb / t_fast);
+
+    double speedup = t_fscanf / t_fast;
+    printf("\nSpeedup: %.1fx\n", speedup);
+    printf("%s Identical records (names, ages, height bits)\n", same ? "✓" : "✗");
+
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,308 @@
+/*
+ * Fast I/O - recparse_main.c
+ *
+ * Demonstrates the record parser on the person records of Test 11 in
+ * ch08/listings/formatted_input.c, shows the per-field error reports,
+ * and checks the number parsers against strtol()/strtod().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "recparse.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// Write text to an anonymous temp file and return an fd at offset 0
+static int temp_fd_with(const char *text)
+{
+    FILE *tmp = tmpfile();
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    fputs(text, tmp);
+    fflush(tmp);
+    int fd = dup(fileno(tmp));
+    fclose(tmp);
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+static unsigned seed = 1;
+
+static unsigned next_random(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// A random decimal number in one of several shapes
+static void random_number(char *buf, size_t size)
+{
+    unsigned shape = next_random() % 6;
+    unsigned long long a = ((unsigned long long)next_random() << 24) | next_random();
+    unsigned b = next_random();
+    int e = (int)(next_random() % 700) - 350;
+    const char *sign = (next_random() & 1) ? "-" : "";
+
+    switch (shape)
+    {
+    case 0: // short decimals, as in data exports
+        snprintf(buf, size, "%s%u.%u", sign, b % 1000, b % 10);
+        break;
+    case 1:
+        snprintf(buf, size, "%s%llu.%06u", sign, a % 100000000ull, b % 1000000);
+        break;
+    case 2: // long mantissas
+        snprintf(buf, size, "%s%llu%llu.%llu", sign, a, a / 7, a / 3);
+        break;
+    case 3: // exponents across the whole range
+        snprintf(buf, size, "%s%llue%d", sign, a % 10000000000ull, e);
+        break;
+    case 4:
+        snprintf(buf, size, "%s0.%09u%u", sign, b, b % 97);
+        break;
+    default:
+        snprintf(buf, size, "%s%u", sign, b);
+        break;
+    }
+}
+
+int main(void)
+{
+    printf("=== Fast Record Parser ===\n\n");
+
+    // Test 1: The formatted_input.c records
+    printf("Test 1: Reading structured records (formatted_input.c Test 11)\n");
+    {
+        int fd = temp_fd_with("42 3.14159 Hello\n"
+                              "100 2.71828 World\n"
+                              "-5 1.41421 Test\n"
+                              "John Doe 25 5.9\n"
+                              "Jane Smith 30 5.7\n");
+        RecReader *r = rec_reader_open(fd, 0);
+        if (fd < 0 || r == NULL)
+        {
+            perror("  ✗ setup failed");
+            return EXIT_FAILURE;
+        }
+
+        // Skip first 3 lines
+        const char *line;
+        size_t len;
+        for (int i = 0; i < 3; i++)
+        {
+            rec_reader_line(r, &line, &len);
+        }
+
+        PersonRecord rec;
+        int count = 0;
+        printf("  Person records:\n");
+        while (rec_read_person(r, &rec, NULL) == REC_OK)
+        {
+            printf("    %s %s, Age: %d, Height: %.1f\n", rec.first, rec.last, rec.age, rec.height);
+            count++;
+        }
+        check(count == 2 && rec.age == 30 && rec.height == 5.7, "two records, same values as fscanf()");
+        rec_reader_close(r);
+        close(fd);
+    }
+    printf("\n");
+
+    // Test 2: Errors are reported per field, and parsing continues
+    printf("Test 2: Per-field error reports\n");
+    {
+        int fd = temp_fd_with("Ada Lovelace 36 5.5\n"
+                              "Alan Turing forty 5.8\n"
+                              "Grace Hopper 85\n"
+                              "\n"
+                              "Linus Torvalds 99999999999 5.9\n"
+                              "Ken Thompson 81 5.9 extra\n"
+                              "Dennis Ritchie 70 5,8\n"
+                              "AVeryLongFirstNameThatDoesNotFitInFiftyBytesAtAllReally X 1 1.0\n"
+                              "Barbara Liskov 84 5.4");
+        RecReader *r = rec_reader_open(fd, 16); // tiny buffer: lines cross refills
+        if (fd < 0 || r == NULL)
+        {
+            perror("  ✗ setup failed");
+            return EXIT_FAILURE;
+        }
+
+        static const FieldStatus expected[] = {FIELD_SYNTAX, FIELD_MISSING, FIELD_RANGE,
+                                               FIELD_EXTRA, FIELD_SYNTAX, FIELD_TOO_LONG};
+        PersonRecord rec;
+        RecError err;
+        RecStatus status;
+        int good = 0, bad = 0, matched = 0;
+        while ((status = rec_read_person(r, &rec, &err)) != REC_END && status != REC_IO_ERROR)
+        {
+            if (status == REC_OK)
+            {
+                printf("    ok:    %s %s %d %.1f\n", rec.first, rec.last, rec.age, rec.height);
+                good++;
+            }
+            else
+            {
+                printf("    error: line %zu, column %zu, field %u: %s\n", err.line, err.column,
+                       err.field, rec_field_status_str(err.status));
+                matched += bad < 6 && err.status == expected[bad];
+                bad++;
+            }
+        }
+        check(good == 2 && bad == 6 && matched == 6, "2 good records, 6 errors with the right reasons");
+        rec_reader_close(r);
+        close(fd);
+    }
+    printf("\n");
+
+    // Test 3: Integers against strtol()
+    printf("Test 3: Integer edge cases\n");
+    {
+        static const char *inputs[] = {"0", "-0", "+17", "2147483647", "-2147483648",
+                                       "2147483648", "-2147483649", "12x", "-", ""};
+        int ok = 1;
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+        {
+            const char *p = inputs[i];
+            int value = 0;
+            FieldStatus fs = rec_parse_int(&p, inputs[i] + strlen(inputs[i]), &value);
+
+            char *end;
+            long ref = strtol(inputs[i], &end, 10);
+            int ref_ok = *inputs[i] != '\0' && *end == '\0' && end != inputs[i] &&
+                         ref >= INT_MIN && ref <= INT_MAX;
+            ok = ok && (fs == FIELD_OK) == ref_ok && (!ref_ok || value == ref);
+            printf("    \"%s\" -> %s", inputs[i], rec_field_status_str(fs));
+            if (fs == FIELD_OK)
+            {
+                printf(" (%d)", value);
+            }
+            printf("\n");
+        }
+        check(ok, "same accept/reject decisions and values as strtol()");
+    }
+    printf("\n");
+
+    // Test 4: Doubles are bit-exact
+    printf("Test 4: Doubles bit-exact against strtod() (1,000,000 inputs)\n");
+    {
+        char buf[128];
+        int mismatches = 0;
+        for (int i = 0; i < 1000000; i++)
+        {
+            random_number(buf, sizeof(buf));
+            const char *p = buf;
+            double value = 0.0;
+            FieldStatus fs = rec_parse_double(&p, buf + strlen(buf), &value);
+            double ref = strtod(buf, NULL);
+            if (fs == FIELD_RANGE)
+            {
+                continue; // overflow to infinity, reported instead of returned
+            }
+            if (fs != FIELD_OK || memcmp(&value, &ref, sizeof(double)) != 0)
+            {
+                if (mismatches++ < 5)
+                {
+                    printf("    mismatch: %s -> %.17g vs %.17g\n", buf, value, ref);
+                }
+            }
+        }
+
+        static const char *specials[] = {"inf", "-nan", "0x1p-3", "1e400", "4.9e-324", ".5", "5."};
+        for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++)
+        {
+            const char *p = specials[i];
+            double value = 0.0;
+            FieldStatus fs = rec_parse_double(&p, specials[i] + strlen(specials[i]), &value);
+            printf("    \"%s\" -> %s", specials[i], rec_field_status_str(fs));
+            if (fs == FIELD_OK)
+            {
+                printf(" (%g)", value);
+            }
+            printf("\n");
+        }
+        check(mismatches == 0, "every double has the same bits as strtod()");
+
+        // A decimal-comma locale must not change what the slow path accepts
+        static const char *comma_locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR"};
+        const char *comma = NULL;
+        for (size_t i = 0; i < sizeof(comma_locales) / sizeof(comma_locales[0]) && comma == NULL; i++)
+        {
+            comma = setlocale(LC_NUMERIC, comma_locales[i]);
+        }
+        const char *text = "1,5";
+        const char *p = text;
+        double value = 0.0;
+        int comma_rejected = rec_parse_double(&p, text + 3, &value) == FIELD_SYNTAX;
+        text = "1.5e-400";
+        p = text;
+        int point_read = rec_parse_double(&p, text + strlen(text), &value) == FIELD_OK;
+        printf("    LC_NUMERIC for this check: %s\n", comma != NULL ? comma : "C (no decimal-comma locale installed)");
+        setlocale(LC_NUMERIC, "C");
+        check(comma_rejected && point_read, "\"1,5\" is a syntax error and strtod() fallbacks read '.'");
+
+        // The same through rec_read_person(), which has its own short-number path
+        FILE *tmp = tmpfile();
+        double *expected = malloc(200000 * sizeof(double));
+        if (tmp == NULL || expected == NULL)
+        {
+            perror("  ✗ setup failed");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < 200000; i++)
+        {
+            do
+            {
+                random_number(buf, sizeof(buf));
+                expected[i] = strtod(buf, NULL);
+            } while (isinf(expected[i]));
+            fprintf(tmp, "First Last %d %s\n", i, buf);
+        }
+        fflush(tmp);
+        lseek(fileno(tmp), 0, SEEK_SET);
+
+        RecReader *r = rec_reader_open(fileno(tmp), 0);
+        PersonRecord rec;
+        int same = 0;
+        while (r != NULL && rec_read_person(r, &rec, NULL) == REC_OK)
+        {
+            same += rec.age >= 0 && rec.age < 200000 &&
+                    memcmp(&rec.height, &expected[rec.age], sizeof(double)) == 0;
+        }
+        check(same == 200000, "same bits when read as records (200,000 lines)");
+        rec_reader_close(r);
+        fclose(tmp);
+        free(expected);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. One record per line; blank lines are skipped\n");
+    printf("2. \"%%s\" into char[50] can overflow; here long words are errors\n");
+    printf("3. Numbers must be the whole field (\"12x\" is rejected, not 12)\n");
+    printf("4. Number parsing ignores the locale: the decimal point is always '.'\n");
+    printf("5. Run ./recparse_bench for the comparison with fscanf()\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/*
+ * Fast I/O - scratch.c
+ *
+ * Implementation of scratch streams.
+ *
+ * The cookie keeps its own position and length, so once the data is in a
+ * file it uses pread()/pwrite() at that position and never lseek()s.
+ * stdio's buffer still sits in front of it: the callbacks see whole
+ * buffers, not single fprintf()s. The memory buffer grows by doubling,
+ * never past the threshold; the write that would take the stream past it
+ * moves everything to the file first.
+ */
+
+#define _GNU_SOURCE // fopencookie(); the rest is POSIX.1-2008
+
+#include "scratch.h"
+#include "vecio.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#define SS_COOKIE 1
+#endif
+
+#define DEFAULT_THRESHOLD ((size_t)1 << 20)
+
+struct ScratchStream
+{
+    FILE *fp;
+    char *data; // the contents, until spilled
+    size_t cap;
+    size_t len; // bytes in the stream
+    size_t pos;
+    size_t threshold;
+    int fd;     // the spill file, or -1
+    TmpPool *pool;
+    char *dir;
+    int freed_by_fclose; // ss_tmpfile()
+    ScratchStats stats;
+};
+
+static void free_stream(ScratchStream *s)
+{
+    free(s->data);
+    free(s->dir);
+    free(s);
+}
+
+#ifdef SS_COOKIE
+
+// ============================================================================
+// Memory and spilling
+// ============================================================================
+
+static void release_file(ScratchStream *s, int fd)
+{
+    if (s->pool != NULL)
+    {
+        tp_release(s->pool, fd);
+    }
+    else
+    {
+        close(fd);
+    }
+}
+
+// Move the contents to a file; from now on all I/O goes there
+static int spill(ScratchStream *s)
+{
+    int fd = s->pool ? tp_acquire_tier(s->pool, TP_DISK) : tp_mkfile(s->dir);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (s->len > 0 && vio_pwrite_all(fd, s->data, s->len, 0) != 0)
+    {
+        int saved = errno;
+        release_file(s, fd);
+        errno = saved;
+        return -1;
+    }
+    s->stats.file_calls += s->len > 0;
+    s->stats.spilled = 1;
+    s->fd = fd;
+    free(s->data);
+    s->data = NULL;
+    s->cap = 0;
+    return 0;
+}
+
+// Room for end bytes in memory, or -1 if that is past the threshold
+static int reserve(ScratchStream *s, size_t end)
+{
+    if (end > s->threshold)
+    {
+        return -1;
+    }
+    if (end <= s->cap)
+    {
+        return 0;
+    }
+    size_t cap = s->cap ? s->cap : 4096;
+    while (cap < end)
+    {
+        cap *= 2;
+    }
+    cap = cap < s->threshold ? cap : s->threshold;
+    char *data = realloc(s->data, cap);
+    if (data == NULL)
+    {
+        return -1;
+    }
+    s->data = data;
+    s->cap = cap;
+    return 0;
+}
+
+// ============================================================================
+// Cookie callbacks
+// ============================================================================
+
+static ssize_t cookie_read(void *cookie, char *buf, size_t size)
+{
+    ScratchStream *s = cookie;
+    ssize_t n;
+    if (s->fd >= 0)
+    {
+        n = vio_pread_full(s->fd, buf, size, (off_t)s->pos);
+        s->stats.file_calls++;
+    }
+    else
+    {
+        size_t left = s->pos < s->len ? s->len - s->pos : 0;
+        n = (ssize_t)(size < left ? size : left);
+        if (n > 0)
+        {
+            memcpy(buf, s->data + s->pos, (size_t)n);
+        }
+    }
+    if (n > 0)
+    {
+        s->pos += (size_t)n;
+        s->stats.bytes_read += (unsigned long long)n;
+    }
+    return n;
+}
+
+static ssize_t cookie_write(void *cookie, const char *buf, size_t size)
+{
+    ScratchStream *s = cookie;
+    size_t end = s->pos + size;
+    if (s->fd < 0 && reserve(s, end) != 0)
+    {
+        if (spill(s) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (s->fd >= 0)
+    {
+        s->stats.file_calls++;
+        if (vio_pwrite_all(s->fd, buf, size, (off_t)s->pos) != 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if (s->pos > s->len)
+        {
+            memset(s->data + s->len, 0, s->pos - s->len); // seeked past the end
+        }
+        memcpy(s->data + s->pos, buf, size);
+    }
+    s->pos = end;
+    s->len = end > s->len ? end : s->len;
+    s->stats.bytes_written += size;
+    if (s->len > s->stats.peak_size)
+    {
+        s->stats.peak_size = s->len;
+    }
+    return (ssize_t)size;
+}
+
+static int cookie_seek(void *cookie, off64_t *offset, int whence)
+{
+    ScratchStream *s = cookie;
+    off64_t base = whence == SEEK_SET ? 0 : whence == SEEK_CUR ? (off64_t)s->pos : (off64_t)s->len;
+    if ((whence != SEEK_SET && whence != SEEK_CUR && whence != SEEK_END) || base + *offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    s->pos = (size_t)(base + *offset);
+    *offset = (off64_t)s->pos;
+    return 0;
+}
+
+static int cookie_close(void *cookie)
+{
+    ScratchStream *s = cookie;
+    if (s->fd >= 0)
+    {
+        release_file(s, s->fd);
+        s->fd = -1;
+    }
+    free(s->data);
+    s->data = NULL;
+    if (s->freed_by_fclose)
+    {
+        free_stream(s);
+    }
+    return 0;
+}
+
+#endif // SS_COOKIE
+
+// ============================================================================
+// Opening and closing
+// ============================================================================
+
+static ScratchStream *open_stream(const ScratchConfig *config, int freed_by_fclose)
+{
+    ScratchConfig defaults = {0};
+    const ScratchConfig *c = config ? config : &defaults;
+    ScratchStream *s = calloc(1, sizeof(ScratchStream));
+    if (s == NULL)
+    {
+        return NULL;
+    }
+    s->fd = -1;
+    s->threshold = c->threshold ? c->threshold : DEFAULT_THRESHOLD;
+    s->pool = c->pool;
+    s->freed_by_fclose = freed_by_fclose;
+    if (c->dir != NULL && (s->dir = strdup(c->dir)) == NULL)
+    {
+        free(s);
+        return NULL;
+    }
+
+#ifdef SS_COOKIE
+    cookie_io_functions_t io = {cookie_read, cookie_write, cookie_seek, cookie_close};
+    s->fp = fopencookie(s, "w+", io);
+#else
+    s->fp = tmpfile();
+#endif
+    if (s->fp == NULL)
+    {
+        int saved = errno;
+        free_stream(s);
+        errno = saved;
+        return NULL;
+    }
+    return s;
+}
+
+ScratchStream *ss_open(const ScratchConfig *config)
+{
+    return open_stream(config, 0);
+}
+
+FILE *ss_file(ScratchStream *s)
+{
+    return s->fp;
+}
+
+ScratchStats ss_stats(const ScratchStream *s)
+{
+    return s->stats;
+}
+
+int ss_close(ScratchStream *s, ScratchStats *final)
+{
+    if (s == NULL)
+    {
+        return 0;
+    }
+    int rc = fclose(s->fp);
+    if (final != NULL)
+    {
+        *final = s->stats;
+    }
+    free_stream(s);
+    return rc;
+}
+
+FILE *ss_tmpfile(size_t threshold)
+{
+    ScratchConfig config = {threshold, NULL, NULL};
+#ifdef SS_COOKIE
+    ScratchStream *s = open_stream(&config, 1);
+    return s ? s->fp : NULL;
+#else
+    (void)config;
+    return tmpfile();
+#endif
+}
@@ -0,0 +1,67 @@
+/*
+ * Fast I/O - scratch.h
+ *
+ * Scratch streams: a tmpfile() replacement that stays in memory until it
+ * grows large.
+ *
+ * Test 12 of ch08/listings/temp_files.c writes a few numbers to a
+ * tmpfile(), rewinds and reads them back. tmpfile() creates a file on
+ * disk for that, however little is written, and every fflush() and
+ * rewind() becomes a system call. A scratch stream is an ordinary FILE
+ * (fprintf(), fscanf(), fseek(), ...) whose data lives in a growable
+ * memory buffer. Only if it grows past a threshold is the data moved to an
+ * unnamed temporary file (see tmppool.h), and from then on it reads and
+ * writes that file. Jobs that stay under the threshold make no file
+ * system calls at all.
+ *
+ * The FILE is a custom stream (fopencookie()). Where that is not
+ * available, ss_open() returns a plain tmpfile(): always on disk, and the
+ * counters stay at 0.
+ */
+
+#ifndef FASTIO_SCRATCH_H
+#define FASTIO_SCRATCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "tmppool.h"
+
+typedef struct
+{
+    size_t threshold; // bytes kept in memory (0 = 1 MiB)
+    const char *dir;  // for the spill file (NULL = $TMPDIR, else /tmp)
+    TmpPool *pool;    // if not NULL, the spill file comes from this pool
+} ScratchConfig;
+
+typedef struct
+{
+    unsigned long long bytes_written; // through the stream, after stdio's buffer
+    unsigned long long bytes_read;
+    unsigned long long peak_size;
+    unsigned long long file_calls; // read()/write() calls on the spill file
+    int spilled;                   // 1 once the data has moved to a file
+} ScratchStats;
+
+typedef struct ScratchStream ScratchStream;
+
+// A new, empty stream open for reading and writing ("w+", like
+// tmpfile()). config may be NULL for the defaults. Returns NULL with
+// errno set on failure.
+ScratchStream *ss_open(const ScratchConfig *config);
+
+// The stdio stream. Do not fclose() it: use ss_close().
+FILE *ss_file(ScratchStream *s);
+
+// Counters so far. Output still in stdio's buffer is not counted yet.
+ScratchStats ss_stats(const ScratchStream *s);
+
+// Close the stream and free its memory or file. If final is not NULL it
+// receives the counters after the last flush. Returns 0, or EOF if the
+// flush failed.
+int ss_close(ScratchStream *s, ScratchStats *final);
+
+// Drop-in for tmpfile(): a scratch stream with the given threshold (0 =
+// 1 MiB) that fclose() frees
+FILE *ss_tmpfile(size_t threshold);
+
+#endif /* FASTIO_SCRATCH_H */
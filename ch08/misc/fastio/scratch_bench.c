@@ -0,0 +1,101 @@
+/*
+ * Fast I/O - scratch_bench.c
+ *
+ * Jobs per second for the Test 12 pattern of ch08/listings/temp_files.c:
+ * open scratch space, fprintf() numbers into it, rewind, fscanf() them
+ * back and sum them, close. tmpfile() against ss_tmpfile() at job sizes
+ * from a few hundred bytes to past the 1 MiB spill threshold.
+ *
+ * Usage: ./scratch_bench [seconds_per_row]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "scratch.h"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// One job of count numbers; returns their sum, or -1 on error
+static long long job(int scratch, long count)
+{
+    FILE *tmp = scratch ? ss_tmpfile(0) : tmpfile();
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    for (long i = 1; i <= count; i++)
+    {
+        fprintf(tmp, "%ld\n", i * i);
+    }
+    rewind(tmp);
+    long long sum = 0;
+    long value;
+    while (fscanf(tmp, "%ld", &value) == 1)
+    {
+        sum += value;
+    }
+    return fclose(tmp) == 0 ? sum : -1;
+}
+
+// Jobs per second over about `seconds`, or a negative value on error
+static double rate(int scratch, long count, double seconds)
+{
+    long long expect = (long long)count * (count + 1) * (2 * count + 1) / 6;
+    long jobs = 0;
+    double t0 = now_seconds();
+    double t;
+    do
+    {
+        if (job(scratch, count) != expect)
+        {
+            return -1;
+        }
+        jobs++;
+        t = now_seconds() - t0;
+    } while (t < seconds);
+    return (double)jobs / t;
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 0.5;
+    if (seconds <= 0)
+    {
+        fprintf(stderr, "Usage: %s [seconds_per_row]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("=== Scratch Stream Benchmark ===\n\n");
+    printf("fprintf() n squares, rewind, fscanf() and sum; %.1f s per row\n\n", seconds);
+    printf("  %-10s %10s %14s %14s %8s\n", "Numbers", "Bytes", "tmpfile()/s", "scratch/s", "Speedup");
+
+    long counts[] = {10, 100, 1000, 10000, 200000};
+    int ok = 1;
+    for (size_t i = 0; ok && i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        long long bytes = 0;
+        for (long k = 1; k <= counts[i]; k++)
+        {
+            bytes += snprintf(NULL, 0, "%ld\n", k * k);
+        }
+        double disk = rate(0, counts[i], seconds);
+        double memory = rate(1, counts[i], seconds);
+        ok = disk > 0 && memory > 0;
+        if (ok)
+        {
+            printf("  %-10ld %10lld %14.0f %14.0f %7.1fx%s\n", counts[i], bytes, disk, memory, memory / disk,
+                   bytes > (1 << 20) ? " (spilled)" : "");
+        }
+    }
+
+    printf("\n%s Every job summed correctly both ways\n", ok ? "✓" : "✗");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
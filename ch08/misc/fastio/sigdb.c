@@ -0,0 +1,402 @@
+/*
+ * Fast I/O - sigdb.c
+ *
+ * Implementation of the signal record database.
+ *
+ * The name index is a hash-and-displace perfect hash. Names are spread
+ * over buckets (about two per bucket) by sigdb_hash(name, 0). Each bucket
+ * then gets the first seed d for which sigdb_hash(name, d) puts all of
+ * its names in slots nobody has taken yet. Buckets are placed largest
+ * first, while most slots are still free. There are exactly as many slots
+ * as records, so the table is minimal.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "sigdb.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_SEED 1000000
+
+struct SigDb
+{
+    void *map;
+    size_t map_size;
+    const SigRecord *recs;
+    size_t count;
+    int32_t *by_num; // signum -> record, -1 for none
+    int max_signum;
+    SigHash hash;
+    uint32_t *own_disp; // set when the table was built here
+    uint32_t *own_index;
+    int precomputed;
+};
+
+uint32_t sigdb_hash(const char *name, uint32_t seed)
+{
+    // FNV-1a, then the MurmurHash3 finalizer so the low bits the modulo
+    // keeps depend on every byte
+    uint32_t h = (2166136261u ^ seed) * 16777619u;
+    for (const unsigned char *p = (const unsigned char *)name; *p != '\0'; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static uint32_t slot_of(const SigHash *h, const char *name)
+{
+    uint32_t b = sigdb_hash(name, 0) % h->buckets;
+    return sigdb_hash(name, h->disp[b]) % h->slots;
+}
+
+// ============================================================================
+// Building the indexes
+// ============================================================================
+
+static int check_records(const SigRecord *recs, size_t n, int *max_signum)
+{
+    *max_signum = -1;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (recs[i].signum < 0 || recs[i].signum > SIGDB_MAX_SIGNUM ||
+            memchr(recs[i].signame, '\0', sizeof(recs[i].signame)) == NULL ||
+            memchr(recs[i].sigdesc, '\0', sizeof(recs[i].sigdesc)) == NULL)
+        {
+            return -1;
+        }
+        if (recs[i].signum > *max_signum)
+        {
+            *max_signum = recs[i].signum;
+        }
+    }
+    return 0;
+}
+
+static int build_by_num(SigDb *db)
+{
+    db->by_num = malloc(((size_t)db->max_signum + 1) * sizeof(int32_t));
+    if (db->by_num == NULL)
+    {
+        return -1;
+    }
+    for (int s = 0; s <= db->max_signum; s++)
+    {
+        db->by_num[s] = -1;
+    }
+    for (size_t i = 0; i < db->count; i++)
+    {
+        int32_t *entry = &db->by_num[db->recs[i].signum];
+        if (*entry >= 0)
+        {
+            errno = EINVAL; // duplicate signum
+            return -1;
+        }
+        *entry = (int32_t)i;
+    }
+    return 0;
+}
+
+// Does the table put every record in its own slot?
+static bool hash_matches(const SigHash *h, const SigRecord *recs, size_t n)
+{
+    if (h->slots != n || h->buckets == 0 || h->disp == NULL || h->index == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        if (h->index[slot_of(h, recs[i].signame)] != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct
+{
+    uint32_t bucket;
+    uint32_t size;
+} BucketSize;
+
+static int larger_first(const void *a, const void *b)
+{
+    const BucketSize *x = a;
+    const BucketSize *y = b;
+    if (x->size != y->size)
+    {
+        return x->size > y->size ? -1 : 1;
+    }
+    return x->bucket < y->bucket ? -1 : x->bucket > y->bucket;
+}
+
+// Place the members of one bucket. Returns the seed, or 0 if none fits.
+static uint32_t place_bucket(const SigRecord *recs, const uint32_t *members, uint32_t size, uint32_t slots,
+                             bool *taken, uint32_t *index, uint32_t *tmp)
+{
+    // Equal names always share a bucket, and no seed separates them
+    for (uint32_t i = 0; i < size; i++)
+    {
+        for (uint32_t k = i + 1; k < size; k++)
+        {
+            if (strcmp(recs[members[i]].signame, recs[members[k]].signame) == 0)
+            {
+                return 0;
+            }
+        }
+    }
+    for (uint32_t d = 1; d <= MAX_SEED; d++)
+    {
+        uint32_t placed = 0;
+        for (; placed < size; placed++)
+        {
+            uint32_t s = sigdb_hash(recs[members[placed]].signame, d) % slots;
+            bool clash = taken[s];
+            for (uint32_t k = 0; k < placed && !clash; k++)
+            {
+                clash = tmp[k] == s;
+            }
+            if (clash)
+            {
+                break;
+            }
+            tmp[placed] = s;
+        }
+        if (placed == size)
+        {
+            for (uint32_t k = 0; k < size; k++)
+            {
+                taken[tmp[k]] = true;
+                index[tmp[k]] = members[k];
+            }
+            return d;
+        }
+    }
+    return 0;
+}
+
+static int build_hash(SigDb *db)
+{
+    uint32_t n = (uint32_t)db->count;
+    uint32_t nb = n / 2 + 1;
+    uint32_t *disp = calloc(nb, sizeof(uint32_t));
+    uint32_t *index = malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *start = calloc((size_t)nb + 1, sizeof(uint32_t));
+    uint32_t *members = malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *fill = malloc((size_t)nb * sizeof(uint32_t));
+    uint32_t *tmp = malloc((size_t)n * sizeof(uint32_t));
+    BucketSize *order = malloc((size_t)nb * sizeof(BucketSize));
+    bool *taken = calloc(n, sizeof(bool));
+    int rc = -1;
+    if (disp == NULL || index == NULL || start == NULL || members == NULL || fill == NULL || tmp == NULL ||
+        order == NULL || taken == NULL)
+    {
+        goto done;
+    }
+
+    // Group the records by bucket (counting sort)
+    for (uint32_t i = 0; i < n; i++)
+    {
+        start[sigdb_hash(db->recs[i].signame, 0) % nb + 1]++;
+    }
+    for (uint32_t b = 0; b < nb; b++)
+    {
+        order[b] = (BucketSize){b, start[b + 1]};
+        start[b + 1] += start[b];
+    }
+    memcpy(fill, start, (size_t)nb * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        members[fill[sigdb_hash(db->recs[i].signame, 0) % nb]++] = i;
+    }
+    qsort(order, nb, sizeof(BucketSize), larger_first);
+
+    for (uint32_t k = 0; k < nb && order[k].size > 0; k++)
+    {
+        uint32_t b = order[k].bucket;
+        disp[b] = place_bucket(db->recs, members + start[b], order[k].size, n, taken, index, tmp);
+        if (disp[b] == 0)
+        {
+            errno = EINVAL; // duplicate name
+            goto done;
+        }
+    }
+
+    db->hash = (SigHash){nb, n, disp, index};
+    db->own_disp = disp;
+    db->own_index = index;
+    disp = NULL;
+    index = NULL;
+    rc = 0;
+
+done:
+    if (rc != 0 && errno == 0)
+    {
+        errno = ENOMEM;
+    }
+    free(disp);
+    free(index);
+    free(start);
+    free(members);
+    free(fill);
+    free(tmp);
+    free(order);
+    free(taken);
+    return rc;
+}
+
+// ============================================================================
+// Opening and lookups
+// ============================================================================
+
+SigDb *sigdb_open(const char *path, const SigHash *hash)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+    if (st.st_size % (off_t)sizeof(SigRecord) != 0)
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    SigDb *db = calloc(1, sizeof(SigDb));
+    if (db == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+    db->map = MAP_FAILED;
+    db->count = (size_t)st.st_size / sizeof(SigRecord);
+    if (db->count > 0)
+    {
+        db->map_size = (size_t)st.st_size;
+        db->map = mmap(NULL, db->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    int saved = errno;
+    close(fd); // the mapping stays valid
+    if (db->count > 0 && db->map == MAP_FAILED)
+    {
+        free(db);
+        errno = saved;
+        return NULL;
+    }
+    db->recs = db->map != MAP_FAILED ? db->map : NULL;
+
+    errno = 0;
+    if (check_records(db->recs, db->count, &db->max_signum) != 0)
+    {
+        errno = EINVAL;
+    }
+    else if (db->count == 0)
+    {
+        return db;
+    }
+    else if (build_by_num(db) == 0)
+    {
+        if (hash != NULL && hash_matches(hash, db->recs, db->count))
+        {
+            db->hash = *hash;
+            db->precomputed = 1;
+            return db;
+        }
+        if (build_hash(db) == 0)
+        {
+            return db;
+        }
+    }
+    saved = errno ? errno : ENOMEM;
+    sigdb_close(db);
+    errno = saved;
+    return NULL;
+}
+
+size_t sigdb_count(const SigDb *db)
+{
+    return db->count;
+}
+
+const SigRecord *sigdb_record(const SigDb *db, size_t i)
+{
+    return i < db->count ? &db->recs[i] : NULL;
+}
+
+const SigRecord *sigdb_by_num(const SigDb *db, int signum)
+{
+    if (signum < 0 || signum > db->max_signum || db->by_num[signum] < 0)
+    {
+        return NULL;
+    }
+    return &db->recs[db->by_num[signum]];
+}
+
+static const SigRecord *find_name(const SigDb *db, const char *name)
+{
+    const SigRecord *r = &db->recs[db->hash.index[slot_of(&db->hash, name)]];
+    return strcmp(r->signame, name) == 0 ? r : NULL;
+}
+
+const SigRecord *sigdb_by_name(const SigDb *db, const char *name)
+{
+    if (db->count == 0)
+    {
+        return NULL;
+    }
+    const SigRecord *r = find_name(db, name);
+    if (r == NULL && strncmp(name, "SIG", 3) == 0)
+    {
+        r = find_name(db, name + 3);
+    }
+    return r;
+}
+
+const SigHash *sigdb_hash_table(const SigDb *db)
+{
+    return &db->hash;
+}
+
+int sigdb_precomputed(const SigDb *db)
+{
+    return db->precomputed;
+}
+
+void sigdb_close(SigDb *db)
+{
+    if (db == NULL)
+    {
+        return;
+    }
+    if (db->map != MAP_FAILED)
+    {
+        munmap(db->map, db->map_size);
+    }
+    free(db->by_num);
+    free(db->own_disp);
+    free(db->own_index);
+    free(db);
+}
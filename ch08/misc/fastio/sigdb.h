@@ -0,0 +1,82 @@
+/*
+ * Fast I/O - sigdb.h
+ *
+ * In-memory signal record database with O(1) lookup by number and by
+ * name.
+ *
+ * ch08/misc/signals_read.c finds a sigrecord in signals.dat by seeking to
+ * its position; finding one by signum or signame means reading the whole
+ * file. sigdb_open() maps the file once with mmap() and builds two
+ * indexes over the records in place:
+ *
+ *   - a dense array indexed by signum
+ *   - a minimal perfect hash over signame: every name has its own slot,
+ *     so a lookup is two hashes and one strcmp()
+ *
+ * After sigdb_open() no lookup touches the file.
+ *
+ * The perfect hash takes a search to build. sigdb_gen computes it at build
+ * time and writes it out as a C header; passing that SigHash to
+ * sigdb_open() skips the search. If the file no longer matches the table,
+ * sigdb_open() notices and builds a new one.
+ *
+ * sigdb_open() returns NULL with errno set on failure: EINVAL for a file
+ * that is not a whole number of records, a name or description without
+ * its terminating NUL, a signum outside 0..SIGDB_MAX_SIGNUM or a duplicate
+ * number or name.
+ */
+
+#ifndef FASTIO_SIGDB_H
+#define FASTIO_SIGDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIGDB_MAX_SIGNUM 1023
+
+// The record of ch08/misc/signals_write.c, byte for byte
+typedef struct
+{
+    int signum;
+    char signame[10]; // without the "SIG" prefix: "USR1"
+    char sigdesc[100];
+} SigRecord;
+
+// Perfect hash over the names: record sigdb_index[s] is the only one whose
+// name can hash to slot s
+typedef struct
+{
+    uint32_t buckets;
+    uint32_t slots;        // == number of records
+    const uint32_t *disp;  // per-bucket seed for the second hash
+    const uint32_t *index; // slot -> record
+} SigHash;
+
+typedef struct SigDb SigDb;
+
+// Map path and index it. hash may be NULL, or a table from sigdb_gen.
+SigDb *sigdb_open(const char *path, const SigHash *hash);
+
+size_t sigdb_count(const SigDb *db);
+
+// Records in file order, i < sigdb_count()
+const SigRecord *sigdb_record(const SigDb *db, size_t i);
+
+// NULL if there is no such signal
+const SigRecord *sigdb_by_num(const SigDb *db, int signum);
+
+// "USR1" or "SIGUSR1". NULL if there is no such signal.
+const SigRecord *sigdb_by_name(const SigDb *db, const char *name);
+
+// The table in use, for sigdb_gen
+const SigHash *sigdb_hash_table(const SigDb *db);
+
+// 1 if sigdb_open() used the SigHash it was given, 0 if it built one
+int sigdb_precomputed(const SigDb *db);
+
+void sigdb_close(SigDb *db);
+
+// The name hash; seed 0 picks the bucket
+uint32_t sigdb_hash(const char *name, uint32_t seed);
+
+#endif /* FASTIO_SIGDB_H */
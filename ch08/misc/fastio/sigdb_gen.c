@@ -0,0 +1,159 @@
+/*
+ * Fast I/O - sigdb_gen.c
+ *
+ * Build-time generator for the signal database.
+ *
+ *   ./sigdb_gen -w sigdb.dat      write this system's signals as SigRecords
+ *                                 (the format of ch08/misc/signals_write.c)
+ *   ./sigdb_gen sigdb.dat [name]  print a C header with the perfect hash
+ *                                 for that file, as a SigHash called name
+ *                                 (default sigdb_table)
+ *
+ * The Makefile runs both, so programs that include the header open the
+ * file without searching for a hash at run time.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sigdb.h"
+
+typedef struct
+{
+    int signum;
+    const char *name;
+    const char *desc;
+} SignalInfo;
+
+static const SignalInfo signals[] = {
+    {SIGHUP, "HUP", "hangup"},
+    {SIGINT, "INT", "interrupt"},
+    {SIGQUIT, "QUIT", "quit"},
+    {SIGILL, "ILL", "illegal instruction"},
+    {SIGTRAP, "TRAP", "trace/breakpoint trap"},
+    {SIGABRT, "ABRT", "aborted"},
+    {SIGBUS, "BUS", "bus error"},
+    {SIGFPE, "FPE", "floating-point exception"},
+    {SIGKILL, "KILL", "killed"},
+    {SIGUSR1, "USR1", "user-defined signal 1"},
+    {SIGSEGV, "SEGV", "segmentation fault"},
+    {SIGUSR2, "USR2", "user-defined signal 2"},
+    {SIGPIPE, "PIPE", "broken pipe"},
+    {SIGALRM, "ALRM", "alarm clock"},
+    {SIGTERM, "TERM", "terminated"},
+    {SIGCHLD, "CHLD", "child exited"},
+    {SIGCONT, "CONT", "continued"},
+    {SIGSTOP, "STOP", "stopped (signal)"},
+    {SIGTSTP, "TSTP", "stopped"},
+    {SIGTTIN, "TTIN", "stopped (tty input)"},
+    {SIGTTOU, "TTOU", "stopped (tty output)"},
+    {SIGURG, "URG", "urgent I/O condition"},
+    {SIGXCPU, "XCPU", "CPU time limit exceeded"},
+    {SIGXFSZ, "XFSZ", "file size limit exceeded"},
+    {SIGVTALRM, "VTALRM", "virtual timer expired"},
+    {SIGPROF, "PROF", "profiling timer expired"},
+    {SIGSYS, "SYS", "bad system call"},
+#ifdef SIGWINCH
+    {SIGWINCH, "WINCH", "window changed"},
+#endif
+#ifdef SIGPOLL
+    {SIGPOLL, "POLL", "I/O possible"},
+#endif
+};
+
+static int write_signals(const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    size_t n = sizeof(signals) / sizeof(signals[0]);
+    size_t written = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        // Where two names share a number (SIGIO/SIGPOLL), keep the first
+        int seen = 0;
+        for (size_t k = 0; k < i; k++)
+        {
+            seen |= signals[k].signum == signals[i].signum;
+        }
+        if (seen)
+        {
+            continue;
+        }
+        SigRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.signum = signals[i].signum;
+        snprintf(rec.signame, sizeof(rec.signame), "%s", signals[i].name);
+        snprintf(rec.sigdesc, sizeof(rec.sigdesc), "%s", signals[i].desc);
+        if (fwrite(&rec, sizeof(rec), 1, fp) != 1)
+        {
+            perror(path);
+            fclose(fp);
+            return EXIT_FAILURE;
+        }
+        written++;
+    }
+    if (fclose(fp) == EOF)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%s: %zu signals\n", path, written);
+    return EXIT_SUCCESS;
+}
+
+static void print_array(const char *name, const char *suffix, const uint32_t *values, uint32_t n)
+{
+    printf("static const uint32_t %s_%s[%u] = {", name, suffix, n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        printf("%s%u,", i % 8 == 0 ? "\n    " : " ", values[i]);
+    }
+    printf("\n};\n\n");
+}
+
+static int print_table(const char *path, const char *name)
+{
+    SigDb *db = sigdb_open(path, NULL);
+    if (db == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    const SigHash *h = sigdb_hash_table(db);
+    if (h->slots == 0)
+    {
+        fprintf(stderr, "%s: no records\n", path);
+        sigdb_close(db);
+        return EXIT_FAILURE;
+    }
+
+    printf("/*\n * Generated by sigdb_gen from %s: do not edit.\n *\n", path);
+    printf(" * Perfect hash over the %u signal names, for sigdb_open().\n */\n\n", h->slots);
+    printf("#include \"sigdb.h\"\n\n");
+    print_array(name, "disp", h->disp, h->buckets);
+    print_array(name, "index", h->index, h->slots);
+    printf("static const SigHash %s = {%u, %u, %s_disp, %s_index};\n", name, h->buckets, h->slots, name, name);
+    sigdb_close(db);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && strcmp(argv[1], "-w") == 0)
+    {
+        return write_signals(argv[2]);
+    }
+    if (argc == 2 || argc == 3)
+    {
+        return print_table(argv[1], argc == 3 ? argv[2] : "sigdb_table");
+    }
+    fprintf(stderr, "Usage: %s -w file | %s file [name]\n", argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
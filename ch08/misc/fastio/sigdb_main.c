@@ -0,0 +1,214 @@
+/*
+ * Fast I/O - sigdb_main.c
+ *
+ * Demonstrates the signal record database: the sigrecord file of
+ * ch08/misc/signals_write.c mapped once and queried by number and by name
+ * with no further I/O, using the hash sigdb_gen computed at build time.
+ *
+ * Run from the build directory: it reads sigdb.dat, which make creates.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sigdb.h"
+#include "sigdb_table.h"
+
+#define LOOKUPS 1000000
+#define SCANS 20000
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int write_records(const char *path, const SigRecord *recs, size_t n)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    size_t written = fwrite(recs, sizeof(SigRecord), n, fp);
+    return fclose(fp) == 0 && written == n ? 0 : -1;
+}
+
+// signals_read.c style: read records until the name matches
+static int scan_for(FILE *fp, const char *name, SigRecord *out)
+{
+    rewind(fp);
+    while (fread(out, sizeof(*out), 1, fp) == 1)
+    {
+        if (strcmp(out->signame, name) == 0)
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int main(void)
+{
+    printf("=== Signal Record Database ===\n\n");
+
+    SigDb *db = sigdb_open("sigdb.dat", &sigdb_table);
+    if (db == NULL)
+    {
+        perror("sigdb.dat (run make first)");
+        return EXIT_FAILURE;
+    }
+
+    // Test 1: Opening with the build-time hash
+    printf("Test 1: Mapping sigdb.dat with the generated hash\n");
+    {
+        const SigHash *h = sigdb_hash_table(db);
+        printf("  %zu records of %zu bytes, %u buckets, %u slots\n", sigdb_count(db), sizeof(SigRecord), h->buckets,
+               h->slots);
+        check(sigdb_precomputed(db) && h->slots == sigdb_count(db), "hash from sigdb_table.h accepted, not rebuilt");
+    }
+    printf("\n");
+
+    // Test 2: Lookups
+    printf("Test 2: Lookups by number and by name\n");
+    {
+        const SigRecord *usr1 = sigdb_by_num(db, SIGUSR1);
+        const SigRecord *term = sigdb_by_name(db, "TERM");
+        printf("  Signal %d: %s (%s)\n", SIGUSR1, usr1 ? usr1->signame : "?", usr1 ? usr1->sigdesc : "?");
+        printf("  TERM: number %d (%s)\n", term ? term->signum : -1, term ? term->sigdesc : "?");
+        check(usr1 != NULL && strcmp(usr1->signame, "USR1") == 0 && term != NULL && term->signum == SIGTERM,
+              "SIGUSR1 by number, TERM by name");
+        check(sigdb_by_name(db, "SIGKILL") == sigdb_by_num(db, SIGKILL), "\"SIGKILL\" accepted as well as \"KILL\"");
+
+        int all = 1;
+        for (size_t i = 0; i < sigdb_count(db); i++)
+        {
+            const SigRecord *r = sigdb_record(db, i);
+            all = all && sigdb_by_num(db, r->signum) == r && sigdb_by_name(db, r->signame) == r;
+        }
+        check(all, "every record found both ways");
+        check(sigdb_by_name(db, "NOSUCH") == NULL && sigdb_by_name(db, "") == NULL && sigdb_by_num(db, 0) == NULL &&
+                  sigdb_by_num(db, -1) == NULL && sigdb_by_num(db, 100000) == NULL,
+              "unknown names and numbers give NULL");
+    }
+    printf("\n");
+
+    // Test 3: The file written by signals_write.c, no precomputed hash
+    printf("Test 3: The two records of ch08/misc/signals_write.c\n");
+    char path[] = "/tmp/sigdb_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    {
+        SigRecord recs[] = {{30, "USR1", "user-defined signal 1"}, {31, "USR2", "user-defined signal 2"}};
+        SigDb *small = write_records(path, recs, 2) == 0 ? sigdb_open(path, NULL) : NULL;
+        const SigRecord *second = small ? sigdb_by_num(small, 31) : NULL;
+        printf("  Signal\n    number = %d\n    name = %s\n    description = %s\n", second ? second->signum : -1,
+               second ? second->signame : "?", second ? second->sigdesc : "?");
+        const SigRecord *first = small ? sigdb_by_name(small, "USR1") : NULL;
+        check(second != NULL && strcmp(second->signame, "USR2") == 0 && first != NULL && first->signum == 30,
+              "no fseek(): signal 31 by number, USR1 by name");
+        check(small != NULL && !sigdb_precomputed(small), "hash built at load time");
+        sigdb_close(small);
+
+        // sigdb_table.h describes sigdb.dat, not this file
+        small = sigdb_open(path, &sigdb_table);
+        check(small != NULL && !sigdb_precomputed(small) && sigdb_by_name(small, "USR2") != NULL,
+              "stale table detected and replaced");
+        sigdb_close(small);
+    }
+    printf("\n");
+
+    // Test 4: Bad files
+    printf("Test 4: Rejecting malformed files\n");
+    {
+        SigRecord dup[] = {{1, "HUP", "hangup"}, {2, "HUP", "again"}};
+        write_records(path, dup, 2);
+        errno = 0;
+        SigDb *bad = sigdb_open(path, NULL);
+        check(bad == NULL && errno == EINVAL, "duplicate name: EINVAL");
+
+        SigRecord num[] = {{1, "HUP", "hangup"}, {1, "INT", "interrupt"}};
+        write_records(path, num, 2);
+        errno = 0;
+        bad = sigdb_open(path, NULL);
+        check(bad == NULL && errno == EINVAL, "duplicate number: EINVAL");
+
+        write_records(path, num, 1);
+        truncate(path, sizeof(SigRecord) - 4);
+        errno = 0;
+        bad = sigdb_open(path, NULL);
+        check(bad == NULL && errno == EINVAL, "partial record: EINVAL");
+
+        truncate(path, 0);
+        bad = sigdb_open(path, NULL);
+        check(bad != NULL && sigdb_count(bad) == 0 && sigdb_by_name(bad, "HUP") == NULL, "empty file: no records");
+        sigdb_close(bad);
+    }
+    printf("\n");
+    unlink(path);
+
+    // Test 5: Lookup cost
+    printf("Test 5: %d name lookups against a scan of the file\n", LOOKUPS);
+    {
+        size_t n = sigdb_count(db);
+        double t0 = now_seconds();
+        size_t found = 0;
+        for (int i = 0; i < LOOKUPS; i++)
+        {
+            found += sigdb_by_name(db, sigdb_record(db, (size_t)i % n)->signame) != NULL;
+        }
+        double hashed = (now_seconds() - t0) / LOOKUPS;
+
+        FILE *fp = fopen("sigdb.dat", "rb");
+        SigRecord rec;
+        size_t scanned = 0;
+        t0 = now_seconds();
+        for (int i = 0; fp != NULL && i < SCANS; i++)
+        {
+            scanned += scan_for(fp, sigdb_record(db, (size_t)i % n)->signame, &rec) == 0;
+        }
+        double scan = (now_seconds() - t0) / SCANS;
+        if (fp != NULL)
+        {
+            fclose(fp);
+        }
+        printf("  sigdb_by_name(): %.1f ns, fread() scan: %.1f ns (%.0fx)\n", hashed * 1e9, scan * 1e9,
+               hashed > 0 ? scan / hashed : 0.0);
+        check(found == LOOKUPS && scanned == SCANS, "both found every name");
+    }
+    printf("\n");
+
+    sigdb_close(db);
+
+    printf("=== Important Notes ===\n");
+    printf("1. The file is mapped once; lookups read only memory\n");
+    printf("2. By number: one array index. By name: two hashes and one strcmp()\n");
+    printf("3. sigdb_gen computes the name hash at build time (sigdb_table.h)\n");
+    printf("4. A table that does not match the file is detected and rebuilt\n");
+    printf("5. Records keep the layout of signals_write.c, so its files load as is\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
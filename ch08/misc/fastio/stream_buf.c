@@ -0,0 +1,290 @@
+/*
+ * Fast I/O - stream_buf.c
+ *
+ * Implementation of the buffered streams.
+ *
+ * With glibc the FILE is created with fopencookie() over callbacks that
+ * make the read(), write() and lseek() calls themselves and count them.
+ * stdio still does all the buffering: the callbacks only see whole
+ * buffers, except for fwrite()/fread() calls larger than the buffer,
+ * which stdio passes straight through.
+ */
+
+#define _GNU_SOURCE // fopencookie(); the rest is POSIX.1-2008
+
+#include "stream_buf.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#define BS_COOKIE 1
+#endif
+
+#define DEFAULT_SIZE ((size_t)64 << 10)
+#define SEQUENTIAL_MIN ((size_t)1 << 20)
+#define SEQUENTIAL_MAX ((size_t)16 << 20)
+
+struct BufferedStream
+{
+    FILE *fp;
+    int fd;
+    char *buf;
+    size_t size;
+    BsStats stats;
+};
+
+static size_t page_size(void)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? (size_t)page : 4096;
+}
+
+static size_t round_up(size_t n, size_t unit)
+{
+    return (n + unit - 1) / unit * unit;
+}
+
+size_t bs_choose_size(size_t blksize, BsHint hint, unsigned long long file_size)
+{
+    size_t page = page_size();
+    size_t blk = blksize ? blksize : 4096;
+    size_t unit = blk > page ? blk : page;
+    if (unit % (blk < page ? blk : page) != 0)
+    {
+        unit *= blk < page ? blk : page;
+    }
+
+    size_t size;
+    switch (hint)
+    {
+    case BS_SEQUENTIAL:
+        size = 64 * blk;
+        size = size < SEQUENTIAL_MIN ? SEQUENTIAL_MIN : size > SEQUENTIAL_MAX ? SEQUENTIAL_MAX : size;
+        break;
+    case BS_RANDOM:
+        size = blk;
+        break;
+    default:
+        size = DEFAULT_SIZE;
+        break;
+    }
+
+    if (file_size > 0 && file_size < size)
+    {
+        size = (size_t)file_size;
+    }
+    return round_up(size, unit);
+}
+
+// ============================================================================
+// Counting callbacks
+// ============================================================================
+
+#ifdef BS_COOKIE
+static ssize_t cookie_read(void *cookie, char *buf, size_t size)
+{
+    BufferedStream *s = cookie;
+    for (;;)
+    {
+        ssize_t n = read(s->fd, buf, size);
+        s->stats.read_calls++;
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n > 0)
+        {
+            s->stats.bytes_read += (size_t)n;
+        }
+        return n;
+    }
+}
+
+// stdio treats a short count as an error, so keep going until all is written
+static ssize_t cookie_write(void *cookie, const char *buf, size_t size)
+{
+    BufferedStream *s = cookie;
+    size_t done = 0;
+    s->stats.flushes++;
+    while (done < size)
+    {
+        ssize_t n = write(s->fd, buf + done, size - done);
+        s->stats.write_calls++;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        done += (size_t)n;
+    }
+    s->stats.bytes_written += done;
+    return done > 0 || size == 0 ? (ssize_t)done : -1;
+}
+
+static int cookie_seek(void *cookie, off64_t *offset, int whence)
+{
+    BufferedStream *s = cookie;
+    off_t pos = lseek(s->fd, (off_t)*offset, whence);
+    s->stats.seek_calls++;
+    if (pos < 0)
+    {
+        return -1;
+    }
+    *offset = pos;
+    return 0;
+}
+
+static int cookie_close(void *cookie)
+{
+    BufferedStream *s = cookie;
+    return close(s->fd);
+}
+#endif
+
+// ============================================================================
+// Opening and closing
+// ============================================================================
+
+static int mode_flags(const char *mode)
+{
+    int plus = strchr(mode, '+') != NULL;
+    switch (mode[0])
+    {
+    case 'r':
+        return plus ? O_RDWR : O_RDONLY;
+    case 'w':
+        return (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC;
+    case 'a':
+        return (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND;
+    default:
+        return -1;
+    }
+}
+
+BufferedStream *bs_open(const char *path, const char *mode, BsHint hint, size_t buffer_size)
+{
+    int flags = mode_flags(mode);
+    if (flags < 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    int fd = open(path, flags, 0666);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    BufferedStream *s = bs_fdopen(fd, mode, hint, buffer_size);
+    if (s == NULL)
+    {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return s;
+}
+
+BufferedStream *bs_fdopen(int fd, const char *mode, BsHint hint, size_t buffer_size)
+{
+    struct stat st;
+    if (mode_flags(mode) < 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        return NULL;
+    }
+    // stdio does not seek to the end before each write; the kernel must
+    if (mode[0] == 'a' && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_APPEND) != 0)
+    {
+        return NULL;
+    }
+
+    // Only a file opened for reading alone is worth capping at its size
+    int read_only = mode[0] == 'r' && strchr(mode, '+') == NULL;
+    unsigned long long file_size = (read_only && S_ISREG(st.st_mode)) ? (unsigned long long)st.st_size : 0;
+
+    BufferedStream *s = calloc(1, sizeof(BufferedStream));
+    if (s == NULL)
+    {
+        return NULL;
+    }
+    s->fd = fd;
+    s->size = buffer_size ? round_up(buffer_size, page_size())
+                          : bs_choose_size((size_t)st.st_blksize, hint, file_size);
+
+    void *buf;
+    int err = posix_memalign(&buf, page_size(), s->size);
+    if (err != 0)
+    {
+        free(s);
+        errno = err;
+        return NULL;
+    }
+    s->buf = buf;
+
+#ifdef BS_COOKIE
+    cookie_io_functions_t io = {cookie_read, cookie_write, cookie_seek, cookie_close};
+    s->fp = fopencookie(s, mode, io);
+#else
+    s->fp = fdopen(fd, mode);
+#endif
+    if (s->fp == NULL)
+    {
+        int saved = errno;
+        free(s->buf);
+        free(s);
+        errno = saved;
+        return NULL;
+    }
+    // Cannot fail on a stream with no I/O yet and a valid mode
+    setvbuf(s->fp, s->buf, _IOFBF, s->size);
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if (hint != BS_DEFAULT && S_ISREG(st.st_mode))
+    {
+        posix_fadvise(fd, 0, 0, hint == BS_SEQUENTIAL ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+    }
+#endif
+    return s;
+}
+
+FILE *bs_file(BufferedStream *s)
+{
+    return s->fp;
+}
+
+size_t bs_buffer_size(const BufferedStream *s)
+{
+    return s->size;
+}
+
+BsStats bs_stats(const BufferedStream *s)
+{
+    return s->stats;
+}
+
+int bs_close(BufferedStream *s, BsStats *final)
+{
+    if (s == NULL)
+    {
+        return 0;
+    }
+    int rc = fclose(s->fp);
+    if (final != NULL)
+    {
+        *final = s->stats;
+    }
+    free(s->buf);
+    free(s);
+    return rc;
+}
@@ -0,0 +1,368 @@
+/*
+ * Fast I/O - tmppool.c
+ *
+ * Implementation of the temporary file pool.
+ *
+ * Each tier keeps its idle descriptors on a stack, so the file released
+ * last (whose pages are most likely still cached) is reused first. A
+ * table indexed by descriptor records which tier each acquired file
+ * belongs to; it is also what rejects a descriptor released twice or one
+ * the pool never handed out. Files are created and closed outside the
+ * lock.
+ */
+
+#define _GNU_SOURCE // O_TMPFILE, memfd_create(); the rest is POSIX.1-2008
+
+#include "tmppool.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_MAX_IDLE 64
+
+enum
+{
+    NOT_OURS = 0,
+    IN_USE_DISK = 1,  // 1 + TP_DISK
+    IN_USE_MEMORY = 2 // 1 + TP_MEMORY
+};
+
+struct TmpPool
+{
+    pthread_mutex_t lock;
+    char *dir;
+    size_t memory_limit;
+    size_t max_idle;
+    int *idle[2];            // stacks of idle descriptors, by tier
+    unsigned char *owner;    // indexed by descriptor
+    size_t owner_cap;
+    atomic_bool use_tmpfile; // cleared the first time O_TMPFILE is refused
+    atomic_bool use_memfd;
+    TpStats stats;
+};
+
+// ============================================================================
+// Creating files
+// ============================================================================
+
+static int create_named(const char *dir)
+{
+    size_t size = strlen(dir) + sizeof("/tmppool.XXXXXX");
+    char *path = malloc(size);
+    if (path == NULL)
+    {
+        return -1;
+    }
+    snprintf(path, size, "%s/tmppool.XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd >= 0)
+    {
+        // The name exists only between these two calls
+        unlink(path);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    int saved = errno;
+    free(path);
+    errno = saved;
+    return fd;
+}
+
+// An unnamed file in dir. *use_tmpfile is cleared the first time the file
+// system refuses O_TMPFILE; *named is set for the mkstemp() fallback.
+static int create_unnamed(const char *dir, atomic_bool *use_tmpfile, bool *named)
+{
+    *named = false;
+#ifdef O_TMPFILE
+    if (*use_tmpfile)
+    {
+        // O_EXCL: the inode can never be given a name with linkat()
+        int fd = open(dir, O_TMPFILE | O_RDWR | O_EXCL | O_CLOEXEC, 0600);
+        if (fd >= 0)
+        {
+            return fd;
+        }
+        if (errno != EOPNOTSUPP && errno != EISDIR && errno != EINVAL)
+        {
+            return -1;
+        }
+        *use_tmpfile = false; // file system or kernel without O_TMPFILE
+    }
+#else
+    (void)use_tmpfile;
+#endif
+    *named = true;
+    return create_named(dir);
+}
+
+static const char *default_dir(void)
+{
+    const char *dir = getenv("TMPDIR");
+    return (dir != NULL && *dir != '\0') ? dir : "/tmp";
+}
+
+// A new file of the tier wanted; *tier is changed to the tier it actually
+// is in
+static int create_file(TmpPool *p, TpTier *tier, bool *named)
+{
+#ifdef MFD_CLOEXEC
+    if (*tier == TP_MEMORY && p->use_memfd)
+    {
+        *named = false;
+        int fd = memfd_create("tmppool", MFD_CLOEXEC);
+        if (fd >= 0 || errno != ENOSYS)
+        {
+            return fd;
+        }
+        p->use_memfd = false; // a race here only costs another ENOSYS
+    }
+#endif
+    *tier = TP_DISK;
+    return create_unnamed(p->dir, &p->use_tmpfile, named);
+}
+
+int tp_mkfile(const char *dir)
+{
+    atomic_bool use_tmpfile = true;
+    bool named;
+    return create_unnamed(dir ? dir : default_dir(), &use_tmpfile, &named);
+}
+
+// ============================================================================
+// The pool
+// ============================================================================
+
+TmpPool *tp_open(const TpConfig *config)
+{
+    TpConfig defaults = {0};
+    const TpConfig *c = config ? config : &defaults;
+    const char *dir = c->dir ? c->dir : default_dir();
+
+    struct stat st;
+    if (stat(dir, &st) != 0)
+    {
+        return NULL;
+    }
+    if (!S_ISDIR(st.st_mode))
+    {
+        errno = ENOTDIR;
+        return NULL;
+    }
+
+    TmpPool *p = calloc(1, sizeof(TmpPool));
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    p->max_idle = c->max_idle ? c->max_idle : DEFAULT_MAX_IDLE;
+    p->memory_limit = c->memory_limit;
+    p->dir = strdup(dir);
+    p->idle[TP_DISK] = malloc(p->max_idle * sizeof(int));
+    p->idle[TP_MEMORY] = malloc(p->max_idle * sizeof(int));
+    p->use_tmpfile = true;
+    p->use_memfd = true;
+    if (p->dir == NULL || p->idle[TP_DISK] == NULL || p->idle[TP_MEMORY] == NULL ||
+        pthread_mutex_init(&p->lock, NULL) != 0)
+    {
+        free(p->dir);
+        free(p->idle[TP_DISK]);
+        free(p->idle[TP_MEMORY]);
+        free(p);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return p;
+}
+
+// Record fd as acquired in tier. Called with the lock held.
+static int mark_in_use(TmpPool *p, int fd, TpTier tier)
+{
+    size_t slot = (size_t)fd;
+    if (slot >= p->owner_cap)
+    {
+        size_t cap = p->owner_cap ? p->owner_cap : 256;
+        while (cap <= slot)
+        {
+            cap *= 2;
+        }
+        unsigned char *owner = realloc(p->owner, cap);
+        if (owner == NULL)
+        {
+            return -1;
+        }
+        memset(owner + p->owner_cap, NOT_OURS, cap - p->owner_cap);
+        p->owner = owner;
+        p->owner_cap = cap;
+    }
+    p->owner[slot] = (unsigned char)(1 + tier);
+    return 0;
+}
+
+int tp_prefill(TmpPool *p, TpTier tier, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        TpTier actual = tier;
+        bool named;
+        int fd = create_file(p, &actual, &named);
+        if (fd < 0)
+        {
+            return -1;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        bool kept = p->stats.idle[actual] < p->max_idle;
+        if (kept)
+        {
+            p->idle[actual][p->stats.idle[actual]++] = fd;
+            p->stats.created[actual]++;
+            p->stats.named += named;
+        }
+        pthread_mutex_unlock(&p->lock);
+        if (!kept)
+        {
+            close(fd);
+            break;
+        }
+    }
+    return 0;
+}
+
+int tp_acquire_tier(TmpPool *p, TpTier tier)
+{
+    pthread_mutex_lock(&p->lock);
+    int fd = -1;
+    if (p->stats.idle[tier] > 0)
+    {
+        fd = p->idle[tier][--p->stats.idle[tier]];
+        p->stats.reused++;
+    }
+    else if (tier == TP_MEMORY && !p->use_memfd && p->stats.idle[TP_DISK] > 0)
+    {
+        tier = TP_DISK;
+        fd = p->idle[TP_DISK][--p->stats.idle[TP_DISK]];
+        p->stats.reused++;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    bool named = false;
+    bool created = fd < 0;
+    if (created && (fd = create_file(p, &tier, &named)) < 0)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    int rc = mark_in_use(p, fd, tier);
+    if (rc == 0)
+    {
+        p->stats.acquired++;
+        p->stats.in_use++;
+        p->stats.created[tier] += created;
+        p->stats.named += named;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (rc != 0)
+    {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+    return fd;
+}
+
+int tp_acquire(TmpPool *p, size_t expected_size)
+{
+    return tp_acquire_tier(p, expected_size <= p->memory_limit && p->memory_limit > 0 ? TP_MEMORY : TP_DISK);
+}
+
+int tp_release(TmpPool *p, int fd)
+{
+    pthread_mutex_lock(&p->lock);
+    int mark = (fd >= 0 && (size_t)fd < p->owner_cap) ? p->owner[fd] : NOT_OURS;
+    if (mark != NOT_OURS)
+    {
+        p->owner[fd] = NOT_OURS;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (mark == NOT_OURS)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    TpTier tier = (TpTier)(mark - 1);
+
+    // Empty it outside the lock: truncating a large file takes a while.
+    // A file that cannot be emptied (a sealed memfd, say) is not reused.
+    struct stat st;
+    unsigned long long size = fstat(fd, &st) == 0 ? (unsigned long long)st.st_size : 0;
+    bool clean = ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0;
+
+    pthread_mutex_lock(&p->lock);
+    bool kept = clean && p->stats.idle[tier] < p->max_idle;
+    if (kept)
+    {
+        p->idle[tier][p->stats.idle[tier]++] = fd;
+    }
+    p->stats.released++;
+    p->stats.closed += !kept;
+    p->stats.in_use--;
+    p->stats.bytes[tier] += size;
+    if (size > p->stats.peak_bytes[tier])
+    {
+        p->stats.peak_bytes[tier] = size;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (!kept)
+    {
+        close(fd);
+    }
+    return 0;
+}
+
+TpTier tp_tier(TmpPool *p, int fd)
+{
+    pthread_mutex_lock(&p->lock);
+    int mark = (fd >= 0 && (size_t)fd < p->owner_cap) ? p->owner[fd] : NOT_OURS;
+    pthread_mutex_unlock(&p->lock);
+    return mark == IN_USE_MEMORY ? TP_MEMORY : TP_DISK;
+}
+
+TpStats tp_stats(TmpPool *p)
+{
+    pthread_mutex_lock(&p->lock);
+    TpStats s = p->stats;
+    pthread_mutex_unlock(&p->lock);
+    return s;
+}
+
+void tp_close(TmpPool *p, TpStats *final)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    if (final != NULL)
+    {
+        *final = p->stats;
+    }
+    for (int tier = TP_DISK; tier <= TP_MEMORY; tier++)
+    {
+        for (size_t i = 0; i < p->stats.idle[tier]; i++)
+        {
+            close(p->idle[tier][i]);
+        }
+        free(p->idle[tier]);
+    }
+    pthread_mutex_destroy(&p->lock);
+    free(p->owner);
+    free(p->dir);
+    free(p);
+}
@@ -0,0 +1,91 @@
+/*
+ * Fast I/O - tmppool.h
+ *
+ * A pool of anonymous temporary files for jobs that spill to disk many
+ * times.
+ *
+ * ch08/misc/mkstemp_example.c makes each temporary file with mkstemp()
+ * and removes it with unlink(): two directory operations per file, each
+ * taking the directory's lock, and a name that other processes can see
+ * in between. A TmpPool creates files that never have a name: O_TMPFILE
+ * (with O_EXCL, so they can never be linked in later), or mkstemp()
+ * followed at once by unlink() where O_TMPFILE is not supported. When a
+ * file is released it is truncated to zero and kept open, so the next
+ * tp_acquire() costs no directory operation at all.
+ *
+ * Small spills can use a memory tier instead: memfd_create() files, which
+ * live in RAM (and swap) and never touch a file system. tp_acquire()
+ * picks the tier from the expected size; where memfd_create() is not
+ * available the memory tier falls back to disk.
+ *
+ * The pool is thread-safe. Functions return 0 (or a descriptor), or -1
+ * with errno set.
+ */
+
+#ifndef FASTIO_TMPPOOL_H
+#define FASTIO_TMPPOOL_H
+
+#include <stddef.h>
+
+typedef enum
+{
+    TP_DISK,
+    TP_MEMORY
+} TpTier;
+
+typedef struct
+{
+    const char *dir;     // for disk files (NULL = $TMPDIR, else /tmp)
+    size_t memory_limit; // spills up to this size go to memory (0 = none)
+    size_t max_idle;     // files kept open per tier (0 = 64)
+} TpConfig;
+
+typedef struct
+{
+    unsigned long long acquired;
+    unsigned long long reused;         // acquisitions served by an idle file
+    unsigned long long created[2];     // new files, by tier
+    unsigned long long named;          // of the disk files, via mkstemp() + unlink()
+    unsigned long long released;
+    unsigned long long closed;         // released but not kept: pool full or bad file
+    unsigned long long bytes[2];       // size of the files when released, by tier
+    unsigned long long peak_bytes[2];  // largest single file, by tier
+    size_t in_use;
+    size_t idle[2];
+} TpStats;
+
+typedef struct TmpPool TmpPool;
+
+// config may be NULL for the defaults. Returns NULL if out of memory or
+// if dir is not a usable directory.
+TmpPool *tp_open(const TpConfig *config);
+
+// Create n files of a tier ahead of time (up to max_idle)
+int tp_prefill(TmpPool *p, TpTier tier, size_t n);
+
+// An empty file open for reading and writing at offset 0, in memory if
+// expected_size is at most the memory limit, else on disk
+int tp_acquire(TmpPool *p, size_t expected_size);
+
+// The same, choosing the tier explicitly
+int tp_acquire_tier(TmpPool *p, TpTier tier);
+
+// Give the file back. It is truncated and kept for reuse, or closed if the
+// pool is full. fd must have come from this pool (EBADF otherwise) and
+// must not be used afterwards. Returns -1 only for EBADF.
+int tp_release(TmpPool *p, int fd);
+
+// Which tier a descriptor from tp_acquire() is in
+TpTier tp_tier(TmpPool *p, int fd);
+
+TpStats tp_stats(TmpPool *p);
+
+// One unnamed file in dir (NULL = $TMPDIR, else /tmp), made the way the
+// pool makes them but not pooled: close() it when done
+int tp_mkfile(const char *dir);
+
+// Close every idle file and free the pool. Files still acquired are left
+// open for the caller to close. final (if not NULL) receives the counters.
+void tp_close(TmpPool *p, TpStats *final);
+
+#endif /* FASTIO_TMPPOOL_H */
@@ -0,0 +1,272 @@
+/*
+ * Fast I/O - tmppool_main.c
+ *
+ * Demonstrates the temporary file pool: files that never appear in the
+ * directory, reuse after release, the memory tier for small spills, and
+ * several threads sharing one pool. tmppool_bench measures files/s
+ * against mkstemp() + unlink() and tmpfile().
+ */
+
+#define _GNU_SOURCE // linkat() through /proc in Test 1
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tmppool.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static size_t count_entries(const char *dir)
+{
+    DIR *d = opendir(dir);
+    size_t n = 0;
+    struct dirent *e;
+    while (d != NULL && (e = readdir(d)) != NULL)
+    {
+        n += strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0;
+    }
+    if (d != NULL)
+    {
+        closedir(d);
+    }
+    return n;
+}
+
+static int write_spill(int fd, size_t len, char fill)
+{
+    char block[4096];
+    memset(block, fill, sizeof(block));
+    while (len > 0)
+    {
+        size_t n = len < sizeof(block) ? len : sizeof(block);
+        if (write(fd, block, n) != (ssize_t)n)
+        {
+            return -1;
+        }
+        len -= n;
+    }
+    return 0;
+}
+
+typedef struct
+{
+    TmpPool *pool;
+    int rounds;
+    int errors;
+} Worker;
+
+static void *worker(void *arg)
+{
+    Worker *w = arg;
+    for (int i = 0; i < w->rounds; i++)
+    {
+        size_t len = 512 + (size_t)(i % 7) * 3000;
+        int fd = tp_acquire(w->pool, len);
+        char back[8] = {0};
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size != 0 || write_spill(fd, len, 'w') != 0 ||
+            pread(fd, back, sizeof(back), 0) != (ssize_t)sizeof(back) || back[0] != 'w' ||
+            tp_release(w->pool, fd) != 0)
+        {
+            w->errors++;
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    printf("=== Temporary File Pool ===\n\n");
+
+    char dir[] = "/tmp/tmppool_main_XXXXXX";
+    if (mkdtemp(dir) == NULL)
+    {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    // Test 1: No names
+    printf("Test 1: Files that never appear in the directory\n");
+    {
+        TpConfig config = {dir, 0, 8};
+        TmpPool *pool = tp_open(&config);
+        int fd = pool ? tp_acquire(pool, 1 << 20) : -1;
+        struct stat st;
+        check(fd >= 0 && write_spill(fd, 1 << 20, 'a') == 0 && fstat(fd, &st) == 0 && st.st_size == 1 << 20,
+              "1 MiB written to an acquired file");
+        printf("  directory entries: %zu, links to the file: %lu\n", count_entries(dir),
+               (unsigned long)st.st_nlink);
+        check(count_entries(dir) == 0 && st.st_nlink == 0, "nothing in the directory, nothing to clean up");
+
+        char proc[64];
+        snprintf(proc, sizeof(proc), "/proc/self/fd/%d", fd);
+        char target[sizeof(dir) + 8];
+        snprintf(target, sizeof(target), "%s/named", dir);
+        TpStats s = tp_stats(pool);
+        if (s.named == 0)
+        {
+            int rc = linkat(AT_FDCWD, proc, AT_FDCWD, target, AT_SYMLINK_FOLLOW);
+            check(rc != 0, "O_TMPFILE | O_EXCL: linkat() cannot give it a name");
+            unlink(target);
+        }
+        else
+        {
+            printf("  (no O_TMPFILE here: mkstemp() + unlink() at once)\n");
+        }
+        tp_release(pool, fd);
+        tp_close(pool, NULL);
+    }
+    printf("\n");
+
+    // Test 2: Reuse
+    printf("Test 2: Released files are emptied and reused\n");
+    {
+        TpConfig config = {dir, 0, 8};
+        TmpPool *pool = tp_open(&config);
+        int first = tp_acquire(pool, 100000);
+        write_spill(first, 100000, 'b');
+        check(tp_release(pool, first) == 0, "released a 100000-byte spill");
+
+        int second = tp_acquire(pool, 100000);
+        struct stat st;
+        off_t pos = lseek(second, 0, SEEK_CUR);
+        check(second == first && fstat(second, &st) == 0 && st.st_size == 0 && pos == 0,
+              "same descriptor back, empty, at offset 0");
+        tp_release(pool, second);
+
+        for (int i = 0; i < 1000; i++)
+        {
+            int fd = tp_acquire(pool, 4096);
+            write_spill(fd, 4096, 'c');
+            tp_release(pool, fd);
+        }
+        TpStats s = tp_stats(pool);
+        printf("  %llu acquired, %llu reused, %llu created, %llu bytes spilled\n", s.acquired, s.reused,
+               s.created[TP_DISK], s.bytes[TP_DISK]);
+        check(s.created[TP_DISK] == 1 && s.reused == 1001, "1002 spills, one file created");
+        check(s.bytes[TP_DISK] == 100000ULL + 1000 * 4096 && s.peak_bytes[TP_DISK] == 100000,
+              "bytes and largest spill counted");
+        tp_close(pool, NULL);
+    }
+    printf("\n");
+
+    // Test 3: The memory tier
+    printf("Test 3: Small spills in memory, large ones on disk\n");
+    {
+        TpConfig config = {dir, 64 << 10, 8};
+        TmpPool *pool = tp_open(&config);
+        int small = tp_acquire(pool, 16 << 10);
+        int large = tp_acquire(pool, 1 << 20);
+        char link[128] = {0};
+        char proc[64];
+        snprintf(proc, sizeof(proc), "/proc/self/fd/%d", small);
+        ssize_t n = readlink(proc, link, sizeof(link) - 1);
+        printf("  16 KiB spill: %s\n", n > 0 ? link : "?");
+        check(tp_tier(pool, small) == TP_MEMORY || tp_stats(pool).created[TP_MEMORY] == 0,
+              "16 KiB goes to memfd_create() (or to disk without it)");
+        check(tp_tier(pool, large) == TP_DISK, "1 MiB goes to disk");
+        write_spill(small, 16 << 10, 'm');
+        write_spill(large, 1 << 20, 'd');
+        tp_release(pool, small);
+        tp_release(pool, large);
+
+        check(tp_prefill(pool, TP_MEMORY, 3) == 0 && tp_prefill(pool, TP_DISK, 20) == 0,
+              "prefilled 3 memory and 20 disk files");
+        TpStats s = tp_stats(pool);
+        printf("  idle: %zu disk, %zu memory\n", s.idle[TP_DISK], s.idle[TP_MEMORY]);
+        check(s.idle[TP_DISK] == 8 && s.idle[TP_DISK] + s.idle[TP_MEMORY] <= 12, "no more than max_idle per tier");
+        check(s.bytes[TP_MEMORY] + s.bytes[TP_DISK] == (16 << 10) + (1 << 20), "bytes counted by tier");
+        tp_close(pool, NULL);
+    }
+    printf("\n");
+
+    // Test 4: Misuse
+    printf("Test 4: Releasing what is not ours\n");
+    {
+        TpConfig config = {dir, 0, 2};
+        TmpPool *pool = tp_open(&config);
+        int fd = tp_acquire(pool, 0);
+        tp_release(pool, fd);
+        errno = 0;
+        check(tp_release(pool, fd) == -1 && errno == EBADF, "second release: EBADF");
+        errno = 0;
+        check(tp_release(pool, STDOUT_FILENO) == -1 && errno == EBADF, "stdout: EBADF");
+
+        int fds[5];
+        for (int i = 0; i < 5; i++)
+        {
+            fds[i] = tp_acquire(pool, 0);
+        }
+        for (int i = 0; i < 5; i++)
+        {
+            tp_release(pool, fds[i]);
+        }
+        TpStats s = tp_stats(pool);
+        check(s.idle[TP_DISK] == 2 && s.closed == 3 && s.in_use == 0, "5 released, 2 kept, 3 closed");
+        tp_close(pool, NULL);
+
+        TpConfig bad = {"/nonexistent/dir", 0, 0};
+        errno = 0;
+        check(tp_open(&bad) == NULL && errno == ENOENT, "missing directory: ENOENT");
+    }
+    printf("\n");
+
+    // Test 5: Threads
+    printf("Test 5: Four threads sharing a pool\n");
+    {
+        TpConfig config = {dir, 8 << 10, 16};
+        TmpPool *pool = tp_open(&config);
+        Worker workers[4];
+        pthread_t threads[4];
+        for (int t = 0; t < 4; t++)
+        {
+            workers[t] = (Worker){pool, 2000, 0};
+            pthread_create(&threads[t], NULL, worker, &workers[t]);
+        }
+        int errors = 0;
+        for (int t = 0; t < 4; t++)
+        {
+            pthread_join(threads[t], NULL);
+            errors += workers[t].errors;
+        }
+        TpStats s;
+        tp_close(pool, &s);
+        printf("  %llu spills: %llu memory and %llu disk files created, %llu reused\n", s.acquired,
+               s.created[TP_MEMORY], s.created[TP_DISK], s.reused);
+        check(errors == 0 && s.acquired == 8000 && s.released == 8000 && s.in_use == 0,
+              "every spill written, read back and released");
+        check(s.created[TP_MEMORY] + s.created[TP_DISK] <= 8, "at most one file per thread and tier");
+        check(count_entries(dir) == 0, "directory still empty");
+    }
+
+    rmdir(dir);
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. mkstemp() + unlink() costs two directory operations per file\n");
+    printf("2. Pooled files are truncated and reused: no directory operation\n");
+    printf("3. O_TMPFILE | O_EXCL files have no name, and can never get one\n");
+    printf("4. memfd_create() keeps small spills off the file system\n");
+    printf("5. Nothing to clean up after a crash: unnamed files vanish on close\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*
+ * Fast I/O - unlocked_io.c
+ *
+ * Implementation of the byte-stream filters.
+ *
+ * Both streams are locked for FIO_BATCH bytes at a time, always in address
+ * order, so two threads filtering between the same pair of streams in
+ * opposite directions cannot deadlock.
+ *
+ * FIO_SKIP and EOF are both -1, so the byte read (c) and the byte to
+ * write (mapped) are kept in separate variables.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "unlocked_io.h"
+#include <stdint.h>
+
+static void lock_pair(FILE *a, FILE *b)
+{
+    if (b == NULL || a == b)
+    {
+        fio_lock(a);
+        return;
+    }
+    if ((uintptr_t)a < (uintptr_t)b)
+    {
+        fio_lock(a);
+        fio_lock(b);
+    }
+    else
+    {
+        fio_lock(b);
+        fio_lock(a);
+    }
+}
+
+static void unlock_pair(FILE *a, FILE *b)
+{
+    fio_unlock(a);
+    if (b != NULL && b != a)
+    {
+        fio_unlock(b);
+    }
+}
+
+long long fio_filter(FILE *in, FILE *out, const FioStage *stages, size_t nstages)
+{
+    long long written = 0;
+    int c = 0;
+
+    while (c != EOF)
+    {
+        lock_pair(in, out);
+        for (int i = 0; i < FIO_BATCH && (c = fio_getc(in)) != EOF; i++)
+        {
+            int mapped = c;
+            for (size_t s = 0; s < nstages && mapped != FIO_SKIP; s++)
+            {
+                mapped = stages[s].fn(mapped, stages[s].ctx);
+            }
+            if (mapped == FIO_SKIP)
+            {
+                continue;
+            }
+            if (fio_putc(mapped, out) == EOF)
+            {
+                unlock_pair(in, out);
+                return -1;
+            }
+            written++;
+        }
+        unlock_pair(in, out);
+    }
+    return ferror(in) ? -1 : written;
+}
+
+long long fio_translate(FILE *in, FILE *out, const int table[256])
+{
+    long long written = 0;
+    int c = 0;
+
+    while (c != EOF)
+    {
+        lock_pair(in, out);
+        for (int i = 0; i < FIO_BATCH && (c = fio_getc(in)) != EOF; i++)
+        {
+            int mapped = table[c];
+            if (mapped == FIO_SKIP)
+            {
+                continue;
+            }
+            if (fio_putc(mapped, out) == EOF)
+            {
+                unlock_pair(in, out);
+                return -1;
+            }
+            written++;
+        }
+        unlock_pair(in, out);
+    }
+    return ferror(in) ? -1 : written;
+}
+
+long long fio_count(FILE *in, FioByteFn pred, void *ctx)
+{
+    long long count = 0;
+    int c = 0;
+
+    while (c != EOF)
+    {
+        fio_lock(in);
+        for (int i = 0; i < FIO_BATCH && (c = fio_getc(in)) != EOF; i++)
+        {
+            count += pred(c, ctx) != 0;
+        }
+        fio_unlock(in);
+    }
+    return ferror(in) ? -1 : count;
+}
+
+void fio_stages_to_table(const FioStage *stages, size_t nstages, int table[256])
+{
+    for (int byte = 0; byte < 256; byte++)
+    {
+        int c = byte;
+        for (size_t s = 0; s < nstages && c != FIO_SKIP; s++)
+        {
+            c = stages[s].fn(c, stages[s].ctx);
+        }
+        table[byte] = c;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Fast I/O - unlocked_io.h
+ *
+ * Character I/O without a lock per character, for the getc()/putc()
+ * loops of ch08/listings/read_write_chars.c.
+ *
+ * Every fgetc(), fputc(), getc() and putc() call locks and unlocks the
+ * FILE so that threads can share it. In a loop over millions of bytes it
+ * is much cheaper to take the lock once (flockfile()) and use the POSIX
+ * getc_unlocked()/putc_unlocked() inside the locked region.
+ *
+ * Where those functions are not declared (a non-POSIX C library, or no
+ * _POSIX_C_SOURCE), FIO_HAVE_UNLOCKED is 0 and everything falls back to
+ * plain getc()/putc() with no-op locking: slower, but still correct.
+ *
+ * On top of that, fio_filter() runs every byte of a stream through a
+ * chain of map/filter callbacks and writes the result to another stream,
+ * releasing the locks every FIO_BATCH bytes so other threads get a turn.
+ */
+
+#ifndef FASTIO_UNLOCKED_IO_H
+#define FASTIO_UNLOCKED_IO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 199506L
+#define FIO_HAVE_UNLOCKED 1
+#else
+#define FIO_HAVE_UNLOCKED 0
+#endif
+
+// Bytes processed per lock hold in fio_filter() and fio_translate()
+#define FIO_BATCH 65536
+
+// ============================================================================
+// Locked regions
+// ============================================================================
+
+// Use fio_getc()/fio_putc() only between fio_lock() and fio_unlock()
+static inline void fio_lock(FILE *fp)
+{
+#if FIO_HAVE_UNLOCKED
+    flockfile(fp);
+#else
+    (void)fp;
+#endif
+}
+
+static inline void fio_unlock(FILE *fp)
+{
+#if FIO_HAVE_UNLOCKED
+    funlockfile(fp);
+#else
+    (void)fp;
+#endif
+}
+
+#if FIO_HAVE_UNLOCKED
+#define fio_getc(fp) getc_unlocked(fp)
+#define fio_putc(c, fp) putc_unlocked((c), (fp))
+#else
+#define fio_getc(fp) getc(fp)
+#define fio_putc(c, fp) putc((c), (fp))
+#endif
+
+// ============================================================================
+// Byte-stream filters
+// ============================================================================
+
+// Returned by a stage to drop the byte
+#define FIO_SKIP (-1)
+
+// Map one byte (0..255) to the byte to emit, or FIO_SKIP to drop it
+typedef int (*FioByteFn)(int c, void *ctx);
+
+typedef struct
+{
+    FioByteFn fn;
+    void *ctx;
+} FioStage;
+
+// Copy in to out through the stages, in order. Returns the number of
+// bytes written, or -1 on a read or write error.
+long long fio_filter(FILE *in, FILE *out, const FioStage *stages, size_t nstages);
+
+// Same with a 256-entry table instead of callbacks: table[c] is the byte
+// to emit, or FIO_SKIP
+long long fio_translate(FILE *in, FILE *out, const int table[256]);
+
+// Number of bytes of in for which pred() returns non-zero, -1 on error
+long long fio_count(FILE *in, FioByteFn pred, void *ctx);
+
+// Build a translation table equivalent to a chain of stages
+void fio_stages_to_table(const FioStage *stages, size_t nstages, int table[256]);
+
+#endif /* FASTIO_UNLOCKED_IO_H */
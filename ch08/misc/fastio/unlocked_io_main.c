@@ -0,0 +1,306 @@
+/*
+ * Fast I/O - unlocked_io_main.c
+ *
+ * Demonstrates locked regions with getc_unlocked()/putc_unlocked() and the
+ * byte-stream filter API, on the copy loops of
+ * ch08/listings/read_write_chars.c.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unlocked_io.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// Read a whole stream from the start into a malloc'd NUL-terminated string
+static char *slurp(FILE *fp, size_t *len)
+{
+    rewind(fp);
+    size_t cap = 4096;
+    size_t n = 0;
+    char *s = malloc(cap);
+    int c;
+    while (s != NULL && (c = fgetc(fp)) != EOF)
+    {
+        if (n + 1 == cap)
+        {
+            char *grown = realloc(s, cap * 2);
+            if (grown == NULL)
+            {
+                free(s);
+                return NULL;
+            }
+            s = grown;
+            cap *= 2;
+        }
+        s[n++] = (char)c;
+    }
+    if (s != NULL)
+    {
+        s[n] = '\0';
+    }
+    *len = n;
+    return s;
+}
+
+static int drop_cr(int c, void *ctx)
+{
+    (void)ctx;
+    return c == '\r' ? FIO_SKIP : c;
+}
+
+static int to_upper(int c, void *ctx)
+{
+    (void)ctx;
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// Keeps printable ASCII and '\n', counting what it drops
+static int drop_control(int c, void *ctx)
+{
+    if ((c >= 0x20 && c < 0x7f) || c == '\n')
+    {
+        return c;
+    }
+    (*(size_t *)ctx)++;
+    return FIO_SKIP;
+}
+
+static int is_vowel(int c, void *ctx)
+{
+    (void)ctx;
+    return strchr("aeiouAEIOU", c) != NULL && c != '\0';
+}
+
+typedef struct
+{
+    FILE *fp;
+    char tag;
+} WriterArgs;
+
+// Writes 200 lines of 60 identical tag characters, one locked region each
+static void *write_lines(void *arg)
+{
+    const WriterArgs *w = arg;
+    for (int line = 0; line < 200; line++)
+    {
+        fio_lock(w->fp);
+        for (int i = 0; i < 60; i++)
+        {
+            fio_putc(w->tag, w->fp);
+        }
+        fio_putc('\n', w->fp);
+        fio_unlock(w->fp);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    printf("=== Unlocked Character I/O ===\n\n");
+    printf("getc_unlocked()/putc_unlocked(): %s\n\n",
+           FIO_HAVE_UNLOCKED ? "available" : "not available, using getc()/putc()");
+
+    // Test 1: Copying character by character (read_write_chars.c Test 3)
+    printf("Test 1: Copying character by character, one lock per file\n");
+    {
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+        if (in == NULL || out == NULL)
+        {
+            perror("  ✗ tmpfile");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < 100000; i++)
+        {
+            fputc("ABCDEFGHIJKLMNOPQRSTUVWXYZ\n"[i % 27], in);
+        }
+        rewind(in);
+
+        size_t copied = 0;
+        int c;
+        fio_lock(in);
+        fio_lock(out);
+        while ((c = fio_getc(in)) != EOF)
+        {
+            fio_putc(c, out);
+            copied++;
+        }
+        fio_unlock(out);
+        fio_unlock(in);
+
+        size_t a_len, b_len;
+        char *a = slurp(in, &a_len);
+        char *b = slurp(out, &b_len);
+        printf("  Copied %zu bytes with 2 lock operations instead of %zu\n", copied, 2 * copied);
+        check(a != NULL && b != NULL && a_len == b_len && memcmp(a, b, a_len) == 0, "copy is identical");
+        free(a);
+        free(b);
+        fclose(in);
+        fclose(out);
+    }
+    printf("\n");
+
+    // Test 2: A filter pipeline over a stream
+    printf("Test 2: Filter pipeline (drop \\r, uppercase, drop control bytes)\n");
+    {
+        const char text[] = "Hello,\r\n\tWorld!\x07\r\nline three\n";
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+        if (in == NULL || out == NULL)
+        {
+            perror("  ✗ tmpfile");
+            return EXIT_FAILURE;
+        }
+        fwrite(text, 1, sizeof(text) - 1, in);
+        rewind(in);
+
+        size_t dropped = 0;
+        const FioStage stages[] = {
+            {drop_cr, NULL},
+            {to_upper, NULL},
+            {drop_control, &dropped},
+        };
+        long long written = fio_filter(in, out, stages, 3);
+
+        size_t len;
+        char *result = slurp(out, &len);
+        printf("  Output: \"");
+        for (size_t i = 0; result != NULL && i < len; i++)
+        {
+            if (result[i] == '\n')
+            {
+                printf("\\n");
+            }
+            else
+            {
+                putchar(result[i]);
+            }
+        }
+        printf("\"\n");
+        printf("  %lld bytes written, %zu control bytes dropped\n", written, dropped);
+        check(result != NULL && strcmp(result, "HELLO,\nWORLD!\nLINE THREE\n") == 0, "stages applied in order");
+        check(written == (long long)len && dropped == 2, "byte counts match");
+        free(result);
+        fclose(in);
+        fclose(out);
+    }
+    printf("\n");
+
+    // Test 3: The same pipeline as a 256-entry table
+    printf("Test 3: Stages folded into a translation table\n");
+    {
+        FILE *in = tmpfile();
+        FILE *out_stages = tmpfile();
+        FILE *out_table = tmpfile();
+        if (in == NULL || out_stages == NULL || out_table == NULL)
+        {
+            perror("  ✗ tmpfile");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < 300000; i++)
+        {
+            fputc((i * 37 + i / 256) & 0xff, in);
+        }
+
+        size_t dropped = 0;
+        const FioStage stages[] = {
+            {drop_cr, NULL},
+            {to_upper, NULL},
+            {drop_control, &dropped},
+        };
+        int table[256];
+        fio_stages_to_table(stages, 3, table);
+
+        rewind(in);
+        long long n1 = fio_filter(in, out_stages, stages, 3);
+        rewind(in);
+        long long n2 = fio_translate(in, out_table, table);
+
+        size_t l1, l2;
+        char *a = slurp(out_stages, &l1);
+        char *b = slurp(out_table, &l2);
+        printf("  300000 bytes in, %lld bytes out\n", n2);
+        check(n1 == n2 && a != NULL && b != NULL && l1 == l2 && memcmp(a, b, l1) == 0,
+              "fio_translate() output equals fio_filter() output");
+
+        rewind(in);
+        long long vowels = fio_count(in, is_vowel, NULL);
+        long long expected = 0;
+        rewind(in);
+        int c;
+        while ((c = fgetc(in)) != EOF)
+        {
+            expected += strchr("aeiouAEIOU", c) != NULL && c != '\0';
+        }
+        check(vowels == expected, "fio_count() agrees with an fgetc() loop");
+        free(a);
+        free(b);
+        fclose(in);
+        fclose(out_stages);
+        fclose(out_table);
+    }
+    printf("\n");
+
+    // Test 4: Locked regions keep lines from two threads whole
+    printf("Test 4: Two threads writing lines to one FILE\n");
+    {
+        FILE *fp = tmpfile();
+        if (fp == NULL)
+        {
+            perror("  ✗ tmpfile");
+            return EXIT_FAILURE;
+        }
+        // A tiny buffer forces many flushes in the middle of lines
+        setvbuf(fp, NULL, _IOFBF, 16);
+
+        pthread_t t1, t2;
+        WriterArgs a1 = {fp, 'a'};
+        WriterArgs a2 = {fp, 'b'};
+        pthread_create(&t1, NULL, write_lines, &a1);
+        pthread_create(&t2, NULL, write_lines, &a2);
+        pthread_join(t1, NULL);
+        pthread_join(t2, NULL);
+
+        size_t len;
+        char *text = slurp(fp, &len);
+        size_t lines = 0;
+        int whole = text != NULL && len == 400 * 61;
+        for (size_t i = 0; whole && i < len; i += 61)
+        {
+            whole = text[i + 60] == '\n' && strspn(text + i, (char[]){text[i], '\0'}) == 60;
+            lines++;
+        }
+        printf("  %zu lines of 60 characters read back\n", lines);
+        check(whole, "no line mixes characters from both threads");
+        free(text);
+        fclose(fp);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. fgetc()/fputc()/getc()/putc() lock the FILE on every call\n");
+    printf("2. Between fio_lock() and fio_unlock() use only fio_getc()/fio_putc()\n");
+    printf("3. Keep locked regions short: other threads using the FILE wait\n");
+    printf("4. toupper() and isprint() depend on the locale; the stages above do not\n");
+    printf("5. Run ./io_bench for bytes/s against the locked loops\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
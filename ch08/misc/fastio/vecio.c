@@ -0,0 +1,402 @@
+/*
+ * Fast I/O - vecio.c
+ *
+ * Implementation of the POSIX I/O helpers.
+ *
+ * vio_writev_all() and vio_readv_full() pass the caller's iovec array to
+ * the kernel through a local window of at most vio_iov_max() entries. The
+ * first entry of the window is trimmed after a partial transfer, so the
+ * caller's array is never modified.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vecio.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WINDOW_MAX 1024
+#define DEFAULT_STAGE ((size_t)64 << 10)
+
+// POSIX guarantees at least 16 entries (_XOPEN_IOV_MAX)
+#define CLAMP_IOV_MAX(max) ((max) < 16 ? 16 : (max) > WINDOW_MAX ? WINDOW_MAX : (int)(max))
+
+#ifdef IOV_MAX
+int vio_iov_max(void)
+{
+    return CLAMP_IOV_MAX(IOV_MAX);
+}
+#else
+// Every thread computes the same value, so a relaxed atomic is enough
+int vio_iov_max(void)
+{
+    static _Atomic int cached = 0;
+    int max = atomic_load_explicit(&cached, memory_order_relaxed);
+    if (max == 0)
+    {
+        long sys_max = sysconf(_SC_IOV_MAX);
+        max = CLAMP_IOV_MAX(sys_max);
+        atomic_store_explicit(&cached, max, memory_order_relaxed);
+    }
+    return max;
+}
+#endif
+
+int vio_write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            errno = EIO; // no progress on a non-empty request
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+ssize_t vio_read_full(int fd, void *buf, size_t len)
+{
+    char *p = buf;
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t n = read(fd, p + done, len - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+int vio_pwrite_all(int fd, const void *buf, size_t len, off_t offset)
+{
+    const char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            errno = EIO; // no progress on a non-empty request
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+ssize_t vio_pread_full(int fd, void *buf, size_t len, off_t offset)
+{
+    char *p = buf;
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t n = pread(fd, p + done, len - done, offset + (off_t)done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+// Copy up to vio_iov_max() entries starting at iov[i], skipping off bytes
+// of the first one. Returns the number of entries in window.
+static int fill_window(struct iovec *window, const struct iovec *iov, int iovcnt, int i, size_t off)
+{
+    int n = 0;
+    int max = vio_iov_max();
+    for (int j = i; j < iovcnt && n < max; j++)
+    {
+        window[n] = iov[j];
+        if (j == i)
+        {
+            window[n].iov_base = (char *)window[n].iov_base + off;
+            window[n].iov_len -= off;
+        }
+        n++;
+    }
+    return n;
+}
+
+// Move (i, off) forward by done bytes
+static void advance(const struct iovec *iov, int iovcnt, int *i, size_t *off, size_t done)
+{
+    while (*i < iovcnt && done >= iov[*i].iov_len - *off)
+    {
+        done -= iov[*i].iov_len - *off;
+        (*i)++;
+        *off = 0;
+    }
+    *off += done;
+}
+
+static int writev_all(int fd, const struct iovec *iov, int iovcnt, unsigned long long *calls)
+{
+    struct iovec window[WINDOW_MAX];
+    int i = 0;
+    size_t off = 0;
+
+    while (i < iovcnt)
+    {
+        int n = fill_window(window, iov, iovcnt, i, off);
+        size_t want = 0;
+        for (int j = 0; j < n; j++)
+        {
+            want += window[j].iov_len;
+        }
+        if (want == 0)
+        {
+            i += n; // only empty buffers left in this window
+            off = 0;
+            continue;
+        }
+
+        ssize_t done = writev(fd, window, n);
+        (*calls)++;
+        if (done < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (done == 0)
+        {
+            errno = EIO; // no progress on a non-empty request
+            return -1;
+        }
+        advance(iov, iovcnt, &i, &off, (size_t)done);
+    }
+    return 0;
+}
+
+int vio_writev_all(int fd, const struct iovec *iov, int iovcnt)
+{
+    unsigned long long calls = 0;
+    return writev_all(fd, iov, iovcnt, &calls);
+}
+
+ssize_t vio_readv_full(int fd, const struct iovec *iov, int iovcnt)
+{
+    struct iovec window[WINDOW_MAX];
+    int i = 0;
+    size_t off = 0;
+    size_t total = 0;
+
+    while (i < iovcnt)
+    {
+        int n = fill_window(window, iov, iovcnt, i, off);
+        size_t want = 0;
+        for (int j = 0; j < n; j++)
+        {
+            want += window[j].iov_len;
+        }
+        if (want == 0)
+        {
+            i += n;
+            off = 0;
+            continue;
+        }
+
+        ssize_t done = readv(fd, window, n);
+        if (done < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (done == 0)
+        {
+            break; // end of file
+        }
+        total += (size_t)done;
+        advance(iov, iovcnt, &i, &off, (size_t)done);
+    }
+    return (ssize_t)total;
+}
+
+// ============================================================================
+// Record batching
+// ============================================================================
+
+struct VioBatch
+{
+    int fd;
+    struct iovec iov[WINDOW_MAX];
+    int count;
+    char *stage;
+    size_t stage_len;
+    size_t stage_cap;
+    bool last_is_copy; // iov[count - 1] ends at stage + stage_len
+    VioStats stats;
+};
+
+VioBatch *vio_batch_open(int fd, size_t stage_size)
+{
+    VioBatch *b = malloc(sizeof(VioBatch));
+    if (b == NULL)
+    {
+        return NULL;
+    }
+    b->stage_cap = stage_size ? stage_size : DEFAULT_STAGE;
+    b->stage = malloc(b->stage_cap);
+    if (b->stage == NULL)
+    {
+        free(b);
+        return NULL;
+    }
+    b->fd = fd;
+    b->count = 0;
+    b->stage_len = 0;
+    b->last_is_copy = false;
+    memset(&b->stats, 0, sizeof(b->stats));
+    return b;
+}
+
+int vio_batch_flush(VioBatch *b)
+{
+    if (b->count == 0)
+    {
+        return 0;
+    }
+    int rc = writev_all(b->fd, b->iov, b->count, &b->stats.syscalls);
+    b->stats.flushes++;
+    b->count = 0;
+    b->stage_len = 0;
+    b->last_is_copy = false;
+    return rc;
+}
+
+int vio_batch_add(VioBatch *b, const void *buf, size_t len)
+{
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (b->count == vio_iov_max() && vio_batch_flush(b) != 0)
+    {
+        return -1;
+    }
+    b->iov[b->count].iov_base = (void *)buf;
+    b->iov[b->count].iov_len = len;
+    b->count++;
+    b->last_is_copy = false;
+    b->stats.bytes += len;
+    b->stats.fragments++;
+    return 0;
+}
+
+int vio_batch_copy(VioBatch *b, const void *buf, size_t len)
+{
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (len > b->stage_cap)
+    {
+        // Too big to stage: send what is queued, then this, directly
+        if (vio_batch_flush(b) != 0 || vio_write_all(b->fd, buf, len) != 0)
+        {
+            return -1;
+        }
+        b->stats.syscalls++;
+        b->stats.bytes += len;
+        b->stats.fragments++;
+        return 0;
+    }
+    if (b->stage_len + len > b->stage_cap || (!b->last_is_copy && b->count == vio_iov_max()))
+    {
+        if (vio_batch_flush(b) != 0)
+        {
+            return -1;
+        }
+    }
+
+    memcpy(b->stage + b->stage_len, buf, len);
+    if (b->last_is_copy)
+    {
+        b->iov[b->count - 1].iov_len += len;
+    }
+    else
+    {
+        b->iov[b->count].iov_base = b->stage + b->stage_len;
+        b->iov[b->count].iov_len = len;
+        b->count++;
+        b->last_is_copy = true;
+    }
+    b->stage_len += len;
+    b->stats.bytes += len;
+    b->stats.fragments++;
+    return 0;
+}
+
+VioStats vio_batch_stats(const VioBatch *b)
+{
+    return b->stats;
+}
+
+int vio_batch_close(VioBatch *b, VioStats *final)
+{
+    if (b == NULL)
+    {
+        return 0;
+    }
+    int rc = vio_batch_flush(b);
+    if (final != NULL)
+    {
+        *final = b->stats;
+    }
+    free(b->stage);
+    free(b);
+    return rc;
+}
@@ -0,0 +1,84 @@
+/*
+ * Fast I/O - vecio.h
+ *
+ * POSIX I/O helpers: full-transfer read()/write() loops and vectored
+ * record batching with writev()/readv().
+ *
+ * ch08/misc/posix_io.c calls write(fd, text, strlen(text)) once and
+ * assumes every byte went out. write() and read() may transfer less than
+ * asked (pipes, sockets, a signal arriving mid-transfer) or fail with
+ * EINTR; the vio_*_all/full functions retry until the whole request is
+ * done.
+ *
+ * A record made of a header, a payload and a trailer is three write()
+ * calls. VioBatch collects such fragments into an iovec array and sends
+ * up to IOV_MAX of them with one writev().
+ *
+ * Functions return 0 (or a byte count), or -1 with errno set.
+ */
+
+#ifndef FASTIO_VECIO_H
+#define FASTIO_VECIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// Entries per writev()/readv(): IOV_MAX, at most 1024
+int vio_iov_max(void);
+
+// Write all len bytes. A write() that makes no progress fails with EIO.
+int vio_write_all(int fd, const void *buf, size_t len);
+
+// Read len bytes. Returns the bytes read: fewer than len only at end of file.
+ssize_t vio_read_full(int fd, void *buf, size_t len);
+
+// Positional versions: the file offset is not used or moved, so threads
+// can share the fd
+int vio_pwrite_all(int fd, const void *buf, size_t len, off_t offset);
+ssize_t vio_pread_full(int fd, void *buf, size_t len, off_t offset);
+
+// Write every buffer of iov, in as many writev() calls as it takes. Any
+// iovcnt is allowed, not just up to IOV_MAX. iov is not modified.
+int vio_writev_all(int fd, const struct iovec *iov, int iovcnt);
+
+// Fill every buffer of iov in order. Returns the bytes read, fewer than
+// the total only at end of file.
+ssize_t vio_readv_full(int fd, const struct iovec *iov, int iovcnt);
+
+// ============================================================================
+// Record batching
+// ============================================================================
+
+typedef struct
+{
+    unsigned long long bytes;
+    unsigned long long fragments; // vio_batch_add() and vio_batch_copy() calls
+    unsigned long long syscalls;  // writev() and write() calls
+    unsigned long long flushes;
+} VioStats;
+
+typedef struct VioBatch VioBatch;
+
+// Batch writes to fd. Copied fragments go to a staging area of
+// stage_size bytes (0 = 64 KiB).
+VioBatch *vio_batch_open(int fd, size_t stage_size);
+
+// Queue a fragment by reference: buf must stay valid and unchanged until
+// the next vio_batch_flush() or vio_batch_close() returns
+int vio_batch_add(VioBatch *b, const void *buf, size_t len);
+
+// Queue a copy of a fragment, for data that will not stay valid (a header
+// built on the stack). Copies that follow each other share one iovec.
+int vio_batch_copy(VioBatch *b, const void *buf, size_t len);
+
+// Write everything queued
+int vio_batch_flush(VioBatch *b);
+
+VioStats vio_batch_stats(const VioBatch *b);
+
+// Flush and free. final (if not NULL) receives the counters. The fd is
+// not closed.
+int vio_batch_close(VioBatch *b, VioStats *final);
+
+#endif /* FASTIO_VECIO_H */
@@ -0,0 +1,435 @@
+/*
+ * Fast I/O - widestream.c
+ *
+ * Implementation of the wide-character streams.
+ *
+ * The reader keeps two buffers: raw bytes from read() and the wchar_t
+ * text decoded from them. A block is decoded in one pass. The UTF-8
+ * transcoding is the string kit's (ch07/misc/strkit/utf8conv.h): runs of
+ * ASCII, the bulk of most text, are widened and narrowed by the kernel
+ * its run-time dispatch picks (up to AVX2), and only multibyte sequences
+ * are decoded one by one. A sequence
+ * cut off at the end of a read() stays in the byte buffer until the next
+ * one. Lines are found in the decoded text with wmemchr(), the same way
+ * linereader uses memchr().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "widestream.h"
+#include <errno.h>
+#include <langinfo.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utf8conv.h"
+#include "vecio.h"
+
+_Static_assert(WCHAR_MAX >= 0x10FFFF, "wchar_t must hold every Unicode code point");
+
+#define DEFAULT_BUFFER ((size_t)64 << 10)
+#define MIN_BUFFER 64
+
+static bool locale_is_utf8(void)
+{
+    const char *codeset = nl_langinfo(CODESET);
+    return strcmp(codeset, "UTF-8") == 0 || strcmp(codeset, "utf8") == 0;
+}
+
+// ============================================================================
+// UTF-8 decoding and encoding
+// ============================================================================
+
+// wchar_t is a 32-bit int, which may be accessed as uint32_t
+_Static_assert(sizeof(wchar_t) == sizeof(uint32_t), "wchar_t must be 32 bits");
+
+// Decode src[0..len) into dst[0..cap). Stops early when dst is full, at
+// an incomplete sequence at the end, or at an invalid one (*bad set).
+static size_t decode_utf8(const unsigned char *src, size_t len, wchar_t *dst, size_t cap, size_t *used, bool *bad)
+{
+    UtfResult res = utf8_to_utf32((const char *)src, len, (uint32_t *)dst, cap);
+    *used = res.read;
+    *bad = res.error == EILSEQ;
+    return res.written;
+}
+
+// Encode s[0..n) into dst[0..cap) while whole characters fit. Returns
+// bytes written; *done is the characters encoded.
+static size_t encode_utf8(const wchar_t *s, size_t n, unsigned char *dst, size_t cap, size_t *done, bool *bad)
+{
+    UtfResult res = utf32_to_utf8((const uint32_t *)s, n, (char *)dst, cap);
+    *done = res.read;
+    *bad = res.error == EILSEQ;
+    return res.written;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+struct WideReader
+{
+    int fd;
+    bool utf8;
+    mbstate_t state; // for the mbrtowc() path
+    unsigned char *in;
+    size_t in_cap;
+    size_t in_len; // bytes read but not decoded yet
+    wchar_t *out;
+    size_t out_cap;
+    size_t start;   // first character not returned yet
+    size_t len;     // characters in out
+    size_t scanned; // out[start .. scanned) holds no newline
+    bool eof;
+    size_t chars;
+    size_t lines;
+};
+
+WideReader *wr_open(int fd, WideEncoding enc, size_t buffer_size)
+{
+    WideReader *r = calloc(1, sizeof(WideReader));
+    if (r == NULL)
+    {
+        return NULL;
+    }
+    size_t cap = buffer_size ? buffer_size : DEFAULT_BUFFER;
+    cap = cap < MIN_BUFFER ? MIN_BUFFER : cap;
+    r->in = malloc(cap);
+    r->out = malloc(cap * sizeof(wchar_t));
+    if (r->in == NULL || r->out == NULL)
+    {
+        wr_close(r);
+        return NULL;
+    }
+    r->fd = fd;
+    r->utf8 = enc == WIDE_UTF8 || locale_is_utf8();
+    r->in_cap = cap;
+    r->out_cap = cap;
+    return r;
+}
+
+void wr_close(WideReader *r)
+{
+    if (r != NULL)
+    {
+        free(r->in);
+        free(r->out);
+        free(r);
+    }
+}
+
+size_t wr_char_count(const WideReader *r)
+{
+    return r->chars;
+}
+
+size_t wr_line_count(const WideReader *r)
+{
+    return r->lines;
+}
+
+static size_t decode_locale(WideReader *r, const unsigned char *src, size_t len, wchar_t *dst, size_t cap,
+                            size_t *used, bool *bad)
+{
+    size_t i = 0;
+    size_t o = 0;
+    *bad = false;
+    while (i < len && o < cap)
+    {
+        size_t n = mbrtowc(&dst[o], (const char *)src + i, len - i, &r->state);
+        if (n == (size_t)-2)
+        {
+            i = len; // absorbed into the conversion state
+            break;
+        }
+        if (n == (size_t)-1)
+        {
+            *bad = true;
+            break;
+        }
+        i += n == 0 ? 1 : n; // 0 means it decoded L'\0'
+        o++;
+    }
+    *used = i;
+    return o;
+}
+
+// Decode as much of the byte buffer as fits in the character buffer
+static int decode_pending(WideReader *r)
+{
+    size_t room = r->out_cap - r->len;
+    size_t used;
+    bool bad;
+    size_t n = r->utf8 ? decode_utf8(r->in, r->in_len, r->out + r->len, room, &used, &bad)
+                       : decode_locale(r, r->in, r->in_len, r->out + r->len, room, &used, &bad);
+    r->len += n;
+    memmove(r->in, r->in + used, r->in_len - used);
+    r->in_len -= used;
+    // Report a bad sequence once the text before it has been returned
+    if (bad && n == 0)
+    {
+        errno = EILSEQ;
+        return -1;
+    }
+    return 0;
+}
+
+// Move unreturned text to the front, grow if the buffer is full of one
+// line, then decode buffered bytes or read more
+static int refill(WideReader *r)
+{
+    size_t rest = r->len - r->start;
+    if (r->start > 0)
+    {
+        memmove(r->out, r->out + r->start, rest * sizeof(wchar_t));
+        r->scanned = r->scanned > r->start ? r->scanned - r->start : 0;
+        r->start = 0;
+        r->len = rest;
+    }
+    if (r->len == r->out_cap)
+    {
+        wchar_t *grown = realloc(r->out, r->out_cap * 2 * sizeof(wchar_t));
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        r->out = grown;
+        r->out_cap *= 2;
+    }
+
+    // Bytes left over because the character buffer was full
+    size_t before = r->len;
+    if (decode_pending(r) != 0)
+    {
+        return -1;
+    }
+    if (r->len > before)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        ssize_t n = read(r->fd, r->in + r->in_len, r->in_cap - r->in_len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            r->eof = true;
+            if (r->in_len > 0 || (!r->utf8 && !mbsinit(&r->state)))
+            {
+                errno = EILSEQ; // input ends inside a character
+                return -1;
+            }
+            return 0;
+        }
+        r->in_len += (size_t)n;
+        return decode_pending(r);
+    }
+}
+
+int wr_next_line(WideReader *r, WideView *line)
+{
+    for (;;)
+    {
+        if (r->scanned < r->start)
+        {
+            r->scanned = r->start;
+        }
+        wchar_t *nl = wmemchr(r->out + r->scanned, L'\n', r->len - r->scanned);
+        if (nl != NULL)
+        {
+            line->ptr = r->out + r->start;
+            line->len = (size_t)(nl - line->ptr);
+            r->start = r->scanned = (size_t)(nl - r->out) + 1;
+            r->chars += line->len + 1;
+            r->lines++;
+            return 1;
+        }
+        r->scanned = r->len;
+
+        if (r->eof)
+        {
+            if (r->start == r->len)
+            {
+                return 0;
+            }
+            line->ptr = r->out + r->start;
+            line->len = r->len - r->start;
+            r->start = r->scanned = r->len;
+            r->chars += line->len;
+            r->lines++;
+            return 1;
+        }
+        if (refill(r) != 0)
+        {
+            return -1;
+        }
+    }
+}
+
+int wr_next_chunk(WideReader *r, WideView *chunk)
+{
+    while (r->start == r->len)
+    {
+        if (r->eof)
+        {
+            return 0;
+        }
+        if (refill(r) != 0)
+        {
+            return -1;
+        }
+    }
+    chunk->ptr = r->out + r->start;
+    chunk->len = r->len - r->start;
+    r->start = r->scanned = r->len;
+    r->chars += chunk->len;
+    return 1;
+}
+
+long wr_read(WideReader *r, wchar_t *dst, size_t max)
+{
+    size_t n = 0;
+    while (n < max)
+    {
+        if (r->start == r->len)
+        {
+            if (r->eof)
+            {
+                break;
+            }
+            if (refill(r) != 0)
+            {
+                return n > 0 ? (long)n : -1;
+            }
+            continue;
+        }
+        size_t take = r->len - r->start;
+        take = take < max - n ? take : max - n;
+        wmemcpy(dst + n, r->out + r->start, take);
+        r->start += take;
+        n += take;
+    }
+    r->chars += n;
+    return (long)n;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+struct WideWriter
+{
+    int fd;
+    bool utf8;
+    mbstate_t state; // for the wcrtomb() path
+    size_t max_char; // longest encoded character
+    unsigned char *buf;
+    size_t cap;
+    size_t len;
+    size_t chars;
+};
+
+WideWriter *ww_open(int fd, WideEncoding enc, size_t buffer_size)
+{
+    WideWriter *w = calloc(1, sizeof(WideWriter));
+    if (w == NULL)
+    {
+        return NULL;
+    }
+    size_t cap = buffer_size ? buffer_size : DEFAULT_BUFFER;
+    w->cap = cap < MIN_BUFFER ? MIN_BUFFER : cap;
+    w->buf = malloc(w->cap);
+    if (w->buf == NULL)
+    {
+        free(w);
+        return NULL;
+    }
+    w->fd = fd;
+    w->utf8 = enc == WIDE_UTF8 || locale_is_utf8();
+    w->max_char = w->utf8 ? 4 : MB_CUR_MAX;
+    return w;
+}
+
+int ww_flush(WideWriter *w)
+{
+    size_t len = w->len;
+    w->len = 0;
+    return len > 0 ? vio_write_all(w->fd, w->buf, len) : 0;
+}
+
+int ww_write(WideWriter *w, const wchar_t *s, size_t n)
+{
+    size_t i = 0;
+    while (i < n)
+    {
+        if (w->cap - w->len < w->max_char && ww_flush(w) != 0)
+        {
+            return -1;
+        }
+        if (w->utf8)
+        {
+            size_t done;
+            bool bad;
+            w->len += encode_utf8(s + i, n - i, w->buf + w->len, w->cap - w->len, &done, &bad);
+            i += done;
+            w->chars += done;
+            if (bad)
+            {
+                errno = EILSEQ;
+                return -1;
+            }
+        }
+        else
+        {
+            size_t k = wcrtomb((char *)w->buf + w->len, s[i], &w->state);
+            if (k == (size_t)-1)
+            {
+                errno = EILSEQ;
+                return -1;
+            }
+            w->len += k;
+            i++;
+            w->chars++;
+        }
+    }
+    return 0;
+}
+
+int ww_puts(WideWriter *w, const wchar_t *s)
+{
+    return ww_write(w, s, wcslen(s));
+}
+
+int ww_putc(WideWriter *w, wchar_t c)
+{
+    return ww_write(w, &c, 1);
+}
+
+size_t ww_char_count(const WideWriter *w)
+{
+    return w->chars;
+}
+
+int ww_close(WideWriter *w)
+{
+    if (w == NULL)
+    {
+        return 0;
+    }
+    int rc = ww_flush(w);
+    int saved = errno;
+    free(w->buf);
+    free(w);
+    errno = saved;
+    return rc;
+}
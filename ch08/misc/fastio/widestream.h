@@ -0,0 +1,103 @@
+/*
+ * Fast I/O - widestream.h
+ *
+ * Bulk wide-character text I/O, replacing the fgetwc()/fputwc()/fgetws()
+ * calls of ch08/misc/wide_char_io.c.
+ *
+ * glibc's wide stdio converts one character at a time through the
+ * locale's conversion functions and takes the FILE lock on every call.
+ * A WideReader instead read()s large blocks of bytes and decodes a whole
+ * block into a wchar_t buffer at once; lines and chunks are returned as
+ * views into that buffer. A WideWriter encodes whole strings into a byte
+ * buffer and write()s it when full. Neither takes a lock: use one reader
+ * or writer per thread.
+ *
+ * Encodings:
+ *
+ *   WIDE_LOCALE  the LC_CTYPE encoding at open time, as stdio uses. If it
+ *                is UTF-8 the fast decoder below is used, otherwise each
+ *                character goes through mbrtowc()/wcrtomb()
+ *   WIDE_UTF8    UTF-8 whatever the locale, through the string kit's
+ *                transcoder (ch07/misc/strkit/utf8conv.h): strict decoding
+ *                (no overlong forms, surrogates or values above U+10FFFF),
+ *                with runs of ASCII handled by the scalar, SWAR, SSE2 or
+ *                AVX2 kernel it picks at run time
+ *
+ * Invalid input fails with EILSEQ, like fgetwc(). wchar_t must hold any
+ * code point (true on glibc, musl and the BSDs).
+ */
+
+#ifndef FASTIO_WIDESTREAM_H
+#define FASTIO_WIDESTREAM_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+typedef enum
+{
+    WIDE_LOCALE,
+    WIDE_UTF8
+} WideEncoding;
+
+typedef struct
+{
+    const wchar_t *ptr; // not NUL-terminated
+    size_t len;
+} WideView;
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+typedef struct WideReader WideReader;
+
+// buffer_size 0 = 64 KiB. Returns NULL if out of memory.
+WideReader *wr_open(int fd, WideEncoding enc, size_t buffer_size);
+
+// Frees the reader; does not close the file descriptor
+void wr_close(WideReader *r);
+
+// Next line, without the L'\n'. Returns 1, 0 at end of input, -1 on error
+// (errno EILSEQ for invalid or truncated input). The last line is
+// returned even without a trailing newline. The view is valid until the
+// next call on this reader; lines longer than the buffer grow it.
+int wr_next_line(WideReader *r, WideView *line);
+
+// Everything decoded so far that has not been returned (decoding another
+// block first if there is none). Same return values and lifetime.
+int wr_next_chunk(WideReader *r, WideView *chunk);
+
+// Copy up to max characters into dst. Returns the count, 0 at end of
+// input, -1 on error.
+long wr_read(WideReader *r, wchar_t *dst, size_t max);
+
+// Characters and lines returned so far
+size_t wr_char_count(const WideReader *r);
+size_t wr_line_count(const WideReader *r);
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+typedef struct WideWriter WideWriter;
+
+// buffer_size 0 = 64 KiB. Returns NULL if out of memory.
+WideWriter *ww_open(int fd, WideEncoding enc, size_t buffer_size);
+
+// Encode n characters. Returns 0, or -1 with errno set (EILSEQ for a
+// character the encoding cannot represent; what came before it is kept).
+int ww_write(WideWriter *w, const wchar_t *s, size_t n);
+int ww_puts(WideWriter *w, const wchar_t *s); // no newline added
+int ww_putc(WideWriter *w, wchar_t c);
+
+// Write out the buffered bytes
+int ww_flush(WideWriter *w);
+
+// Flush and free; does not close the file descriptor. Returns the result
+// of the flush.
+int ww_close(WideWriter *w);
+
+// Characters encoded so far
+size_t ww_char_count(const WideWriter *w);
+
+#endif /* FASTIO_WIDESTREAM_H */
@@ -0,0 +1,333 @@
+/*
+ * Fast I/O - widestream_bench.c
+ *
+ * Writes and reads a file of mixed ASCII, Latin and CJK text, one short
+ * line at a time, through the wide stdio calls of ch08/misc/wide_char_io.c
+ * and through widestream.h, in a UTF-8 locale. Reports MB/s of UTF-8 and
+ * checks that every method writes the same bytes and reads back the same
+ * number of characters.
+ *
+ * Usage: ./widestream_bench [size_mb]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <locale.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+#include "widestream.h"
+
+#define RUNS 3
+#define LINE_MAX_CHARS 256
+
+static const wchar_t *words[] = {L"the ",   L"quick ", L"brown ", L"fox ",    L"Grüße ", L"aus ",
+                                 L"Köln, ", L"déjà ",  L"niño ",  L"世界",    L"你好",   L"中文",
+                                 L"。",     L"data ",  L"wide ",  L"stream ", L"I ♥ C "};
+
+typedef struct
+{
+    wchar_t *buf;  // lines, each ending in L'\n' and then a NUL
+    size_t *start; // offset of each line in buf
+    size_t *len;   // characters in each line, newline included
+    size_t lines;
+    size_t chars;
+    size_t bytes; // as UTF-8
+} Text;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t utf8_length(wchar_t c)
+{
+    return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+}
+
+static int make_text(Text *t, size_t target_bytes)
+{
+    size_t max_lines = target_bytes / 8 + 1;
+    t->buf = malloc((target_bytes + 2 * max_lines) * sizeof(wchar_t));
+    t->start = malloc(max_lines * sizeof(size_t));
+    t->len = malloc(max_lines * sizeof(size_t));
+    if (!t->buf || !t->start || !t->len)
+    {
+        return -1;
+    }
+
+    unsigned seed = 2024;
+    size_t pos = 0;
+    t->lines = t->chars = t->bytes = 0;
+    while (t->bytes < target_bytes && t->lines < max_lines)
+    {
+        seed = seed * 1103515245u + 12345u;
+        size_t want = 20 + (seed >> 16) % 100; // characters in this line
+        size_t begin = pos;
+        while (pos - begin < want)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const wchar_t *w = words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+            for (; *w != L'\0' && pos - begin < LINE_MAX_CHARS - 2; w++)
+            {
+                t->bytes += utf8_length(*w);
+                t->buf[pos++] = *w;
+            }
+        }
+        t->buf[pos++] = L'\n';
+        t->bytes++;
+        t->start[t->lines] = begin;
+        t->len[t->lines] = pos - begin;
+        t->chars += pos - begin;
+        t->lines++;
+        t->buf[pos++] = L'\0';
+    }
+    return 0;
+}
+
+// FNV-1a of the file's contents, to compare what each method wrote
+static uint64_t file_hash(const char *path)
+{
+    uint64_t h = 1469598103934665603ULL;
+    int fd = open(path, O_RDONLY);
+    char block[65536];
+    ssize_t n;
+    while (fd >= 0 && (n = read(fd, block, sizeof(block))) > 0)
+    {
+        for (ssize_t i = 0; i < n; i++)
+        {
+            h = (h ^ (unsigned char)block[i]) * 1099511628211ULL;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return h;
+}
+
+// ============================================================================
+// Writers: return elapsed seconds, or a negative value on error
+// ============================================================================
+
+static double write_fputwc(const char *path, const Text *t)
+{
+    double t0 = now_seconds();
+    FILE *fp = fopen(path, "w");
+    for (size_t i = 0; fp != NULL && i < t->lines; i++)
+    {
+        const wchar_t *p = t->buf + t->start[i];
+        for (size_t k = 0; k < t->len[i]; k++)
+        {
+            fputwc(p[k], fp);
+        }
+    }
+    if (fp == NULL || fclose(fp) != 0)
+    {
+        return -1;
+    }
+    return now_seconds() - t0;
+}
+
+static double write_fputws(const char *path, const Text *t)
+{
+    double t0 = now_seconds();
+    FILE *fp = fopen(path, "w");
+    for (size_t i = 0; fp != NULL && i < t->lines; i++)
+    {
+        fputws(t->buf + t->start[i], fp);
+    }
+    if (fp == NULL || fclose(fp) != 0)
+    {
+        return -1;
+    }
+    return now_seconds() - t0;
+}
+
+static double write_ww(const char *path, const Text *t)
+{
+    double t0 = now_seconds();
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    WideWriter *w = fd >= 0 ? ww_open(fd, WIDE_UTF8, 0) : NULL;
+    int rc = w != NULL ? 0 : -1;
+    for (size_t i = 0; rc == 0 && i < t->lines; i++)
+    {
+        rc = ww_write(w, t->buf + t->start[i], t->len[i]);
+    }
+    if (w != NULL && ww_close(w) != 0)
+    {
+        rc = -1;
+    }
+    if (fd >= 0 && close(fd) != 0)
+    {
+        rc = -1;
+    }
+    return rc == 0 ? now_seconds() - t0 : -1;
+}
+
+// ============================================================================
+// Readers: count the characters read
+// ============================================================================
+
+static double read_fgetwc(const char *path, size_t *chars)
+{
+    double t0 = now_seconds();
+    FILE *fp = fopen(path, "r");
+    size_t n = 0;
+    while (fp != NULL && fgetwc(fp) != WEOF)
+    {
+        n++;
+    }
+    if (fp == NULL || ferror(fp))
+    {
+        return -1;
+    }
+    fclose(fp);
+    *chars = n;
+    return now_seconds() - t0;
+}
+
+static double read_fgetws(const char *path, size_t *chars)
+{
+    wchar_t line[LINE_MAX_CHARS];
+    double t0 = now_seconds();
+    FILE *fp = fopen(path, "r");
+    size_t n = 0;
+    while (fp != NULL && fgetws(line, LINE_MAX_CHARS, fp) != NULL)
+    {
+        n += wcslen(line);
+    }
+    if (fp == NULL || ferror(fp))
+    {
+        return -1;
+    }
+    fclose(fp);
+    *chars = n;
+    return now_seconds() - t0;
+}
+
+static double read_wr(const char *path, int by_line, size_t *chars)
+{
+    double t0 = now_seconds();
+    int fd = open(path, O_RDONLY);
+    WideReader *r = fd >= 0 ? wr_open(fd, WIDE_UTF8, 0) : NULL;
+    if (r == NULL)
+    {
+        return -1;
+    }
+    WideView v;
+    size_t n = 0;
+    int rc;
+    while ((rc = by_line ? wr_next_line(r, &v) : wr_next_chunk(r, &v)) == 1)
+    {
+        n += v.len + (size_t)by_line; // put the newline back
+    }
+    wr_close(r);
+    close(fd);
+    *chars = n;
+    return rc == 0 ? now_seconds() - t0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size_mb = (argc > 1) ? strtoul(argv[1], NULL, 10) : 32;
+    if (size_mb == 0)
+    {
+        fprintf(stderr, "Usage: %s [size_mb]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (setlocale(LC_ALL, "C.UTF-8") == NULL && setlocale(LC_ALL, "en_US.UTF-8") == NULL)
+    {
+        fprintf(stderr, "No UTF-8 locale available\n");
+        return EXIT_FAILURE;
+    }
+
+    Text t;
+    char ref_path[] = "/tmp/widestream_bench_ref_XXXXXX";
+    char path[] = "/tmp/widestream_bench_XXXXXX";
+    int fd_ref = mkstemp(ref_path);
+    int fd = mkstemp(path);
+    if (fd_ref < 0 || fd < 0)
+    {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd_ref);
+    close(fd);
+    if (make_text(&t, size_mb << 20) != 0)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    double mb = (double)t.bytes / 1e6;
+
+    printf("=== Wide-Character Stream Benchmark ===\n\n");
+    printf("%zu lines, %zu characters, %.0f MB of UTF-8, best of %d runs\n\n", t.lines, t.chars, mb, RUNS);
+
+    int ok = write_fputws(ref_path, &t) >= 0;
+    uint64_t ref_hash = file_hash(ref_path);
+
+    printf("  %-32s %10s\n", "Write", "MB/s");
+    struct
+    {
+        const char *label;
+        double (*fn)(const char *, const Text *);
+    } writers[] = {
+        {"fputwc() per character", write_fputwc},
+        {"fputws() per line", write_fputws},
+        {"ww_write() per line", write_ww},
+    };
+    for (size_t i = 0; ok && i < sizeof(writers) / sizeof(writers[0]); i++)
+    {
+        double best = 1e30;
+        for (int run = 0; ok && run < RUNS; run++)
+        {
+            double s = writers[i].fn(path, &t);
+            ok = s >= 0 && file_hash(path) == ref_hash;
+            best = s < best ? s : best;
+        }
+        if (!ok)
+        {
+            printf("  ✗ %s: failed or wrote different bytes\n", writers[i].label);
+            break;
+        }
+        printf("  %-32s %10.1f\n", writers[i].label, mb / best);
+    }
+
+    printf("\n  %-32s %10s\n", "Read", "MB/s");
+    const char *readers[] = {"fgetwc() per character", "fgetws() per line", "wr_next_line()", "wr_next_chunk()"};
+    for (size_t i = 0; ok && i < sizeof(readers) / sizeof(readers[0]); i++)
+    {
+        double best = 1e30;
+        for (int run = 0; ok && run < RUNS; run++)
+        {
+            size_t chars = 0;
+            double s = i == 0   ? read_fgetwc(ref_path, &chars)
+                       : i == 1 ? read_fgetws(ref_path, &chars)
+                                : read_wr(ref_path, i == 2, &chars);
+            ok = s >= 0 && chars == t.chars;
+            best = s < best ? s : best;
+        }
+        if (!ok)
+        {
+            printf("  ✗ %s: failed or miscounted\n", readers[i]);
+            break;
+        }
+        printf("  %-32s %10.1f\n", readers[i], mb / best);
+    }
+
+    unlink(ref_path);
+    unlink(path);
+    free(t.buf);
+    free(t.start);
+    free(t.len);
+    printf("\n%s Every method wrote the same bytes and read back every character\n", ok ? "✓" : "✗");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,369 @@
+/*
+ * Fast I/O - widestream_main.c
+ *
+ * Demonstrates the wide-character streams on the text of
+ * ch08/misc/wide_char_io.c and checks them, character by character,
+ * against fgetwc()/fputws() in a UTF-8 locale and in the "C" locale.
+ * widestream_bench measures throughput on large files.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wchar.h>
+#include "widestream.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static int write_bytes(const char *path, const void *data, size_t len)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    size_t n = fwrite(data, 1, len, fp);
+    return fclose(fp) == 0 && n == len ? 0 : -1;
+}
+
+// Every character of the file through fgetwc(); returns the count, or -1
+// with errno from the failing call
+static long read_fgetwc(const char *path, wchar_t *out, size_t max)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    long n = 0;
+    wint_t c;
+    errno = 0;
+    while ((size_t)n < max && (c = fgetwc(fp)) != WEOF)
+    {
+        out[n++] = (wchar_t)c;
+    }
+    int failed = ferror(fp) || errno == EILSEQ;
+    int saved = errno;
+    fclose(fp);
+    errno = saved;
+    return failed ? -1 : n;
+}
+
+// Every character of the file through wr_next_line(), newlines put back
+static long read_lines(const char *path, WideEncoding enc, size_t buffer, wchar_t *out, size_t max, size_t *lines)
+{
+    int fd = open(path, O_RDONLY);
+    WideReader *r = fd >= 0 ? wr_open(fd, enc, buffer) : NULL;
+    if (r == NULL)
+    {
+        return -1;
+    }
+    long n = 0;
+    WideView line;
+    int rc;
+    while ((rc = wr_next_line(r, &line)) == 1 && (size_t)n + line.len + 1 <= max)
+    {
+        wmemcpy(out + n, line.ptr, line.len);
+        n += (long)line.len;
+        if (wr_char_count(r) > (size_t)n)
+        {
+            out[n++] = L'\n';
+        }
+    }
+    *lines = wr_line_count(r);
+    int saved = errno;
+    wr_close(r);
+    close(fd);
+    errno = saved;
+    return rc < 0 ? -1 : n;
+}
+
+// Text with every sequence length and lines longer than a small buffer
+static size_t make_text(char *buf, size_t cap)
+{
+    static const char *pieces[] = {"Héllo Wörld", " ", "Ñom", "日本", "😀", "plain ASCII text of some length", "\n",
+                                   "\n"};
+    unsigned seed = 5;
+    size_t len = 0;
+    for (;;)
+    {
+        seed = seed * 1103515245u + 12345u;
+        const char *p = pieces[(seed >> 16) % (sizeof(pieces) / sizeof(pieces[0]))];
+        size_t n = strlen(p);
+        if (len + n > cap)
+        {
+            return len;
+        }
+        memcpy(buf + len, p, n);
+        len += n;
+    }
+}
+
+int main(void)
+{
+    printf("=== Wide-Character Streams ===\n\n");
+
+    const char *utf8 = setlocale(LC_ALL, "C.UTF-8");
+    if (utf8 == NULL)
+    {
+        utf8 = setlocale(LC_ALL, "en_US.UTF-8");
+    }
+    if (utf8 == NULL)
+    {
+        printf("No UTF-8 locale installed - comparisons with stdio use WIDE_UTF8 only\n\n");
+    }
+
+    char path[] = "/tmp/widestream_XXXXXX";
+    int tmp = mkstemp(path);
+    if (tmp < 0)
+    {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(tmp);
+
+    enum
+    {
+        TEXT = 20000
+    };
+    char *text = malloc(TEXT);
+    wchar_t *expect = malloc(TEXT * sizeof(wchar_t));
+    wchar_t *got = malloc(TEXT * sizeof(wchar_t));
+    if (!text || !expect || !got)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // Test 1: The lines of wide_char_io.c
+    printf("Test 1: Writing and reading the wide_char_io.c strings\n");
+    {
+        int fd = open(path, O_WRONLY | O_TRUNC);
+        WideWriter *w = ww_open(fd, WIDE_UTF8, 0);
+        ww_puts(w, L"Héllo Wörld\n");
+        ww_puts(w, L"Héllo, Wörld!\nSécond liné\n");
+        ww_putc(w, L'日');
+        ww_putc(w, L'本');
+        ww_puts(w, L"\nÑom");
+        size_t written = ww_char_count(w);
+        check(ww_close(w) == 0 && written == 44, "ww_puts()/ww_putc() wrote 44 characters");
+        close(fd);
+
+        fd = open(path, O_RDONLY);
+        WideReader *r = wr_open(fd, WIDE_UTF8, 0);
+        WideView line;
+        while (wr_next_line(r, &line) == 1)
+        {
+            // %.*ls would count the precision in bytes, so terminate a copy
+            wchar_t copy[32] = {0};
+            wmemcpy(copy, line.ptr, line.len < 31 ? line.len : 31);
+            printf("  line %zu: \"%ls\" (%zu characters)\n", wr_line_count(r), copy, line.len);
+        }
+        check(wr_line_count(r) == 5 && wr_char_count(r) == 44, "5 lines, 44 characters, last line unterminated");
+        wr_close(r);
+        close(fd);
+
+        if (utf8 != NULL)
+        {
+            FILE *fp = fopen(path, "r");
+            wchar_t first[64];
+            int same = fp != NULL && fgetws(first, 64, fp) != NULL && wcscmp(first, L"Héllo Wörld\n") == 0;
+            if (fp != NULL)
+            {
+                fclose(fp);
+            }
+            check(same, "fgetws() reads the same first line");
+        }
+    }
+    printf("\n");
+
+    // Test 2: Small buffers against fgetwc()
+    printf("Test 2: Sequences split between reads, long lines, vs fgetwc()\n");
+    {
+        size_t len = make_text(text, TEXT);
+        write_bytes(path, text, len);
+        long ref = utf8 != NULL ? read_fgetwc(path, expect, TEXT) : -1;
+        if (ref < 0)
+        {
+            // Without a UTF-8 locale, a 1 MiB reader is the reference
+            size_t lines;
+            ref = read_lines(path, WIDE_UTF8, 1 << 20, expect, TEXT, &lines);
+        }
+        printf("  %zu bytes, %ld characters\n", len, ref);
+
+        int all = ref > 0;
+        static const size_t buffers[] = {64, 65, 67, 100, 256, 4096, 0};
+        for (size_t b = 0; b < sizeof(buffers) / sizeof(buffers[0]) && all; b++)
+        {
+            size_t lines;
+            long n = read_lines(path, WIDE_UTF8, buffers[b], got, TEXT, &lines);
+            all = n == ref && wmemcmp(got, expect, (size_t)ref) == 0;
+        }
+        check(all, "wr_next_line() at buffer sizes 64 to 64 KiB: same characters");
+
+        int fd = open(path, O_RDONLY);
+        WideReader *r = wr_open(fd, WIDE_UTF8, 64);
+        long n = 0;
+        long k;
+        while ((k = wr_read(r, got + n, 7)) > 0)
+        {
+            n += k;
+        }
+        check(k == 0 && n == ref && wmemcmp(got, expect, (size_t)ref) == 0, "wr_read() in pieces of 7");
+        wr_close(r);
+
+        lseek(fd, 0, SEEK_SET);
+        r = wr_open(fd, WIDE_UTF8, 100);
+        WideView chunk;
+        size_t chunks = 0;
+        n = 0;
+        while (wr_next_chunk(r, &chunk) == 1)
+        {
+            wmemcpy(got + n, chunk.ptr, chunk.len);
+            n += (long)chunk.len;
+            chunks++;
+        }
+        printf("  wr_next_chunk(): %zu chunks from a 100-byte buffer\n", chunks);
+        check(n == ref && wmemcmp(got, expect, (size_t)ref) == 0, "chunks join up to the same text");
+        wr_close(r);
+        close(fd);
+    }
+    printf("\n");
+
+    // Test 3: Writing matches fputws()
+    printf("Test 3: ww_write() output vs fputws()\n");
+    if (utf8 != NULL)
+    {
+        size_t len = make_text(text, TEXT);
+        write_bytes(path, text, len);
+        long n = read_fgetwc(path, expect, TEXT);
+
+        char path2[] = "/tmp/widestream_XXXXXX";
+        int fd = mkstemp(path2);
+        WideWriter *w = ww_open(fd, WIDE_UTF8, 64);
+        for (long i = 0; i < n; i += 13)
+        {
+            ww_write(w, expect + i, (size_t)(n - i < 13 ? n - i : 13));
+        }
+        int closed = ww_close(w);
+        close(fd);
+
+        FILE *fp = fopen(path2, "r");
+        char *back = malloc(len + 1);
+        size_t got_len = fp != NULL && back != NULL ? fread(back, 1, len + 1, fp) : 0;
+        if (fp != NULL)
+        {
+            fclose(fp);
+        }
+        check(closed == 0 && got_len == len && memcmp(back, text, len) == 0,
+              "byte-identical to the UTF-8 that fputws() decodes from");
+        free(back);
+        unlink(path2);
+
+        fd = open(path, O_WRONLY | O_TRUNC);
+        w = ww_open(fd, WIDE_UTF8, 0);
+        wchar_t bad[] = {L'o', L'k', (wchar_t)0xD800};
+        errno = 0;
+        int rc = ww_write(w, bad, 3);
+        check(rc == -1 && errno == EILSEQ && ww_char_count(w) == 2, "surrogate U+D800: EILSEQ after \"ok\"");
+        ww_close(w);
+        close(fd);
+    }
+    else
+    {
+        printf("  No UTF-8 locale - skipped\n");
+    }
+    printf("\n");
+
+    // Test 4: Invalid input
+    printf("Test 4: Invalid and truncated input\n");
+    {
+        static const struct
+        {
+            const char *what;
+            const char *bytes;
+            int silent; // fgetwc() just stops, with no error
+        } cases[] = {
+            {"stray continuation byte", "ok\n\x80\n", 0},
+            {"overlong '/' (C0 AF)", "ok\n\xC0\xAF", 0},
+            {"surrogate (ED A0 80)", "ok\n\xED\xA0\x80", 0},
+            {"cut off at end of file (E6 97)", "ok\n\xE6\x97", 1},
+        };
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        {
+            write_bytes(path, cases[i].bytes, strlen(cases[i].bytes));
+            int fd = open(path, O_RDONLY);
+            WideReader *r = wr_open(fd, WIDE_UTF8, 0);
+            WideView line;
+            int first = wr_next_line(r, &line);
+            errno = 0;
+            int second = wr_next_line(r, &line);
+            int err = errno;
+            wr_close(r);
+            close(fd);
+
+            long ref = utf8 != NULL ? read_fgetwc(path, expect, TEXT) : -1;
+            int ref_ok = utf8 == NULL || (cases[i].silent ? ref == 3 : ref == -1 && errno == EILSEQ);
+            char label[96];
+            snprintf(label, sizeof(label), "%s: EILSEQ%s", cases[i].what,
+                     utf8 == NULL ? "" : cases[i].silent ? " (fgetwc() silently stops)" : ", as fgetwc()");
+            check(first == 1 && second == -1 && err == EILSEQ && ref_ok, label);
+        }
+    }
+    printf("\n");
+
+    // Test 5: WIDE_LOCALE outside UTF-8
+    printf("Test 5: The \"C\" locale\n");
+    {
+        setlocale(LC_ALL, "C");
+        const char *bytes = "plain\nÑom\n";
+        write_bytes(path, bytes, strlen(bytes));
+
+        size_t lines;
+        long ref = read_fgetwc(path, expect, TEXT);
+        int ref_errno = errno;
+        errno = 0;
+        long n = read_lines(path, WIDE_LOCALE, 0, got, TEXT, &lines);
+        printf("  fgetwc(): %s, WIDE_LOCALE: %s\n", ref < 0 ? strerror(ref_errno) : "read",
+               n < 0 ? strerror(errno) : "read");
+        check(ref == n && (n < 0 || wmemcmp(got, expect, (size_t)n) == 0),
+              "WIDE_LOCALE decodes like fgetwc() (mbrtowc() path)");
+
+        n = read_lines(path, WIDE_UTF8, 0, got, TEXT, &lines);
+        check(n == 10 && got[6] == L'Ñ', "WIDE_UTF8 reads UTF-8 whatever the locale");
+    }
+
+    unlink(path);
+    free(text);
+    free(expect);
+    free(got);
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. Bytes are read in large blocks and decoded a block at a time\n");
+    printf("2. ASCII runs are widened by strkit's SIMD kernels; no lock per character\n");
+    printf("3. Lines and chunks are views into the decoded buffer, not copies\n");
+    printf("4. A character split between two reads is carried over, not lost\n");
+    printf("5. Invalid or truncated input fails with EILSEQ; fgetwc() ignores a cut-off end\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
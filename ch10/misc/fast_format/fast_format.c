@@ -0,0 +1,568 @@
+/*
+ * Fast Format - fast_format.c
+ *
+ * Integer conversion writes two digits per step from a 200-byte table,
+ * back to front from a precomputed digit count. Doubles use Ulf Adams'
+ * Ryu algorithm (PLDI 2018): the binary value and the halfway points to
+ * its neighbours are scaled by a 128-bit power of 5 into decimal, and
+ * digits are dropped while both halfway points still agree on them.
+ * Reference Ryu ships its power-of-5 tables as 10 KB of constants; here
+ * they are computed once, on first use, from a small bignum.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "fast_format.h"
+
+#ifndef __SIZEOF_INT128__
+#error "fast_format.c needs a compiler with unsigned __int128 (GCC or Clang)"
+#endif
+
+typedef unsigned __int128 u128;
+
+static const char digit_pairs[200] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+static const uint64_t pow10_u64[20] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// ============================================================================
+// Integers
+// ============================================================================
+
+// Decimal digits in value (1 for 0): log10 estimated from the bit length,
+// then corrected by a single compare
+static unsigned digit_count(uint64_t value)
+{
+    unsigned bits = 64 - (unsigned)__builtin_clzll(value | 1);
+    unsigned t = (bits * 1233) >> 12; // 1233 / 4096 ~ log10(2)
+    return t + 1 - ((value | 1) < pow10_u64[t]);
+}
+
+// Write value's digits so that the last one lands just before end
+static void put_digits(char *end, uint64_t value)
+{
+    while (value > UINT32_MAX)
+    {
+        uint64_t r = value % 100;
+        value /= 100;
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * r, 2);
+    }
+    uint32_t v = (uint32_t)value;
+    while (v >= 100)
+    {
+        uint32_t r = v % 100;
+        v /= 100;
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * r, 2);
+    }
+    if (v >= 10)
+    {
+        memcpy(end - 2, digit_pairs + 2 * v, 2);
+    }
+    else
+    {
+        end[-1] = (char)('0' + v);
+    }
+}
+
+char *ff_u64(char *dst, uint64_t value)
+{
+    char *end = dst + digit_count(value);
+    put_digits(end, value);
+    return end;
+}
+
+char *ff_i64(char *dst, int64_t value)
+{
+    uint64_t u = (uint64_t)value;
+    if (value < 0)
+    {
+        *dst++ = '-';
+        u = 0 - u; // also right for INT64_MIN
+    }
+    return ff_u64(dst, u);
+}
+
+char *ff_u32(char *dst, uint32_t value)
+{
+    return ff_u64(dst, value);
+}
+
+char *ff_i32(char *dst, int32_t value)
+{
+    return ff_i64(dst, value);
+}
+
+// ============================================================================
+// Ryu power-of-5 tables
+// ============================================================================
+
+#define POW5_BITCOUNT 125
+#define POW5_INV_BITCOUNT 125
+#define POW5_TABLE_SIZE 326
+#define POW5_INV_TABLE_SIZE 342
+
+// pow5_split[i] = 5^i scaled to exactly 125 bits
+// pow5_inv_split[q] = floor(2^(pow5bits(q) - 1 + 125) / 5^q) + 1
+// Each as {low 64 bits, high 64 bits}
+static uint64_t pow5_split[POW5_TABLE_SIZE][2];
+static uint64_t pow5_inv_split[POW5_INV_TABLE_SIZE][2];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// Bits in 5^e, for 0 <= e <= 3528
+static int32_t pow5bits(int32_t e)
+{
+    return ((e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)), for 0 <= e <= 1650
+static uint32_t log10_pow2(int32_t e)
+{
+    return (uint32_t)((e * 78913) >> 18);
+}
+
+// floor(log10(5^e)), for 0 <= e <= 2620
+static uint32_t log10_pow5(int32_t e)
+{
+    return (uint32_t)((e * 732923) >> 20);
+}
+
+// Little-endian bignum, large enough for 2^1024
+#define BIG_WORDS 33
+
+// Bits shift .. shift + 127 of n (bits below 0 read as 0)
+static void big_extract(const uint32_t *n, int shift, uint64_t out[2])
+{
+    out[0] = out[1] = 0;
+    for (int k = 0; k < 128; k++)
+    {
+        int bit = shift + k;
+        if (bit >= 0 && bit < BIG_WORDS * 32 && (n[bit >> 5] >> (bit & 31)) & 1)
+        {
+            out[k >> 6] |= 1ULL << (k & 63);
+        }
+    }
+}
+
+static void init_tables(void)
+{
+    uint32_t pow5[BIG_WORDS] = {1}; // 5^i
+    for (int i = 0; i < POW5_TABLE_SIZE; i++)
+    {
+        big_extract(pow5, pow5bits(i) - POW5_BITCOUNT, pow5_split[i]);
+        uint64_t carry = 0;
+        for (int w = 0; w < BIG_WORDS; w++)
+        {
+            uint64_t x = (uint64_t)pow5[w] * 5 + carry;
+            pow5[w] = (uint32_t)x;
+            carry = x >> 32;
+        }
+    }
+
+    // floor(2^1024 / 5^q), one exact division by 5 per step; shifting it
+    // right gives floor(2^N / 5^q) for any N <= 1024
+    uint32_t inv[BIG_WORDS] = {0};
+    inv[BIG_WORDS - 1] = 1;
+    for (int q = 0; q < POW5_INV_TABLE_SIZE; q++)
+    {
+        int n = pow5bits(q) - 1 + POW5_INV_BITCOUNT;
+        uint64_t *e = pow5_inv_split[q];
+        big_extract(inv, 1024 - n, e);
+        e[1] += ++e[0] == 0;
+        uint64_t rem = 0;
+        for (int w = BIG_WORDS - 1; w >= 0; w--)
+        {
+            uint64_t x = (rem << 32) | inv[w];
+            inv[w] = (uint32_t)(x / 5);
+            rem = x % 5;
+        }
+    }
+}
+
+// ============================================================================
+// Ryu: shortest decimal for a double
+// ============================================================================
+
+static uint32_t pow5_factor(uint64_t value)
+{
+    uint32_t count = 0;
+    while (value % 5 == 0)
+    {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+static int multiple_of_pow5(uint64_t value, uint32_t p)
+{
+    return pow5_factor(value) >= p;
+}
+
+static int multiple_of_pow2(uint64_t value, uint32_t p)
+{
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, for 64 < j < 128
+static uint64_t mul_shift(uint64_t m, const uint64_t mul[2], int32_t j)
+{
+    u128 low = (u128)m * mul[0];
+    u128 high = (u128)m * mul[1];
+    return (uint64_t)(((low >> 64) + high) >> (j - 64));
+}
+
+// Decimal significand and exponent: value = *digits * 10^*exponent
+static void ryu(uint64_t mantissa, uint32_t biased_exp, uint64_t *digits, int32_t *exponent)
+{
+    // Step 1: value = m2 * 2^e2, with 2 extra bits for the halfway points
+    int32_t e2;
+    uint64_t m2;
+    if (biased_exp == 0)
+    {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = mantissa;
+    }
+    else
+    {
+        e2 = (int32_t)biased_exp - 1023 - 52 - 2;
+        m2 = (1ULL << 52) | mantissa;
+    }
+    int accept_bounds = (m2 & 1) == 0; // round-half-even reads the bounds back as this value
+
+    // Step 2: the interval (mm, mp) that reads back as this value, as
+    // 4 * m2 -/+ 2 (the lower gap halves at a power of two)
+    uint64_t mv = 4 * m2;
+    uint32_t mm_shift = mantissa != 0 || biased_exp <= 1;
+
+    // Step 3: vm, vr, vp = the three points times 10^-e10, rounded down
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    if (e2 >= 0)
+    {
+        uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift(4 * m2, pow5_inv_split[q], i);
+        vp = mul_shift(4 * m2 + 2, pow5_inv_split[q], i);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, pow5_inv_split[q], i);
+        if (q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5, if any
+            if (mv % 5 == 0)
+            {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            }
+            else if (accept_bounds)
+            {
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            }
+            else
+            {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    }
+    else
+    {
+        uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mul_shift(4 * m2, pow5_split[i], j);
+        vp = mul_shift(4 * m2 + 2, pow5_split[i], j);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, pow5_split[i], j);
+        if (q <= 1)
+        {
+            // mv = 4 * m2 always has at least two trailing zero bits
+            vr_trailing_zeros = 1;
+            if (accept_bounds)
+            {
+                vm_trailing_zeros = mm_shift == 1; // mm = mv - 1 - mm_shift
+            }
+            else
+            {
+                --vp; // mp = mv + 2 always has at least one trailing zero bit
+            }
+        }
+        else if (q < 63)
+        {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Step 4: drop digits while vm and vp still differ above them
+    int32_t removed = 0;
+    uint32_t last_removed = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        // Exact-bound cases (well under 1% of doubles)
+        while (vp / 10 > vm / 10)
+        {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (uint32_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (uint32_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0)
+        {
+            last_removed = 4; // exactly halfway: round to even
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    }
+    else
+    {
+        int round_up = 0;
+        if (vp / 100 > vm / 100)
+        {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    *digits = output;
+    *exponent = e10 + removed;
+}
+
+char *ff_double(char *dst, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t mantissa = bits & ((1ULL << 52) - 1);
+    uint32_t biased_exp = (uint32_t)(bits >> 52) & 0x7ff;
+
+    if (biased_exp == 0x7ff && mantissa != 0)
+    {
+        memcpy(dst, "nan", 3);
+        return dst + 3;
+    }
+    if (bits >> 63)
+    {
+        *dst++ = '-';
+    }
+    if (biased_exp == 0x7ff)
+    {
+        memcpy(dst, "inf", 3);
+        return dst + 3;
+    }
+    if (biased_exp == 0 && mantissa == 0)
+    {
+        memcpy(dst, "0.0", 3);
+        return dst + 3;
+    }
+
+    pthread_once(&tables_once, init_tables);
+    uint64_t output;
+    int32_t exp10;
+    ryu(mantissa, biased_exp, &output, &exp10);
+
+    char digits[20];
+    int len = (int)digit_count(output);
+    put_digits(digits + len, output);
+    int point = exp10 + len; // value = 0.<digits> * 10^point
+
+    if (point <= -4 || point > 16)
+    {
+        // 1.2345e+67: at least two exponent digits, as printf("%e") writes
+        *dst++ = digits[0];
+        if (len > 1)
+        {
+            *dst++ = '.';
+            memcpy(dst, digits + 1, (size_t)(len - 1));
+            dst += len - 1;
+        }
+        int e = point - 1;
+        *dst++ = 'e';
+        *dst++ = e < 0 ? '-' : '+';
+        e = e < 0 ? -e : e;
+        if (e < 10)
+        {
+            *dst++ = '0';
+        }
+        return ff_u32(dst, (uint32_t)e);
+    }
+    if (point <= 0)
+    {
+        // 0.000123
+        memcpy(dst, "0.000", (size_t)(2 - point));
+        dst += 2 - point;
+        memcpy(dst, digits, (size_t)len);
+        return dst + len;
+    }
+    if (point < len)
+    {
+        // 123.45
+        memcpy(dst, digits, (size_t)point);
+        dst += point;
+        *dst++ = '.';
+        memcpy(dst, digits + point, (size_t)(len - point));
+        return dst + len - point;
+    }
+    // 12300.0
+    memcpy(dst, digits, (size_t)len);
+    dst += len;
+    memset(dst, '0', (size_t)(point - len));
+    dst += point - len;
+    memcpy(dst, ".0", 2);
+    return dst + 2;
+}
+
+// ============================================================================
+// Bounded buffer
+// ============================================================================
+
+void ff_buffer_init(FfBuffer *b, char *storage, size_t cap, FILE *sink)
+{
+    b->data = storage;
+    b->len = 0;
+    b->cap = cap;
+    b->sink = sink;
+    b->overflow = 0;
+}
+
+int ff_flush(FfBuffer *b)
+{
+    if (b->sink == NULL)
+    {
+        return -1;
+    }
+    size_t len = b->len;
+    b->len = 0;
+    if (len > 0 && fwrite(b->data, 1, len, b->sink) != len)
+    {
+        b->overflow = 1;
+        return -1;
+    }
+    return 0;
+}
+
+int ff_put_mem(FfBuffer *b, const char *s, size_t len)
+{
+    if (b->cap - b->len < len)
+    {
+        if (ff_flush(b) != 0)
+        {
+            b->overflow = 1;
+            return -1;
+        }
+        if (len > b->cap)
+        {
+            // Larger than the whole buffer: straight through
+            if (fwrite(s, 1, len, b->sink) != len)
+            {
+                b->overflow = 1;
+                return -1;
+            }
+            return 0;
+        }
+    }
+    memcpy(b->data + b->len, s, len);
+    b->len += len;
+    return 0;
+}
+
+int ff_put_str(FfBuffer *b, const char *s)
+{
+    return ff_put_mem(b, s, strlen(s));
+}
+
+int ff_put_char(FfBuffer *b, char c)
+{
+    if (b->len < b->cap)
+    {
+        b->data[b->len++] = c;
+        return 0;
+    }
+    return ff_put_mem(b, &c, 1);
+}
+
+// Convert in place when the longest output fits, else through a copy so
+// that a nearly full buffer still takes short numbers
+#define PUT_NUMBER(b, fn, size, value)                             \
+    do                                                             \
+    {                                                              \
+        if ((b)->cap - (b)->len >= (size))                         \
+        {                                                          \
+            char *start = (b)->data + (b)->len;                    \
+            (b)->len += (size_t)(fn(start, value) - start);        \
+            return 0;                                              \
+        }                                                          \
+        char tmp[size];                                            \
+        return ff_put_mem((b), tmp, (size_t)(fn(tmp, value) - tmp)); \
+    } while (0)
+
+int ff_put_u64(FfBuffer *b, uint64_t value)
+{
+    PUT_NUMBER(b, ff_u64, FF_U64_SIZE, value);
+}
+
+int ff_put_i64(FfBuffer *b, int64_t value)
+{
+    PUT_NUMBER(b, ff_i64, FF_I64_SIZE, value);
+}
+
+int ff_put_double(FfBuffer *b, double value)
+{
+    PUT_NUMBER(b, ff_double, FF_DOUBLE_SIZE, value);
+}
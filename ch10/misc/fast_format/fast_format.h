@@ -0,0 +1,74 @@
+/*
+ * Fast Format - fast_format.h
+ *
+ * Public interface for number-to-text conversion without printf().
+ *
+ * printf("%d") parses its format string, walks its varargs and consults
+ * the locale on every call, and takes the stream lock besides. The
+ * functions here convert one number straight into a caller's buffer:
+ *
+ *   - integers two digits at a time from a 200-byte table, with the
+ *     digit count computed up front so nothing is reversed afterwards
+ *   - doubles as the shortest decimal that reads back as the same double
+ *     (Ryu), so 0.1 is "0.1", not "0.10000000000000001" as %.17g gives
+ *
+ * The ff_* converters write no terminating NUL and return a pointer just
+ * past the last character; dst must have room for the FF_*_SIZE bytes
+ * below. FfBuffer adds bounds checks and an optional FILE to flush to.
+ */
+
+#ifndef FAST_FORMAT_H
+#define FAST_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Longest output of each converter
+#define FF_U32_SIZE 10    // 4294967295
+#define FF_I32_SIZE 11    // -2147483648
+#define FF_U64_SIZE 20    // 18446744073709551615
+#define FF_I64_SIZE 20    // -9223372036854775808
+#define FF_DOUBLE_SIZE 24 // -2.2250738585072014e-308
+
+// Integers, in decimal
+char *ff_u32(char *dst, uint32_t value);
+char *ff_i32(char *dst, int32_t value);
+char *ff_u64(char *dst, uint64_t value);
+char *ff_i64(char *dst, int64_t value);
+
+// The shortest digits that round-trip through strtod(), laid out as
+// Python's repr() does: "0.1", "100.0", "1e+16", "1.5e-07", "-0.0",
+// "inf", "nan"
+char *ff_double(char *dst, double value);
+
+// ============================================================================
+// Bounded buffer
+// ============================================================================
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t cap;
+    FILE *sink;   // when full: fwrite() the contents here and start over
+    int overflow; // something did not fit (no sink) or fwrite() failed
+} FfBuffer;
+
+// Format into storage[0..cap). sink may be NULL.
+void ff_buffer_init(FfBuffer *b, char *storage, size_t cap, FILE *sink);
+
+// Append one item. Returns 0, or -1 (and sets overflow) if it did not fit
+// and could not be flushed; nothing is then written.
+int ff_put_u64(FfBuffer *b, uint64_t value);
+int ff_put_i64(FfBuffer *b, int64_t value);
+int ff_put_double(FfBuffer *b, double value);
+int ff_put_str(FfBuffer *b, const char *s);
+int ff_put_mem(FfBuffer *b, const char *s, size_t len);
+int ff_put_char(FfBuffer *b, char c);
+
+// Write the contents to the sink. Returns 0, or -1 with no sink or if
+// fwrite() failed.
+int ff_flush(FfBuffer *b);
+
+#endif /* FAST_FORMAT_H */
@@ -0,0 +1,207 @@
+/*
+ * Fast Format - fast_format_bench.c
+ *
+ * Benchmark: values formatted per second by snprintf() and by the ff_*
+ * converters, for integers and for doubles (%.17g being the printf way
+ * to get a round-trip form, %g the short but lossy one), then a whole
+ * dump of "id value\n" lines through fprintf() versus an FfBuffer
+ * flushing to the same FILE.
+ *
+ * Usage: ./fast_format_bench [value_count]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fast_format.h"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dULL;
+
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static int64_t *ints;
+static double *doubles;
+static size_t count;
+static volatile size_t sink_bytes; // keeps the loops from being optimized out
+
+static void int_snprintf(void)
+{
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (size_t)snprintf(buf, sizeof(buf), "%lld", (long long)ints[i]);
+    }
+    sink_bytes = total;
+}
+
+static void int_ff(void)
+{
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (size_t)(ff_i64(buf, ints[i]) - buf);
+    }
+    sink_bytes = total;
+}
+
+static void double_snprintf_17g(void)
+{
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (size_t)snprintf(buf, sizeof(buf), "%.17g", doubles[i]);
+    }
+    sink_bytes = total;
+}
+
+static void double_snprintf_g(void)
+{
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (size_t)snprintf(buf, sizeof(buf), "%g", doubles[i]);
+    }
+    sink_bytes = total;
+}
+
+static void double_ff(void)
+{
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (size_t)(ff_double(buf, doubles[i]) - buf);
+    }
+    sink_bytes = total;
+}
+
+static double time_it(void (*fn)(void))
+{
+    double t0 = now_seconds();
+    fn();
+    return now_seconds() - t0;
+}
+
+int main(int argc, char *argv[])
+{
+    count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000000;
+    if (count == 0)
+    {
+        fprintf(stderr, "Usage: %s [value_count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    ints = malloc(count * sizeof(*ints));
+    doubles = malloc(count * sizeof(*doubles));
+    if (ints == NULL || doubles == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    // Integers of every length; doubles as measurements (a few digits)
+    // and as arbitrary bit patterns (17 digits, any exponent)
+    for (size_t i = 0; i < count; i++)
+    {
+        ints[i] = (int64_t)next_random() >> (next_random() % 64);
+        if (i % 2 == 0)
+        {
+            doubles[i] = (double)(next_random() % 1000000) / 100.0;
+        }
+        else
+        {
+            uint64_t bits = next_random() & ~(1ULL << 62); // no inf or nan
+            memcpy(&doubles[i], &bits, sizeof(double));
+        }
+    }
+
+    printf("=== Number Formatting Benchmark ===\n\n");
+    printf("%zu values per method\n\n", count);
+    printf("  %-28s %14s\n", "Method", "Values/s");
+
+    struct
+    {
+        const char *label;
+        void (*fn)(void);
+        void (*baseline)(void);
+    } rows[] = {
+        {"snprintf(\"%lld\")", int_snprintf, NULL},
+        {"ff_i64()", int_ff, int_snprintf},
+        {"snprintf(\"%.17g\")", double_snprintf_17g, NULL},
+        {"snprintf(\"%g\") (lossy)", double_snprintf_g, double_snprintf_17g},
+        {"ff_double()", double_ff, double_snprintf_17g},
+    };
+    double times[5];
+    for (int i = 0; i < 5; i++)
+    {
+        times[i] = time_it(rows[i].fn);
+        printf("  %-28s %14.0f", rows[i].label, (double)count / times[i]);
+        if (rows[i].baseline != NULL)
+        {
+            int base = rows[i].baseline == int_snprintf ? 0 : 2;
+            printf("   %.2fx", times[base] / times[i]);
+        }
+        printf("\n");
+    }
+
+    // A dump loop: "id value\n" per record into a temporary file
+    FILE *a = tmpfile();
+    FILE *b = tmpfile();
+    if (a == NULL || b == NULL)
+    {
+        perror("tmpfile");
+        return EXIT_FAILURE;
+    }
+    double t0 = now_seconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        fprintf(a, "%zu %.17g\n", i, doubles[i]);
+    }
+    fflush(a);
+    double t_fprintf = now_seconds() - t0;
+
+    char storage[1 << 16];
+    FfBuffer out;
+    t0 = now_seconds();
+    ff_buffer_init(&out, storage, sizeof(storage), b);
+    for (size_t i = 0; i < count; i++)
+    {
+        ff_put_u64(&out, i);
+        ff_put_char(&out, ' ');
+        ff_put_double(&out, doubles[i]);
+        ff_put_char(&out, '\n');
+    }
+    ff_flush(&out);
+    fflush(b);
+    double t_ff = now_seconds() - t0;
+
+    printf("\n  %-28s %14s %12s\n", "Dump of id/value lines", "Lines/s", "Bytes");
+    printf("  %-28s %14.0f %12ld\n", "fprintf(\"%zu %.17g\\n\")", (double)count / t_fprintf, ftell(a));
+    printf("  %-28s %14.0f %12ld   %.2fx\n", "FfBuffer", (double)count / t_ff, ftell(b), t_fprintf / t_ff);
+    int ok = !out.overflow;
+    fclose(a);
+    fclose(b);
+
+    free(ints);
+    free(doubles);
+    printf("\n%s Every value formatted\n", ok ? "✓" : "✗");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
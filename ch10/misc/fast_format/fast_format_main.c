@@ -0,0 +1,271 @@
+/*
+ * Fast Format - fast_format_main.c
+ *
+ * Demonstrates printf-free number formatting: integers checked against
+ * snprintf(), doubles against known shortest forms and round-tripped
+ * through strtod(), and FfBuffer rebuilding the queue_print() and
+ * show_result() lines of ch10 with a flush to a FILE.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fast_format.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Random value with a random bit length, so every digit count shows up
+static uint64_t random_magnitude(void)
+{
+    uint64_t v = next_random();
+    return v >> (next_random() % 64);
+}
+
+// Digits from the first nonzero one to the last ("0.00120" -> 2)
+static int significant_digits(const char *text)
+{
+    int first = -1, last = -1, n = 0;
+    for (const char *p = text; *p != '\0' && *p != 'e'; p++)
+    {
+        if (*p >= '0' && *p <= '9')
+        {
+            if (*p != '0')
+            {
+                first = first < 0 ? n : first;
+                last = n;
+            }
+            n++;
+        }
+    }
+    return first < 0 ? 1 : last - first + 1;
+}
+
+static const char *fmt_double(char *buf, double d)
+{
+    *ff_double(buf, d) = '\0';
+    return buf;
+}
+
+int main(void)
+{
+    printf("=== Fast Number Formatting ===\n\n");
+
+    // Test 1: Integers
+    printf("Test 1: Integers against snprintf()\n");
+    {
+        const int64_t edges[] = {0, 1, 9, 10, 99, 100, 999, 1000, -1, -10, INT32_MAX, INT32_MIN,
+                                 (int64_t)UINT32_MAX + 1, INT64_MAX, INT64_MIN, 1000000000000000000LL};
+        char a[32], b[32];
+        int bad = 0;
+        for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+        {
+            *ff_i64(a, edges[i]) = '\0';
+            snprintf(b, sizeof(b), "%" PRId64, edges[i]);
+            bad += strcmp(a, b) != 0;
+        }
+        *ff_u64(a, UINT64_MAX) = '\0';
+        check(bad == 0 && strcmp(a, "18446744073709551615") == 0, "edge values (0, powers of ten, INT64_MIN, UINT64_MAX)");
+
+        int len_bad = 0;
+        bad = 0;
+        for (int i = 0; i < 1000000; i++)
+        {
+            uint64_t u = random_magnitude();
+            int64_t s = (int64_t)next_random() >> (next_random() % 64);
+            char *end = ff_u64(a, u);
+            *end = '\0';
+            snprintf(b, sizeof(b), "%" PRIu64, u);
+            bad += strcmp(a, b) != 0;
+            len_bad += (size_t)(end - a) > FF_U64_SIZE;
+            *ff_i64(a, s) = '\0';
+            snprintf(b, sizeof(b), "%" PRId64, s);
+            bad += strcmp(a, b) != 0;
+            *ff_i32(a, (int32_t)s) = '\0';
+            snprintf(b, sizeof(b), "%" PRId32, (int32_t)s);
+            bad += strcmp(a, b) != 0;
+            *ff_u32(a, (uint32_t)u) = '\0';
+            snprintf(b, sizeof(b), "%" PRIu32, (uint32_t)u);
+            bad += strcmp(a, b) != 0;
+        }
+        check(bad == 0 && len_bad == 0, "4,000,000 random u64/i64/i32/u32 values identical");
+    }
+    printf("\n");
+
+    // Test 2: Shortest doubles
+    printf("Test 2: Doubles in their shortest form\n");
+    {
+        static const struct
+        {
+            double value;
+            const char *text;
+        } cases[] = {
+            {0.1, "0.1"},
+            {0.1 + 0.2, "0.30000000000000004"},
+            {1.0 / 3.0, "0.3333333333333333"},
+            {100.0, "100.0"},
+            {-2.5, "-2.5"},
+            {1e16, "1e+16"},
+            {1234567890123456.0, "1234567890123456.0"},
+            {1.5e-7, "1.5e-07"},
+            {0.0001, "0.0001"},
+            {5e-324, "5e-324"},
+            {1.7976931348623157e308, "1.7976931348623157e+308"},
+            {-2.2250738585072014e-308, "-2.2250738585072014e-308"},
+            {-0.0, "-0.0"},
+        };
+        char buf[32], g17[32];
+        int bad = 0;
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        {
+            fmt_double(buf, cases[i].value);
+            if (strcmp(buf, cases[i].text) != 0)
+            {
+                printf("    %s, expected %s\n", buf, cases[i].text);
+                bad++;
+            }
+        }
+        snprintf(g17, sizeof(g17), "%.17g", 0.1);
+        printf("  0.1 -> \"%s\" (printf %%.17g: \"%s\")\n", fmt_double(buf, 0.1), g17);
+        check(bad == 0, "13 known values, fixed and exponent layouts");
+        int ok = strcmp(fmt_double(buf, INFINITY), "inf") == 0 && strcmp(fmt_double(buf, -INFINITY), "-inf") == 0 &&
+                 strcmp(fmt_double(buf, NAN), "nan") == 0;
+        check(ok, "inf, -inf, nan");
+    }
+    printf("\n");
+
+    // Test 3: Round trip
+    printf("Test 3: Random bit patterns through strtod()\n");
+    {
+        char buf[32], ref[32];
+        int bad = 0, longer = 0, over = 0;
+        for (int i = 0; i < 1000000; i++)
+        {
+            uint64_t bits = next_random();
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (!isfinite(d))
+            {
+                continue;
+            }
+            char *end = ff_double(buf, d);
+            *end = '\0';
+            over += end - buf > FF_DOUBLE_SIZE;
+            double back = strtod(buf, NULL);
+            bad += memcmp(&back, &d, sizeof(d)) != 0;
+
+            // No shorter %.*e form reads back as d
+            if (i % 50 == 0)
+            {
+                int digits = significant_digits(buf);
+                snprintf(ref, sizeof(ref), "%.*e", digits - 2, d);
+                longer += digits > 1 && strtod(ref, NULL) == d;
+            }
+        }
+        check(bad == 0, "1,000,000 values read back bit for bit");
+        check(longer == 0, "no value has a shorter round-trip form");
+        check(over == 0, "no output longer than FF_DOUBLE_SIZE");
+    }
+    printf("\n");
+
+    // Test 4: FfBuffer
+    printf("Test 4: Building lines in an FfBuffer\n");
+    {
+        // queue_print() from ch10/listings/queue.c, without printf()
+        const int queue[] = {10, 20, -30, 40};
+        char storage[64];
+        FfBuffer b;
+        ff_buffer_init(&b, storage, sizeof(storage), NULL);
+        ff_put_str(&b, "Queue: [");
+        for (int i = 0; i < 4; i++)
+        {
+            ff_put_i64(&b, queue[i]);
+            if (i < 3)
+            {
+                ff_put_str(&b, ", ");
+            }
+        }
+        ff_put_str(&b, "] (size=");
+        ff_put_u64(&b, 4);
+        ff_put_char(&b, ')');
+        printf("  %.*s\n", (int)b.len, b.data);
+        check(b.len == 33 && memcmp(b.data, "Queue: [10, 20, -30, 40] (size=4)", 33) == 0, "same text as queue_print()");
+
+        // No sink: what does not fit is refused whole
+        char tiny[8];
+        ff_buffer_init(&b, tiny, sizeof(tiny), NULL);
+        int rc1 = ff_put_i64(&b, -123456);
+        int rc2 = ff_put_i64(&b, 42);
+        check(rc1 == 0 && rc2 == -1 && b.overflow && b.len == 7, "without a sink, a number that does not fit is refused");
+
+        // With a sink: show_result()-style lines from simple_program,
+        // 100,000 of them, flushed in 4 KiB pieces
+        FILE *fast = tmpfile();
+        FILE *slow = tmpfile();
+        if (fast == NULL || slow == NULL)
+        {
+            perror("tmpfile");
+            return EXIT_FAILURE;
+        }
+        char out[4096], num[32];
+        ff_buffer_init(&b, out, sizeof(out), fast);
+        for (int i = 0; i < 100000; i++)
+        {
+            ff_put_str(&b, "Result: 7 * ");
+            ff_put_i64(&b, i);
+            ff_put_str(&b, " = ");
+            ff_put_i64(&b, 7LL * i);
+            ff_put_str(&b, " (");
+            ff_put_double(&b, i / 8.0);
+            ff_put_str(&b, ")\n");
+            fprintf(slow, "Result: 7 * %d = %lld (%s)\n", i, 7LL * i, fmt_double(num, i / 8.0));
+        }
+        ff_flush(&b);
+        long size = ftell(fast);
+        int same = !b.overflow && size == ftell(slow);
+        rewind(fast);
+        rewind(slow);
+        for (int c; same && (c = getc(fast)) != EOF;)
+        {
+            same = c == getc(slow);
+        }
+        printf("  %ld bytes written through a %zu-byte buffer\n", size, sizeof(out));
+        check(same, "same bytes as fprintf(), across every flush boundary");
+        fclose(fast);
+        fclose(slow);
+    }
+
+    printf("\n=== Important Notes ===\n");
+    printf("1. No format string, varargs, locale or stream lock per number\n");
+    printf("2. Integers are written two digits per step, length known up front\n");
+    printf("3. Doubles are the shortest digits that strtod() reads back exactly\n");
+    printf("4. Output has no NUL; each ff_* returns the end of what it wrote\n");
+    printf("5. The decimal point is always '.', whatever setlocale() says\n");
+
+    if (failures != 0)
+    {
+        printf("\n✗ %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -3,44 +3,45 @@
  */
 
 #include "isprime.h"
+#include "parse_u64.h"
 #include <assert.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Print command line help text.
 static void print_help(void)
 {
-    printf("%s", "primetest num1 [num2 num3 ... numN]\n\n");
+    printf("%s", "primetest num1 [num2 num3 ... numN]\n");
+    printf("%s", "primetest -f file   (whitespace-separated numbers; - for stdin)\n\n");
     printf("%s", "Tests positive integers for primality. Supports testing ");
     printf("%s [2-%llu].\n", "numbers in the range", ULLONG_MAX);
 }
 
+// Returns true if val is in the range the program tests, [2-ULLONG_MAX].
+// Shared by command line arguments and -f input.
+static bool in_range(unsigned long long val)
+{
+    // We want to allow only values greater than one, so we reject values <= 1.
+    return val > 1;
+}
+
 // Converts a string argument arg to an unsigned long long value referenced by val.
 // Returns true if the argument conversion succeeds, and false if it fails.
 static bool convert_arg(const char *arg, unsigned long long *val)
 {
-    char *end;
-
-    // strtoll returns an in-band error indicator; clear errno before the call.
-    errno = 0;
-    *val = strtoull(arg, &end, 10);
-
-    // Check for failures where the call returns a sentinel value and sets errno.
-    if ((*val == ULLONG_MAX) && errno)
-        return false;
-    if (*val == 0 && errno)
-        return false;
-    if (end == arg)
+    // Unlike strtoull, parse_u64 rejects signs, whitespace and trailing
+    // characters ("-5" would otherwise wrap around to a huge value) and
+    // reports overflow in its return value rather than through errno.
+    if (!parse_u64(arg, val))
         return false;
 
-    // If we got here, we were able to convert the argument. However, we want to allow only
-    // values greater than one, so we reject values <= 1.
-    if (*val <= 1)
-        return false;
-    return true;
+    // If we got here, we were able to convert the argument. However, it
+    // must also be in range.
+    return in_range(*val);
 }
 
 static unsigned long long *convert_command_line_args(int argc,
@@ -86,8 +87,89 @@ static unsigned long long *convert_command_line_args(int argc,
     return args;
 }
 
+// Tests every number in a file (or stdin for "-"), one block at a time. The
+// numbers are parsed into a fixed array, so nothing is allocated per number
+// or per file. Returns EXIT_SUCCESS, or EXIT_FAILURE on a read or parse error
+// or a number outside [2-ULLONG_MAX].
+static int test_file(const char *path)
+{
+    static char block[1 << 16];
+    unsigned long long vals[1024];
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (in == NULL)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    size_t kept = 0; // bytes of a number cut off at the end of the last block
+    bool eof = false;
+    int result = EXIT_SUCCESS;
+    while (!eof && result == EXIT_SUCCESS)
+    {
+        size_t got = fread(block + kept, 1, sizeof(block) - kept, in);
+        eof = got < sizeof(block) - kept;
+        const char *end = block + kept + got;
+
+        // Parse only up to the last whitespace unless this is the end of the
+        // input; the digits after it may continue in the next block.
+        const char *stop = end;
+        while (!eof && stop > block && strchr(" \t\n\r\v\f", stop[-1]) == NULL)
+            --stop;
+        if (!eof && stop == block)
+        {
+            fprintf(stderr, "%s: token longer than %zu bytes\n", path, sizeof(block));
+            result = EXIT_FAILURE;
+            break;
+        }
+
+        const char *cursor = block;
+        ParseU64Status status = PARSE_U64_OK;
+        while (cursor < stop && status == PARSE_U64_OK && result == EXIT_SUCCESS)
+        {
+            size_t n = parse_u64_list(&cursor, stop, vals, sizeof(vals) / sizeof(vals[0]), &status);
+            for (size_t i = 0; i < n; ++i)
+            {
+                // The same range as command line arguments: stop at the
+                // first value outside it, as at a parse error.
+                if (!in_range(vals[i]))
+                {
+                    fprintf(stderr, "%s: %llu is out of range [2-%llu]\n", path, vals[i], ULLONG_MAX);
+                    result = EXIT_FAILURE;
+                    break;
+                }
+                printf("%llu is %s.\n", vals[i],
+                       is_prime(vals[i], 100) ? "probably prime" : "not prime");
+            }
+        }
+        if (status != PARSE_U64_OK)
+        {
+            int shown = stop - cursor < 20 ? (int)(stop - cursor) : 20;
+            fprintf(stderr, "%s: %s at \"%.*s\"\n", path,
+                    status == PARSE_U64_OVERFLOW ? "number out of range" : "not a number",
+                    shown, cursor);
+            result = EXIT_FAILURE;
+        }
+
+        kept = (size_t)(end - stop);
+        memmove(block, stop, kept);
+    }
+
+    if (ferror(in))
+    {
+        perror(path);
+        result = EXIT_FAILURE;
+    }
+    if (in != stdin)
+        fclose(in);
+    return result;
+}
+
 int main(int argc, const char *argv[])
 {
+    if (argc == 3 && strcmp(argv[1], "-f") == 0)
+        return test_file(argv[2]);
+
     size_t num_args;
     unsigned long long *vals = convert_command_line_args(argc, argv, &num_args);
 
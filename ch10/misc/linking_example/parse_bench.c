@@ -0,0 +1,162 @@
+/*
+ * Prime Number Testing - Parsing Benchmark
+ * strtoull per number versus parse_u64_list over a whole buffer
+ *
+ * Usage: bin/parse_bench [count]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "parse_u64.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned long long rng_state = 0x9e3779b97f4a7c15ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// The per-number loop a strtoull-based reader needs, with convert_arg's checks
+static bool sum_strtoull(const char *text, size_t count, unsigned long long *sum)
+{
+    const char *p = text;
+    *sum = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        char *end;
+        errno = 0;
+        unsigned long long v = strtoull(p, &end, 10);
+        if (end == p || errno != 0)
+            return false;
+        *sum += v;
+        p = end;
+    }
+    return true;
+}
+
+static bool sum_parse_u64(const char *text, size_t len, size_t count, unsigned long long *sum)
+{
+    unsigned long long vals[1024];
+    const char *cursor = text;
+    const char *end = text + len;
+    ParseU64Status status = PARSE_U64_OK;
+    size_t total = 0;
+    *sum = 0;
+    while (cursor < end && status == PARSE_U64_OK)
+    {
+        size_t n = parse_u64_list(&cursor, end, vals, sizeof(vals) / sizeof(vals[0]), &status);
+        for (size_t i = 0; i < n; ++i)
+            *sum += vals[i];
+        total += n;
+    }
+    return status == PARSE_U64_OK && total == count;
+}
+
+static bool check_edges(void)
+{
+    static const struct
+    {
+        const char *text;
+        bool ok;
+        unsigned long long value;
+    } cases[] = {
+        {"0", true, 0},
+        {"12345678", true, 12345678},
+        {"1234567890123456", true, 1234567890123456ULL},
+        {"18446744073709551615", true, ULLONG_MAX},
+        {"18446744073709551616", false, 0},
+        {"99999999999999999999", false, 0},
+        {"0000000000000000000000042", true, 42},
+        {"", false, 0},
+        {"-5", false, 0},
+        {"+5", false, 0},
+        {" 5", false, 0},
+        {"12a45678", false, 0},
+        {"1234567/", false, 0},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        unsigned long long v = 0;
+        bool got = parse_u64(cases[i].text, &v);
+        if (got != cases[i].ok || (got && v != cases[i].value))
+        {
+            printf("  parse_u64(\"%s\") gave %s %llu\n", cases[i].text, got ? "true" : "false", v);
+            ok = false;
+        }
+    }
+
+    // Lists: whitespace, errors and the cursor left at the offending number
+    const char *list = " 7\t11\n\n13  ";
+    const char *cursor = list;
+    unsigned long long vals[4];
+    ParseU64Status status;
+    size_t n = parse_u64_list(&cursor, list + strlen(list), vals, 4, &status);
+    ok = ok && n == 3 && vals[2] == 13 && status == PARSE_U64_OK && *cursor == '\0';
+
+    const char *bad = "2 3 18446744073709551616 5";
+    cursor = bad;
+    n = parse_u64_list(&cursor, bad + strlen(bad), vals, 4, &status);
+    ok = ok && n == 2 && status == PARSE_U64_OVERFLOW && cursor == bad + 4;
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 5000000;
+    if (count == 0)
+    {
+        fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool edges = check_edges();
+    printf("Edge cases: %s\n\n", edges ? "all passed" : "FAILED");
+
+    // Candidates of every length from 1 to 20 digits, one per line
+    char *text = malloc(count * 21 + 1);
+    if (text == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < count; ++i)
+        len += (size_t)sprintf(text + len, "%llu\n", next_random() >> (next_random() % 64));
+
+    printf("Parsing %zu numbers (%.1f MB)\n\n", count, len / 1e6);
+    printf("  %-18s %14s %10s\n", "Method", "Numbers/s", "MB/s");
+
+    unsigned long long sum_a, sum_b;
+    double t0 = now_seconds();
+    bool ok_a = sum_strtoull(text, count, &sum_a);
+    double t_a = now_seconds() - t0;
+    t0 = now_seconds();
+    bool ok_b = sum_parse_u64(text, len, count, &sum_b);
+    double t_b = now_seconds() - t0;
+
+    printf("  %-18s %14.0f %10.0f\n", "strtoull", count / t_a, len / t_a / 1e6);
+    printf("  %-18s %14.0f %10.0f   %.2fx\n", "parse_u64_list", count / t_b, len / t_b / 1e6, t_a / t_b);
+
+    free(text);
+    bool ok = edges && ok_a && ok_b && sum_a == sum_b;
+    printf("\n%s\n", ok ? "Both methods agree" : "MISMATCH");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+/*
+ * Prime Number Testing - Decimal Parsing
+ * Unsigned 64-bit parsing, eight digits per step (SWAR)
+ */
+
+#include "parse_u64.h"
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+_Static_assert(ULLONG_MAX == UINT64_MAX, "unsigned long long must be 64 bits");
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Loads 8 bytes so that the first character ends up in the low byte.
+static uint64_t load_eight(const char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// One byte per character: zero where the character is '0'..'9'. Each byte
+// must be 0x3N, and adding 6 to N must not carry into the high nibble. A
+// carry out of a non-digit byte can only disturb the bytes after it.
+static uint64_t non_digit_mask(uint64_t v)
+{
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ^
+           0x3333333333333333ULL;
+}
+
+// Converts 8 digit characters with three multiplies: adjacent digits are
+// combined into pairs, then pairs into 4-digit halves, then the halves.
+static uint64_t eight_digits_value(uint64_t v)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return v;
+}
+
+static const uint64_t pow10[8] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+
+// Parses the digits at p (there is at least one), up to end. Stores the value
+// and returns the first character after the digits, or NULL on overflow.
+static const char *parse_digits(const char *p, const char *end, uint64_t *val)
+{
+    // Leading zeros do not count towards the 20 digits that fit
+    while (p < end && *p == '0')
+    {
+        ++p;
+    }
+
+    // Up to two 8-byte blocks: 16 digits stay below 10^16, so no overflow.
+    // A block holding fewer than 8 digits ends the number; its digits are
+    // moved to the top of the word behind '0' padding and converted at once.
+    uint64_t v = 0;
+    for (int block = 0; block < 2 && end - p >= 8; ++block)
+    {
+        uint64_t chunk = load_eight(p);
+        uint64_t mask = non_digit_mask(chunk);
+        if (mask == 0)
+        {
+            v = v * 100000000 + eight_digits_value(chunk);
+            p += 8;
+            continue;
+        }
+        int n = __builtin_ctzll(mask) / 8;
+        if (n > 0)
+        {
+            chunk = (chunk << (64 - 8 * n)) | (0x3030303030303030ULL >> (8 * n));
+            v = v * pow10[n] + eight_digits_value(chunk);
+            p += n;
+        }
+        *val = v;
+        return p;
+    }
+
+    // The rest one at a time; only digits 19 and 20 can overflow
+    for (; p < end && is_digit(*p); ++p)
+    {
+        if (__builtin_mul_overflow(v, 10, &v) ||
+            __builtin_add_overflow(v, (uint64_t)(*p - '0'), &v))
+        {
+            return NULL;
+        }
+    }
+    *val = v;
+    return p;
+}
+
+size_t parse_u64_list(const char **cursor, const char *end,
+                      unsigned long long *out, size_t capacity,
+                      ParseU64Status *status)
+{
+    const char *p = *cursor;
+    size_t count = 0;
+    *status = PARSE_U64_OK;
+
+    while (count < capacity)
+    {
+        while (p < end && is_space(*p))
+        {
+            ++p;
+        }
+        if (p == end)
+        {
+            break;
+        }
+        if (!is_digit(*p))
+        {
+            *status = PARSE_U64_INVALID;
+            break;
+        }
+
+        uint64_t v;
+        const char *next = parse_digits(p, end, &v);
+        if (next == NULL)
+        {
+            *status = PARSE_U64_OVERFLOW;
+            break;
+        }
+        if (next < end && !is_space(*next))
+        {
+            // Digits followed by something else, such as "12abc" or "7,"
+            *status = PARSE_U64_INVALID;
+            break;
+        }
+        out[count++] = v;
+        p = next;
+    }
+
+    // A trailing run of whitespace is consumed too, so that *cursor == end
+    // tells the caller everything was read.
+    while (count == capacity && p < end && is_space(*p))
+    {
+        ++p;
+    }
+    *cursor = p;
+    return count;
+}
+
+bool parse_u64(const char *str, unsigned long long *val)
+{
+    const char *end = str + strlen(str);
+    uint64_t v;
+    if (str == end || !is_digit(*str))
+    {
+        return false;
+    }
+    const char *next = parse_digits(str, end, &v);
+    if (next != end)
+    {
+        return false;
+    }
+    *val = v;
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef PRIMETEST_PARSE_U64_H
+#define PRIMETEST_PARSE_U64_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum
+{
+    PARSE_U64_OK,       // reached the end of the input, or filled the output
+    PARSE_U64_INVALID,  // found a character that is neither a digit nor whitespace
+    PARSE_U64_OVERFLOW, // found a number greater than ULLONG_MAX
+} ParseU64Status;
+
+// Parses whitespace-separated decimal numbers from [*cursor, end) into out,
+// storing at most capacity values, and returns how many were stored. *cursor
+// is advanced past the numbers stored; on an error it is left at the start of
+// the offending number. Nothing is allocated and no locale is consulted.
+size_t parse_u64_list(const char **cursor, const char *end,
+                      unsigned long long *out, size_t capacity,
+                      ParseU64Status *status);
+
+// Converts the whole of str, which must consist of decimal digits only.
+// Returns false on an empty string, any other character, or overflow.
+bool parse_u64(const char *str, unsigned long long *val);
+
+#endif // PRIMETEST_PARSE_U64_H